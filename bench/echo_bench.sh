@@ -0,0 +1,42 @@
+#!/bin/sh
+# @file echo_bench.sh
+# @brief Benchmark of built-in echo against the external /bin/echo
+# @author Nom1
+# @author Nom2
+# @date 2025-26
+# @details Exécute un script de N lignes "echo" avec la commande intégrée (echo) puis avec la commande externe (/bin/echo),
+#   sortie vers /dev/null, et affiche la durée et le débit (commandes par seconde) de chaque variante.
+#
+#   Utilisation : echo_bench.sh [minishell] [iterations] [iterations de la commande externe]   (par défaut : ./minishell 100000 100000)
+
+SHELL_BIN=${1:-./minishell}
+N=${2:-100000}
+N_EXT=${3:-$N}
+TMP=$(mktemp -d) || exit 1
+trap 'rm -rf "$TMP"' EXIT
+
+# script de N lignes identiques
+gen() {
+    awk -v n="$1" -v cmd="$2" 'BEGIN { for (i = 0; i < n; i++) print cmd " hello world " i % 10 }' > "$3"
+}
+
+# durée d'exécution du script en secondes (horloge en nanosecondes de date)
+run() {
+    t0=$(date +%s%N)
+    "$SHELL_BIN" "$1" > /dev/null || exit 1
+    t1=$(date +%s%N)
+    echo $(( (t1 - t0) / 1000 ))
+}
+
+gen "$N" echo "$TMP/builtin.sh"
+gen "$N_EXT" /bin/echo "$TMP/external.sh"
+
+us_builtin=$(run "$TMP/builtin.sh")
+us_external=$(run "$TMP/external.sh")
+
+awk -v n="$N" -v ne="$N_EXT" -v b="$us_builtin" -v e="$us_external" 'BEGIN {
+    printf "%-10s %10s %12s %14s\n", "commande", "iterations", "durée (s)", "commandes/s"
+    printf "%-10s %10d %12.3f %14.0f\n", "echo", n, b / 1e6, n / (b / 1e6)
+    printf "%-10s %10d %12.3f %14.0f\n", "/bin/echo", ne, e / 1e6, ne / (e / 1e6)
+    printf "accélération : x%.1f par commande\n", (e / ne) / (b / n)
+}'
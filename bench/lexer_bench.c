@@ -0,0 +1,169 @@
+/** @file lexer_bench.c
+ * @brief Benchmark of command line tokenization
+ * @author Nom1
+ * @author Nom2
+ * @date 2025-26
+ * @details Mesure le débit (Mo/s) du découpage d'une ligne de commande avec l'ancienne chaîne de passes
+ *   (*trim()*, *clean()*, *separate_s()*, *substenv()*, *strcut()*) et avec l'analyseur lexical en une passe (*lexer_next()*),
+ *   ainsi que le coût complet de *parse_command_line()* suivie de l'instanciation des pipelines (analyse lexicale et construction des processus).
+ *   L'ancienne chaîne étant quadratique, elle n'est mesurée que jusqu'à une taille maximale.
+ *
+ *   Utilisation : lexer_bench [taille maximale de l'ancienne chaîne en Ko]   (par défaut : 1024)
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+
+#include "parser.h"
+#include "lexer.h"
+#include "plan.h"
+#include "env.h"
+
+/// Motif répété pour construire les lignes
+#define PATTERN "echo abc def $HOME \"x y\" ; "
+
+/** @brief Temps monotone courant en secondes. */
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/** @brief Construction d'une ligne d'environ *size* octets. */
+static char* make_line(size_t size) {
+    size_t plen = strlen(PATTERN);
+    char* line = malloc(size + plen + 1);
+    if (!line) return NULL;
+    size_t len = 0;
+    while (len < size) {
+        memcpy(line + len, PATTERN, plen);
+        len += plen;
+    }
+    line[len] = '\0';
+    return line;
+}
+
+/** @brief Paramètres d'une mesure de l'ancienne chaîne. */
+typedef struct {
+    const char* line;
+    double seconds;
+    int tokens;
+} old_run_t;
+
+/** @brief Ancienne chaîne de passes, exécutée dans un thread à grande pile (les fonctions utilisent des VLA de la taille de la ligne). */
+static void* old_chain(void* arg) {
+    old_run_t* run = arg;
+    size_t len = strlen(run->line);
+    size_t max = 3 * len + 4096;
+    char* str = malloc(max);
+    char** tokens = malloc((max / 2 + 1) * sizeof(char*));
+    if (!str || !tokens) { free(str); free(tokens); run->tokens = -1; return NULL; }
+    memcpy(str, run->line, len + 1);
+
+    double t0 = now();
+    trim(str);
+    clean(str);
+    separate_s(str, ";", max);
+    substenv(str, max);
+    run->tokens = strcut(str, ' ', tokens, max / 2 + 1);
+    run->seconds = now() - t0;
+
+    free(str);
+    free(tokens);
+    return NULL;
+}
+
+/** @brief Mesure de l'ancienne chaîne sur *line*. */
+static int bench_old(const char* line, double* seconds) {
+    pthread_attr_t attr;
+    pthread_t thread;
+    old_run_t run = { line, 0, 0 };
+
+    pthread_attr_init(&attr);
+    pthread_attr_setstacksize(&attr, 16 * strlen(line) + (64 << 20));
+    int err = pthread_create(&thread, &attr, old_chain, &run);
+    pthread_attr_destroy(&attr);
+    if (err) return -1;
+    pthread_join(thread, NULL);
+    *seconds = run.seconds;
+    return run.tokens;
+}
+
+/** @brief Mesure de l'analyseur lexical seul sur *line*. */
+static int bench_lexer(const char* line, double* seconds) {
+    arena_t arena = {0};
+    lexer_t lex;
+    token_t tok;
+    int count = 0, r;
+
+    double t0 = now();
+    lexer_init(&lex, line, strlen(line), &arena);
+    while ((r = lexer_next(&lex, &tok)) > 0) count++;
+    *seconds = now() - t0;
+
+    arena_destroy(&arena);
+    return r < 0 ? -1 : count;
+}
+
+/** @brief Instanciation de tous les pipelines d'une ligne analysée, comme le fait son exécution (construction des processus). */
+static int instantiate_all(command_line_t* cmdl) {
+    for (size_t pc = 0; pc < cmdl->code_len; ++pc) {
+        const instruction_t* in = &cmdl->code[pc];
+        control_flow_t* cf;
+        if ((in->op == BC_PIPELINE || in->op == BC_BUILTIN || in->op == BC_ASSIGN) && plan_instantiate(cmdl, in->arg, &cf) != 0) return -1;
+    }
+    return 0;
+}
+
+/** @brief Mesure de *parse_command_line()* et de l'instanciation des pipelines de *line*. */
+static int bench_parse(const char* line, double* seconds) {
+    command_line_t cmdl = {0};
+    init_command_line(&cmdl);
+
+    double t0 = now();
+    int r = parse_command_line(&cmdl, line);
+    if (r == 0) r = instantiate_all(&cmdl);
+    *seconds = now() - t0;
+
+    int count = (r == 0) ? (int)cmdl.num_commands : -1;
+    init_command_line(&cmdl);
+    arena_destroy(&cmdl.arena);
+    return count;
+}
+
+int main(int argc, char* argv[]) {
+    size_t old_max = (argc > 1 ? strtoul(argv[1], NULL, 10) : 1024) << 10;
+    const size_t sizes[] = { 64 << 10, 256 << 10, 1 << 20, 4 << 20, 16 << 20 };
+
+    env_set("HOME", "/home/user", ENV_EXPORT);
+    printf("%-10s %22s %22s %22s\n", "taille", "ancienne chaîne", "lexer", "parse_command_line");
+
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); ++i) {
+        char* line = make_line(sizes[i]);
+        if (!line) return 1;
+        double mb = strlen(line) / 1e6;
+        double t_old = 0, t_lex = 0, t_parse = 0;
+        char old_col[64] = "-";
+
+        if (sizes[i] <= old_max) {
+            if (bench_old(line, &t_old) < 0) snprintf(old_col, sizeof(old_col), "erreur");
+            else snprintf(old_col, sizeof(old_col), "%9.3f s %7.2f Mo/s", t_old, mb / t_old);
+        }
+        int n_lex = bench_lexer(line, &t_lex);
+        int n_cmd = bench_parse(line, &t_parse);
+        if (n_lex < 0 || n_cmd < 0) {
+            fprintf(stderr, "erreur d'analyse\n");
+            return 1;
+        }
+
+        printf("%-7zu Ko %22s %9.3f s %7.1f Mo/s %9.3f s %7.1f Mo/s\n", sizes[i] >> 10, old_col,
+               t_lex, mb / t_lex, t_parse, mb / t_parse);
+        fflush(stdout);
+        free(line);
+    }
+    return 0;
+}
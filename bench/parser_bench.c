@@ -0,0 +1,361 @@
+/** @file parser_bench.c
+ * @brief Scaling benchmark of the parser primitives
+ * @author Nom1
+ * @author Nom2
+ * @date 2025-26
+ * @details Mesure le débit (Mo/s) de chaque primitive de parser.c (*trim()*, *clean()*, *separate_s()*, *replace()*, *substenv()*, *strcut()*)
+ *   et de *parse_command_line()* sur des lignes générées de 100 octets à 16 Mo, pour plusieurs profils de lignes
+ *   (proportions d'opérateurs et de variables $VAR). Pour chaque primitive, la complexité est estimée par la pente de la droite
+ *   des moindres carrés de log(durée) en fonction de log(taille) : environ 1 pour un traitement linéaire, 2 pour un traitement quadratique.
+ *
+ *   Chaque mesure est faite dans un thread dont la pile est allouée par le programme (sans réservation de mémoire) :
+ *   le nombre de pages de pile effectivement touchées, relevé avec *mincore()*, donne la profondeur de pile maximale atteinte
+ *   (certaines primitives utilisent des VLA de la taille maximale de la ligne). Une réécriture doit montrer une pente proche de 1
+ *   et une pile indépendante de la taille de la ligne.
+ *
+ *   Une taille n'est mesurée que si sa durée, extrapolée depuis les deux tailles précédentes, reste sous le budget :
+ *   les primitives quadratiques s'arrêtent donc avant 16 Mo.
+ *
+ *   Utilisation : parser_bench [-t budget par appel en secondes] [-p profil]   (par défaut : 0.5 s, tous les profils)
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "parser.h"
+#include "plan.h"
+#include "env.h"
+
+/// Nombre de tailles de lignes mesurées
+#define NUM_SIZES 10
+/// Durée cumulée minimale d'une mesure (les petites lignes sont traitées plusieurs fois)
+#define MIN_MEASURE 0.05
+/// Taille à partir de laquelle les points entrent dans l'estimation de la pente (les coûts fixes dominent en dessous)
+#define FIT_MIN_SIZE (6 << 10)
+/// Pile des threads de mesure en plus de la taille du tampon de travail
+#define STACK_MARGIN (16 << 20)
+
+/// Tailles des lignes mesurées (facteur 4 entre deux tailles, jusqu'à 16 Mo)
+static const size_t sizes[NUM_SIZES] = { 100, 400, 1600, 6400, 25600, 102400, 409600, 1638400, 6553600, 16 << 20 };
+
+/**
+ * @brief Structure représentant un profil de lignes générées.
+ * @struct profile_t
+ */
+typedef struct {
+    const char* name;  ///< Nom du profil
+    int op_pct;        ///< Pourcentage de tokens opérateurs
+    int var_pct;       ///< Pourcentage de mots $VAR
+} profile_t;
+
+/// Profils mesurés
+static const profile_t profiles[] = {
+    { "mots",       0,  0 },
+    { "operateurs", 40, 0 },
+    { "variables",  0,  50 },
+    { "mixte",      20, 25 },
+};
+
+typedef struct run_t run_t;
+
+/**
+ * @brief Structure représentant une primitive mesurée.
+ * @struct primitive_t
+ */
+typedef struct {
+    const char* name;          ///< Nom (colonne)
+    int (*call)(run_t* run);   ///< Appel sur *run->work* : valeur positive ou nulle en cas de succès, -1 en cas d'erreur
+} primitive_t;
+
+/**
+ * @brief Structure représentant une mesure, partagée avec le thread qui l'exécute.
+ * @struct run_t
+ */
+struct run_t {
+    const char* line;          ///< Ligne générée
+    size_t len;                ///< Longueur de la ligne
+    char* work;                ///< Copie modifiable de la ligne
+    size_t max;                ///< Taille du tampon *work* (argument *max* des primitives)
+    char** tokens;             ///< Tableau de tokens de *strcut()*
+    size_t max_tokens;         ///< Taille du tableau *tokens*
+    const primitive_t* prim;   ///< Primitive mesurée
+    double seconds;            ///< Durée moyenne d'un appel
+    int error;                 ///< La primitive a échoué
+};
+
+/** @brief Temps monotone courant en secondes. */
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int call_trim(run_t* run) { return trim(run->work); }
+static int call_clean(run_t* run) { return clean(run->work); }
+static int call_separate_s(run_t* run) { return separate_s(run->work, ";|<>&", run->max); }
+static int call_replace(run_t* run) { return replace(run->work, "$HOME", "/home/user", run->max); }
+static int call_substenv(run_t* run) { return substenv(run->work, run->max); }
+static int call_strcut(run_t* run) { return strcut(run->work, ' ', run->tokens, run->max_tokens); }
+
+/** @brief Instanciation de tous les pipelines d'une ligne analysée, comme le fait son exécution (construction des processus). */
+static int instantiate_all(command_line_t* cmdl) {
+    for (size_t pc = 0; pc < cmdl->code_len; ++pc) {
+        const instruction_t* in = &cmdl->code[pc];
+        control_flow_t* cf;
+        if ((in->op == BC_PIPELINE || in->op == BC_BUILTIN || in->op == BC_ASSIGN) && plan_instantiate(cmdl, in->arg, &cf) != 0) return -1;
+    }
+    return 0;
+}
+
+/** @brief Analyse complète et instanciation des pipelines, sans le cache des plans (vidé avant chaque appel, hors mesure). */
+static int call_parse(run_t* run) {
+    command_line_t cmdl = {0};
+    init_command_line(&cmdl);
+    int r = parse_command_line(&cmdl, run->work);
+    if (r == 0) r = instantiate_all(&cmdl);
+    init_command_line(&cmdl);
+    arena_destroy(&cmdl.arena);
+    return r;
+}
+
+/// Primitives mesurées, dans l'ordre des colonnes
+static const primitive_t primitives[] = {
+    { "trim",       call_trim },
+    { "clean",      call_clean },
+    { "separate_s", call_separate_s },
+    { "replace",    call_replace },
+    { "substenv",   call_substenv },
+    { "strcut",     call_strcut },
+    { "parse",      call_parse },
+};
+#define NUM_PRIMITIVES (sizeof(primitives) / sizeof(primitives[0]))
+
+/** @brief Générateur pseudo-aléatoire déterministe (les lignes sont identiques d'une exécution à l'autre). */
+static unsigned next_random(unsigned* state) {
+    *state = *state * 1103515245u + 12345u;
+    return (*state >> 16) & 0x7fff;
+}
+
+/** @brief Construction d'une ligne valide d'au moins *size* octets selon le profil *p*.
+ * @details Un opérateur est toujours suivi d'un mot (la ligne ne commence ni ne se termine par un opérateur)
+ *    et une redirection d'un mot sans variable : la ligne est acceptée par *parse_command_line()*.
+ */
+static char* make_line(const profile_t* p, size_t size, size_t* len) {
+    static const char* words[] = { "echo", "abc", "defgh", "file.txt", "-l", "x1" };
+    static const char* vars[] = { "$HOME", "$USER", "$PATH_X", "$X1" };
+    static const char* ops[] = { ";", "|", "&&", "||", ">", "<" };
+    unsigned state = 42;
+
+    char* line = malloc(size + 64);
+    if (!line) return NULL;
+    size_t n = 0;
+    int after_op = 1, after_redir = 0;
+    while (n < size || after_op) {
+        unsigned r = next_random(&state) % 100;
+        const char* tok;
+        if (!after_op && r < (unsigned)p->op_pct) {
+            tok = ops[next_random(&state) % 6];
+            after_op = 1;
+            after_redir = (tok[0] == '>' || tok[0] == '<');
+        } else {
+            /* une variable vide après une redirection serait une redirection ambiguë */
+            int var = !after_redir && r >= 100 - (unsigned)p->var_pct;
+            tok = var ? vars[next_random(&state) % 4] : words[next_random(&state) % 6];
+            after_op = after_redir = 0;
+        }
+        size_t tl = strlen(tok);
+        if (n > 0) line[n++] = ' ';
+        memcpy(line + n, tok, tl);
+        n += tl;
+    }
+    line[n] = '\0';
+    *len = n;
+    return line;
+}
+
+/** @brief Corps du thread de mesure : appels répétés jusqu'à MIN_MEASURE secondes cumulées (copie de la ligne hors mesure). */
+static void* measure(void* arg) {
+    run_t* run = arg;
+    double total = 0;
+    long calls = 0;
+
+    do {
+        memcpy(run->work, run->line, run->len + 1);
+        if (run->prim->call == call_parse) plan_cache_clear();
+        double t0 = now();
+        int r = run->prim->call(run);
+        total += now() - t0;
+        calls++;
+        if (r < 0) {
+            run->error = 1;
+            break;
+        }
+    } while (total < MIN_MEASURE);
+
+    run->seconds = total / calls;
+    return NULL;
+}
+
+/** @brief Mesure d'une primitive dans un thread à pile dédiée.
+ * @param stack_peak Pointeur dans lequel est renvoyée la profondeur de pile maximale atteinte (octets).
+ * @return int 0 en cas de succès, -1 en cas d'erreur.
+ */
+static int run_measure(run_t* run, size_t* stack_peak) {
+    size_t page = sysconf(_SC_PAGESIZE);
+    size_t stack_size = (run->max + STACK_MARGIN + page - 1) & ~(page - 1);
+    char* stack = mmap(NULL, stack_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_STACK, -1, 0);
+    if (stack == MAP_FAILED) return -1;
+
+    pthread_attr_t attr;
+    pthread_t thread;
+    pthread_attr_init(&attr);
+    pthread_attr_setstack(&attr, stack, stack_size);
+    int err = pthread_create(&thread, &attr, measure, run);
+    pthread_attr_destroy(&attr);
+    if (!err) pthread_join(thread, NULL);
+
+    /* les pages jamais touchées ne sont pas résidentes : la plus basse résidente marque la profondeur atteinte */
+    size_t num_pages = stack_size / page;
+    unsigned char* vec = malloc(num_pages);
+    *stack_peak = 0;
+    if (vec && mincore(stack, stack_size, vec) == 0) {
+        for (size_t i = 0; i < num_pages; ++i) {
+            if (vec[i] & 1) {
+                *stack_peak = stack_size - i * page;
+                break;
+            }
+        }
+    }
+    free(vec);
+    munmap(stack, stack_size);
+    return (err || run->error) ? -1 : 0;
+}
+
+/** @brief Pente de la droite des moindres carrés de log(durée) en fonction de log(taille). */
+static double fit_slope(const double* seconds, size_t count) {
+    double sx = 0, sy = 0, sxx = 0, sxy = 0;
+    int n = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (seconds[i] <= 0 || sizes[i] < FIT_MIN_SIZE) continue;
+        double x = log((double)sizes[i]), y = log(seconds[i]);
+        sx += x;
+        sy += y;
+        sxx += x * x;
+        sxy += x * y;
+        n++;
+    }
+    if (n < 2) return NAN;
+    return (n * sxy - sx * sy) / (n * sxx - sx * sx);
+}
+
+/** @brief Mesure de toutes les primitives sur un profil et affichage du tableau. */
+static int bench_profile(const profile_t* p, double budget) {
+    double seconds[NUM_PRIMITIVES][NUM_SIZES] = {{0}};
+    size_t stack[NUM_PRIMITIVES] = {0};
+    size_t stack_at[NUM_PRIMITIVES] = {0};
+
+    printf("\nprofil %s (%d %% d'opérateurs, %d %% de variables) : Mo/s\n%-9s", p->name, p->op_pct, p->var_pct, "taille");
+    for (size_t j = 0; j < NUM_PRIMITIVES; ++j) printf(" %10s", primitives[j].name);
+    printf("\n");
+
+    for (size_t i = 0; i < NUM_SIZES; ++i) {
+        size_t len = 0;
+        char* line = make_line(p, sizes[i], &len);
+        run_t run = { line, len, NULL, 4 * len + 4096, NULL, len / 2 + 2, NULL, 0, 0 };
+        run.work = malloc(run.max);
+        run.tokens = malloc(run.max_tokens * sizeof(char*));
+        if (!line || !run.work || !run.tokens) {
+            free(line);
+            free(run.work);
+            free(run.tokens);
+            return -1;
+        }
+
+        if (sizes[i] >= (1 << 20)) printf("%6zu Mo", sizes[i] >> 20);
+        else if (sizes[i] >= 1024) printf("%6.1f Ko", sizes[i] / 1024.0);
+        else printf("%7zu o", sizes[i]);
+
+        for (size_t j = 0; j < NUM_PRIMITIVES; ++j) {
+            /* extrapolation depuis les deux tailles précédentes (pente locale au moins 1) */
+            if (i >= 2 && seconds[j][i - 1] > 0 && seconds[j][i - 2] > 0) {
+                double k = log(seconds[j][i - 1] / seconds[j][i - 2]) / log((double)sizes[i - 1] / sizes[i - 2]);
+                if (k < 1) k = 1;
+                if (seconds[j][i - 1] * pow((double)sizes[i] / sizes[i - 1], k) > budget) {
+                    printf(" %10s", "-");
+                    continue;
+                }
+            } else if (i >= 1 && seconds[j][i - 1] <= 0) {
+                printf(" %10s", "-");
+                continue;
+            }
+
+            size_t peak;
+            run.prim = &primitives[j];
+            run.error = 0;
+            if (run_measure(&run, &peak) != 0) {
+                printf(" %10s", "erreur");
+                continue;
+            }
+            seconds[j][i] = run.seconds;
+            stack[j] = peak;
+            stack_at[j] = sizes[i];
+            printf(" %10.1f", len / run.seconds / 1e6);
+            fflush(stdout);
+        }
+        printf("\n");
+        free(line);
+        free(run.work);
+        free(run.tokens);
+    }
+
+    printf("%-9s", "pente");
+    for (size_t j = 0; j < NUM_PRIMITIVES; ++j) {
+        double k = fit_slope(seconds[j], NUM_SIZES);
+        if (isnan(k)) printf(" %10s", "-");
+        else printf(" %10.2f", k);
+    }
+    printf("\n%-9s", "pile Ko");
+    for (size_t j = 0; j < NUM_PRIMITIVES; ++j) printf(" %10zu", stack[j] >> 10);
+    printf("\n%-9s", "à Ko");
+    for (size_t j = 0; j < NUM_PRIMITIVES; ++j) printf(" %10zu", stack_at[j] >> 10);
+    printf("\n");
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    double budget = 0.5;
+    const char* only = NULL;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "t:p:")) != -1) {
+        switch (opt) {
+        case 't': budget = atof(optarg); break;
+        case 'p': only = optarg; break;
+        default:
+            fprintf(stderr, "usage: %s [-t budget par appel en secondes] [-p profil]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    env_set("HOME", "/home/user", ENV_EXPORT);
+    env_set("USER", "user", ENV_EXPORT);
+    env_set("X1", "valeur", ENV_EXPORT);
+    printf("pente : exposant k de durée ~ taille^k (1 : linéaire, 2 : quadratique), estimé à partir de %d Ko\n", FIT_MIN_SIZE >> 10);
+    printf("pile : profondeur de pile maximale atteinte, à la plus grande taille mesurée\n");
+
+    for (size_t i = 0; i < sizeof(profiles) / sizeof(profiles[0]); ++i) {
+        if (only && strcmp(only, profiles[i].name) != 0) continue;
+        if (bench_profile(&profiles[i], budget) != 0) {
+            fprintf(stderr, "%s: mémoire insuffisante\n", profiles[i].name);
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,133 @@
+/** @file spawn_bench.c
+ * @brief Benchmark of process creation strategies
+ * @author Nom1
+ * @author Nom2
+ * @date 2025-26
+ * @details Mesure le débit de lancement de commandes externes (lancements par seconde) avec l'ancienne stratégie
+ *   de *launch_processus()* (*fork()* + *execvp()* + *waitpid()*), la nouvelle (*posix_spawnp()* + *waitpid()*)
+ *   et le serveur de lancement de l'option -z (*zygote_spawn()* + *zygote_wait()*, serveur créé avant la croissance du tas),
+ *   pour plusieurs tailles de tas du processus parent afin de reproduire le coût de recopie des tables de pages.
+ *
+ *   Utilisation : spawn_bench [iterations] [commande]   (par défaut : 2000 /bin/true ; chemin complet pour le serveur de lancement)
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <spawn.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "zygote.h"
+
+extern char** environ;
+
+/** @brief Temps monotone courant en secondes. */
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/** @brief Lancement par *fork()* + *execvp()*, comme avant l'introduction de *posix_spawn()*. */
+static int run_fork(char** argv) {
+    pid_t pid = fork();
+    if (pid < 0) return -1;
+    if (pid == 0) {
+        signal(SIGINT, SIG_DFL);
+        execvp(argv[0], argv);
+        _exit(127);
+    }
+    int status;
+    return waitpid(pid, &status, 0) < 0 ? -1 : 0;
+}
+
+/** @brief Lancement par *posix_spawnp()*, avec les mêmes attributs que *spawn_processus()*. */
+static int run_spawn(char** argv) {
+    posix_spawnattr_t attr;
+    sigset_t sigdef;
+    pid_t pid;
+
+    posix_spawnattr_init(&attr);
+    sigemptyset(&sigdef);
+    sigaddset(&sigdef, SIGINT);
+    posix_spawnattr_setsigdefault(&attr, &sigdef);
+    posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGDEF);
+    int err = posix_spawnp(&pid, argv[0], NULL, &attr, argv, environ);
+    posix_spawnattr_destroy(&attr);
+    if (err) return -1;
+    int status;
+    return waitpid(pid, &status, 0) < 0 ? -1 : 0;
+}
+
+/** @brief Lancement par le serveur de lancement, avec les mêmes signaux remis par défaut que *run_spawn()*. */
+static int run_zygote(char** argv) {
+    sigset_t sigdef;
+    sigemptyset(&sigdef);
+    sigaddset(&sigdef, SIGINT);
+    zygote_request_t req = { argv[0], argv, environ, { STDIN_FILENO, STDOUT_FILENO, STDERR_FILENO }, NULL, 0, &sigdef };
+    int err, status;
+    pid_t pid = zygote_spawn(&req, &err);
+    if (pid <= 0) return -1;
+    return zygote_wait(pid, &status, NULL);
+}
+
+/** @brief Mesure du débit d'une stratégie de lancement.
+ * @return double Nombre de lancements par seconde, -1 en cas d'erreur.
+ */
+static double measure(int (*run)(char**), char** argv, int iterations) {
+    double start = now();
+    for (int i = 0; i < iterations; ++i) {
+        if (run(argv) != 0) return -1;
+    }
+    return iterations / (now() - start);
+}
+
+int main(int argc, char* argv[]) {
+    int iterations = (argc > 1) ? atoi(argv[1]) : 2000;
+    char* cmd[] = { (argc > 2) ? argv[2] : "/bin/true", NULL };
+    /* tailles de tas simulées (en Mo) : shell vierge, ligne de commande chargée, gros shell */
+    const size_t heaps[] = { 0, 64, 512 };
+
+    if (iterations <= 0) {
+        fprintf(stderr, "usage: %s [iterations] [commande]\n", argv[0]);
+        return 1;
+    }
+
+    /* le serveur est créé tant que le processus est petit, comme au démarrage du shell */
+    if (zygote_start() != 0) {
+        perror("zygote");
+        return 1;
+    }
+
+    printf("%-10s %14s %14s %14s %8s %8s\n", "heap (MB)", "fork+exec/s", "posix_spawn/s", "zygote/s", "spawn", "zygote");
+    for (size_t h = 0; h < sizeof(heaps) / sizeof(heaps[0]); ++h) {
+        size_t size = heaps[h] << 20;
+        char* heap = NULL;
+        if (size) {
+            heap = malloc(size);
+            if (!heap) {
+                perror("malloc");
+                return 1;
+            }
+            /* toucher toutes les pages pour qu'elles soient effectivement mappées */
+            memset(heap, 1, size);
+        }
+
+        double f = measure(run_fork, cmd, iterations);
+        double s = measure(run_spawn, cmd, iterations);
+        double z = measure(run_zygote, cmd, iterations);
+        if (f < 0 || s < 0 || z < 0) {
+            fprintf(stderr, "%s: échec du lancement\n", cmd[0]);
+            return 1;
+        }
+        /* accélérations par rapport à fork() + execvp() */
+        printf("%-10zu %14.0f %14.0f %14.0f %7.2fx %7.2fx\n", heaps[h], f, s, z, s / f, z / f);
+        free(heap);
+    }
+    zygote_stop();
+    return 0;
+}
@@ -0,0 +1,415 @@
+/** @file suite_bench.c
+ * @brief End-to-end benchmark suite of the shell
+ * @author Nom1
+ * @author Nom2
+ * @date 2025-26
+ * @details Exécute le shell compilé sur des charges fixes et affiche les résultats au format JSON (sur la sortie standard),
+ *   pour comparer deux versions du shell. Charges mesurées :
+ *   - trivial : N commandes externes triviales (/bin/true), une par ligne ;
+ *   - andor : longues chaînes "&&" / "||" de commandes intégrées ;
+ *   - pipeline : pipeline profond (head | cat | ... | wc) transportant 1 Go ;
+ *   - redirections : commandes intégrées avec plusieurs redirections chacune ;
+ *   - builtins : script de commandes intégrées (echo, printf, test, true, false) ;
+ *   - startup : temps entre le lancement du shell interactif et l'affichage du premier prompt.
+ *
+ *   Pour chaque charge : durée médiane et 99e centile des exécutions complètes, commandes par seconde (d'après la médiane),
+ *   et appels système par commande, comptés par une exécution supplémentaire sous *ptrace()* : ceux du shell seul
+ *   (y compris ses fils avant leur *execve()*), et le total avec les commandes lancées.
+ *   Le format de sortie est stable : les clés et leur ordre ne changent pas d'une version à l'autre (champ "format").
+ *
+ *   Utilisation : suite_bench [-r exécutions] [-b octets du pipeline] [-w charge] chemin/vers/minishell
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ptrace.h>
+#include <sys/wait.h>
+#include <linux/ptrace.h>
+
+/// Version du format JSON produit
+#define BENCH_FORMAT 1
+/// Nombre maximal de processus suivis simultanément sous ptrace
+#define MAX_TRACED 4096
+
+/**
+ * @brief Structure représentant la configuration d'une exécution de la suite.
+ * @struct config_t
+ */
+typedef struct {
+    const char* shell;        ///< Chemin du shell mesuré
+    const char* dir;          ///< Répertoire temporaire (scripts et fichiers de redirection)
+    int runs;                 ///< Nombre d'exécutions mesurées par charge
+    long long pipe_bytes;     ///< Volume transporté par la charge pipeline
+} config_t;
+
+/**
+ * @brief Structure représentant une charge de travail.
+ * @struct workload_t
+ */
+typedef struct {
+    const char* name;                                     ///< Nom (clé JSON)
+    int max_runs;                                         ///< Nombre maximal d'exécutions (0 : celui de la configuration)
+    long (*generate)(const config_t* cfg, FILE* script);  ///< Écriture du script, renvoie le nombre de commandes (-1 en cas d'erreur)
+} workload_t;
+
+/** @brief Temps monotone courant en secondes. */
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/** @brief Charge trivial : une commande externe par ligne. */
+static long gen_trivial(const config_t* cfg, FILE* f) {
+    (void) cfg;
+    for (int i = 0; i < 1000; ++i) fputs("/bin/true\n", f);
+    return 1000;
+}
+
+/** @brief Charge andor : 10 lignes de 2000 commandes intégrées reliées par "&&" et "||". */
+static long gen_andor(const config_t* cfg, FILE* f) {
+    (void) cfg;
+    for (int line = 0; line < 10; ++line) {
+        fputs("true", f);
+        for (int i = 1; i < 2000; ++i) fputs((i % 2) ? " && false" : " || true", f);
+        fputc('\n', f);
+    }
+    return 10 * 2000;
+}
+
+/** @brief Charge pipeline : 8 étages transportant *pipe_bytes* octets. */
+static long gen_pipeline(const config_t* cfg, FILE* f) {
+    fprintf(f, "head -c %lld /dev/zero | cat | cat | cat | cat | cat | cat | wc -c\n", cfg->pipe_bytes);
+    return 8;
+}
+
+/** @brief Charge redirections : commandes intégrées avec trois redirections chacune. */
+static long gen_redirections(const config_t* cfg, FILE* f) {
+    for (int i = 0; i < 2000; ++i)
+        fprintf(f, "echo line %d > %s/out%d.txt 2>> %s/err.txt < /dev/null\n", i, cfg->dir, i % 16, cfg->dir);
+    return 2000;
+}
+
+/** @brief Charge builtins : mélange des commandes intégrées courantes des scripts. */
+static long gen_builtins(const config_t* cfg, FILE* f) {
+    (void) cfg;
+    static const char* lines[] = {
+        "echo hello world", "printf '%s=%d\\n' x 42", "test 1 -lt 2", "[ -n value ]", "true", "false",
+    };
+    const size_t n = sizeof(lines) / sizeof(lines[0]);
+    for (int i = 0; i < 10000; ++i) fprintf(f, "%s\n", lines[i % n]);
+    return 10000;
+}
+
+/** @brief Charge startup : pas de script, le shell interactif est lancé sur un tube. */
+static long gen_startup(const config_t* cfg, FILE* f) {
+    (void) cfg;
+    (void) f;
+    return 1;
+}
+
+/// Charges de la suite, dans l'ordre d'affichage
+static const workload_t workloads[] = {
+    { "trivial",      0, gen_trivial },
+    { "andor",        0, gen_andor },
+    { "pipeline",     3, gen_pipeline },
+    { "redirections", 0, gen_redirections },
+    { "builtins",     0, gen_builtins },
+    { "startup",      0, gen_startup },
+};
+
+/** @brief Exécution du script *script* par le shell, sorties vers /dev/null.
+ * @return double Durée en secondes, -1 en cas d'erreur.
+ */
+static double run_script(const config_t* cfg, const char* script) {
+    double t0 = now();
+    pid_t pid = fork();
+    if (pid < 0) return -1;
+    if (pid == 0) {
+        int null = open("/dev/null", O_RDWR);
+        dup2(null, STDIN_FILENO);
+        dup2(null, STDOUT_FILENO);
+        execl(cfg->shell, cfg->shell, script, (char*)NULL);
+        _exit(127);
+    }
+    int status;
+    if (waitpid(pid, &status, 0) < 0) return -1;
+    double elapsed = now() - t0;
+    return (WIFEXITED(status) && WEXITSTATUS(status) != 127) ? elapsed : -1;
+}
+
+/** @brief Lancement du shell interactif sur un tube et mesure du temps jusqu'au premier octet du prompt.
+ * @param traced 1 pour lancer le shell sous *ptrace()* (le fils s'arrête avant *execve()*).
+ * @param pid Pointeur dans lequel est renvoyé le PID du shell (l'entrée est fermée : le shell se termine après le prompt).
+ * @return double Durée en secondes, -1 en cas d'erreur.
+ */
+static double run_startup(const config_t* cfg, int traced, pid_t* pid) {
+    int in[2], out[2];
+    if (pipe2(in, O_CLOEXEC) < 0) return -1;
+    if (pipe2(out, O_CLOEXEC) < 0) { close(in[0]); close(in[1]); return -1; }
+
+    double t0 = now();
+    *pid = fork();
+    if (*pid < 0) return -1;
+    if (*pid == 0) {
+        dup2(in[0], STDIN_FILENO);
+        dup2(out[1], STDOUT_FILENO);
+        if (traced) {
+            ptrace(PTRACE_TRACEME, 0, NULL, NULL);
+            raise(SIGSTOP);
+        }
+        execl(cfg->shell, cfg->shell, "-i", (char*)NULL);
+        _exit(127);
+    }
+    close(in[0]);
+    close(out[1]);
+    /* fin de l'entrée : le shell affiche son prompt, lit EOF et se termine */
+    close(in[1]);
+    if (traced) {
+        close(out[0]);
+        return 0;
+    }
+
+    char c;
+    ssize_t n;
+    do n = read(out[0], &c, 1); while (n < 0 && errno == EINTR);
+    double elapsed = now() - t0;
+    close(out[0]);
+    int status;
+    waitpid(*pid, &status, 0);
+    return (n == 1) ? elapsed : -1;
+}
+
+/**
+ * @brief Structure représentant l'état d'un processus suivi sous ptrace.
+ * @struct traced_t
+ */
+typedef struct {
+    pid_t pid;     ///< PID (0 : entrée libre)
+    int execed;    ///< Le processus a exécuté *execve()* : ce n'est plus le shell
+} traced_t;
+
+/** @brief Recherche (ou création) de l'état d'un processus suivi. */
+static traced_t* traced_get(traced_t* table, pid_t pid) {
+    traced_t* free_slot = NULL;
+    for (size_t i = 0; i < MAX_TRACED; ++i) {
+        if (table[i].pid == pid) return &table[i];
+        if (!free_slot && table[i].pid == 0) free_slot = &table[i];
+    }
+    if (free_slot) {
+        free_slot->pid = pid;
+        free_slot->execed = 0;
+    }
+    return free_slot;
+}
+
+/** @brief Comptage des appels système d'une exécution, fils compris.
+ * @param script Script à exécuter (NULL pour la charge startup).
+ * @param shell_calls Pointeur dans lequel est renvoyé le nombre d'appels faits par le shell (et ses fils avant *execve()*).
+ * @param total_calls Pointeur dans lequel est renvoyé le nombre total d'appels.
+ * @return int 0 en cas de succès, -1 si *ptrace()* n'est pas disponible.
+ */
+static int count_syscalls(const config_t* cfg, const char* script, long* shell_calls, long* total_calls) {
+    pid_t pid;
+    if (script) {
+        pid = fork();
+        if (pid < 0) return -1;
+        if (pid == 0) {
+            int null = open("/dev/null", O_RDWR);
+            dup2(null, STDIN_FILENO);
+            dup2(null, STDOUT_FILENO);
+            ptrace(PTRACE_TRACEME, 0, NULL, NULL);
+            raise(SIGSTOP);
+            execl(cfg->shell, cfg->shell, script, (char*)NULL);
+            _exit(127);
+        }
+    } else if (run_startup(cfg, 1, &pid) < 0) {
+        return -1;
+    }
+
+    int status;
+    if (waitpid(pid, &status, 0) < 0 || !WIFSTOPPED(status)) return -1;
+    long options = PTRACE_O_TRACESYSGOOD | PTRACE_O_TRACEFORK | PTRACE_O_TRACEVFORK | PTRACE_O_TRACECLONE
+                 | PTRACE_O_TRACEEXEC | PTRACE_O_EXITKILL;
+    if (ptrace(PTRACE_SETOPTIONS, pid, NULL, (void*)options) < 0) {
+        kill(pid, SIGKILL);
+        waitpid(pid, &status, 0);
+        return -1;
+    }
+
+    traced_t* table = calloc(MAX_TRACED, sizeof(traced_t));
+    if (!table) {
+        kill(pid, SIGKILL);
+        waitpid(pid, &status, 0);
+        return -1;
+    }
+    *shell_calls = 0;
+    *total_calls = 0;
+    /* l'execve() du shell lui-même n'en fait pas une commande lancée */
+    traced_get(table, pid)->execed = -1;
+    ptrace(PTRACE_SYSCALL, pid, NULL, NULL);
+
+    pid_t p;
+    while ((p = waitpid(-1, &status, __WALL)) > 0) {
+        traced_t* t = traced_get(table, p);
+        if (WIFEXITED(status) || WIFSIGNALED(status)) {
+            if (t) t->pid = 0;
+            continue;
+        }
+        if (!WIFSTOPPED(status)) continue;
+
+        int sig = WSTOPSIG(status), inject = 0;
+        if (sig == (SIGTRAP | 0x80)) {
+            struct ptrace_syscall_info info;
+            if (ptrace(PTRACE_GET_SYSCALL_INFO, p, (void*)sizeof(info), &info) > 0 && info.op == PTRACE_SYSCALL_INFO_ENTRY) {
+                (*total_calls)++;
+                if (t && t->execed <= 0) (*shell_calls)++;
+            }
+        } else if (status >> 16 == PTRACE_EVENT_EXEC) {
+            if (t) t->execed = (t->execed < 0) ? 0 : 1;
+        } else if (status >> 16 == 0 && sig != SIGSTOP && sig != SIGTRAP) {
+            /* signal destiné au processus : transmis */
+            inject = sig;
+        }
+        ptrace(PTRACE_SYSCALL, p, NULL, (void*)(long)inject);
+    }
+
+    free(table);
+    return 0;
+}
+
+/** @brief Affichage d'une chaîne JSON (guillemets compris) : '"', '\\' et les caractères de contrôle sont échappés. */
+static void print_json_string(const char* s) {
+    putchar('"');
+    for (; *s; ++s) {
+        unsigned char c = (unsigned char)*s;
+        if (c == '"' || c == '\\')
+            printf("\\%c", c);
+        else if (c < 0x20)
+            printf("\\u%04x", c);
+        else
+            putchar(c);
+    }
+    putchar('"');
+}
+
+/** @brief Comparaison de durées pour *qsort()*. */
+static int cmp_double(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+/** @brief Mesure d'une charge et affichage de son objet JSON.
+ * @return int 0 en cas de succès, -1 en cas d'erreur.
+ */
+static int bench_workload(const config_t* cfg, const workload_t* w, int first) {
+    char script[4096];
+    long commands;
+    int is_startup = (w->generate == gen_startup);
+
+    snprintf(script, sizeof(script), "%s/%s.sh", cfg->dir, w->name);
+    FILE* f = fopen(script, "w");
+    if (!f) {
+        perror(script);
+        return -1;
+    }
+    commands = w->generate(cfg, f);
+    if (fclose(f) != 0 || commands <= 0) return -1;
+
+    int runs = (w->max_runs && w->max_runs < cfg->runs) ? w->max_runs : cfg->runs;
+    double* samples = malloc(runs * sizeof(double));
+    if (!samples) return -1;
+    fprintf(stderr, "%-13s", w->name);
+    for (int r = 0; r < runs; ++r) {
+        pid_t pid;
+        samples[r] = is_startup ? run_startup(cfg, 0, &pid) : run_script(cfg, script);
+        if (samples[r] < 0) {
+            fprintf(stderr, " échec de l'exécution\n");
+            free(samples);
+            return -1;
+        }
+        fputc('.', stderr);
+    }
+    qsort(samples, runs, sizeof(double), cmp_double);
+    double median = (runs % 2) ? samples[runs / 2] : (samples[runs / 2 - 1] + samples[runs / 2]) / 2;
+    int p99_index = (int)(0.99 * runs + 0.999999) - 1;
+    double p99 = samples[p99_index < 0 ? 0 : p99_index];
+    free(samples);
+
+    long shell_calls = -1, total_calls = -1;
+    if (count_syscalls(cfg, is_startup ? NULL : script, &shell_calls, &total_calls) != 0) {
+        shell_calls = total_calls = -1;
+    }
+    fprintf(stderr, " %.3f s\n", median);
+
+    printf("%s    {\"name\": ", first ? "" : ",\n");
+    print_json_string(w->name);
+    printf(", \"commands\": %ld, \"runs\": %d, \"median_ms\": %.3f, \"p99_ms\": %.3f, \"commands_per_sec\": %.1f, ",
+           commands, runs, median * 1e3, p99 * 1e3, commands / median);
+    if (shell_calls < 0)
+        printf("\"syscalls_per_command\": null, \"total_syscalls_per_command\": null}");
+    else
+        printf("\"syscalls_per_command\": %.2f, \"total_syscalls_per_command\": %.2f}",
+               (double)shell_calls / commands, (double)total_calls / commands);
+    fflush(stdout);
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    config_t cfg = { NULL, NULL, 10, 1LL << 30 };
+    const char* only = NULL;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "r:b:w:")) != -1) {
+        switch (opt) {
+        case 'r': cfg.runs = atoi(optarg); break;
+        case 'b': cfg.pipe_bytes = atoll(optarg); break;
+        case 'w': only = optarg; break;
+        default: cfg.runs = 0; break;
+        }
+    }
+    if (optind >= argc || cfg.runs <= 0 || cfg.pipe_bytes <= 0) {
+        fprintf(stderr, "usage: %s [-r exécutions] [-b octets du pipeline] [-w charge] chemin/vers/minishell\n", argv[0]);
+        return 2;
+    }
+    cfg.shell = argv[optind];
+    if (access(cfg.shell, X_OK) != 0) {
+        perror(cfg.shell);
+        return 1;
+    }
+
+    char dir[] = "/tmp/minishell-bench-XXXXXX";
+    if (!mkdtemp(dir)) {
+        perror("mkdtemp");
+        return 1;
+    }
+    cfg.dir = dir;
+
+    printf("{\n  \"format\": %d,\n  \"shell\": ", BENCH_FORMAT);
+    print_json_string(cfg.shell);
+    printf(",\n  \"runs\": %d,\n  \"pipeline_bytes\": %lld,\n  \"workloads\": [\n", cfg.runs, cfg.pipe_bytes);
+    int err = 0, first = 1;
+    for (size_t i = 0; i < sizeof(workloads) / sizeof(workloads[0]); ++i) {
+        if (only && strcmp(only, workloads[i].name) != 0) continue;
+        if (bench_workload(&cfg, &workloads[i], first) != 0) {
+            fprintf(stderr, "%s: échec de la charge\n", workloads[i].name);
+            err = 1;
+            continue;
+        }
+        first = 0;
+    }
+    printf("\n  ]\n}\n");
+
+    /* nettoyage du répertoire temporaire */
+    char cmd[4200];
+    snprintf(cmd, sizeof(cmd), "rm -rf '%s'", dir);
+    if (system(cmd) != 0) fprintf(stderr, "%s: non supprimé\n", dir);
+    return err;
+}
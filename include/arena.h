@@ -0,0 +1,113 @@
+/**
+ * @file arena.h
+ * @brief Header file for the per-line arena allocator
+ * @author Nom1
+ * @author Nom2
+ * @date 2025-26
+ * @details Définitions d'un allocateur "bump" par blocs. Toutes les données d'une ligne de commande (copie de la ligne, mots,
+ *   processus, noeuds de contrôle de flux, vecteurs d'arguments) sont allouées dans une arène et libérées en une seule fois
+ *   par *arena_reset()* avant la ligne suivante : il n'y a ni *free()* individuel, ni limite fixe sur le nombre d'éléments.
+ */
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+/// Taille par défaut d'un bloc de l'arène
+#define ARENA_BLOCK_SIZE (64 * 1024)
+
+/**
+ * @brief Bloc mémoire d'une arène.
+ * @struct arena_block_t
+ */
+typedef struct arena_block {
+    struct arena_block* next; ///< Bloc suivant (plus ancien)
+    size_t size;              ///< Taille de la zone de données
+    size_t used;              ///< Nombre d'octets utilisés
+    char data[];              ///< Zone de données
+} arena_block_t;
+
+/**
+ * @brief Structure représentant une arène.
+ * @struct arena_t
+ * @details Une arène initialisée à zéro est valide et vide : le premier bloc est alloué à la première demande.
+ */
+typedef struct {
+    arena_block_t* current; ///< Bloc courant (les blocs pleins sont chaînés derrière lui)
+    void* last;             ///< Dernière allocation, qui peut être agrandie sur place
+} arena_t;
+
+/**
+ * @brief Position dans une arène, à laquelle elle peut être ramenée.
+ * @struct arena_mark_t
+ */
+typedef struct {
+    arena_block_t* block;   ///< Bloc courant au moment de la prise de position (NULL si l'arène était vide)
+    size_t used;            ///< Nombre d'octets alors utilisés dans ce bloc
+} arena_mark_t;
+
+/** @brief Fonction d'allocation dans une arène.
+ * @param arena Pointeur vers l'arène.
+ * @param size Taille demandée en octets.
+ * @return void* Zone alignée pour tout type (non initialisée), NULL en cas d'erreur.
+ * @details Si le bloc courant est plein, un nouveau bloc d'au moins ARENA_BLOCK_SIZE octets est ajouté.
+ */
+void* arena_alloc(arena_t* arena, size_t size);
+
+/** @brief Fonction d'allocation d'une zone initialisée à zéro dans une arène.
+ * @param arena Pointeur vers l'arène.
+ * @param size Taille demandée en octets.
+ * @return void* Zone alignée remplie de zéros, NULL en cas d'erreur.
+ */
+void* arena_calloc(arena_t* arena, size_t size);
+
+/** @brief Fonction d'agrandissement d'une zone allouée dans une arène.
+ * @param arena Pointeur vers l'arène.
+ * @param ptr Zone à agrandir (ou NULL).
+ * @param old_size Taille actuelle de la zone.
+ * @param new_size Nouvelle taille.
+ * @return void* Zone redimensionnée, dont les premiers octets (au plus *old_size*) sont conservés, NULL en cas d'erreur.
+ * @details Si *ptr* est la dernière allocation de l'arène, la zone est réduite sur place (l'espace libéré est rendu au bloc courant),
+ *    ou agrandie sur place si le bloc courant a la place. Une autre zone n'est jamais réduite ; pour l'agrandir, une nouvelle zone
+ *    est allouée et les données y sont recopiées (l'ancienne zone est perdue jusqu'au prochain *arena_reset()*).
+ */
+void* arena_realloc(arena_t* arena, void* ptr, size_t old_size, size_t new_size);
+
+/** @brief Fonction de copie d'une chaîne de caractères dans une arène.
+ * @param arena Pointeur vers l'arène.
+ * @param str Chaîne à copier.
+ * @param len Nombre d'octets à copier (un '\0' est ajouté).
+ * @return char* Copie de la chaîne, NULL en cas d'erreur.
+ */
+char* arena_strndup(arena_t* arena, const char* str, size_t len);
+
+/** @brief Fonction de prise de position dans une arène.
+ * @param arena Pointeur vers l'arène.
+ * @return arena_mark_t Position courante.
+ * @details Les allocations antérieures ne peuvent plus être agrandies sur place : *arena_rewind()* ne peut donc pas les tronquer.
+ */
+arena_mark_t arena_mark(arena_t* arena);
+
+/** @brief Fonction de retour d'une arène à une position.
+ * @param arena Pointeur vers l'arène.
+ * @param mark Position obtenue par *arena_mark()* (aucun *arena_reset()* ne doit avoir eu lieu depuis).
+ * @details Les allocations postérieures à la position sont invalidées et les blocs ajoutés depuis sont libérés ;
+ *    les allocations antérieures restent valides. Permet de réutiliser la même mémoire à chaque itération d'une boucle.
+ */
+void arena_rewind(arena_t* arena, arena_mark_t mark);
+
+/** @brief Fonction de remise à zéro d'une arène.
+ * @param arena Pointeur vers l'arène.
+ * @details Toutes les allocations sont invalidées. Le premier bloc alloué est conservé (vidé) pour la ligne suivante s'il a la taille par défaut, les autres sont libérés :
+ *    le coût est proportionnel au nombre de blocs utilisés, donc à la quantité de mémoire réellement consommée par la ligne.
+ */
+void arena_reset(arena_t* arena);
+
+/** @brief Fonction de libération d'une arène.
+ * @param arena Pointeur vers l'arène.
+ * @details Libère tous les blocs ; l'arène redevient vide et réutilisable.
+ */
+void arena_destroy(arena_t* arena);
+
+#endif // ARENA_H
@@ -5,6 +5,8 @@
  * @author Nom2
  * @date 2025-26
  * @details Définitions des fonctions des commandes intégrées.
+ *   Les commandes sont décrites par une table (nom, fonction, flags) indexée par le hachage de leur nom : la recherche est en temps constant.
+ *   Les commandes les plus fréquentes des scripts (echo, printf, true, false, test) sont intégrées : elles ne coûtent ni *fork()* ni *execve()*.
  */
 
 #ifndef BUILTINS_H
@@ -12,23 +14,56 @@
 
 #include "processus.h"
 
+/// La commande modifie l'état du shell (répertoire courant, variables, jobs...) : elle n'a d'effet qu'exécutée dans le processus du shell
+#define BUILTIN_PARENT 0x1
+/// La commande ne modifie pas l'état du shell : le shell peut l'exécuter lui-même, y compris en dernier étage d'un pipeline
+#define BUILTIN_NOFORK 0x2
+/// Taille du tampon de sortie des commandes intégrées
+#define BUILTIN_OUT_SIZE 4096
+
+/** @brief Type des fonctions de commandes intégrées (renvoient le code de retour de la commande). */
+typedef int (*builtin_fn_t)(processus_t* cmd);
+
+/**
+ * @brief Structure représentant une commande intégrée.
+ * @struct builtin_t
+ */
+typedef struct {
+    const char* name;  ///< Nom de la commande
+    builtin_fn_t fn;   ///< Fonction d'exécution
+    int flags;         ///< BUILTIN_PARENT, BUILTIN_NOFORK
+} builtin_t;
+
+/** @brief Fonction de recherche d'une commande intégrée.
+ * @param name Nom de la commande.
+ * @return const builtin_t* Description de la commande, NULL si elle n'est pas intégrée.
+ */
+const builtin_t* builtin_find(const char* name);
+
+/** @brief Fonction d'accès à la table des commandes intégrées.
+ * @param count Pointeur dans lequel est renvoyé le nombre de commandes.
+ * @return const builtin_t* Tableau des commandes intégrées (utilisé par la complétion).
+ */
+const builtin_t* builtin_list(size_t* count);
+
 /** @brief Fonction de vérification si une commande est une commande "built-in".
  * @param cmd Structure de commande à vérifier. (Le champ *path* est utilisé pour vérifier le nom de la commande.)
  * @return int 1 si la commande est intégrée, 0 sinon.
- * @details Les commandes intégrées sont a minima: cd, exit, export, unset, pwd.
+ * @details Les commandes intégrées sont a minima: cd, exit, export, unset, pwd (ainsi que hash, plancache, jobs, wait, fg, bg,
+ *  echo, printf, true, false, test, [, break et continue).
  */
 int is_builtin(const processus_t* cmd);
 
 /** @brief Fonction d'exécution d'une commande intégrée.
  * @param cmd Pointeur vers la structure de commande à exécuter.
- * @return int 0 en cas de succès, -1 en cas d'erreur.
+ * @return int Code de retour de la commande (0 en cas de succès), -1 si la commande n'est pas intégrée.
  */
 int exec_builtin(processus_t* cmd);
 
 /** Fonctions spécifiques aux commandes intégrées. */
 /** @brief Fonction d'exécution de la commande "cd".
  * @param cmd Pointeur vers la structure de commande à exécuter.
- * @return int 0 en cas de succès, -1 en cas d'erreur.
+ * @return int Code de retour de la commande : 0 en cas de succès, 1 en cas d'erreur.
  * @details Déplace le CWD du processus vers le répertoire spécifié dans le premier argument de la commande.
  *  Si aucun argument n'est fourni, le CWD est déplacé vers le répertoire HOME de l'utilisateur.
  *  En cas d'erreur (répertoire inexistant, permission refusée, etc.), un message d'erreur est affiché sur *cmd->stderr* et la fonction retourne un code d'erreur.
@@ -37,7 +72,7 @@ int builtin_cd(processus_t* cmd);
 
 /** @brief Fonction d'exécution de la commande "exit".
  * @param cmd Pointeur vers la structure de commande à exécuter.
- * @return int 0 en cas de succès, -1 en cas d'erreur.
+ * @return int Code de retour de la commande : 0 en cas de succès, 1 en cas d'erreur.
  * @details Termine le shell avec le code de sortie spécifié dans le premier argument de la commande.
  *  Si aucun argument n'est fourni, le shell se termine avec le code de sortie 0.
  *  En cas d'erreur (argument non numérique, etc.), un message d'erreur est affiché sur *cmd->stderr* et la fonction retourne un code d'erreur
@@ -46,23 +81,125 @@ int builtin_exit(processus_t* cmd);
 
 /** @brief Fonction d'exécution de la commande "export".
  * @param cmd Pointeur vers la structure de commande à exécuter.
- * @return int 0 en cas de succès, -1 en cas d'erreur.
- * @details Ajoute ou modifie une variable d'environnement dans l'environnement du shell. En cas d'erreur (format invalide, etc.), un message d'erreur est affiché sur *cmd->stderr* et la fonction retourne un code d'erreur.
+ * @return int Code de retour de la commande : 0 en cas de succès, 1 en cas d'erreur.
+ * @details Pour chaque argument NOM=valeur, ajoute ou modifie la variable et l'exporte vers les commandes lancées ; un argument NOM seul exporte la variable existante.
+ *  Sans argument, affiche les variables exportées sur *cmd->stdout*. En cas d'erreur (nom invalide, etc.), un message d'erreur est affiché sur *cmd->stderr* et la fonction retourne un code d'erreur.
  */
 int builtin_export(processus_t* cmd);
 
 /** @brief Fonction d'exécution de la commande "unset".
  * @param cmd Pointeur vers la structure de commande à exécuter.
- * @return int 0 en cas de succès, -1 en cas d'erreur.
- * @details Supprime une variable d'environnement de l'environnement du shell. En cas d'erreur (variable inexistante, etc.), un message d'erreur est affiché sur *cmd->stderr* et la fonction retourne un code d'erreur.
+ * @return int Code de retour de la commande : 0 en cas de succès, 1 en cas d'erreur.
+ * @details Supprime les variables (locales ou exportées) dont les noms sont passés en arguments. En cas d'erreur (nom invalide, etc.), un message d'erreur est affiché sur *cmd->stderr* et la fonction retourne un code d'erreur.
  */
 int builtin_unset(processus_t* cmd);
 
 /** @brief Fonction d'exécution de la commande "pwd".
  * @param cmd Pointeur vers la structure de commande à exécuter.
- * @return int 0 en cas de succès, -1 en cas d'erreur.
+ * @return int Code de retour de la commande : 0 en cas de succès, 1 en cas d'erreur.
  * @details Affiche le répertoire de travail actuel (CWD) du processus sur la sortie standard *cmd->stdout*. En cas d'erreur, un message d'erreur est affiché sur *cmd->stderr* et la fonction retourne un code d'erreur.
  */
 int builtin_pwd(processus_t* cmd);
 
+/** @brief Fonction d'exécution de la commande "hash".
+ * @param cmd Pointeur vers la structure de commande à exécuter.
+ * @return int Code de retour de la commande : 0 en cas de succès, 1 en cas d'erreur.
+ * @details Sans argument, affiche le contenu du cache des chemins de commandes sur *cmd->stdout*.
+ *  Avec l'option -r, vide le cache. Avec des noms de commandes, les résout et les mémorise (préchargement) ;
+ *  un message d'erreur est affiché sur *cmd->stderr* pour chaque commande introuvable.
+ */
+int builtin_hash(processus_t* cmd);
+
+/** @brief Fonction d'exécution de la commande "plancache".
+ * @param cmd Pointeur vers la structure de commande à exécuter.
+ * @return int Code de retour de la commande : 0 en cas de succès, 1 en cas d'erreur.
+ * @details Sans argument, affiche sur *cmd->stdout* les compteurs du cache des plans de lignes de commande (succès, échecs, remplacements)
+ *  et les lignes en cache avec leur nombre d'utilisations. Avec l'option -r, vide le cache et remet les compteurs à zéro.
+ */
+int builtin_plancache(processus_t* cmd);
+
+/** @brief Fonction d'exécution de la commande "jobs".
+ * @param cmd Pointeur vers la structure de commande à exécuter.
+ * @return int Code de retour de la commande : 0 en cas de succès, 1 en cas d'erreur.
+ * @details Affiche sur *cmd->stdout* les jobs de la table avec leur état. L'option -l ajoute le PID du premier étage, l'option -p n'affiche que les PID.
+ */
+int builtin_jobs(processus_t* cmd);
+
+/** @brief Fonction d'exécution de la commande "wait".
+ * @param cmd Pointeur vers la structure de commande à exécuter.
+ * @return int Code de retour du dernier job attendu, 1 si un job désigné n'existe pas.
+ * @details Sans argument, attend la fin de tous les jobs en cours d'exécution. Sinon, attend chacun des jobs désignés ("%n", "n" ou un PID).
+ *  La commande échoue si un job désigné n'existe pas ou si le dernier job attendu s'est terminé en échec.
+ */
+int builtin_wait(processus_t* cmd);
+
+/** @brief Fonction d'exécution de la commande "fg".
+ * @param cmd Pointeur vers la structure de commande à exécuter.
+ * @return int Code de retour du job, 1 s'il n'existe pas.
+ * @details Passe au premier plan le job désigné (le job courant par défaut) : il reçoit le terminal et SIGCONT, puis le shell attend
+ *  sa terminaison ou sa suspension. La commande échoue si le job n'existe pas ou se termine en échec.
+ */
+int builtin_fg(processus_t* cmd);
+
+/** @brief Fonction d'exécution de la commande "bg".
+ * @param cmd Pointeur vers la structure de commande à exécuter.
+ * @return int Code de retour de la commande : 0 en cas de succès, 1 en cas d'erreur.
+ * @details Relance en arrière-plan (SIGCONT) le job suspendu désigné (le job courant par défaut).
+ */
+int builtin_bg(processus_t* cmd);
+
+/** @brief Fonction d'exécution de la commande "echo".
+ * @param cmd Pointeur vers la structure de commande à exécuter.
+ * @return int Code de retour de la commande : 0 en cas de succès, 1 en cas d'erreur d'écriture.
+ * @details Affiche les arguments séparés par des espaces sur *cmd->stdout*, suivis d'un saut de ligne.
+ *  Options : -n supprime le saut de ligne final, -e interprète les séquences d'échappement (\n, \t, \0nnn, \xHH, \c...), -E les désactive.
+ */
+int builtin_echo(processus_t* cmd);
+
+/** @brief Fonction d'exécution de la commande "printf".
+ * @param cmd Pointeur vers la structure de commande à exécuter.
+ * @return int Code de retour de la commande : 0 en cas de succès, 1 si un argument numérique est invalide ou en cas d'erreur d'écriture, 2 sans format.
+ * @details Affiche les arguments sur *cmd->stdout* selon le format du premier argument (conversions d, i, o, u, x, X, c, s, b, e, f, g et %%,
+ *  avec flags, largeur et précision, éventuellement "*"). Le format est réutilisé tant qu'il reste des arguments.
+ */
+int builtin_printf(processus_t* cmd);
+
+/** @brief Fonction d'exécution de la commande "true".
+ * @param cmd Pointeur vers la structure de commande à exécuter.
+ * @return int 0.
+ */
+int builtin_true(processus_t* cmd);
+
+/** @brief Fonction d'exécution de la commande "false".
+ * @param cmd Pointeur vers la structure de commande à exécuter.
+ * @return int 1.
+ */
+int builtin_false(processus_t* cmd);
+
+/** @brief Fonction d'exécution des commandes "break" et "continue" hors d'une boucle.
+ * @param cmd Pointeur vers la structure de commande à exécuter (*path* : nom de la commande).
+ * @return int 0, ou 1 si le nombre de boucles n'est pas un entier positif.
+ * @details Dans une boucle, "break [n]" et "continue [n]" sont compilés en sauts (voir plan.h) : cette fonction n'est appelée
+ *  qu'en dehors d'une boucle (message affiché, sans effet) ou pour un argument invalide.
+ */
+int builtin_break(processus_t* cmd);
+
+/** @brief Fonction d'exécution de la commande "set".
+ * @param cmd Pointeur vers la structure de commande à exécuter.
+ * @return int Code de retour de la commande : 0 en cas de succès, 2 pour une option invalide.
+ * @details Seule l'option de l'ordonnanceur parallèle est reconnue (voir scheduler.h) : "set -j N" exécute les listes indépendantes
+ *  au plus N à la fois, "set +j" revient à l'exécution dans l'ordre. Sans argument, affiche le réglage courant sur *cmd->stdout*.
+ *  Le réglage s'applique à partir de la ligne suivante ; la commande étant une barrière, les jobs en cours sont terminés avant elle.
+ */
+int builtin_set(processus_t* cmd);
+
+/** @brief Fonction d'exécution des commandes "test" et "[".
+ * @param cmd Pointeur vers la structure de commande à exécuter.
+ * @return int 0 si l'expression est vraie, 1 si elle est fausse, 2 en cas d'erreur de syntaxe.
+ * @details Évalue l'expression formée par les arguments : tests de fichiers (-e, -f, -d, -r, -w, -x, -s, -L...), de chaînes (-n, -z, =, !=),
+ *  comparaisons entières (-eq, -ne, -lt, -le, -gt, -ge), négation (!), parenthèses et opérateurs -a et -o.
+ *  Sous la forme "[", le dernier argument doit être "]".
+ */
+int builtin_test(processus_t* cmd);
+
 #endif // BUILTINS_H
\ No newline at end of file
@@ -0,0 +1,52 @@
+/**
+ * @file complete.h
+ * @brief Header file for tab completion
+ * @author Nom1
+ * @author Nom2
+ * @date 2025-26
+ * @details Définitions de la complétion de l'éditeur de ligne. En position de commande, un mot est complété par les commandes intégrées
+ *   et les exécutables des répertoires du PATH ; ailleurs (arguments, cibles de redirection) et pour un mot contenant un '/', par les noms de fichiers.
+ *   Les exécutables du PATH sont rangés dans un index trié, construit à la première complétion puis conservé : avant chaque complétion,
+ *   seule la date de modification de chaque répertoire est relue, et seuls les répertoires modifiés sont parcourus à nouveau.
+ *   L'index est abandonné à chaque modification de la variable PATH.
+ */
+
+#ifndef COMPLETE_H
+#define COMPLETE_H
+
+#include <stddef.h>
+
+/**
+ * @brief Structure représentant les candidats d'une complétion.
+ * @struct completion_t
+ */
+typedef struct {
+    char* data;      ///< Candidats, chacun terminé par '\0'
+    size_t len;      ///< Octets utilisés dans *data*
+    size_t cap;      ///< Capacité de *data*
+    char** items;    ///< Candidats triés et sans doublon (texte remplaçant le mot, caractères spéciaux échappés)
+    size_t count;    ///< Nombre de candidats
+    size_t display;  ///< Octets de début de chaque candidat à omettre dans la liste affichée (répertoire déjà saisi)
+} completion_t;
+
+/** @brief Fonction de complétion du mot situé avant le curseur.
+ * @param line Ligne en cours d'édition.
+ * @param pos Position du curseur.
+ * @param start Pointeur dans lequel est renvoyé le début du mot à remplacer.
+ * @param out Structure recevant les candidats (initialisée à zéro, à libérer avec *completion_free()*).
+ * @return int Nombre de candidats, -1 en cas d'erreur.
+ * @details Un candidat désignant un répertoire se termine par '/'.
+ */
+int complete_word(const char* line, size_t pos, size_t* start, completion_t* out);
+
+/** @brief Fonction de libération des candidats d'une complétion.
+ * @param c Structure à libérer (remise à zéro).
+ */
+void completion_free(completion_t* c);
+
+/** @brief Fonction d'abandon de l'index des exécutables du PATH.
+ * @details Appelée par la table des variables à chaque modification de la variable PATH ; l'index est reconstruit à la complétion suivante.
+ */
+void complete_invalidate(void);
+
+#endif // COMPLETE_H
@@ -0,0 +1,85 @@
+/**
+ * @file env.h
+ * @brief Header file for the shell variables table
+ * @author Nom1
+ * @author Nom2
+ * @date 2025-26
+ * @details Définitions des fonctions de gestion des variables du shell. Les variables sont conservées dans une table de hachage
+ *   propre au shell (et non dans *environ*) : une variable est locale au shell ou exportée vers les commandes lancées.
+ *   Le tableau "NOM=valeur" passé à *execve()* n'est reconstruit que lorsqu'une variable exportée a changé.
+ */
+
+#ifndef ENV_H
+#define ENV_H
+
+#include <stddef.h>
+
+#include "arena.h"
+
+/// Exporter la variable (sinon, une nouvelle variable est locale et une variable existante garde son statut)
+#define ENV_EXPORT 0x1
+
+/** @brief Fonction d'initialisation de la table à partir d'un environnement.
+ * @param envp Tableau "NOM=valeur" terminé par NULL (en général *environ*) : toutes ses variables sont exportées.
+ * @return int 0 en cas de succès, -1 en cas d'erreur.
+ */
+int env_init(char** envp);
+
+/** @brief Fonction de lecture d'une variable.
+ * @param name Nom de la variable.
+ * @return const char* Valeur de la variable, NULL si elle n'existe pas (ou si elle est exportée sans valeur).
+ * @details Le pointeur retourné reste valide jusqu'à la prochaine modification de la variable.
+ */
+const char* env_get(const char* name);
+
+/** @brief Fonction de modification d'une variable.
+ * @param name Nom de la variable.
+ * @param value Nouvelle valeur (NULL : la variable existe sans valeur, ce qui n'a de sens qu'avec ENV_EXPORT).
+ * @param flags ENV_EXPORT pour exporter la variable, 0 sinon.
+ * @return int 0 en cas de succès, -1 en cas d'erreur (nom invalide, mémoire insuffisante).
+ * @details Une modification de PATH vide le cache des chemins de commandes.
+ */
+int env_set(const char* name, const char* value, int flags);
+
+/** @brief Fonction de modification d'une variable à partir d'une affectation.
+ * @param assignment Chaîne "NOM=valeur".
+ * @param flags ENV_EXPORT pour exporter la variable, 0 sinon.
+ * @return int 0 en cas de succès, -1 en cas d'erreur (affectation invalide, mémoire insuffisante).
+ */
+int env_put(const char* assignment, int flags);
+
+/** @brief Fonction de suppression d'une variable.
+ * @param name Nom de la variable.
+ * @return int 0 en cas de succès (y compris si la variable n'existait pas), -1 si le nom est invalide.
+ */
+int env_unset(const char* name);
+
+/** @brief Fonction de validation d'un nom de variable.
+ * @param name Nom à valider.
+ * @param len Longueur du nom.
+ * @return int 1 si *name* est un nom valide ([A-Za-z_][A-Za-z0-9_]*), 0 sinon.
+ */
+int env_valid_name(const char* name, size_t len);
+
+/** @brief Fonction d'accès à l'environnement des commandes lancées.
+ * @return char** Tableau "NOM=valeur" des variables exportées, terminé par NULL (NULL en cas d'erreur).
+ * @details Le tableau est mis en cache et n'est reconstruit que si une variable exportée a été modifiée depuis le dernier appel.
+ *    Il reste valide jusqu'à la prochaine modification d'une variable exportée.
+ */
+char** env_environ(void);
+
+/** @brief Fonction de construction de l'environnement d'une commande avec des affectations propres.
+ * @param arena Arène dans laquelle le tableau est alloué.
+ * @param overrides Affectations "NOM=valeur" de la commande ("FOO=1 cmd"), terminées par NULL.
+ * @return char** Environnement des variables exportées dans lequel les affectations remplacent ou complètent les variables, NULL en cas d'erreur.
+ */
+char** env_merge(arena_t* arena, char* const* overrides);
+
+/** @brief Fonction d'affichage des variables exportées.
+ * @param fd Descripteur sur lequel écrire.
+ * @return int Nombre de variables affichées.
+ * @details Les variables sont affichées triées par nom, sous la forme "export NOM=\"valeur\"".
+ */
+int env_print(int fd);
+
+#endif // ENV_H
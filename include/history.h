@@ -0,0 +1,83 @@
+/**
+ * @file history.h
+ * @brief Header file for the persistent command history
+ * @author Nom1
+ * @author Nom2
+ * @date 2025-26
+ * @details Définitions de l'historique des commandes, partagé par tous les shells interactifs d'un utilisateur.
+ *   L'historique est un fichier texte en ajout seul (une commande par ligne) : chaque commande y est ajoutée par un seul *write()*
+ *   en O_APPEND, si bien que des shells concurrents ne mélangent jamais leurs lignes. Le fichier est projeté en mémoire (*mmap()*)
+ *   et n'est jamais analysé en entier : les entrées sont désignées par leur position dans le fichier et retrouvées à la demande.
+ *
+ *   La recherche incrémentale s'appuie sur un index persistant, projeté lui aussi en mémoire (fichier de l'historique suivi de ".idx") :
+ *   l'historique est découpé en blocs de lignes d'environ HISTORY_BLOCK_SIZE octets, et chaque bloc a un filtre de Bloom
+ *   des trigrammes (suites de 3 octets) de ses lignes. Une recherche ne parcourt que les blocs dont le filtre contient tous les trigrammes
+ *   de la requête. L'index est complété au démarrage et avant chaque recherche pour les seules lignes ajoutées depuis
+ *   (verrou *flock()* pendant la mise à jour) ; il est reconstruit si l'historique a été remplacé ou tronqué.
+ */
+
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/// Variable d'environnement donnant le fichier d'historique (par défaut : $HOME/.minishell_history)
+#define HISTORY_ENV "MINISHELL_HISTFILE"
+/// Nom du fichier d'historique dans le répertoire personnel
+#define HISTORY_DEFAULT_NAME ".minishell_history"
+/// Taille visée d'un bloc de l'index (lignes entières)
+#define HISTORY_BLOCK_SIZE 2048
+/// Taille du filtre de Bloom d'un bloc (octets)
+#define HISTORY_FILTER_BYTES 256
+
+/** @brief Fonction d'ouverture de l'historique.
+ * @param path Chemin du fichier d'historique (créé s'il n'existe pas).
+ * @return int 0 en cas de succès, -1 en cas d'erreur (l'historique reste désactivé).
+ * @details Les fichiers sont ouverts avec O_CLOEXEC. Si l'index ne peut pas être ouvert ou créé, les recherches parcourent tout l'historique.
+ */
+int history_open(const char* path);
+
+/** @brief Fonction de fermeture de l'historique. */
+void history_close(void);
+
+/** @brief Fonction d'ajout d'une commande à la fin de l'historique.
+ * @param line Commande (sans saut de ligne).
+ * @param len Longueur de la commande.
+ * @return int 0 en cas de succès (ou commande ignorée), -1 en cas d'erreur.
+ * @details Une commande identique à la dernière entrée n'est pas ajoutée.
+ */
+int history_add(const char* line, size_t len);
+
+/** @brief Fonction de mise à jour de la projection et de lecture de la fin de l'historique.
+ * @return size_t Position suivant la dernière entrée (les entrées ajoutées par d'autres shells sont prises en compte).
+ * @details Les pointeurs renvoyés par les fonctions suivantes ne restent valides que jusqu'au prochain appel de cette fonction ou de *history_search()*.
+ */
+size_t history_end(void);
+
+/** @brief Fonction de lecture de l'entrée précédant une position.
+ * @param pos Pointeur vers la position (début d'une entrée, ou *history_end()*), remplacée par le début de l'entrée trouvée.
+ * @param len Pointeur dans lequel est renvoyée la longueur de l'entrée.
+ * @return const char* Entrée (non terminée par '\0'), NULL s'il n'y en a pas.
+ */
+const char* history_prev(size_t* pos, size_t* len);
+
+/** @brief Fonction de lecture de l'entrée suivant une position.
+ * @param pos Pointeur vers la position (début d'une entrée), remplacée par le début de l'entrée trouvée.
+ * @param len Pointeur dans lequel est renvoyée la longueur de l'entrée.
+ * @return const char* Entrée (non terminée par '\0'), NULL si l'entrée de départ est la dernière.
+ */
+const char* history_next(size_t* pos, size_t* len);
+
+/** @brief Fonction de recherche de l'entrée la plus récente contenant une chaîne.
+ * @param query Chaîne cherchée.
+ * @param qlen Longueur de la chaîne (0 : aucune entrée).
+ * @param pos Pointeur vers la position avant laquelle l'entrée doit commencer, remplacée par le début de l'entrée trouvée.
+ * @param len Pointeur dans lequel est renvoyée la longueur de l'entrée.
+ * @return const char* Entrée trouvée (non terminée par '\0'), NULL s'il n'y en a pas.
+ * @details Les lignes non encore indexées sont parcourues directement, puis les blocs de l'index du plus récent au plus ancien ;
+ *    pour une requête d'au moins 3 octets, seuls les blocs dont le filtre contient tous ses trigrammes sont parcourus.
+ */
+const char* history_search(const char* query, size_t qlen, size_t* pos, size_t* len);
+
+#endif // HISTORY_H
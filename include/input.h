@@ -0,0 +1,82 @@
+/**
+ * @file input.h
+ * @brief Header file for command input sources
+ * @author Nom1
+ * @author Nom2
+ * @date 2025-26
+ * @details Définitions de la lecture des lignes de commandes depuis un descripteur (entrée standard, script) ou une chaîne (option -c).
+ *   Les données sont lues par gros blocs avec *read()* et découpées en lignes dans un tampon qui s'agrandit au besoin :
+ *   la longueur d'une ligne n'est pas limitée.
+ */
+
+#ifndef INPUT_H
+#define INPUT_H
+
+#include <stddef.h>
+#include <sys/types.h>
+
+/// Taille des blocs lus avec *read()*
+#define INPUT_BLOCK_SIZE (64 * 1024)
+
+/**
+ * @brief Structure représentant une source de lignes de commandes.
+ * @struct input_t
+ * @details Les octets non encore consommés sont ceux de l'intervalle [*start*, *end*) du tampon.
+ */
+typedef struct {
+    int fd;          ///< Descripteur lu (-1 pour une chaîne)
+    int owns_fd;     ///< Le descripteur a été ouvert par *input_open_file()* et doit être fermé
+    int seekable;    ///< Le descripteur est un fichier régulier : la position peut être resynchronisée avec *lseek()*
+    int eof;         ///< Fin de la source atteinte
+    char* buf;       ///< Tampon de lecture
+    size_t start;    ///< Début des octets non consommés
+    size_t end;      ///< Fin des octets lus
+    size_t cap;      ///< Capacité du tampon
+    size_t line_no;  ///< Numéro de la dernière ligne lue
+} input_t;
+
+/** @brief Fonction d'ouverture d'une source sur un descripteur existant.
+ * @param in Pointeur vers la source à initialiser.
+ * @param fd Descripteur à lire (il n'est pas fermé par *input_close()*).
+ * @return int 0 en cas de succès, -1 en cas d'erreur.
+ */
+int input_open_fd(input_t* in, int fd);
+
+/** @brief Fonction d'ouverture d'une source sur un fichier (script).
+ * @param in Pointeur vers la source à initialiser.
+ * @param path Chemin du fichier.
+ * @return int 0 en cas de succès, -1 en cas d'erreur (errno est positionné).
+ * @details Le fichier est ouvert avec O_CLOEXEC : les commandes lancées n'en héritent pas.
+ */
+int input_open_file(input_t* in, const char* path);
+
+/** @brief Fonction d'ouverture d'une source sur une chaîne de caractères (option -c).
+ * @param in Pointeur vers la source à initialiser.
+ * @param str Chaîne à lire (copiée).
+ * @return int 0 en cas de succès, -1 en cas d'erreur.
+ */
+int input_open_string(input_t* in, const char* str);
+
+/** @brief Fonction de lecture de la ligne suivante.
+ * @param in Pointeur vers la source.
+ * @param len Pointeur dans lequel est renvoyée la longueur de la ligne (peut être NULL).
+ * @return char* Ligne lue, sans le saut de ligne final et terminée par '\0', ou NULL en fin de source ou en cas d'erreur.
+ * @details La ligne est située dans le tampon de la source et reste valide jusqu'au prochain appel.
+ *    Un appel à *read()* n'est effectué que lorsque le tampon ne contient plus de ligne complète.
+ */
+char* input_read_line(input_t* in, size_t* len);
+
+/** @brief Fonction de resynchronisation de la position du descripteur sur la fin de la dernière ligne lue.
+ * @param in Pointeur vers la source.
+ * @details Les commandes lancées partagent le descripteur de l'entrée standard : si celle-ci est un fichier régulier, la position est ramenée
+ *    juste après la dernière ligne lue pour qu'elles lisent la suite du fichier et non ce qui suit le bloc lu par le shell.
+ *    Sans effet pour une chaîne, un script ouvert par *input_open_file()* ou un descripteur non positionnable.
+ */
+void input_sync(input_t* in);
+
+/** @brief Fonction de fermeture d'une source.
+ * @param in Pointeur vers la source.
+ */
+void input_close(input_t* in);
+
+#endif // INPUT_H
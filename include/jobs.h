@@ -0,0 +1,148 @@
+/**
+ * @file jobs.h
+ * @brief Header file for job control
+ * @author Nom1
+ * @author Nom2
+ * @date 2025-26
+ * @details Définitions de la table des jobs (pipelines lancés en arrière-plan ou suspendus) et des fonctions de contrôle des jobs :
+ *   récupération des processus terminés sur SIGCHLD, groupes de processus et passage du terminal au job de premier plan.
+ */
+
+#ifndef JOBS_H
+#define JOBS_H
+
+#include <stddef.h>
+
+#include "processus.h"
+
+/** @brief États d'un job ou d'un de ses processus.
+ * @enum job_state_t
+ */
+typedef enum {
+    JOB_RUNNING, ///< En cours d'exécution
+    JOB_STOPPED, ///< Suspendu (SIGTSTP, SIGTTIN...)
+    JOB_DONE     ///< Terminé
+} job_state_t;
+
+/**
+ * @brief Structure représentant un job.
+ * @struct job_t
+ * @details Un job correspond à un pipeline. Les étages sont recopiés depuis la ligne de commande (qui est réinitialisée à chaque prompt) :
+ *   seuls *pid*, *pgid*, *status*, *start_time*, *end_time* et *rusage* sont significatifs dans ces copies (*argv*, *path* et *cf* sont remis à NULL).
+ */
+typedef struct {
+    int id;                   ///< Numéro du job ([n])
+    pid_t pgid;               ///< Groupe de processus du job (0 si le contrôle des jobs est inactif)
+    char* command;            ///< Texte de la commande, pour l'affichage
+    processus_t* procs;       ///< Copies des étages du pipeline
+    job_state_t* proc_states; ///< État de chaque étage
+    size_t num_procs;         ///< Nombre d'étages
+    job_state_t state;        ///< État global du job
+    int notified;             ///< 1 si le dernier changement d'état a été signalé à l'utilisateur
+} job_t;
+
+/** @brief Fonction d'initialisation du contrôle des jobs.
+ * @param interactive 1 si le shell est interactif, 0 sinon (script, option -c).
+ * @return int 0 en cas de succès, -1 en cas d'erreur.
+ * @details Installe le gestionnaire de SIGCHLD, qui récupère sans bloquer les processus des jobs de la table.
+ *    Si le shell est interactif et que l'entrée standard est un terminal, le contrôle des jobs est activé : le shell se place dans son propre groupe de processus,
+ *    prend le terminal et ignore SIGQUIT, SIGTSTP, SIGTTIN et SIGTTOU. Chaque pipeline est alors lancé dans son propre groupe.
+ */
+int job_control_init(int interactive);
+
+/** @brief Fonction indiquant si le contrôle des jobs est actif.
+ * @return int 1 si actif, 0 sinon.
+ */
+int job_control_enabled(void);
+
+/** @brief Fonction de désactivation du contrôle des jobs dans un sous-shell.
+ * @details Appelée par le fils créé pour une substitution de commande : ses commandes restent dans le groupe du shell,
+ *    qui est au premier plan, sans prendre le terminal. La table des jobs est conservée (la commande jobs l'affiche toujours).
+ */
+void job_control_leave(void);
+
+/** @brief Fonction retournant le descripteur du terminal contrôlé par le shell.
+ * @return int Descripteur du terminal, -1 si le contrôle des jobs est inactif.
+ */
+int job_terminal(void);
+
+/** @brief Fonction de blocage de SIGCHLD.
+ * @details Doit encadrer (avec *job_unblock_sigchld()*) le lancement d'un job et toute modification de la table,
+ *    afin qu'un processus ne puisse pas se terminer avant d'avoir été enregistré.
+ */
+void job_block_sigchld(void);
+
+/** @brief Fonction de déblocage de SIGCHLD. */
+void job_unblock_sigchld(void);
+
+/** @brief Fonction de passage du terminal à un groupe de processus.
+ * @param pgid Groupe de processus du job de premier plan.
+ * @details Sans effet si le contrôle des jobs est inactif.
+ */
+void job_give_terminal(pid_t pgid);
+
+/** @brief Fonction de reprise du terminal par le shell.
+ * @details Le terminal est rendu au groupe du shell et ses attributs (sauvegardés par *job_control_init()*) sont restaurés.
+ *    Sans effet si le contrôle des jobs est inactif.
+ */
+void job_take_terminal(void);
+
+/** @brief Fonction d'ajout d'un job à la table.
+ * @param first Premier étage du pipeline.
+ * @param num_procs Nombre d'étages (les suivants sont atteints via *cf->pipe_next*).
+ * @param pgid Groupe de processus du pipeline.
+ * @param state État initial du job (JOB_RUNNING pour un lancement en arrière-plan, JOB_STOPPED pour un job suspendu).
+ * @return job_t* Pointeur vers le job ajouté, NULL en cas d'erreur.
+ * @details Les étages dont le *status* indique déjà une terminaison sont considérés comme terminés.
+ *    Doit être appelée SIGCHLD bloqué.
+ */
+job_t* job_add(processus_t* first, size_t num_procs, pid_t pgid, job_state_t state);
+
+/** @brief Fonction de recherche d'un job.
+ * @param spec Désignation du job : "%n" ou "n" (numéro), "%+" ou "%%" (job courant), "%-" (job précédent), ou NULL (job courant).
+ * @return job_t* Pointeur vers le job, NULL s'il n'existe pas.
+ */
+job_t* job_find(const char* spec);
+
+/** @brief Fonction de recherche du job contenant un processus.
+ * @param pid PID recherché.
+ * @return job_t* Pointeur vers le job, NULL s'il n'existe pas.
+ */
+job_t* job_find_pid(pid_t pid);
+
+/** @brief Fonction d'attente d'un job.
+ * @param job Pointeur vers le job à attendre.
+ * @return int Code de retour du dernier étage (128 + numéro du signal s'il a été tué ou suspendu).
+ * @details Bloque jusqu'à ce que tous les étages soient terminés ou que le job soit suspendu.
+ */
+int job_wait(job_t* job);
+
+/** @brief Fonction de suppression d'un job de la table.
+ * @param job Pointeur vers le job à supprimer (libéré par la fonction).
+ */
+void job_remove(job_t* job);
+
+/** @brief Fonction d'affichage d'un job.
+ * @param job Pointeur vers le job à afficher.
+ * @param fd Descripteur sur lequel écrire.
+ * @param with_pids 1 pour afficher aussi le PID de chaque étage.
+ */
+void job_print(const job_t* job, int fd, int with_pids);
+
+/** @brief Fonction d'accès à la table des jobs.
+ * @param index Indice dans la table (de 0 à *job_count()* - 1, du plus ancien au plus récent).
+ * @return job_t* Pointeur vers le job, NULL si l'indice est invalide.
+ */
+job_t* job_at(size_t index);
+
+/** @brief Fonction retournant le nombre de jobs de la table. */
+size_t job_count(void);
+
+/** @brief Fonction de signalement des jobs ayant changé d'état.
+ * @param fd Descripteur sur lequel écrire, ou -1 pour ne rien afficher.
+ * @details Affiche les jobs terminés ou suspendus depuis le dernier appel, puis retire les jobs terminés de la table.
+ *    Appelée avant chaque prompt.
+ */
+void job_notify(int fd);
+
+#endif // JOBS_H
@@ -0,0 +1,161 @@
+/**
+ * @file lexer.h
+ * @brief Header file for the command line lexer
+ * @author Nom1
+ * @author Nom2
+ * @date 2025-26
+ * @details Définitions de l'analyseur lexical de la ligne de commande. La ligne est parcourue une seule fois : les guillemets
+ *   et les échappements sont traités au fil de la lecture et chaque appel à *lexer_next()* renvoie un token typé (mot, affectation,
+ *   opérateur, redirection). Les variables restent symboliques dans les mots : elles ne sont remplacées par leur valeur
+ *   qu'au moment de l'instanciation de la ligne (*lexer_expand()*), ce qui permet de réutiliser l'analyse d'une ligne (cache des plans).
+ *   Le texte analysé peut s'étendre sur plusieurs lignes : les corps des here-documents suivent la ligne qui les introduit.
+ */
+
+#ifndef LEXER_H
+#define LEXER_H
+
+#include <stddef.h>
+
+#include "arena.h"
+
+/** @brief Types de tokens.
+ * @enum token_type_t
+ */
+typedef enum {
+    TOKEN_WORD,        ///< Mot (commande, argument, nom de fichier)
+    TOKEN_ASSIGNMENT,  ///< Mot de la forme NOM=valeur
+    TOKEN_OPERATOR,    ///< Opérateur de contrôle (;, &, |, &&, ||, saut de ligne)
+    TOKEN_REDIRECTION, ///< Redirection ([n]<, [n]>, [n]>>, [n]>&m, [n]<&m, [n]<<mot, [n]<<-mot, [n]<<<mot)
+    TOKEN_KEYWORD      ///< Mot réservé (for, while, until, do, done, in) : jamais produit par *lexer_next()*, reconnu selon sa position par l'analyse syntaxique
+} token_type_t;
+
+/** @brief Opérateurs de contrôle.
+ * @enum operator_t
+ */
+typedef enum {
+    OP_SEMICOLON, ///< ;
+    OP_AMPERSAND, ///< &
+    OP_PIPE,      ///< |
+    OP_AND,       ///< &&
+    OP_OR,        ///< ||
+    OP_NEWLINE    ///< Saut de ligne non protégé (séparateur de commandes, comme ';', ou simple blanc selon sa position)
+} operator_t;
+
+/** @brief Types de redirections.
+ * @enum redirection_t
+ */
+typedef enum {
+    REDIR_IN,         ///< [n]<fichier (n vaut 0 par défaut)
+    REDIR_OUT,        ///< [n]>fichier (n vaut 1 par défaut)
+    REDIR_APPEND,     ///< [n]>>fichier (n vaut 1 par défaut)
+    REDIR_DUP_IN,     ///< [n]<&m (n vaut 0 par défaut)
+    REDIR_DUP_OUT,    ///< [n]>&m (n vaut 1 par défaut)
+    REDIR_HEREDOC,    ///< [n]<<mot ou [n]<<-mot : here-document, suivi du token de son corps
+    REDIR_HERESTRING  ///< [n]<<<mot : here-string, suivi du mot (auquel un saut de ligne est ajouté)
+} redirection_t;
+
+/// Le mot contient au moins une partie entre guillemets ou échappée
+#define TOKEN_QUOTED 0x1
+/// La forme symbolique du mot contient des marqueurs (variables, guillemets, échappements) ; sinon, c'est le texte de son unique champ
+#define TOKEN_SYMBOLIC 0x2
+
+/**
+ * @brief Structure représentant un token.
+ * @struct token_t
+ * @details Pour un mot, *text* contient sa forme symbolique : les caractères littéraux (guillemets et échappements retirés)
+ *   et des marqueurs pour les variables et les guillemets. Elle ne contient aucun '\0' et ne dépend pas des variables :
+ *   ce sont *lexer_expand()* et les valeurs courantes qui déterminent les champs produits.
+ */
+typedef struct {
+    token_type_t type; ///< Type du token
+    int op;            ///< Opérateur (operator_t) ou type de redirection (redirection_t)
+    int fd;            ///< Descripteur redirigé (redirection)
+    int target_fd;     ///< Descripteur cible d'une duplication ([n]>&m, [n]<&m)
+    int flags;         ///< TOKEN_QUOTED, TOKEN_SYMBOLIC
+    char* text;        ///< Forme symbolique du mot (allouée dans l'arène), texte de l'opérateur sinon
+    size_t len;        ///< Longueur de la forme symbolique du mot (0 pour un opérateur ou une redirection)
+} token_t;
+
+/**
+ * @brief Structure représentant le délimiteur d'un here-document.
+ * @struct heredoc_t
+ */
+typedef struct {
+    char* delim;  ///< Délimiteur, guillemets et échappements retirés (alloué dans l'arène)
+    size_t len;   ///< Longueur du délimiteur
+    int strip;    ///< <<- : les tabulations de tête des lignes du corps (délimiteur compris) sont retirées
+} heredoc_t;
+
+/**
+ * @brief Structure d'état de l'analyseur lexical.
+ * @struct lexer_t
+ */
+typedef struct {
+    const char* line;    ///< Ligne analysée
+    size_t len;          ///< Longueur de la ligne
+    size_t pos;          ///< Position courante
+    arena_t* arena;      ///< Arène dans laquelle les mots sont construits
+    size_t line_end;     ///< Fin de la ligne courante, suivie des corps de ses here-documents
+    size_t body;         ///< Début du corps du prochain here-document de la ligne courante (0 si la ligne n'en a pas)
+    token_t queued;      ///< Corps du dernier here-document, renvoyé par l'appel suivant à *lexer_next()*
+    int has_queued;      ///< *queued* est en attente
+    size_t unterminated; ///< Nombre de here-documents dont le délimiteur n'a pas été trouvé (corps étendu jusqu'à la fin du texte)
+    heredoc_t heredoc;   ///< Délimiteur du dernier here-document lu
+} lexer_t;
+
+/** @brief Fonction d'initialisation d'un analyseur lexical.
+ * @param lex Pointeur vers l'analyseur à initialiser.
+ * @param line Ligne à analyser (non modifiée, elle doit rester valide pendant l'analyse).
+ * @param len Longueur de la ligne.
+ * @param arena Arène dans laquelle les mots sont alloués.
+ * @return int 0 en cas de succès, -1 en cas d'erreur.
+ */
+int lexer_init(lexer_t* lex, const char* line, size_t len, arena_t* arena);
+
+/** @brief Fonction de lecture du token suivant.
+ * @param lex Pointeur vers l'analyseur.
+ * @param tok Pointeur vers le token à remplir.
+ * @return int 1 si un token a été lu, 0 en fin de ligne, -1 en cas d'erreur (guillemet non fermé, mémoire insuffisante...).
+ * @details Les blancs séparent les mots et un '#' en début de mot commence un commentaire qui s'étend jusqu'à la fin de la ligne.
+ *    Un saut de ligne hors guillemets et non protégé est renvoyé comme opérateur OP_NEWLINE.
+ *    - Entre apostrophes, tous les caractères sont littéraux.
+ *    - Entre guillemets, seuls '$' (expansion) et '\' devant '$', '"', '\' ou un saut de ligne sont interprétés.
+ *    - Hors guillemets, '\' protège le caractère suivant.
+ *    Les variables $NOM et ${NOM} sont conservées sous forme symbolique (un ${...} non fermé ou dont le nom est invalide est une erreur),
+ *    de même que les substitutions de commandes $(...), qui peuvent être imbriquées et dont la ligne intérieure n'est analysée qu'à l'expansion.
+ *    Un mot NOM=valeur dont le nom n'est ni protégé ni vide est renvoyé comme TOKEN_ASSIGNMENT (c'est l'analyseur syntaxique qui décide s'il s'agit d'une affectation).
+ *    Un nombre collé devant '<' ou '>' est le descripteur redirigé : "2>>f" donne la redirection REDIR_APPEND de *fd* 2 suivie du mot "f".
+ *    Un here-document (REDIR_HEREDOC) est suivi d'un TOKEN_WORD qui contient son corps : les lignes qui suivent la ligne courante,
+ *    jusqu'à celle qui est égale au délimiteur. Si le délimiteur n'est ni protégé ni entre guillemets, les variables du corps sont développées
+ *    (sans découpage en champs) et '\' ne protège que '$', '`' et '\' ; sinon le corps est littéral. Avec <<-, les tabulations de tête sont retirées.
+ *    La ligne terminée, l'analyse reprend après le corps de son dernier here-document.
+ */
+int lexer_next(lexer_t* lex, token_t* tok);
+
+/** @brief Fonction de recherche des here-documents d'une ligne dont le corps n'est pas encore lu.
+ * @param arena Arène dans laquelle les délimiteurs sont alloués.
+ * @param line Texte de la commande (ligne qui introduit les here-documents, suivie éventuellement d'une partie de leurs corps).
+ * @param len Longueur du texte.
+ * @param docs Pointeur dans lequel est renvoyé le tableau des délimiteurs, dans l'ordre des here-documents.
+ * @param num Pointeur dans lequel est renvoyé le nombre de délimiteurs.
+ * @return int 0 en cas de succès, -1 en cas d'erreur de syntaxe (signalée par l'analyse de la ligne).
+ * @details Permet à l'appelant de lire les lignes des corps avant d'analyser la commande complète.
+ */
+int lexer_heredocs(arena_t* arena, const char* line, size_t len, heredoc_t** docs, size_t* num);
+
+/** @brief Fonction d'expansion d'un mot.
+ * @param arena Arène dans laquelle les champs sont alloués.
+ * @param text Forme symbolique du mot (*token_t.text*).
+ * @param len Longueur de la forme symbolique.
+ * @param split 1 pour découper en champs la valeur des variables et la sortie des substitutions hors guillemets, 0 sinon (affectations).
+ * @param fields Pointeur dans lequel sont renvoyés les champs, séparés par des '\0'.
+ * @param num_fields Pointeur dans lequel est renvoyé le nombre de champs.
+ * @return int 0 en cas de succès, -1 en cas d'erreur.
+ * @details Les variables sont remplacées par leur valeur courante : "a$X" avec X="b c" donne les deux champs "ab" et "c".
+ *    Les substitutions de commandes sont exécutées (*subst_run()*) et remplacées par leur sortie, sans ses sauts de ligne finaux ;
+ *    la sortie est ajoutée au mot au fur et à mesure de sa lecture.
+ *    Un mot peut ne produire aucun champ ("$VIDE"), alors que "" produit un champ vide.
+ */
+int lexer_expand(arena_t* arena, const char* text, size_t len, int split, char** fields, size_t* num_fields);
+
+#endif // LEXER_H
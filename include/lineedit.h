@@ -0,0 +1,38 @@
+/**
+ * @file lineedit.h
+ * @brief Header file for the interactive line editor
+ * @author Nom1
+ * @author Nom2
+ * @date 2025-26
+ * @details Définitions de l'éditeur de ligne du shell interactif. Le terminal est placé en mode brut le temps de la saisie
+ *   (il retrouve ses réglages avant l'exécution de la commande) et la ligne est redessinée à chaque touche.
+ *   Touches reconnues :
+ *   - flèches gauche/droite, Début/Fin, Ctrl-A/Ctrl-E, Ctrl-B/Ctrl-F : déplacement du curseur ;
+ *   - Retour arrière, Suppr, Ctrl-D (ligne non vide), Ctrl-K, Ctrl-U, Ctrl-W : suppression ;
+ *   - flèches haut/bas, Ctrl-P/Ctrl-N : navigation dans l'historique ;
+ *   - Ctrl-R : recherche incrémentale en arrière dans l'historique (Ctrl-R à nouveau : occurrence plus ancienne, Ctrl-G : abandon) ;
+ *   - Tab : complétion du mot (commandes, noms de fichiers, voir complete.h), un second Tab affiche les candidats ;
+ *   - Ctrl-C : abandon de la ligne, Ctrl-D sur une ligne vide : fin de saisie, Ctrl-L : effacement de l'écran.
+ *   Une ligne plus large que le terminal défile horizontalement.
+ */
+
+#ifndef LINEEDIT_H
+#define LINEEDIT_H
+
+#include <stddef.h>
+
+/** @brief Fonction indiquant si l'éditeur peut être utilisé.
+ * @return int 1 si l'entrée et la sortie standard sont un terminal (autre que "dumb"), 0 sinon.
+ */
+int lineedit_available(void);
+
+/** @brief Fonction de lecture d'une ligne avec édition.
+ * @param prompt Prompt affiché en début de ligne.
+ * @param len Pointeur dans lequel est renvoyée la longueur de la ligne (peut être NULL).
+ * @return char* Ligne saisie, terminée par '\0' (vide après Ctrl-C), ou NULL en fin de saisie (Ctrl-D sur une ligne vide) ou en cas d'erreur.
+ * @details La ligne est située dans le tampon de l'éditeur et reste valide jusqu'au prochain appel.
+ *    Elle n'est pas ajoutée à l'historique : c'est à l'appelant de le faire (*history_add()*).
+ */
+char* lineedit_read(const char* prompt, size_t* len);
+
+#endif // LINEEDIT_H
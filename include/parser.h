@@ -70,14 +70,16 @@ int strcut(char* str, char sep, char** tokens, size_t max);
 /** @brief Fonction d'analyse d'une ligne de commande.
  * @param cmdl Pointeur vers la structure de ligne de commande à remplir.
  * @param line Chaîne de caractères contenant la ligne de commande à analyser.
- * @return int 0 en cas de succès, -1 en cas d'erreur (ligne trop longue, trop de commandes, etc.).
- * @details Cette fonction analyse la ligne de commande *line* et remplit la structure *cmdl* avec les informations extraites.
- *    La ligne de commande est copiée dans *cmdl->command_line* dans la limite de MAX_CMD_LINE caractères.
- *    La ligne est ensuite nettoyée (trim, clean, separate_s, replace, substenv), puis découpée en tokens.
- *    Les tokens sont ensuite utilisés pour remplir les structures processus_t et control_flow_t dans *cmdl*.
- *    Si la ligne dépasse la taille maximale ou si le nombre de commandes dépasse MAX_CMDS, la fonction retourne -1.
- *    Si une erreur est détectée, les descripteurs de fichiers ouverts sont fermés via close_fds(cmdl) avant de retourner -1.
- */
+ * @return int 0 en cas de succès, 1 si la ligne est incomplète (boucle non fermée : la suite est attendue, aucun message), -1 en cas d'erreur (erreur de syntaxe, mémoire insuffisante, etc.).
+ * @details Cette fonction analyse la ligne de commande *line* et prépare la structure *cmdl* à son exécution.
+ *    La ligne de commande est copiée dans *cmdl->command_line*, allouée dans l'arène de *cmdl* (tout comme les mots, les processus et leurs arguments).
+ *    L'analyse se fait en deux temps (*plan_build()*) : la ligne est d'abord transformée en plan, suite de tokens typés produits en une seule passe
+ *    par l'analyseur lexical et dont les variables restent symboliques ; ce plan est mis en cache, si bien qu'une ligne déjà rencontrée n'est pas réanalysée.
+ *    Le plan est copié dans l'arène ; chacun de ses pipelines est instancié juste avant son lancement (*plan_instantiate()*) : les variables sont remplacées
+ *    par leur valeur courante ("X=5; echo $X" affiche 5), les mots deviennent des arguments et les redirections sont enregistrées sur leur processus.
+ *    Les affectations qui précèdent le nom d'une commande sont rangées dans son *envp*. Un '!' en tête de pipeline inverse son code de retour.
+ *    Aucun fichier ni tube n'est ouvert par l'analyse : ils le sont au lancement de chaque commande (une commande non exécutée ne tronque pas son fichier).
+*/
 int parse_command_line(command_line_t* cmdl, const char* line);
 
 #endif // PARSER_H
\ No newline at end of file
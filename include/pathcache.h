@@ -0,0 +1,45 @@
+/**
+ * @file pathcache.h
+ * @brief Header file for the command path cache
+ * @author Nom1
+ * @author Nom2
+ * @date 2025-26
+ * @details Définitions des fonctions de résolution des commandes dans le PATH et de leur mise en cache.
+ *   La résolution est faite une seule fois dans le shell (et non à chaque lancement dans le fils via *execvp()*) :
+ *   la table associe le nom d'une commande à son chemin absolu, ou mémorise qu'elle est introuvable (cache négatif).
+ *   Une commande introuvable est recherchée à nouveau dès qu'un répertoire du PATH a changé (commande installée entre-temps) ;
+ *   un chemin trouvé par un élément relatif du PATH ("." ou élément vide) n'est jamais mémorisé, car il dépend du répertoire courant.
+ */
+
+#ifndef PATHCACHE_H
+#define PATHCACHE_H
+
+/** @brief Fonction de résolution d'un nom de commande en chemin exécutable.
+ * @param name Nom de la commande à résoudre.
+ * @return const char* Chemin de l'exécutable, ou NULL si la commande est introuvable.
+ * @details Si *name* contient un '/', il est retourné tel quel sans passer par le cache.
+ *    Sinon, le résultat (positif ou négatif) est lu dans la table, ou calculé en parcourant les répertoires de $PATH puis mémorisé.
+ *    Un résultat négatif n'est repris que si aucun répertoire du PATH n'a été modifié depuis ; un chemin relatif n'est pas mémorisé.
+ *    Le pointeur retourné reste valide jusqu'au prochain appel à *path_resolve()*, *path_cache_clear()* ou *path_cache_forget()*.
+ */
+const char* path_resolve(const char* name);
+
+/** @brief Fonction de suppression d'une entrée du cache.
+ * @param name Nom de la commande à oublier.
+ * @details Utilisée lorsque le chemin mémorisé n'existe plus (exécutable déplacé ou supprimé) afin de forcer une nouvelle résolution.
+ */
+void path_cache_forget(const char* name);
+
+/** @brief Fonction de vidage du cache.
+ * @details Appelée par la table des variables à chaque modification de la variable PATH (export, unset, affectation).
+ */
+void path_cache_clear(void);
+
+/** @brief Fonction d'affichage du contenu du cache.
+ * @param fd Descripteur sur lequel écrire.
+ * @return int Nombre d'entrées affichées.
+ * @details Chaque entrée est affichée avec son nombre d'utilisations ; les commandes introuvables sont signalées comme telles.
+ */
+int path_cache_print(int fd);
+
+#endif // PATHCACHE_H
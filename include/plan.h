@@ -0,0 +1,127 @@
+/**
+ * @file plan.h
+ * @brief Header file for parsed command line plans and their cache
+ * @author Nom1
+ * @author Nom2
+ * @date 2025-26
+ * @details Définitions des plans de lignes de commande. Un plan est le résultat de l'analyse lexicale et syntaxique d'une ligne :
+ *   la suite de ses tokens, dont les mots sont sous forme symbolique (les variables ne sont pas encore remplacées),
+ *   et le programme qui enchaîne ses pipelines (instructions instruction_t : lancements, sauts conditionnels sur le statut, fins de liste, boucles).
+ *   Il est stocké d'un seul bloc, sans pointeur interne (positions relatives au début du bloc), et peut donc être copié tel quel.
+ *   Les plans sont mis en cache selon le hachage de la ligne : une ligne déjà rencontrée (boucle, script généré, commande répétée)
+ *   est exécutée directement, sans nouvelle analyse. Chaque pipeline n'est instancié qu'au moment de son lancement, les variables
+ *   étant alors remplacées par leur valeur courante : un plan reste valable quand leurs valeurs changent, et "X=1; echo $X"
+ *   ou le corps d'une boucle voient les affectations qui les précèdent.
+ */
+
+#ifndef PLAN_H
+#define PLAN_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "arena.h"
+#include "processus.h"
+
+/// Nombre d'emplacements du cache des plans (puissance de 2)
+#define PLAN_CACHE_SIZE 256
+/// Taille maximale d'un plan mis en cache (les plans plus grands sont reconstruits à chaque fois)
+#define PLAN_MAX_SIZE (64 * 1024)
+
+/** @brief Mots réservés, reconnus en position de commande (champ *op* des tokens TOKEN_KEYWORD).
+ * @enum keyword_t
+ */
+typedef enum {
+    KW_FOR,   ///< for NOM [in mots] ; do liste ; done
+    KW_WHILE, ///< while liste ; do liste ; done
+    KW_UNTIL, ///< until liste ; do liste ; done
+    KW_DO,    ///< Début du corps d'une boucle
+    KW_DONE,  ///< Fin d'une boucle, éventuellement suivie de redirections qui s'appliquent à toute la boucle
+    KW_IN     ///< Début de la liste des mots d'une boucle for
+} keyword_t;
+
+/**
+ * @brief Structure représentant un token d'un plan.
+ * @struct plan_token_t
+ */
+typedef struct {
+    uint8_t type;   ///< Type du token (token_type_t)
+    uint8_t op;     ///< Opérateur (operator_t), type de redirection (redirection_t) ou mot réservé (keyword_t)
+    uint8_t flags;  ///< TOKEN_QUOTED, TOKEN_SYMBOLIC
+    int fd;         ///< Descripteur redirigé (redirection)
+    int target_fd;  ///< Descripteur cible d'une duplication
+    size_t text;    ///< Position de la forme symbolique du mot depuis le début du plan
+    size_t len;     ///< Longueur de la forme symbolique du mot
+} plan_token_t;
+
+/**
+ * @brief Structure représentant un plan de ligne de commande.
+ * @struct plan_t
+ * @details Le tableau des tokens est suivi du programme compilé, de la ligne source (comparée lors de la recherche dans le cache) puis des formes symboliques des mots.
+ *    La syntaxe du plan est valide : chaque opérateur suit une commande, la ligne ne se termine pas par "|", "&&" ou "||",
+ *    chaque redirection vers un fichier est suivie de son mot et chaque boucle est fermée. Les sauts de ligne sont devenus des ";" ou ont été retirés.
+ */
+typedef struct plan {
+    size_t size;            ///< Taille totale du bloc en octets
+    size_t line_len;        ///< Longueur de la ligne source
+    size_t num_tokens;      ///< Nombre de tokens
+    size_t code_len;        ///< Nombre d'instructions du programme (BC_HALT compris)
+    unsigned hits;          ///< Nombre d'instanciations servies par le cache
+    plan_token_t tokens[];  ///< Tokens de la ligne
+} plan_t;
+
+/** @brief Fonction de construction d'une ligne de commande à partir de son plan.
+ * @param cmdl Pointeur vers la structure de ligne de commande à remplir.
+ * @param line Ligne de commande.
+ * @param len Longueur de la ligne.
+ * @return int 0 en cas de succès, 1 si la ligne est incomplète (boucle non fermée : la suite est sur les lignes suivantes, aucun message),
+ *    -1 en cas d'erreur (message affiché).
+ * @details Le plan de la ligne est cherché dans le cache. En cas d'absence, la ligne est analysée
+ *    et le plan obtenu est mémorisé s'il ne dépasse pas PLAN_MAX_SIZE.
+ *    Le programme de la ligne est compilé avec le plan : "a && b || c" devient le lancement de a, un saut vers c si a échoue, le lancement de b,
+ *    un saut vers la fin de la liste si b réussit, puis le lancement de c. Une commande intégrée seule au premier plan dont le nom est littéral
+ *    est résolue à la compilation, de même qu'une commande réduite à des affectations.
+ *    Une boucle devient une instruction d'entrée (redirections de la boucle), une instruction d'itération en tête du corps, vers laquelle le corps
+ *    revient par un saut, et une instruction de sortie ; la condition d'un while ou d'un until est une liste suivie d'un saut vers la sortie.
+ *    break et continue (littéraux, avec un nombre de niveaux optionnel) deviennent des sauts vers la sortie ou l'itération de la boucle visée.
+ *    Le plan est copié dans l'arène de *cmdl* (*cmdl->plan*, *cmdl->code*) : il ne référence pas le cache, qu'une commande de la ligne peut vider
+ *    ("plancache -r"). Aucun pipeline n'est instancié ici (voir *plan_instantiate()*).
+ */
+int plan_build(command_line_t* cmdl, const char* line, size_t len);
+
+/** @brief Fonction d'instanciation d'un pipeline du plan d'une ligne de commande, juste avant son lancement.
+ * @param cmdl Pointeur vers la structure de ligne de commande (plan construit par *plan_build()*).
+ * @param token Rang du premier token du pipeline (opérande de son instruction de lancement).
+ * @param head Pointeur dans lequel est renvoyé le premier étage du pipeline.
+ * @return int 0 en cas de succès, -1 en cas d'erreur (message affiché ; redirection ambiguë, mémoire insuffisante...).
+ * @details Les variables sont remplacées par leur valeur courante, puis les mots deviennent des arguments, les "|" créent les étages suivants
+ *    et les redirections sont enregistrées sur leur processus. Aucun fichier ni tube n'est ouvert : ils le sont au lancement.
+ *    Les données produites sont allouées dans l'arène de *cmdl* ; les mots littéraux sont ceux de la copie du plan.
+ *    Un pipeline réduit à des redirections (celles qui suivent le "done" d'une boucle) donne un processus sans commande.
+ */
+int plan_instantiate(command_line_t* cmdl, size_t token, control_flow_t** head);
+
+/** @brief Fonction d'expansion de la liste des mots d'une boucle for.
+ * @param cmdl Pointeur vers la structure de ligne de commande (plan construit par *plan_build()*).
+ * @param token Rang du token du nom de la variable de boucle (opérande de l'instruction BC_FOR).
+ * @param name Pointeur dans lequel est renvoyé le nom de la variable.
+ * @param words Pointeur dans lequel est renvoyé le tableau des champs (alloué dans l'arène de *cmdl*).
+ * @param num_words Pointeur dans lequel est renvoyé le nombre de champs.
+ * @return int 0 en cas de succès, -1 en cas d'erreur (message affiché).
+ * @details Les mots qui suivent "in" sont développés et découpés en champs comme des arguments ; sans "in", la liste est vide.
+ */
+int plan_for_words(command_line_t* cmdl, size_t token, const char** name, char*** words, size_t* num_words);
+
+/** @brief Fonction de vidage du cache des plans.
+ * @details Les compteurs de succès et d'échecs sont remis à zéro.
+ */
+void plan_cache_clear(void);
+
+/** @brief Fonction d'affichage de l'état du cache des plans.
+ * @param fd Descripteur sur lequel écrire.
+ * @return int Nombre de plans en cache.
+ * @details Affiche les compteurs de succès, d'échecs et de remplacements, puis chaque ligne en cache avec son nombre d'utilisations.
+ */
+int plan_cache_print(int fd);
+
+#endif // PLAN_H
@@ -12,15 +12,13 @@
 
 #include <unistd.h>
 
+#include <stddef.h>
 #include <stdint.h>
 #include <time.h>
+#include <sys/resource.h>
+
+#include "arena.h"
 
-/// Nombre maximum d'arguments
-#define MAX_ARGS 128
-/// Nombre maximum de variables d'environnement
-#define MAX_ENV 128
-/// Nombre maximum de commandes sur une ligne
-#define MAX_CMDS 128
 /// Taille maximale d'une ligne de commande
 #define MAX_CMD_LINE 4096
 
@@ -31,11 +29,62 @@
 typedef enum {
     UNCONDITIONAL, ///< Exécution inconditionnelle
     ON_SUCCESS,    ///< Exécution en cas de succès
-    ON_FAILURE     ///< Exécution en cas d'échec
+    ON_FAILURE,    ///< Exécution en cas d'échec
+    PIPE           ///< Étage suivant d'un pipeline (la sortie du processus courant alimente l'entrée du suivant)
 } control_flow_mode_t;
 
+/** @brief Codes des instructions du programme d'une ligne de commande.
+ * @enum opcode_t
+ * @details Le programme est compilé à partir du plan de la ligne (voir plan.h) et mis en cache avec lui. Les instructions de lancement
+ *   désignent un pipeline par le rang de son premier token dans le plan (il est instancié au lancement) ; les sauts désignent une instruction par son rang.
+ */
+typedef enum {
+    BC_HALT,         ///< Fin du programme
+    BC_PIPELINE,     ///< Lancement du pipeline commençant au token *arg* (*launch_pipeline()*), dont le statut devient celui de la ligne
+    BC_BUILTIN,      ///< Commande intégrée *builtin* (rang dans la table des commandes intégrées) du pipeline commençant au token *arg*, seule au premier plan : exécutée dans le shell
+    BC_ASSIGN,       ///< Affectations seules du pipeline commençant au token *arg*, au premier plan ("X=1") : variables du shell
+    BC_JUMP,         ///< Saut inconditionnel vers l'instruction *arg*
+    BC_JUMP_SUCCESS, ///< Saut vers l'instruction *arg* si le dernier pipeline a réussi ("||" : commande sautée)
+    BC_JUMP_FAILURE, ///< Saut vers l'instruction *arg* si le dernier pipeline a échoué ("&&" : commande sautée)
+    BC_LIST_END,     ///< Fin d'une liste "&&"/"||" (bilan d'une mesure time en cours)
+    BC_LOOP,         ///< Entrée dans une boucle : redirections de la boucle, dont le premier token est *arg* (LOOP_NO_REDIRECT si elle n'en a pas)
+    BC_FOR,          ///< Expansion des mots d'une boucle for, dont le token du nom de variable est *arg*
+    BC_ITERATE,      ///< Début d'une itération (mémoire de l'itération précédente rendue) ; for : mot suivant, ou saut vers la sortie *arg* s'il n'y en a plus
+    BC_LOOP_EXIT,    ///< Sortie de la boucle : descripteurs standards rétablis, statut de la dernière commande du corps (0 si aucune)
+    BC_BREAK,        ///< Sortie des *builtin* boucles intérieures, puis saut vers la sortie *arg* de la boucle visée (break [n])
+    BC_CONTINUE      ///< Sortie des *builtin* boucles intérieures, puis saut vers l'itération *arg* de la boucle visée (continue [n])
+} opcode_t;
+
+/// Opérande de BC_LOOP pour une boucle sans redirection
+#define LOOP_NO_REDIRECT UINT32_MAX
+
+/**
+ * @brief Structure représentant une instruction du programme d'une ligne de commande (8 octets).
+ * @struct instruction_t
+ */
+typedef struct {
+    uint8_t op;      ///< Code de l'instruction (opcode_t)
+    uint8_t builtin; ///< Rang de la commande intégrée (BC_BUILTIN), mot-clé de la boucle (BC_LOOP, keyword_t), nombre de boucles intérieures quittées (BC_BREAK, BC_CONTINUE)
+    uint32_t arg;    ///< Rang du premier token du pipeline (lancements), de l'instruction cible (sauts) ou d'un token du plan (boucles)
+} instruction_t;
+
+/**
+ * @brief Structure représentant une redirection d'un processus.
+ * @struct redirect_t
+ * @details Les redirections sont enregistrées à l'analyse de la ligne et appliquées, dans leur ordre d'apparition, au lancement du processus :
+ *   un fichier n'est ouvert (ou tronqué) que si la commande est effectivement exécutée, et il est refermé par le shell dès le lancement effectué.
+ */
+typedef struct {
+    uint8_t type;   ///< Type de redirection (redirection_t : REDIR_IN, REDIR_OUT, REDIR_APPEND, REDIR_DUP_IN, REDIR_DUP_OUT, REDIR_HEREDOC ou REDIR_HERESTRING)
+    int fd;         ///< Descripteur redirigé (0, 1 ou 2)
+    int target_fd;  ///< Descripteur dupliqué ([n]>&m, [n]<&m)
+    char* path;     ///< Fichier cible, ou contenu d'un here-document ou d'une here-string (NULL pour une duplication), alloué dans l'arène de la ligne
+    int opened;     ///< Descripteur ouvert au lancement (-1 si aucun)
+} redirect_t;
+
 struct control_flow; // Déclaration anticipée pour l'utilisation dans processus_t
 struct command_line; // Déclaration anticipée pour l'utilisation dans control_flow_t
+struct plan;         // Déclaration anticipée pour l'utilisation dans command_line_t (voir plan.h)
 
 /**
  * @brief Structure représentant un processus.
@@ -44,48 +93,67 @@ struct command_line; // Déclaration anticipée pour l'utilisation dans control_
  */
 typedef struct {
     pid_t pid;                  ///< Process ID
-    char* argv[MAX_ARGS];       ///< Liste des arguments
-    char* envp[MAX_ENV];        ///< Variables d'environnement
+    pid_t pgid;                 ///< Groupe de processus à rejoindre (0 : nouveau groupe), utilisé avec le contrôle des jobs
+    char** argv;                ///< Liste des arguments, terminée par NULL (allouée dans l'arène de la ligne)
+    size_t argc;                ///< Nombre d'arguments
+    size_t argv_capacity;       ///< Capacité du tableau *argv* (0 : tableau vide partagé, non modifiable)
+    char** envp;                ///< Affectations propres à la commande ("FOO=1 cmd"), terminées par NULL (NULL si aucune)
     char* path;                 ///< Chemin de l'exécutable
 
-    int stdin_fd;               ///< Descripteur d'entrée standard
-    int stdout_fd;              ///< Descripteur de sortie standard
-    int stderr_fd;              ///< Descripteur d'erreur standard
+    int stdin_fd;               ///< Descripteur d'entrée standard (extrémité de tube ou fichier, positionné au lancement)
+    int stdout_fd;              ///< Descripteur de sortie standard (extrémité de tube ou fichier, positionné au lancement)
+    int stderr_fd;              ///< Descripteur d'erreur standard (fichier, positionné au lancement)
+    redirect_t* redirs;         ///< Redirections, dans leur ordre d'apparition (allouées dans l'arène de la ligne)
+    size_t num_redirs;          ///< Nombre de redirections
+    size_t redirs_capacity;     ///< Capacité du tableau *redirs*
+    int* inherited;             ///< Descripteurs transmis tels quels à la commande (substitutions de processus "<(...)", ">(...)"), alloués dans l'arène de la ligne
+    size_t num_inherited;       ///< Nombre de descripteurs transmis
+    size_t inherited_capacity;  ///< Capacité du tableau *inherited*
     int status;                 ///< Statut de sortie
     uint8_t is_background;      ///< Background flag
-    uint8_t invert;             ///< Inversion du code de retour pour le contrôle de flux
-    struct timespec start_time; ///< Start time
-    struct timespec end_time;   ///< End time
+    uint8_t invert;             ///< Inversion du code de retour pour le contrôle de flux ("! pipeline", porté par le premier étage)
+    uint8_t timed;              ///< Mesure des temps de la liste "&&"/"||" commençant à ce pipeline (mot-clé time, porté par le premier étage)
+    uint8_t zygote;             ///< Lancé par le serveur de lancement (zygote.h) : attendu par *zygote_wait()* et non par *wait4()*
+    struct timespec start_time; ///< Start time (CLOCK_MONOTONIC)
+    struct timespec end_time;   ///< End time (CLOCK_MONOTONIC)
+    struct rusage rusage;       ///< Ressources consommées, renvoyées par *wait4()* à la terminaison
     struct control_flow* cf;    ///< Pointeur vers la structure de contrôle de flux associée
 } processus_t;
 
 /** @brief Structure de contrôle de flux. 
  * @struct control_flow_t
- * @details Cette structure permet de gérer le flux d'exécution des processus.
+ * @details Cette structure relie les étages d'un pipeline. L'enchaînement des pipelines ("&&", "||", ";") est porté par le programme de la ligne.
 */
 typedef struct control_flow {
     processus_t* proc;                     ///< Pointeur vers la structure du processus courant
-    struct control_flow* unconditionnal_next; ///< Pointeur vers la prochaine structure de processus en cas d'exécution inconditionnelle
-    struct control_flow* on_success_next;     ///< Pointeur vers la prochaine structure de processus en cas d'exécution réussie
-    struct control_flow* on_failure_next;     ///< Pointeur vers la prochaine structure de processus en cas d'échec de l'exécution
+    struct control_flow* pipe_next;           ///< Pointeur vers l'étage suivant du pipeline (NULL si le processus est le dernier étage)
     struct command_line* cmdl;                     ///< Pointeur vers la structure de ligne de commande associée
 } control_flow_t;
 
 /**
  * @brief Structure représentant une ligne de commande.
  * @struct command_line_t
- * @details Cette structure contient la ligne de commande complète, un tableau de structures de processus, une structure de contrôle de flux, et un tableau des descripteurs de fichiers ouverts.
- * La structure permet à la fois d'allouer l'espace mémoire nécessaire pour les processus et de gérer le flux d'exécution entre eux.
+ * @details Cette structure contient la ligne de commande complète, son plan et le programme qui enchaîne ses pipelines, les structures de contrôle de flux
+ * (et donc les processus) des pipelines instanciés, et un tableau des descripteurs de fichiers ouverts.
+ * Toutes les données de la ligne (copie de la ligne, mots, processus, noeuds de contrôle de flux, vecteurs d'arguments) sont allouées dans l'arène *arena* :
+ * leur nombre n'est limité que par la mémoire disponible, et elles sont toutes libérées en une fois par *init_command_line()* avant la ligne suivante.
  * Le schéma suivant illustre la relation entre les structures:
  * \image html schema_struct.png
  */
 typedef struct command_line {
-    char command_line[MAX_CMD_LINE];  ///< Ligne de commande complète
-    char* tokens[MAX_CMD_LINE / 2 + 1]; ///< Tableau des tokens extraits de la ligne de commande
-    processus_t commands[MAX_CMDS];   ///< Tableau des structures de processus
-    control_flow_t flow[MAX_CMDS];    ///< Structure de contrôle de flux
+    arena_t arena;                    ///< Arène propriétaire de toutes les allocations de la ligne
+    char* command_line;               ///< Ligne de commande complète (copie dans l'arène)
+    control_flow_t* flow;             ///< Premier noeud de contrôle de flux (NULL si la ligne est vide)
+    control_flow_t* last_flow;        ///< Dernier noeud de contrôle de flux ajouté
+    control_flow_t* pending_flow;     ///< Noeud préparé par *next_processus()* et pas encore ajouté
     unsigned int num_commands;        ///< Nombre de commandes
-    int opened_descriptors[MAX_CMDS * 3 + 1]; ///< Tableau des descripteurs de fichiers ouverts
+    const struct plan* plan;          ///< Plan de la ligne (copie dans l'arène, NULL si la ligne n'est pas analysée)
+    const instruction_t* code;        ///< Programme de la ligne (dans *plan*)
+    size_t code_len;                  ///< Nombre d'instructions de *code*
+    int status;                       ///< Code de retour du dernier pipeline exécuté (0 à 255, 128 + signal si tué par un signal)
+    int* opened_descriptors;          ///< Tableau des descripteurs de fichiers ouverts (entrées fermées à -1, alloué dans l'arène)
+    size_t num_descriptors;           ///< Nombre d'entrées utilisées dans *opened_descriptors*
+    size_t descriptors_capacity;      ///< Capacité du tableau *opened_descriptors*
 } command_line_t;
 
 /**
@@ -94,64 +162,142 @@ typedef struct command_line {
  * @return int 0 en cas de succès, -1 en cas d'erreur.
  * @details Cette fonction initialise les champs de la structure avec les valeurs suivantes:
  * - *pid*: 0
- * - *argv*: {NULL}
- * - *envp*: {NULL}
+ * - *pgid*: 0
+ * - *argv*: {NULL} (tableau vide partagé, *argc* et *argv_capacity* à 0)
+ * - *envp*: NULL
  * - *path*: NULL
  * - *stdin_fd*: 0
  * - *stdout_fd*: 1
  * - *stderr_fd*: 2
+ * - *redirs*: NULL (*num_redirs* et *redirs_capacity* à 0)
+ * - *inherited*: NULL (*num_inherited* et *inherited_capacity* à 0)
  * - *status*: 0
  * - *is_background*: 0
  * - *invert*: 0
+ * - *timed*: 0
+ * - *zygote*: 0
  * - *start_time*: {0}
  * - *end_time*: {0}
+ * - *rusage*: {0}
  * - *cf*: NULL
  */
 int init_processus(processus_t* proc);
 
+/** @brief Fonction d'ajout d'un argument à un processus.
+ * @param proc Pointeur vers la structure de processus (rattachée à une ligne de commande via *cf*).
+ * @param arg Argument à ajouter (non copié : il doit vivre aussi longtemps que la ligne).
+ * @return int 0 en cas de succès, -1 en cas d'erreur (processus non rattaché, mémoire insuffisante).
+ * @details Le tableau *argv* est alloué dans l'arène de la ligne et sa capacité est doublée lorsqu'il est plein :
+ *    les arguments d'une commande sont généralement les dernières allocations de l'arène, le tableau est alors agrandi sur place.
+ */
+int add_argument(processus_t* proc, char* arg);
+
+/** @brief Fonction d'ajout d'une affectation propre à un processus ("FOO=1 cmd").
+ * @param proc Pointeur vers la structure de processus (rattachée à une ligne de commande via *cf*).
+ * @param assignment Affectation "NOM=valeur" (non copiée : elle doit vivre aussi longtemps que la ligne).
+ * @return int 0 en cas de succès, -1 en cas d'erreur (processus non rattaché, mémoire insuffisante).
+ * @details Le tableau *envp* est alloué dans l'arène de la ligne. Il ne contient que les affectations de la commande :
+ *    l'environnement complet est construit au lancement à partir des variables exportées du shell.
+ */
+int add_assignment(processus_t* proc, char* assignment);
+
+/** @brief Fonction d'ajout d'une redirection à un processus.
+ * @param proc Pointeur vers la structure de processus (rattachée à une ligne de commande via *cf*).
+ * @param type Type de redirection (redirection_t).
+ * @param fd Descripteur redirigé (0, 1 ou 2).
+ * @param target_fd Descripteur dupliqué pour REDIR_DUP_IN et REDIR_DUP_OUT (0, 1 ou 2).
+ * @param path Fichier cible, ou contenu pour REDIR_HEREDOC et REDIR_HERESTRING (non copié : il doit vivre aussi longtemps que la ligne).
+ * @return int 0 en cas de succès, -1 en cas d'erreur (processus non rattaché, mémoire insuffisante).
+ * @details La redirection n'est qu'enregistrée : le fichier est ouvert au lancement du processus, si celui-ci a lieu.
+ *    Le tableau *redirs* est alloué dans l'arène de la ligne et sa capacité est doublée lorsqu'il est plein.
+ */
+int add_redirection(processus_t* proc, int type, int fd, int target_fd, char* path);
+
+/** @brief Fonction d'ajout d'un descripteur transmis tel quel à un processus.
+ * @param proc Pointeur vers la structure de processus (rattachée à une ligne de commande via *cf*).
+ * @param fd Descripteur ouvert par le shell (O_CLOEXEC), déjà listé dans *opened_descriptors*.
+ * @return int 0 en cas de succès, -1 en cas d'erreur (processus non rattaché, mémoire insuffisante).
+ * @details Le descripteur reste ouvert sous le même numéro dans la commande (accès par /dev/fd/N) ;
+ *    le shell le ferme dès le lancement effectué, comme les fichiers de redirection.
+ */
+int add_inherited_fd(processus_t* proc, int fd);
+
 /** @brief Fonction de lancement d'un processus à partir d'une structure de processus.
  * @param proc Pointeur vers la structure de processus à lancer.
  * @return int 0 en cas de succès, un code d'erreur sinon.
- * @details Cette fonction utilise *fork()* et *execve()* pour lancer le processus décrit par la structure.
- *    Elle gère également les redirections des IOs standards (via *dup2()*).
+ * @details Cette fonction utilise *posix_spawn()* pour lancer le processus décrit par la structure (*fork()* n'est conservé que pour les builtins exécutés hors du shell).
+ *    Elle gère également les redirections des IOs standards (actions *dup2* de *posix_spawn*).
  *    En cas de succès, le champ *pid* de la structure est mis à jour avec le PID du processus fils.
- *    Le flag *is_background* détermine si on attend la fin du processus ou non.
+ *    Le flag *is_background* détermine si on attend la fin du processus ou non : un processus en arrière-plan est enregistré dans la table des jobs.
  *    La valeur de *status* est mise à jour à l'issue de l'exécution avec le code de retour du processus fils lorsque le flag *is_background* est désactivé.
  *    Les temps de démarrage et d'arrêt sont enregistrés dans *start_time* et *end_time* respectivement. *end_time* est mis à jour uniquement si *is_background* est désactivé.
- *    Les descripteurs de fichiers ouverts sont gérés dans *cf->cmdl->opened_descriptors* : le processus "fils" ferme tous les descripteurs listés dans ce tableau avant d'exécuter la commande.
+ *    Les descripteurs ouverts par le shell (tubes, fichiers de redirection) le sont avec O_CLOEXEC : seuls ceux qui sont dupliqués sur 0, 1 et 2 restent ouverts dans la commande.
+ *    Ils sont listés dans *cf->cmdl->opened_descriptors* pour être refermés par le shell.
+ *    Si la commande est introuvable, un message est affiché et *status* vaut le code de retour 127.
  */
 int launch_processus(processus_t* proc);
 
+/** @brief Fonction de démarrage d'un processus sans attente de sa terminaison.
+ * @param proc Pointeur vers la structure de processus à démarrer.
+ * @return int 0 en cas de succès, -1 en cas d'erreur (échec de *fork()*).
+ * @details Cette fonction effectue le lancement décrit pour *launch_processus()* mais rend la main immédiatement au parent.
+ *    Contrairement à *launch_processus()*, une commande intégrée est toujours exécutée dans le processus fils : cette fonction est utilisée
+ *    pour les étages d'un pipeline, qui doivent tous s'exécuter en parallèle.
+ *    Avec le contrôle des jobs, le processus est placé dans le groupe *pgid* (0 : nouveau groupe dont il est le leader).
+ *    Un processus sans commande (*path* NULL) n'est pas lancé : son *pid* reste à 0 et son *status* à 0.
+ */
+int start_processus(processus_t* proc);
+
+/** @brief Fonction d'attente de la terminaison d'un processus démarré par *start_processus()*.
+ * @param proc Pointeur vers la structure de processus à attendre.
+ * @return int 0 si le processus s'est terminé avec succès, son code de retour (ou 128 + numéro de signal) sinon, -1 en cas d'erreur.
+ * @details Les champs *status*, *end_time* et *rusage* sont mis à jour (attente par *wait4()*) ; *end_time* n'est renseigné que si le processus est terminé.
+ *    Avec le contrôle des jobs, la fonction retourne aussi lorsque le processus est suspendu (WIFSTOPPED(*status*) est alors vrai).
+ *    Si *pid* vaut 0 (processus non lancé), la fonction retourne immédiatement.
+ */
+int wait_processus(processus_t* proc);
+
+/** @brief Fonction de lancement d'un pipeline complet.
+ * @param cf Pointeur vers la structure de contrôle de flux du premier étage du pipeline.
+ * @param last Pointeur dans lequel est renvoyé le dernier étage du pipeline (peut être NULL).
+ * @return int 0 en cas de succès, -1 en cas d'erreur fatale (échec de *fork()*, de *waitpid()*...).
+ * @details Les étages sont reliés par le champ *pipe_next*. Une commande intégrée seule au premier plan est exécutée dans le shell,
+ *    et une commande réduite à des affectations ("X=1") y modifie les variables.
+ *    Sinon, tous les étages sont démarrés via *start_processus()* avant la moindre attente : le parent ferme ses extrémités des tubes
+ *    (et les fichiers de redirection) de chaque étage dès que celui-ci est lancé, puis attend l'ensemble des étages.
+ *    Avec le contrôle des jobs, les étages forment un groupe de processus dont le leader est le premier étage, et ce groupe reçoit le terminal.
+ *    Le statut du pipeline est celui du dernier étage. Si le dernier étage est en arrière-plan, le pipeline est enregistré dans la table des jobs sans attente.
+ */
+int launch_pipeline(control_flow_t* cf, control_flow_t** last);
+
 /** @brief Fonction d'initialisation d'une structure de contrôle de flux.
  * @param cf Pointeur vers la structure de contrôle de flux à initialiser.
  * @return int 0 en cas de succès, -1 en cas d'erreur.
  * @details Cette fonction initialise les champs de la structure avec les valeurs suivantes:
  * - *proc*: NULL
- * - *unconditionnal_next*: NULL
- * - *on_success_next*: NULL
- * - *on_failure_next*: NULL
+ * - *pipe_next*: NULL
  * - *cmdl*: NULL
  */
 int init_control_flow(control_flow_t* cf);
 
 /** @brief Fonction d'ajout d'un processus à la structure de contrôle de flux.
  * @param cmdl Pointeur vers la structure de ligne de commande dans laquelle le processus doit être ajouté.
- * @param mode Mode d'ajout (UNCONDITIONAL, ON_SUCCESS, ON_FAILURE).
- * @return processus_t* Pointeur vers le processus ajouté, ou NULL en cas d'erreur (tableau plein par exemple).
- * @details Cette fonction ajoute le processus *proc* à la structure de contrôle de flux *cf* selon le mode spécifié:
- * Le dernier élément du tableau *commands* est retourné après avoir été initialisé dans le dernier élément du tableau *flow*.
- * Cette structure control_flow_t est mise à jour pour que le champ *proc* pointe vers le processus ajouté et la liste est mise à jour de la manière suivante :
- * - Si *mode* est UNCONDITIONAL, *proc* est ajouté à la liste des processus à exécuter inconditionnellement après le processus courant.
- * - Si *mode* est ON_SUCCESS, *proc* est ajouté à la liste des processus à exécuter uniquement si le processus courant s'est terminé avec succès (code de retour 0).
- * - Si *mode* est ON_FAILURE, *proc* est ajouté à la liste des processus à exécuter uniquement si le processus courant s'est terminé avec un échec (code de retour non nul).
+ * @param mode Mode d'ajout (UNCONDITIONAL, ON_SUCCESS, ON_FAILURE, PIPE).
+ * @return processus_t* Pointeur vers le processus ajouté, ou NULL en cas d'erreur (mémoire insuffisante).
+ * @details Cette fonction ajoute un processus à la liste des noeuds de contrôle de flux de *cmdl* selon le mode spécifié.
+ * Le noeud et son processus sont alloués dans l'arène de la ligne (ou repris de *pending_flow* s'ils ont été préparés par *next_processus()*).
+ * - Si *mode* est PIPE, *proc* devient l'étage suivant du pipeline du processus courant (champ *pipe_next*).
+ * - Sinon (UNCONDITIONAL, ON_SUCCESS, ON_FAILURE), *proc* commence un nouveau pipeline.
+ *
+ * La condition d'exécution du pipeline n'est pas enregistrée ici : elle est compilée dans le programme de la ligne (*code*).
  */
 processus_t* add_processus(command_line_t* cmdl, control_flow_mode_t mode);
 
 /** @brief Fonction de récupération du prochain processus à exécuter selon le contrôle de flux.
  * @param cmdl Pointeur vers la structure de ligne de commande.
- * @return processus_t* Pointeur vers le prochain processus à exécuter, ou NULL si le nombre maximum est atteint.
- * @details Cette fonction retourne un pointeur vers la structure processus_t dans le tableau *commands* situé à l'indice *num_commands + 1*.
- *  Si le nombre maximum de commandes est atteint (MAX_CMDS), la fonction retourne NULL.
+ * @return processus_t* Pointeur vers le prochain processus, ou NULL en cas d'erreur (mémoire insuffisante).
+ * @details Cette fonction prépare dans l'arène (champ *pending_flow*) le processus qui sera renvoyé par le prochain appel à *add_processus()*,
+ *  et retourne toujours le même tant que cet appel n'a pas eu lieu.
  *  Cela permet notamment d'initialiser les descripteurs des IOs standards qui dépendent du processus en court de traitement (dans le cas des pipes par exemple).
  */
 processus_t* next_processus(command_line_t* cmdl);
@@ -159,9 +305,9 @@ processus_t* next_processus(command_line_t* cmdl);
 /** @brief Fonction d'ajout d'un descripteur de fichier à la structure de contrôle de flux.
  * @param cmdl Pointeur vers la structure de ligne de commande.
  * @param fd Descripteur de fichier à ajouter.
- * @return int 0 en cas de succès, -1 en cas d'erreur (tableau plein ou fd invalide).
+ * @return int 0 en cas de succès, -1 en cas d'erreur (mémoire insuffisante ou fd invalide).
  * @details Cette fonction ajoute le descripteur de fichier *fd* au tableau *opened_descriptors* de la structure *cf*.
- *    Si le tableau est plein ou si *fd* est invalide (négatif), la fonction retourne -1
+ *    Le tableau est agrandi dans l'arène de la ligne lorsqu'il est plein ; si *fd* est invalide (négatif), la fonction retourne -1
  */
 int add_fd(command_line_t* cmdl, int fd);
 
@@ -173,26 +319,49 @@ int add_fd(command_line_t* cmdl, int fd);
  */
 int close_fds(command_line_t* cmdl);
 
+/** @brief Fonction de fermeture d'un descripteur de fichier listé dans la structure de ligne de commande.
+ * @param cmdl Pointeur vers la structure de ligne de commande.
+ * @param fd Descripteur de fichier à fermer.
+ * @return int 0 si le descripteur a été fermé, -1 s'il n'est pas présent dans *opened_descriptors*.
+ * @details Le descripteur n'est fermé que s'il est présent dans le tableau *opened_descriptors*, son entrée étant remise à -1 :
+ *    un même descripteur ne peut donc pas être fermé deux fois, et les descripteurs standards ne sont jamais fermés.
+ */
+int release_fd(command_line_t* cmdl, int fd);
+
 /** @brief Fonction d'initialisation d'une structure de ligne de commande.
- * @param cmdl Pointeur vers la structure de ligne de commande à initialiser.
+ * @param cmdl Pointeur vers la structure de ligne de commande à initialiser (initialisée à zéro avant le premier appel).
  * @return int 0 en cas de succès, -1 en cas d'erreur.
- * @details Cette fonction initialise les champs de la structure avec les valeurs suivantes:
- * - *command_line*: "\0"
- * - *tokens*: {NULL}
- * - *commands*: tableau de processus initialisé via *init_processus()*
- * - *flow*: tableau de contrôle de flux initialisé via *init_control_flow()*
+ * @details Cette fonction ferme les descripteurs encore ouverts de la ligne précédente (ligne non lancée après une erreur d'analyse) et attend ses substitutions de processus,
+ *    libère toutes ses données par *arena_reset()* (coût proportionnel à la mémoire utilisée)
+ *    et initialise les champs de la structure avec les valeurs suivantes:
+ * - *command_line*: NULL
+ * - *flow*, *last_flow*, *pending_flow*: NULL
  * - *num_commands*: 0
- * - *opened_descriptors*: {-1}
+ * - *plan*, *code*: NULL (*code_len* à 0)
+ * - *status*: 0
+ * - *opened_descriptors*: NULL (*num_descriptors* et *descriptors_capacity* à 0)
  */
 int init_command_line(command_line_t* cmdl);
 
 /** @brief Fonction de lancement d'une ligne de commande.
  * @param cmdl Pointeur vers la structure de ligne de commande à lancer.
  * @return int 0 en cas de succès, un code d'erreur sinon.
- * @details Cette fonction lance les processus selon le flux défini dans la structure *cmdl*. Les lancements sont effectués via *launch_processus()* en
- *    respectant les conditions de contrôle de flux (inconditionnel, en cas de succès, en cas d'échec).
+ * @details Cette fonction exécute le programme de la ligne (*code*) : une boucle d'interprétation instancie puis lance les pipelines désignés par les instructions
+ *    (*launch_pipeline()*, ou directement la commande intégrée ou les affectations d'un pipeline réduit à celles-ci), suit les sauts conditionnels
+ *    évalués sur le statut du dernier étage, inversé si le premier étage porte le flag *invert*, et exécute les boucles.
  *    Le tableau *opened_descriptors* est utilisé pour fermer les descripteurs ouverts au moment de l'initialisation des structures processus_t.
  *    La fonction retourne 0 si tous les processus à lancer en fonction du contrôle de flux ont pu être lancés sans erreur.
+ *    Le code de retour du dernier pipeline exécuté est rangé dans *cmdl->status*.
+ *    Après chaque pipeline, ses descripteurs sont fermés et ses substitutions de processus attendues (*subst_wait()*).
  */
 int launch_command_line(command_line_t* cmdl);
+
+/** @brief Fonction de lancement d'une ligne de commande lue par le shell (script, -c, terminal), avec l'ordonnanceur s'il est activé.
+ * @param cmdl Pointeur vers la structure de ligne de commande à lancer.
+ * @return int 0 en cas de succès, un code d'erreur sinon.
+ * @details Sans ordonnanceur (scheduler.h), la fonction est équivalente à *launch_command_line()*. Avec l'ordonnanceur, les listes de premier niveau
+ *    sont exécutées par des jobs, au plus N à la fois, et peuvent encore être en cours au retour : *cmdl->status* n'est alors significatif
+ *    qu'après une barrière, et le code de retour des listes suivantes est obtenu par *sched_drain()*.
+ */
+int schedule_command_line(command_line_t* cmdl);
 #endif
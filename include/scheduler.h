@@ -0,0 +1,58 @@
+/**
+ * @file scheduler.h
+ * @brief Header file for the parallel list scheduler
+ * @author Nom1
+ * @author Nom2
+ * @date 2025-26
+ * @details Définitions de l'ordonnanceur parallèle, activé par "minishell -j N" ou "set -j N".
+ *   Le programme d'une ligne est vu comme un graphe : chaque liste "&&"/"||" de premier niveau (terminée par ";", "&" ou la fin de ligne)
+ *   est un noeud, dont les pipelines restent enchaînés selon leurs arcs de succès et d'échec ; deux listes séparées par ";" ou "&" sont indépendantes.
+ *   Un noeud prêt est exécuté par un sous-shell (un job de l'ordonnanceur), au plus N à la fois, y compris d'une ligne à l'autre d'un script.
+ *   Une liste qui modifie l'état du shell (commande intégrée autre qu'echo, printf, pwd, test, true, false ; affectations ; boucle)
+ *   est une barrière : tous les jobs en cours sont terminés avant qu'elle s'exécute dans le shell.
+ *   Les sorties standard et d'erreur de chaque job sont écrites dans des fichiers anonymes en mémoire (*memfd_create()*) puis recopiées
+ *   dans l'ordre du programme, job par job (une seule capture si les deux sorties du shell désignent le même fichier, ce qui garde leur entrelacement) ;
+ *   l'entrée standard d'un job est /dev/null, comme celle d'une commande en arrière-plan.
+ *   Le code de retour est celui de la dernière liste dans l'ordre du programme, quel que soit l'ordre de terminaison des jobs ;
+ *   une liste terminée par "&" vaut 0, comme sans l'ordonnanceur.
+ */
+
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <sys/types.h>
+
+/// Nombre maximal de jobs de l'ordonnanceur exécutés en même temps
+#define SCHED_MAX_JOBS 128
+
+/** @brief Fonction de réglage du nombre de jobs exécutés en même temps.
+ * @param limit Nombre de jobs (0 : ordonnanceur désactivé, les listes sont exécutées dans l'ordre par le shell), au plus SCHED_MAX_JOBS.
+ * @return int 0 en cas de succès, -1 si *limit* est trop grand.
+ * @details Les jobs en cours ne sont pas attendus : l'appelant doit d'abord appeler *sched_drain()*.
+ */
+int sched_set_limit(unsigned limit);
+
+/** @brief Fonction renvoyant le nombre de jobs exécutés en même temps.
+ * @return unsigned Limite courante, 0 si l'ordonnanceur est désactivé.
+ */
+unsigned sched_limit(void);
+
+/** @brief Fonction de création d'un job : attente d'une place libre, puis création du sous-shell.
+ * @return pid_t PID du job dans le shell, 0 dans le job, -1 en cas d'erreur (message affiché, la liste doit alors être exécutée par le shell).
+ * @details Dans le job, les descripteurs standards sont en place (/dev/null, fichiers de capture), le contrôle des jobs, le serveur de lancement
+ *    et l'ordonnanceur sont désactivés, SIGINT et SIGPIPE ont leur comportement par défaut. Le job se termine par *_exit()* avec le code de retour de sa liste.
+ *    Pendant l'attente d'une place, la sortie des jobs terminés est recopiée dans l'ordre.
+ */
+pid_t sched_fork(void);
+
+/** @brief Fonction d'attente de tous les jobs de l'ordonnanceur, dont la sortie est recopiée dans l'ordre.
+ * @param status Pointeur dans lequel est renvoyé le code de retour du dernier job, dans l'ordre du programme.
+ * @return int 1 si au moins un job a été attendu (*status* positionné), 0 s'il n'y en avait aucun.
+ */
+int sched_drain(int* status);
+
+/** @brief Fonction à appeler dans un fils créé par *fork()* du shell : la table des jobs de l'ordonnanceur est oubliée et ses descripteurs fermés.
+ */
+void sched_leave(void);
+
+#endif // SCHEDULER_H
@@ -0,0 +1,71 @@
+/**
+ * @file subst.h
+ * @brief Header file for command and process substitution
+ * @author Nom1
+ * @author Nom2
+ * @date 2025-26
+ * @details Définitions de l'exécution des substitutions de commandes "$(...)" et de processus "<(...)", ">(...)".
+ *   Pour une substitution de commande, la ligne intérieure est analysée comme une ligne de commande
+ *   (plan, cache) puis lancée par *launch_command_line()*, sa sortie standard étant capturée. Aucun fichier temporaire n'est créé :
+ *   - une commande intégrée sans effet sur le shell (BUILTIN_NOFORK : echo, printf, pwd...), seule, est exécutée dans le shell,
+ *     sa sortie étant écrite dans un fichier anonyme en mémoire (*memfd_create()*) ;
+ *   - toute autre ligne est exécutée par un sous-shell (*fork()*), dont la sortie standard est un tube lu au fur et à mesure.
+ *   La sortie est transmise par blocs à la fonction appelante (découpage en champs par l'analyseur lexical) : sa taille n'est pas limitée.
+ *   Une substitution de processus démarre un sous-shell relié à la commande par un tube, sans attendre sa fin : la commande reçoit le chemin
+ *   /dev/fd/N de son extrémité du tube, et les deux s'exécutent en parallèle. Le sous-shell est attendu à la fin du pipeline de la commande.
+ */
+
+#ifndef SUBST_H
+#define SUBST_H
+
+#include <stddef.h>
+
+#include "processus.h"
+
+/// Profondeur maximale d'imbrication des substitutions
+#define SUBST_MAX_DEPTH 64
+/// Taille des blocs de sortie transmis à la fonction appelante
+#define SUBST_CHUNK (16 * 1024)
+
+/** @brief Type des fonctions recevant la sortie d'une substitution, bloc par bloc (retournent 0, ou -1 pour abandonner la lecture). */
+typedef int (*subst_sink_t)(void* arg, const char* data, size_t len);
+
+/** @brief Fonction d'exécution d'une substitution de commande.
+ * @param line Ligne de commande intérieure (terminée par '\0').
+ * @param sink Fonction recevant la sortie standard de la ligne.
+ * @param arg Argument transmis à *sink*.
+ * @return int Code de retour de la dernière commande exécutée (2 pour une erreur de syntaxe, message affiché), -1 en cas d'erreur système (*errno* positionné).
+ * @details Les substitutions contenues dans la ligne intérieure sont effectuées à l'instanciation de ses pipelines (dans le sous-shell s'il y en a un).
+ *    Dans le sous-shell, le contrôle des jobs est désactivé et SIGINT et SIGPIPE ont leur comportement par défaut : Ctrl-C interrompt la substitution.
+ *    Avec le traçage, la substitution est enregistrée (catégorie "subst") avec son code de retour.
+ */
+int subst_run(const char* line, subst_sink_t sink, void* arg);
+
+/** @brief Fonction de désignation du processus auquel sont rattachées les substitutions de processus suivantes.
+ * @param proc Processus dont les mots sont en cours d'expansion (NULL : aucune substitution de processus possible).
+ * @details Appelée par l'instanciation d'un pipeline avant l'expansion des mots de chaque commande.
+ */
+void subst_attach(processus_t* proc);
+
+/** @brief Fonction de démarrage d'une substitution de processus.
+ * @param line Ligne de commande intérieure (terminée par '\0').
+ * @param output 1 pour ">(...)" (la commande écrit, le sous-shell lit son entrée standard), 0 pour "<(...)".
+ * @param path Tampon recevant le chemin /dev/fd/N à passer à la commande.
+ * @param size Taille de *path*.
+ * @return int 0 en cas de succès, -1 en cas d'erreur (message affiché).
+ * @details L'extrémité du tube laissée au shell est ajoutée aux descripteurs de la ligne et transmise telle quelle au processus désigné
+ *    par *subst_attach()* (*add_inherited_fd()*) : le shell la ferme dès son lancement. Le sous-shell démarre immédiatement.
+ *    Si la ligne intérieure est vide ou invalide (message affiché), aucun sous-shell n'est lancé et le tube est vide.
+ *    Avec le traçage, le démarrage est enregistré (catégorie "subst") avec le PID du sous-shell.
+ */
+int subst_process(const char* line, int output, char* path, size_t size);
+
+/** @brief Fonction d'attente des substitutions de processus d'une ligne.
+ * @param cmdl Ligne dont les descripteurs viennent d'être fermés (à la fin de chaque pipeline).
+ * @details Les sous-shells rattachés à une commande au premier plan sont attendus : une fois les tubes fermés par le shell,
+ *    le producteur d'un "<(...)" reçoit EPIPE et le lecteur d'un ">(...)" la fin de fichier. Ceux d'une commande en arrière-plan
+ *    sont récupérés sans attente lors des appels suivants.
+ */
+void subst_wait(command_line_t* cmdl);
+
+#endif // SUBST_H
@@ -0,0 +1,88 @@
+/**
+ * @file trace.h
+ * @brief Header file for execution tracing
+ * @author Nom1
+ * @author Nom2
+ * @date 2025-26
+ * @details Définitions de l'enregistrement de traces d'exécution au format Chrome trace (JSON, lisible par chrome://tracing ou Perfetto).
+ *   Le traçage est activé par la variable d'environnement MINISHELL_TRACE, qui donne le chemin du fichier de trace.
+ *   Les événements (analyse, lancement, vie et attente des fils, ouverture des redirections, commandes intégrées, arc suivi après chaque pipeline)
+ *   sont rangés dans un tampon propre au processus, sans verrou ni allocation : l'emplacement est réservé par un incrément atomique,
+ *   ce qui permet aussi l'enregistrement depuis le gestionnaire de SIGCHLD. Le tampon est écrit dans le fichier entre deux lignes
+ *   de commandes s'il se remplit, et à la fin du processus.
+ *   Désactivé, le traçage ne coûte qu'un test de *trace_enabled* à chaque point d'enregistrement.
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+#include <time.h>
+#include <sys/types.h>
+
+/// Variable d'environnement donnant le fichier de trace
+#define TRACE_ENV "MINISHELL_TRACE"
+/// Nombre d'événements du tampon d'un processus
+#define TRACE_BUFFER_EVENTS 16384
+/// Taille maximale d'un nom d'événement (tronqué au-delà)
+#define TRACE_NAME_SIZE 48
+
+/// Traçage actif (seul test effectué aux points d'enregistrement lorsqu'il est désactivé)
+extern int trace_enabled;
+
+/** @brief Fonction d'activation du traçage.
+ * @param path Chemin du fichier de trace (NULL ou vide : traçage désactivé).
+ * @return int 0 en cas de succès ou si le traçage est désactivé, -1 si le fichier ne peut pas être ouvert (message affiché).
+ * @details Le fichier est ouvert en ajout (O_APPEND, O_CLOEXEC) : les shells lancés par le shell tracé, qui héritent de la variable,
+ *    ajoutent leurs événements au même fichier, chacun sous son PID. Un fichier vide reçoit l'en-tête du tableau JSON ;
+ *    le ']' final est omis, ce que le format autorise. Le tampon est écrit à la sortie du processus (*atexit()*).
+ */
+int trace_init(const char* path);
+
+/** @brief Fonction de lecture de l'horloge de la trace.
+ * @return int64_t Temps CLOCK_MONOTONIC en nanosecondes (même horloge que *start_time* et *end_time* des processus).
+ */
+int64_t trace_clock(void);
+
+/** @brief Fonction de conversion d'un temps de l'horloge monotone en nanosecondes.
+ * @param ts Temps à convertir.
+ * @return int64_t Temps en nanosecondes.
+ */
+int64_t trace_timespec(struct timespec ts);
+
+/** @brief Fonction d'enregistrement d'un intervalle.
+ * @param cat Catégorie ("parse", "spawn", "fork", "child", "wait", "redirect", "builtin", "pipeline"), chaîne statique.
+ * @param name Nom de l'événement (copié, tronqué à TRACE_NAME_SIZE - 1 caractères ; NULL : *cat*).
+ * @param start Début en nanosecondes (*trace_clock()*).
+ * @param end Fin en nanosecondes.
+ * @param tid Processus auquel l'intervalle est rattaché (PID d'un fils, 0 pour le processus courant).
+ * @param key Nom de l'argument numérique (chaîne statique, NULL si aucun).
+ * @param value Valeur de l'argument numérique.
+ * @param edge Arc suivi ("success", "failure", "unconditional"), chaîne statique ou NULL.
+ * @details Async-signal-safe : utilisable depuis un gestionnaire de signal. Si le tampon est plein, l'événement est compté comme perdu.
+ */
+void trace_span(const char* cat, const char* name, int64_t start, int64_t end, pid_t tid, const char* key, long value, const char* edge);
+
+/** @brief Fonction d'écriture du tampon si celui-ci est à moitié plein.
+ * @details Appelée par le shell entre deux lignes de commandes, hors de tout gestionnaire de signal.
+ */
+void trace_sync(void);
+
+/** @brief Fonction d'écriture du tampon dans le fichier de trace.
+ * @details Les signaux sont bloqués pendant l'écriture. Les événements perdus depuis la dernière écriture sont signalés par un événement "trace_dropped".
+ */
+void trace_flush(void);
+
+/** @brief Fonction retournant le descripteur du fichier de trace.
+ * @return int Descripteur (O_CLOEXEC), -1 si le traçage est désactivé.
+ * @details Un fils créé par *fork()* qui ferme ses descripteurs doit conserver celui-ci pour écrire ses événements.
+ */
+int trace_descriptor(void);
+
+/** @brief Fonction de réinitialisation du tampon dans un fils créé par *fork()*.
+ * @details Le fils hérite d'une copie des événements non écrits du parent, qui les écrira lui-même : le tampon du fils est vidé
+ *    et ses événements portent son PID. Le fils doit appeler *trace_flush()* avant *_exit()*.
+ */
+void trace_fork_child(void);
+
+#endif // TRACE_H
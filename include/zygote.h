@@ -0,0 +1,83 @@
+/**
+ * @file zygote.h
+ * @brief Header file for the pre-forked spawn server
+ * @author Nom1
+ * @author Nom2
+ * @date 2025-26
+ * @details Définitions du serveur de lancement ("zygote"), activé par l'option -z du shell.
+ *   Au démarrage, avant que le tas du shell ne grossisse, le shell crée un petit processus auxiliaire relié par une paire de sockets Unix.
+ *   Chaque demande de lancement lui transmet l'exécutable, les arguments, l'environnement et les signaux à remettre par défaut ;
+ *   les descripteurs standards, le répertoire courant (descripteur ouvert sur ".") et les descripteurs hérités voyagent par *SCM_RIGHTS*.
+ *   L'auxiliaire crée le fils par *fork()* (son propre espace mémoire, minuscule, est seul recopié), lui fait exécuter la commande,
+ *   puis renvoie son PID (ou l'erreur d'*execve()*) et, à sa terminaison, son statut et ses ressources (*wait4()*).
+ *   Le coût d'un lancement ne dépend donc pas de la mémoire occupée par le shell. Les fils de l'auxiliaire ne sont pas ceux du shell :
+ *   ils sont attendus par *zygote_wait()*, jamais par *waitpid()*.
+ *   Si l'auxiliaire disparaît, le serveur est désactivé et les lancements suivants reviennent à *posix_spawn()*.
+ */
+
+#ifndef ZYGOTE_H
+#define ZYGOTE_H
+
+#include <signal.h>
+#include <stddef.h>
+#include <sys/types.h>
+#include <sys/resource.h>
+
+/// Nombre maximal de descripteurs hérités transmis avec une demande (au-delà, le lancement se fait sans le serveur)
+#define ZYGOTE_MAX_INHERITED 16
+
+/**
+ * @brief Demande de lancement d'une commande par le serveur.
+ * @struct zygote_request_t
+ */
+typedef struct {
+    const char* exe;            ///< Chemin de l'exécutable (déjà résolu dans le PATH)
+    char* const* argv;          ///< Arguments, terminés par NULL
+    char* const* envp;          ///< Environnement, terminé par NULL
+    int fds[3];                 ///< Descripteurs à placer sur 0, 1 et 2 dans le fils
+    const int* inherited;       ///< Descripteurs transmis tels quels, sous le même numéro
+    size_t num_inherited;       ///< Nombre de descripteurs transmis (au plus ZYGOTE_MAX_INHERITED)
+    const sigset_t* sigdefault; ///< Signaux remis à leur comportement par défaut dans le fils (le masque est vidé)
+} zygote_request_t;
+
+/** @brief Fonction de démarrage du serveur de lancement.
+ * @return int 0 en cas de succès, -1 en cas d'erreur (*errno* positionné, le shell fonctionne alors sans serveur).
+ * @details À appeler tôt, tant que le shell occupe peu de mémoire : l'auxiliaire n'exécute ensuite que le code de ce module.
+ *    Il ignore SIGINT (Ctrl-C est destiné aux commandes) et se termine quand le shell ferme la socket.
+ */
+int zygote_start(void);
+
+/** @brief Fonction d'arrêt du serveur de lancement (la socket est fermée, l'auxiliaire est attendu).
+ * @details Les fils encore en cours ne pourront plus être attendus par *zygote_wait()*.
+ */
+void zygote_stop(void);
+
+/** @brief Fonction à appeler dans un fils créé par *fork()* du shell (commande intégrée, sous-shell).
+ * @details Le fils ferme sa copie de la socket et lance ses commandes sans le serveur : les réponses de l'auxiliaire restent au seul shell.
+ */
+void zygote_leave(void);
+
+/** @brief Fonction indiquant si le serveur de lancement est actif.
+ * @return int 1 si le serveur peut recevoir des demandes, 0 sinon.
+ */
+int zygote_enabled(void);
+
+/** @brief Fonction de lancement d'une commande par le serveur.
+ * @param req Demande de lancement.
+ * @param err Pointeur dans lequel est renvoyée l'erreur d'*execve()* (0 si la commande a été exécutée).
+ * @return pid_t PID du fils, 0 si *execve()* a échoué (*err* positionné, le fils est déjà attendu),
+ *    -1 si la demande n'a pas pu être traitée (*errno* positionné ; si l'auxiliaire ne répond plus, le serveur est désactivé).
+ *    L'appelant lance alors la commande lui-même.
+ */
+pid_t zygote_spawn(const zygote_request_t* req, int* err);
+
+/** @brief Fonction d'attente d'un fils lancé par le serveur.
+ * @param pid PID renvoyé par *zygote_spawn()*.
+ * @param wstatus Pointeur dans lequel est renvoyé le statut, au format de *waitpid()*.
+ * @param usage Pointeur dans lequel sont renvoyées les ressources consommées par le fils (peut être NULL).
+ * @return int 0 en cas de succès, -1 en cas d'erreur (*errno* positionné).
+ * @details Les terminaisons d'autres fils reçues pendant l'attente sont mémorisées pour les appels suivants.
+ */
+int zygote_wait(pid_t pid, int* wstatus, struct rusage* usage);
+
+#endif // ZYGOTE_H
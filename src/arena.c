@@ -0,0 +1,134 @@
+/** @file arena.c
+ * @brief Implementation of the per-line arena allocator
+ * @author Nom1
+ * @author Nom2
+ * @date 2025-26
+ * @details Implémentation de l'allocateur "bump" par blocs.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdalign.h>
+#include <stdint.h>
+
+#include "arena.h"
+
+/// Alignement des allocations
+#define ARENA_ALIGN (alignof(max_align_t))
+
+/** @brief Arrondi de *n* au multiple supérieur de l'alignement. */
+static size_t align_up(size_t n) {
+    return (n + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1);
+}
+
+/** @brief Ajout d'un bloc pouvant contenir au moins *size* octets en tête de l'arène. */
+static arena_block_t* new_block(arena_t* arena, size_t size) {
+    size_t block_size = (size > ARENA_BLOCK_SIZE) ? size : ARENA_BLOCK_SIZE;
+    arena_block_t* block = malloc(sizeof(arena_block_t) + block_size);
+    if (!block) return NULL;
+
+    block->size = block_size;
+    block->used = 0;
+    block->next = arena->current;
+    arena->current = block;
+    return block;
+}
+
+void* arena_alloc(arena_t* arena, size_t size) {
+    if (!arena) return NULL;
+
+    size = align_up(size ? size : 1);
+    arena_block_t* block = arena->current;
+    if (!block || block->size - block->used < size) {
+        block = new_block(arena, size);
+        if (!block) return NULL;
+    }
+
+    void* ptr = block->data + block->used;
+    block->used += size;
+    arena->last = ptr;
+    return ptr;
+}
+
+void* arena_calloc(arena_t* arena, size_t size) {
+    void* ptr = arena_alloc(arena, size);
+    if (ptr) memset(ptr, 0, size);
+    return ptr;
+}
+
+void* arena_realloc(arena_t* arena, void* ptr, size_t old_size, size_t new_size) {
+    if (!arena) return NULL;
+    if (!ptr) return arena_alloc(arena, new_size);
+
+    /* dernière allocation du bloc courant : redimensionnement sur place si possible */
+    arena_block_t* block = arena->current;
+    if (ptr == arena->last && block) {
+        size_t offset = (char*)ptr - block->data;
+        size_t needed = align_up(new_size);
+        if (block->size - offset >= needed) {
+            block->used = offset + needed;
+            return ptr;
+        }
+    }
+    if (new_size <= old_size) return ptr;
+
+    void* copy = arena_alloc(arena, new_size);
+    if (copy) memcpy(copy, ptr, old_size);
+    return copy;
+}
+
+char* arena_strndup(arena_t* arena, const char* str, size_t len) {
+    char* copy = arena_alloc(arena, len + 1);
+    if (!copy) return NULL;
+    memcpy(copy, str, len);
+    copy[len] = '\0';
+    return copy;
+}
+
+arena_mark_t arena_mark(arena_t* arena) {
+    arena->last = NULL;
+    return (arena_mark_t){ arena->current, arena->current ? arena->current->used : 0 };
+}
+
+void arena_rewind(arena_t* arena, arena_mark_t mark) {
+    while (arena->current && arena->current != mark.block) {
+        arena_block_t* next = arena->current->next;
+        free(arena->current);
+        arena->current = next;
+    }
+    if (arena->current) arena->current->used = mark.used;
+    arena->last = NULL;
+}
+
+void arena_reset(arena_t* arena) {
+    if (!arena || !arena->current) return;
+
+    /* conserver le bloc le plus ancien s'il a la taille par défaut, et libérer les autres */
+    arena_block_t* block = arena->current;
+    while (block->next) {
+        arena_block_t* next = block->next;
+        free(block);
+        block = next;
+    }
+    if (block->size != ARENA_BLOCK_SIZE) {
+        free(block);
+        block = NULL;
+    } else {
+        block->used = 0;
+    }
+    arena->current = block;
+    arena->last = NULL;
+}
+
+void arena_destroy(arena_t* arena) {
+    if (!arena) return;
+
+    arena_block_t* block = arena->current;
+    while (block) {
+        arena_block_t* next = block->next;
+        free(block);
+        block = next;
+    }
+    arena->current = NULL;
+    arena->last = NULL;
+}
@@ -12,57 +12,115 @@
 #include <unistd.h>
 #include <string.h>
 #include <stdlib.h>
+#include <signal.h>
+#include <errno.h>
+#include <stdint.h>
+#include <ctype.h>
+#include <stdarg.h>
+#include <sys/stat.h>
 
 #include "builtins.h"
 #include "processus.h"
+#include "pathcache.h"
+#include "jobs.h"
+#include "env.h"
+#include "plan.h"
+#include "scheduler.h"
+
+/** @brief Table des commandes intégrées : nom, fonction et flags. */
+static const builtin_t builtins[] = {
+    { "cd",        builtin_cd,        BUILTIN_PARENT },
+    { "exit",      builtin_exit,      BUILTIN_PARENT },
+    { "export",    builtin_export,    BUILTIN_PARENT },
+    { "unset",     builtin_unset,     BUILTIN_PARENT },
+    { "pwd",       builtin_pwd,       BUILTIN_NOFORK },
+    { "hash",      builtin_hash,      BUILTIN_PARENT },
+    { "plancache", builtin_plancache, BUILTIN_PARENT },
+    { "jobs",      builtin_jobs,      BUILTIN_PARENT },
+    { "wait",      builtin_wait,      BUILTIN_PARENT },
+    { "fg",        builtin_fg,        BUILTIN_PARENT },
+    { "bg",        builtin_bg,        BUILTIN_PARENT },
+    { "echo",      builtin_echo,      BUILTIN_NOFORK },
+    { "printf",    builtin_printf,    BUILTIN_NOFORK },
+    { "true",      builtin_true,      BUILTIN_NOFORK },
+    { "false",     builtin_false,     BUILTIN_NOFORK },
+    { "test",      builtin_test,      BUILTIN_NOFORK },
+    { "[",         builtin_test,      BUILTIN_NOFORK },
+    { "break",     builtin_break,     BUILTIN_PARENT },
+    { "continue",  builtin_break,     BUILTIN_PARENT },
+    { "set",       builtin_set,       BUILTIN_PARENT },
+};
+
+/// Nombre de commandes intégrées
+#define NUM_BUILTINS (sizeof(builtins) / sizeof(builtins[0]))
+/// Nombre d'emplacements de l'index (puissance de 2, au moins le double du nombre de commandes)
+#define BUILTIN_INDEX_SIZE 64
+
+/// Index des commandes par hachage de leur nom (position dans *builtins* + 1, 0 pour un emplacement vide)
+static uint8_t builtin_index[BUILTIN_INDEX_SIZE];
+/// L'index a été construit
+static int builtin_index_ready = 0;
+
+/** @brief Hachage d'un nom de commande (FNV-1a). */
+static unsigned builtin_hash_name(const char* name) {
+    unsigned h = 2166136261u;
+    for (; *name; ++name) h = (h ^ (unsigned char)*name) * 16777619u;
+    return h;
+}
+
+/** @brief Construction de l'index des commandes intégrées (adressage ouvert, sondage linéaire). */
+static void builtin_index_build(void) {
+    for (size_t i = 0; i < NUM_BUILTINS; ++i) {
+        unsigned slot = builtin_hash_name(builtins[i].name) & (BUILTIN_INDEX_SIZE - 1);
+        while (builtin_index[slot]) slot = (slot + 1) & (BUILTIN_INDEX_SIZE - 1);
+        builtin_index[slot] = (uint8_t)(i + 1);
+    }
+    builtin_index_ready = 1;
+}
+
+const builtin_t* builtin_find(const char* name) {
+    if (!name) return NULL;
+    if (!builtin_index_ready) builtin_index_build();
+
+    unsigned slot = builtin_hash_name(name) & (BUILTIN_INDEX_SIZE - 1);
+    while (builtin_index[slot]) {
+        const builtin_t* b = &builtins[builtin_index[slot] - 1];
+        if (strcmp(b->name, name) == 0) return b;
+        slot = (slot + 1) & (BUILTIN_INDEX_SIZE - 1);
+    }
+    return NULL;
+}
+
+const builtin_t* builtin_list(size_t* count) {
+    *count = NUM_BUILTINS;
+    return builtins;
+}
 
 /** @brief Fonction de vérification si une commande est une commande "built-in".
  * @param cmd Nom de la commande à vérifier.
  * @return int 1 si la commande est intégrée, 0 sinon.
- * @details Les commandes intégrées sont a minima: cd, exit, export, unset, pwd.
+ * @details La recherche se fait dans l'index des commandes intégrées, en temps constant.
  */
 int is_builtin(const processus_t* cmd) {
-if (!cmd || !cmd->path) return 0;
-
-    return (
-        strcmp(cmd->path, "cd")    == 0 ||
-        strcmp(cmd->path, "exit")  == 0 ||
-        strcmp(cmd->path, "export")== 0 ||
-        strcmp(cmd->path, "unset") == 0 ||
-        strcmp(cmd->path, "pwd")   == 0
-    );
+    if (!cmd || !cmd->path) return 0;
+    return builtin_find(cmd->path) != NULL;
 }
 
 /** @brief Fonction d'exécution d'une commande intégrée.
  * @param cmd Pointeur vers la structure de commande à exécuter.
- * @return int 0 en cas de succès, -1 en cas d'erreur.
+ * @return int Code de retour de la commande (0 en cas de succès), -1 si la commande n'est pas intégrée.
  */
 int exec_builtin(processus_t* cmd) {
     if (!cmd || !cmd->path) return -1;
 
-    if (strcmp(cmd->path, "cd") == 0)
-        return builtin_cd(cmd);
-
-    if (strcmp(cmd->path, "exit") == 0)
-        return builtin_exit(cmd);
-
-    if (strcmp(cmd->path, "export") == 0)
-        return builtin_export(cmd);
-
-    if (strcmp(cmd->path, "unset") == 0)
-        return builtin_unset(cmd);
-
-    if (strcmp(cmd->path, "pwd") == 0)
-        return builtin_pwd(cmd);
-
-    return -1;
-
+    const builtin_t* b = builtin_find(cmd->path);
+    return b ? b->fn(cmd) : -1;
 }
 
 /** Fonctions spécifiques aux commandes intégrées. */
 /** @brief Fonction d'exécution de la commande "cd".
  * @param cmd Pointeur vers la structure de commande à exécuter.
- * @return int 0 en cas de succès, -1 en cas d'erreur.
+ * @return int Code de retour de la commande : 0 en cas de succès, 1 en cas d'erreur.
  * @details Déplace le CWD du processus vers le répertoire spécifié dans le premier argument de la commande.
  *  Si aucun argument n'est fourni, le CWD est déplacé vers le répertoire HOME de l'utilisateur.
  *  En cas d'erreur (répertoire inexistant, permission refusée, etc.), un message d'erreur est affiché sur *cmd->stderr* et la fonction retourne un code d'erreur.
@@ -73,7 +131,7 @@ int builtin_cd(processus_t* cmd) {
     if (cmd->argv[1])
         target = cmd->argv[1];
     else
-        target = getenv("HOME");
+        target = (char*)env_get("HOME");
 
     if (!target)
         target = "/";
@@ -81,7 +139,7 @@ int builtin_cd(processus_t* cmd) {
     if (chdir(target) != 0) {
          
         dprintf(cmd->stderr_fd, "cd: %s: No such file or directory\n", target);
-        return -1;
+        return 1;
     }
 
     return 0;
@@ -91,7 +149,7 @@ int builtin_cd(processus_t* cmd) {
 
 /** @brief Fonction d'exécution de la commande "exit".
  * @param cmd Pointeur vers la structure de commande à exécuter.
- * @return int 0 en cas de succès, -1 en cas d'erreur.
+ * @return int Code de retour de la commande : 0 en cas de succès, 1 en cas d'erreur.
  * @details Termine le shell avec le code de sortie spécifié dans le premier argument de la commande.
  *  Si aucun argument n'est fourni, le shell se termine avec le code de sortie 0.
  *  En cas d'erreur (argument non numérique, etc.), un message d'erreur est affiché sur *cmd->stderr* et la fonction retourne un code d'erreur
@@ -103,7 +161,7 @@ int builtin_exit(processus_t* cmd) {
         for (int i = 0; cmd->argv[1][i]; i++) {
             if (cmd->argv[1][i] < '0' || cmd->argv[1][i] > '9') {
                 dprintf(cmd->stderr_fd, "exit: numeric argument required\n");
-                return -1;
+                return 1;
             }
         }
         code = atoi(cmd->argv[1]);
@@ -114,60 +172,57 @@ int builtin_exit(processus_t* cmd) {
 
 /** @brief Fonction d'exécution de la commande "export".
  * @param cmd Pointeur vers la structure de commande à exécuter.
- * @return int 0 en cas de succès, -1 en cas d'erreur.
- * @details Ajoute ou modifie une variable d'environnement dans l'environnement du shell. En cas d'erreur (format invalide, etc.), un message d'erreur est affiché sur *cmd->stderr* et la fonction retourne un code d'erreur.
+ * @return int Code de retour de la commande : 0 en cas de succès, 1 en cas d'erreur.
+ * @details Pour chaque argument NOM=valeur, ajoute ou modifie la variable et l'exporte vers les commandes lancées ; un argument NOM seul exporte la variable existante.
+ *  Sans argument, affiche les variables exportées sur *cmd->stdout*. En cas d'erreur (nom invalide, etc.), un message d'erreur est affiché sur *cmd->stderr* et la fonction retourne un code d'erreur.
  */
 int builtin_export(processus_t* cmd) {
     if (!cmd->argv[1]) {
-        dprintf(cmd->stderr_fd, "export: expected VAR=VALUE\n");
-        return -1;
+        env_print(cmd->stdout_fd);
+        return 0;
     }
 
-    char *arg = cmd->argv[1];
-    char *eq = strchr(arg, '=');
-
-    if (!eq) {
-        dprintf(cmd->stderr_fd, "export: expected VAR=VALUE\n");
-        return -1;
-    }
-
-    *eq = '\0';
-    char *var = arg;
-    char *val = eq + 1;
-
-    if (setenv(var, val, 1) != 0) {
-        dprintf(cmd->stderr_fd, "export: failed to set variable\n");
-        return -1;
+    int ret = 0;
+    for (int i = 1; cmd->argv[i]; i++) {
+        char *arg = cmd->argv[i];
+        int err = strchr(arg, '=') ? env_put(arg, ENV_EXPORT) : env_set(arg, NULL, ENV_EXPORT);
+        if (err != 0) {
+            dprintf(cmd->stderr_fd, "export: `%s': not a valid identifier\n", arg);
+            ret = 1;
+        }
     }
 
-    return 0;
+    return ret;
 
 
 }
 
 /** @brief Fonction d'exécution de la commande "unset".
  * @param cmd Pointeur vers la structure de commande à exécuter.
- * @return int 0 en cas de succès, -1 en cas d'erreur.
- * @details Supprime une variable d'environnement de l'environnement du shell. En cas d'erreur (variable inexistante, etc.), un message d'erreur est affiché sur *cmd->stderr* et la fonction retourne un code d'erreur.
+ * @return int Code de retour de la commande : 0 en cas de succès, 1 en cas d'erreur.
+ * @details Supprime les variables (locales ou exportées) dont les noms sont passés en arguments. En cas d'erreur (nom invalide, etc.), un message d'erreur est affiché sur *cmd->stderr* et la fonction retourne un code d'erreur.
  */
 int builtin_unset(processus_t* cmd) {
     if (!cmd->argv[1]) {
         dprintf(cmd->stderr_fd, "unset: missing variable name\n");
-        return -1;
+        return 1;
     }
 
-    if (unsetenv(cmd->argv[1]) != 0) {
-        dprintf(cmd->stderr_fd, "unset: error removing variable\n");
-        return -1;
+    int ret = 0;
+    for (int i = 1; cmd->argv[i]; i++) {
+        if (env_unset(cmd->argv[i]) != 0) {
+            dprintf(cmd->stderr_fd, "unset: `%s': not a valid identifier\n", cmd->argv[i]);
+            ret = 1;
+        }
     }
 
-    return 0;
+    return ret;
 
 }
 
 /** @brief Fonction d'exécution de la commande "pwd".
  * @param cmd Pointeur vers la structure de commande à exécuter.
- * @return int 0 en cas de succès, -1 en cas d'erreur.
+ * @return int Code de retour de la commande : 0 en cas de succès, 1 en cas d'erreur.
  * @details Affiche le répertoire de travail actuel (CWD) du processus sur la sortie standard *cmd->stdout*. En cas d'erreur, un message d'erreur est affiché sur *cmd->stderr* et la fonction retourne un code d'erreur.
  */
 int builtin_pwd(processus_t* cmd) {
@@ -175,10 +230,770 @@ int builtin_pwd(processus_t* cmd) {
 
     if (!getcwd(buffer, sizeof(buffer))) {
         dprintf(cmd->stderr_fd, "pwd: error retrieving path\n");
-        return -1;
+        return 1;
     }
 
     dprintf(cmd->stdout_fd, "%s\n", buffer);
     return 0;
 
 }
+
+/** @brief Fonction d'exécution de la commande "hash".
+ * @param cmd Pointeur vers la structure de commande à exécuter.
+ * @return int Code de retour de la commande : 0 en cas de succès, 1 en cas d'erreur.
+ * @details Sans argument, affiche le contenu du cache des chemins de commandes sur *cmd->stdout*.
+ *  Avec l'option -r, vide le cache. Avec des noms de commandes, les résout et les mémorise (préchargement) ;
+ *  un message d'erreur est affiché sur *cmd->stderr* pour chaque commande introuvable.
+ */
+int builtin_hash(processus_t* cmd) {
+    if (!cmd->argv[1]) {
+        if (path_cache_print(cmd->stdout_fd) == 0)
+            dprintf(cmd->stdout_fd, "hash: hash table empty\n");
+        return 0;
+    }
+
+    int ret = 0;
+    for (int i = 1; cmd->argv[i]; i++) {
+        if (strcmp(cmd->argv[i], "-r") == 0) {
+            path_cache_clear();
+            continue;
+        }
+        if (!path_resolve(cmd->argv[i])) {
+            dprintf(cmd->stderr_fd, "hash: %s: not found\n", cmd->argv[i]);
+            ret = 1;
+        }
+    }
+    return ret;
+}
+
+/** @brief Fonction d'exécution de la commande "plancache".
+ * @param cmd Pointeur vers la structure de commande à exécuter.
+ * @return int Code de retour de la commande : 0 en cas de succès, 1 en cas d'erreur.
+ * @details Sans argument, affiche sur *cmd->stdout* les compteurs du cache des plans de lignes de commande (succès, échecs, remplacements)
+ *  et les lignes en cache avec leur nombre d'utilisations. Avec l'option -r, vide le cache et remet les compteurs à zéro.
+ */
+int builtin_plancache(processus_t* cmd) {
+    if (!cmd->argv[1]) {
+        plan_cache_print(cmd->stdout_fd);
+        return 0;
+    }
+    if (strcmp(cmd->argv[1], "-r") == 0 && !cmd->argv[2]) {
+        plan_cache_clear();
+        return 0;
+    }
+    dprintf(cmd->stderr_fd, "plancache: usage: plancache [-r]\n");
+    return 1;
+}
+
+/** @brief Fonction d'exécution de la commande "jobs".
+ * @param cmd Pointeur vers la structure de commande à exécuter.
+ * @return int Code de retour de la commande : 0 en cas de succès, 1 en cas d'erreur.
+ * @details Affiche sur *cmd->stdout* les jobs de la table avec leur état. L'option -l ajoute le PID du premier étage, l'option -p n'affiche que les PID.
+ */
+int builtin_jobs(processus_t* cmd) {
+    int with_pids = 0, only_pids = 0;
+
+    for (int i = 1; cmd->argv[i]; i++) {
+        if (strcmp(cmd->argv[i], "-l") == 0) {
+            with_pids = 1;
+        } else if (strcmp(cmd->argv[i], "-p") == 0) {
+            only_pids = 1;
+        } else {
+            dprintf(cmd->stderr_fd, "jobs: %s: invalid option\n", cmd->argv[i]);
+            return 1;
+        }
+    }
+
+    for (size_t j = 0; j < job_count(); j++) {
+        job_t* job = job_at(j);
+        if (only_pids)
+            dprintf(cmd->stdout_fd, "%d\n", (int)job->procs[0].pid);
+        else
+            job_print(job, cmd->stdout_fd, with_pids);
+        job->notified = 1;
+    }
+    return 0;
+}
+
+/** @brief Fonction d'exécution de la commande "wait".
+ * @param cmd Pointeur vers la structure de commande à exécuter.
+ * @return int Code de retour du dernier job attendu, 1 si un job désigné n'existe pas.
+ * @details Sans argument, attend la fin de tous les jobs en cours d'exécution. Sinon, attend chacun des jobs désignés ("%n", "n" ou un PID).
+ *  La commande échoue si un job désigné n'existe pas ou si le dernier job attendu s'est terminé en échec.
+ */
+int builtin_wait(processus_t* cmd) {
+    int status = 0;
+
+    if (!cmd->argv[1]) {
+        for (size_t j = 0; j < job_count(); j++) {
+            job_t* job = job_at(j);
+            if (job->state == JOB_RUNNING) job_wait(job);
+        }
+        return 0;
+    }
+
+    for (int i = 1; cmd->argv[i]; i++) {
+        job_t* job = (cmd->argv[i][0] == '%') ? job_find(cmd->argv[i]) : job_find_pid(atoi(cmd->argv[i]));
+        if (!job && cmd->argv[i][0] != '%') job = job_find(cmd->argv[i]);
+        if (!job) {
+            dprintf(cmd->stderr_fd, "wait: %s: no such job\n", cmd->argv[i]);
+            return 1;
+        }
+        status = job_wait(job);
+        if (job->state == JOB_DONE) {
+            job->notified = 1;
+            job_remove(job);
+        }
+    }
+    return status;
+}
+
+/** @brief Fonction de recherche du job désigné par le premier argument d'une commande.
+ * @param cmd Pointeur vers la structure de commande.
+ * @param name Nom de la commande, pour les messages d'erreur.
+ * @return job_t* Pointeur vers le job, NULL (avec un message sur *cmd->stderr*) s'il n'existe pas.
+ */
+static job_t* job_argument(processus_t* cmd, const char* name) {
+    job_t* job = job_find(cmd->argv[1]);
+    if (!job) {
+        dprintf(cmd->stderr_fd, "%s: %s: no such job\n", name, cmd->argv[1] ? cmd->argv[1] : "current");
+    }
+    return job;
+}
+
+/** @brief Fonction d'exécution de la commande "fg".
+ * @param cmd Pointeur vers la structure de commande à exécuter.
+ * @return int Code de retour du job, 1 s'il n'existe pas.
+ * @details Passe au premier plan le job désigné (le job courant par défaut) : il reçoit le terminal et SIGCONT, puis le shell attend
+ *  sa terminaison ou sa suspension. La commande échoue si le job n'existe pas ou se termine en échec.
+ */
+int builtin_fg(processus_t* cmd) {
+    job_t* job = job_argument(cmd, "fg");
+    if (!job) return 1;
+
+    dprintf(cmd->stdout_fd, "%s\n", job->command);
+    job_give_terminal(job->pgid);
+    if (job->state == JOB_STOPPED) {
+        if (job->pgid > 0) {
+            kill(-job->pgid, SIGCONT);
+        } else {
+            for (size_t i = 0; i < job->num_procs; i++) kill(job->procs[i].pid, SIGCONT);
+        }
+        for (size_t i = 0; i < job->num_procs; i++) {
+            if (job->proc_states[i] == JOB_STOPPED) job->proc_states[i] = JOB_RUNNING;
+        }
+        job->state = JOB_RUNNING;
+    }
+
+    int status = job_wait(job);
+    job_take_terminal();
+
+    if (job->state == JOB_STOPPED) {
+        fputc('\n', stderr);
+        job_print(job, STDERR_FILENO, 0);
+        job->notified = 1;
+    } else {
+        job_remove(job);
+    }
+    return status;
+}
+
+/** @brief Fonction d'exécution de la commande "bg".
+ * @param cmd Pointeur vers la structure de commande à exécuter.
+ * @return int Code de retour de la commande : 0 en cas de succès, 1 en cas d'erreur.
+ * @details Relance en arrière-plan (SIGCONT) le job suspendu désigné (le job courant par défaut).
+ */
+int builtin_bg(processus_t* cmd) {
+    job_t* job = job_argument(cmd, "bg");
+    if (!job) return 1;
+
+    if (job->state != JOB_STOPPED) {
+        dprintf(cmd->stderr_fd, "bg: job %d already in background\n", job->id);
+        return 0;
+    }
+
+    job_block_sigchld();
+    for (size_t i = 0; i < job->num_procs; i++) {
+        if (job->proc_states[i] == JOB_STOPPED) job->proc_states[i] = JOB_RUNNING;
+    }
+    job->state = JOB_RUNNING;
+    job_unblock_sigchld();
+
+    if (job->pgid > 0) {
+        kill(-job->pgid, SIGCONT);
+    } else {
+        for (size_t i = 0; i < job->num_procs; i++) kill(job->procs[i].pid, SIGCONT);
+    }
+    dprintf(cmd->stdout_fd, "[%d] %s &\n", job->id, job->command);
+    return 0;
+}
+
+/**
+ * @brief Structure représentant le tampon de sortie d'une commande intégrée.
+ * @struct out_t
+ * @details Les écritures sont regroupées en appels *write()* de BUILTIN_OUT_SIZE octets au plus.
+ */
+typedef struct {
+    int fd;                       ///< Descripteur de sortie
+    int err;                      ///< errno de la première écriture en échec (0 si aucune)
+    size_t len;                   ///< Nombre d'octets en attente
+    char buf[BUILTIN_OUT_SIZE];   ///< Octets en attente
+} out_t;
+
+/** @brief Écriture des octets en attente. */
+static void out_flush(out_t* out) {
+    size_t done = 0;
+    while (done < out->len && !out->err) {
+        ssize_t n = write(out->fd, out->buf + done, out->len - done);
+        if (n < 0) {
+            if (errno != EINTR) out->err = errno;
+            continue;
+        }
+        done += n;
+    }
+    out->len = 0;
+}
+
+/** @brief Ajout de *len* octets dans le tampon de sortie. */
+static void out_write(out_t* out, const char* data, size_t len) {
+    if (out->err) return;
+    if (out->len + len > sizeof(out->buf)) {
+        out_flush(out);
+        if (len > sizeof(out->buf)) {
+            /* bloc plus grand que le tampon : écrit directement */
+            while (len > 0 && !out->err) {
+                ssize_t n = write(out->fd, data, len);
+                if (n < 0) {
+                    if (errno != EINTR) out->err = errno;
+                    continue;
+                }
+                data += n;
+                len -= n;
+            }
+            return;
+        }
+    }
+    memcpy(out->buf + out->len, data, len);
+    out->len += len;
+}
+
+/** @brief Ajout d'un caractère dans le tampon de sortie. */
+static void out_putc(out_t* out, char c) {
+    if (out->len == sizeof(out->buf)) out_flush(out);
+    out->buf[out->len++] = c;
+}
+
+/** @brief Vidage final du tampon de sortie.
+ * @return int 0 si toutes les écritures ont réussi, 1 sinon (message sur *cmd->stderr*).
+ */
+static int out_close(out_t* out, processus_t* cmd) {
+    out_flush(out);
+    if (!out->err) return 0;
+    dprintf(cmd->stderr_fd, "%s: write error: %s\n", cmd->argv[0], strerror(out->err));
+    return 1;
+}
+
+/** @brief Valeur d'un chiffre hexadécimal, -1 si *c* n'en est pas un. */
+static int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+/** @brief Interprétation d'une séquence d'échappement.
+ * @param s Chaîne pointant sur le caractère qui suit le '\'.
+ * @param out Tampon de sortie.
+ * @param echo_octal 1 pour la forme \\0nnn (echo -e, %b de printf), 0 pour la forme \\nnn (format de printf).
+ * @return int Nombre de caractères consommés après le '\', -1 pour \\c (fin de la sortie).
+ */
+static int put_escape(const char* s, out_t* out, int echo_octal) {
+    switch (*s) {
+    case 'a': out_putc(out, '\a'); return 1;
+    case 'b': out_putc(out, '\b'); return 1;
+    case 'e': out_putc(out, '\033'); return 1;
+    case 'f': out_putc(out, '\f'); return 1;
+    case 'n': out_putc(out, '\n'); return 1;
+    case 'r': out_putc(out, '\r'); return 1;
+    case 't': out_putc(out, '\t'); return 1;
+    case 'v': out_putc(out, '\v'); return 1;
+    case '\\': out_putc(out, '\\'); return 1;
+    case 'c': return -1;
+    case 'x': {
+        int n = 1, value = 0;
+        while (n < 3 && hex_value(s[n]) >= 0) value = value * 16 + hex_value(s[n++]);
+        if (n == 1) { out_putc(out, '\\'); return 0; }
+        out_putc(out, (char)value);
+        return n;
+    }
+    default:
+        break;
+    }
+
+    if (*s >= '0' && *s <= '7') {
+        int n = (echo_octal && *s == '0') ? 1 : 0, start = n, value = 0;
+        while (n < start + 3 && s[n] >= '0' && s[n] <= '7') value = value * 8 + (s[n++] - '0');
+        out_putc(out, (char)value);
+        return n;
+    }
+    /* séquence inconnue : conservée telle quelle */
+    out_putc(out, '\\');
+    return 0;
+}
+
+/** @brief Affichage d'une chaîne en interprétant ses séquences d'échappement (forme de echo -e).
+ * @return int 0, ou -1 si la séquence \\c a été rencontrée.
+ */
+static int put_escaped(const char* s, out_t* out) {
+    for (; *s; ++s) {
+        if (*s != '\\' || !s[1]) {
+            out_putc(out, *s);
+            continue;
+        }
+        int n = put_escape(s + 1, out, 1);
+        if (n < 0) return -1;
+        s += n;
+    }
+    return 0;
+}
+
+/** @brief Fonction d'exécution de la commande "echo".
+ * @param cmd Pointeur vers la structure de commande à exécuter.
+ * @return int Code de retour de la commande : 0 en cas de succès, 1 en cas d'erreur d'écriture.
+ * @details Affiche les arguments séparés par des espaces sur *cmd->stdout*, suivis d'un saut de ligne.
+ *  Options : -n supprime le saut de ligne final, -e interprète les séquences d'échappement (\n, \t, \0nnn, \xHH, \c...), -E les désactive.
+ */
+int builtin_echo(processus_t* cmd) {
+    out_t out = { .fd = cmd->stdout_fd };
+    int newline = 1, escapes = 0, i = 1;
+
+    /* options regroupables (-ne), un argument contenant un autre caractère est affiché */
+    for (; cmd->argv[i] && cmd->argv[i][0] == '-' && cmd->argv[i][1]; ++i) {
+        const char* opt = cmd->argv[i] + 1;
+        if (opt[strspn(opt, "neE")] != '\0') break;
+        for (; *opt; ++opt) {
+            if (*opt == 'n') newline = 0;
+            else escapes = (*opt == 'e');
+        }
+    }
+
+    for (int first = i; cmd->argv[i]; ++i) {
+        if (i > first) out_putc(&out, ' ');
+        if (!escapes) {
+            out_write(&out, cmd->argv[i], strlen(cmd->argv[i]));
+        } else if (put_escaped(cmd->argv[i], &out) < 0) {
+            newline = 0;
+            break;
+        }
+    }
+    if (newline) out_putc(&out, '\n');
+    return out_close(&out, cmd);
+}
+
+/** @brief Conversion d'un argument numérique de printf.
+ * @details Un argument commençant par une apostrophe ou un guillemet vaut le code de son caractère suivant.
+ *    Un argument invalide affiche un message et positionne *err*.
+ */
+static long long printf_integer(processus_t* cmd, const char* arg, int* err) {
+    if (!arg) return 0;
+    if (arg[0] == '\'' || arg[0] == '"') return (unsigned char)arg[1];
+
+    char* end;
+    errno = 0;
+    long long value = strtoll(arg, &end, 0);
+    if (errno == ERANGE) {
+        /* valeurs non signées au-delà de LLONG_MAX (%u, %x) */
+        errno = 0;
+        value = (long long)strtoull(arg, &end, 0);
+    }
+    if (end == arg || *end || errno) {
+        dprintf(cmd->stderr_fd, "printf: %s: invalid number\n", arg);
+        *err = 1;
+    }
+    return value;
+}
+
+/** @brief Conversion d'un argument flottant de printf. */
+static double printf_double(processus_t* cmd, const char* arg, int* err) {
+    if (!arg) return 0;
+    if (arg[0] == '\'' || arg[0] == '"') return (unsigned char)arg[1];
+
+    char* end;
+    double value = strtod(arg, &end);
+    if (end == arg || *end) {
+        dprintf(cmd->stderr_fd, "printf: %s: invalid number\n", arg);
+        *err = 1;
+    }
+    return value;
+}
+
+/** @brief Affichage formaté d'une conversion de printf dans le tampon de sortie. */
+static void printf_convert(out_t* out, const char* spec, ...) {
+    char small[256];
+    va_list ap;
+
+    va_start(ap, spec);
+    int n = vsnprintf(small, sizeof(small), spec, ap);
+    va_end(ap);
+    if (n < 0) return;
+    if ((size_t)n < sizeof(small)) {
+        out_write(out, small, n);
+        return;
+    }
+
+    /* conversion plus longue que le tampon local (largeur ou chaîne importante) */
+    char* big = malloc(n + 1);
+    if (!big) return;
+    va_start(ap, spec);
+    vsnprintf(big, n + 1, spec, ap);
+    va_end(ap);
+    out_write(out, big, n);
+    free(big);
+}
+
+/** @brief Fonction d'exécution de la commande "printf".
+ * @param cmd Pointeur vers la structure de commande à exécuter.
+ * @return int Code de retour de la commande : 0 en cas de succès, 1 si un argument numérique est invalide ou en cas d'erreur d'écriture, 2 sans format.
+ * @details Affiche les arguments sur *cmd->stdout* selon le format du premier argument (conversions d, i, o, u, x, X, c, s, b, e, f, g et %%,
+ *  avec flags, largeur et précision, éventuellement "*"). Le format est réutilisé tant qu'il reste des arguments.
+ */
+int builtin_printf(processus_t* cmd) {
+    if (!cmd->argv[1]) {
+        dprintf(cmd->stderr_fd, "printf: usage: printf format [arguments]\n");
+        return 2;
+    }
+
+    out_t out = { .fd = cmd->stdout_fd };
+    const char* format = cmd->argv[1];
+    char** args = cmd->argv + 2;
+    int err = 0, stop = 0;
+
+    do {
+        char** pass = args;
+        for (const char* f = format; *f && !stop; ++f) {
+            if (*f == '\\') {
+                int n = f[1] ? put_escape(f + 1, &out, 0) : 0;
+                if (n < 0) stop = 1;
+                else if (f[1]) f += n;
+                else out_putc(&out, '\\');
+                continue;
+            }
+            if (*f != '%') {
+                out_putc(&out, *f);
+                continue;
+            }
+            if (f[1] == '%') {
+                out_putc(&out, '%');
+                ++f;
+                continue;
+            }
+
+            /* spécification : %[flags][largeur][.précision]conversion, les '*' prennent leur valeur dans les arguments */
+            char spec[64];
+            size_t len = 0;
+            spec[len++] = '%';
+            ++f;
+            while (*f && strchr("-+ #0", *f) && len < 8) spec[len++] = *f++;
+            for (int part = 0; part < 2; ++part) {
+                if (part == 1) {
+                    if (*f != '.') break;
+                    spec[len++] = *f++;
+                }
+                if (*f == '*') {
+                    int value = (int)printf_integer(cmd, *args, &err);
+                    if (*args) ++args;
+                    len += snprintf(spec + len, 16, "%d", value);
+                    ++f;
+                } else {
+                    while (isdigit((unsigned char)*f) && len < 40) spec[len++] = *f++;
+                }
+            }
+
+            const char* arg = *args;
+            char conv = *f;
+            if (conv && strchr("diouxXcsbeEfFgGaA", conv) && arg) ++args;
+            switch (conv) {
+            case 'd': case 'i':
+                spec[len++] = 'l'; spec[len++] = 'l'; spec[len++] = conv; spec[len] = '\0';
+                printf_convert(&out, spec, printf_integer(cmd, arg, &err));
+                break;
+            case 'o': case 'u': case 'x': case 'X':
+                spec[len++] = 'l'; spec[len++] = 'l'; spec[len++] = conv; spec[len] = '\0';
+                printf_convert(&out, spec, (unsigned long long)printf_integer(cmd, arg, &err));
+                break;
+            case 'e': case 'E': case 'f': case 'F': case 'g': case 'G': case 'a': case 'A':
+                spec[len++] = conv; spec[len] = '\0';
+                printf_convert(&out, spec, printf_double(cmd, arg, &err));
+                break;
+            case 'c':
+                spec[len++] = 'c'; spec[len] = '\0';
+                if (arg && *arg) printf_convert(&out, spec, arg[0]);
+                break;
+            case 's':
+                spec[len++] = 's'; spec[len] = '\0';
+                printf_convert(&out, spec, arg ? arg : "");
+                break;
+            case 'b':
+                if (arg && put_escaped(arg, &out) < 0) stop = 1;
+                break;
+            default:
+                dprintf(cmd->stderr_fd, "printf: %%%c: invalid format character\n", conv ? conv : ' ');
+                out_close(&out, cmd);
+                return 1;
+            }
+        }
+        /* le format est réutilisé pour les arguments restants, s'il en consomme */
+        if (args == pass) break;
+    } while (*args && !stop);
+
+    return out_close(&out, cmd) ? 1 : err;
+}
+
+/** @brief Fonction d'exécution de la commande "true".
+ * @param cmd Pointeur vers la structure de commande à exécuter.
+ * @return int 0.
+ */
+int builtin_true(processus_t* cmd) {
+    (void) cmd;
+    return 0;
+}
+
+/** @brief Fonction d'exécution de la commande "false".
+ * @param cmd Pointeur vers la structure de commande à exécuter.
+ * @return int 1.
+ */
+int builtin_false(processus_t* cmd) {
+    (void) cmd;
+    return 1;
+}
+
+/** @brief Fonction d'exécution des commandes "break" et "continue" hors d'une boucle.
+ * @param cmd Pointeur vers la structure de commande à exécuter (*path* : nom de la commande).
+ * @return int 0, ou 1 si le nombre de boucles n'est pas un entier positif.
+ * @details Dans une boucle, "break [n]" et "continue [n]" sont compilés en sauts (voir plan.h) : cette fonction n'est appelée
+ *  qu'en dehors d'une boucle (message affiché, sans effet) ou pour un argument invalide.
+ */
+int builtin_break(processus_t* cmd) {
+    const char* arg = cmd->argv[1];
+    char* end = NULL;
+    if (arg && (arg[0] < '0' || arg[0] > '9' || strtoul(arg, &end, 10) == 0 || *end)) {
+        dprintf(cmd->stderr_fd, "%s: %s: loop count out of range\n", cmd->path, arg);
+        return 1;
+    }
+    dprintf(cmd->stderr_fd, "%s: only meaningful in a `for', `while', or `until' loop\n", cmd->path);
+    return 0;
+}
+
+/**
+ * @brief Structure représentant l'état de l'évaluation d'une expression de test.
+ * @struct test_t
+ */
+typedef struct {
+    processus_t* cmd;  ///< Commande (messages d'erreur)
+    char** argv;       ///< Arguments de l'expression
+    int argc;          ///< Nombre d'arguments
+    int pos;           ///< Position courante
+    int err;           ///< Erreur de syntaxe rencontrée
+} test_t;
+
+/** @brief Erreur de syntaxe d'une expression de test. */
+static int test_error(test_t* t, const char* what, const char* arg) {
+    if (!t->err) dprintf(t->cmd->stderr_fd, "%s: %s%s%s\n", t->cmd->argv[0], arg ? arg : "", arg ? ": " : "", what);
+    t->err = 1;
+    return 0;
+}
+
+/** @brief Conversion d'un opérande entier d'une comparaison (espaces autorisés autour du nombre). */
+static long long test_integer(test_t* t, const char* arg) {
+    char* end;
+    errno = 0;
+    long long value = strtoll(arg, &end, 10);
+    while (isspace((unsigned char)*end)) ++end;
+    if (end == arg || *end || errno) test_error(t, "integer expression expected", arg);
+    return value;
+}
+
+/** @brief Le mot est un opérateur binaire de test. */
+static int test_is_binary(const char* op) {
+    static const char* ops[] = { "=", "==", "!=", "<", ">", "-eq", "-ne", "-lt", "-le", "-gt", "-ge", "-nt", "-ot", "-ef", NULL };
+    for (int i = 0; ops[i]; ++i)
+        if (strcmp(op, ops[i]) == 0) return 1;
+    return 0;
+}
+
+/** @brief Le mot est un opérateur unaire de test. */
+static int test_is_unary(const char* op) {
+    return op[0] == '-' && op[1] && !op[2] && strchr("bcdefghknprsStuwxzLO", op[1]);
+}
+
+/** @brief Évaluation d'un opérateur unaire. */
+static int test_unary(test_t* t, char op, const char* arg) {
+    struct stat st;
+    switch (op) {
+    case 'n': return arg[0] != '\0';
+    case 'z': return arg[0] == '\0';
+    case 't': return isatty((int)test_integer(t, arg));
+    case 'r': return access(arg, R_OK) == 0;
+    case 'w': return access(arg, W_OK) == 0;
+    case 'x': return access(arg, X_OK) == 0;
+    case 'h': case 'L': return lstat(arg, &st) == 0 && S_ISLNK(st.st_mode);
+    default: break;
+    }
+    if (stat(arg, &st) != 0) return 0;
+    switch (op) {
+    case 'e': return 1;
+    case 'f': return S_ISREG(st.st_mode);
+    case 'd': return S_ISDIR(st.st_mode);
+    case 'b': return S_ISBLK(st.st_mode);
+    case 'c': return S_ISCHR(st.st_mode);
+    case 'p': return S_ISFIFO(st.st_mode);
+    case 'S': return S_ISSOCK(st.st_mode);
+    case 's': return st.st_size > 0;
+    case 'g': return (st.st_mode & S_ISGID) != 0;
+    case 'u': return (st.st_mode & S_ISUID) != 0;
+    case 'k': return (st.st_mode & S_ISVTX) != 0;
+    case 'O': return st.st_uid == geteuid();
+    default: return 0;
+    }
+}
+
+/** @brief Évaluation d'un opérateur binaire. */
+static int test_binary(test_t* t, const char* left, const char* op, const char* right) {
+    if (strcmp(op, "=") == 0 || strcmp(op, "==") == 0) return strcmp(left, right) == 0;
+    if (strcmp(op, "!=") == 0) return strcmp(left, right) != 0;
+    if (strcmp(op, "<") == 0) return strcmp(left, right) < 0;
+    if (strcmp(op, ">") == 0) return strcmp(left, right) > 0;
+
+    if (op[1] == 'n' || op[1] == 'o' || (op[1] == 'e' && op[2] == 'f')) {
+        struct stat a, b;
+        int has_a = stat(left, &a) == 0, has_b = stat(right, &b) == 0;
+        if (op[1] == 'e') return has_a && has_b && a.st_dev == b.st_dev && a.st_ino == b.st_ino;
+        if (op[1] == 'n') return has_a && (!has_b || a.st_mtim.tv_sec > b.st_mtim.tv_sec
+                                          || (a.st_mtim.tv_sec == b.st_mtim.tv_sec && a.st_mtim.tv_nsec > b.st_mtim.tv_nsec));
+        return has_b && (!has_a || a.st_mtim.tv_sec < b.st_mtim.tv_sec
+                         || (a.st_mtim.tv_sec == b.st_mtim.tv_sec && a.st_mtim.tv_nsec < b.st_mtim.tv_nsec));
+    }
+
+    long long l = test_integer(t, left), r = test_integer(t, right);
+    if (strcmp(op, "-eq") == 0) return l == r;
+    if (strcmp(op, "-ne") == 0) return l != r;
+    if (strcmp(op, "-lt") == 0) return l < r;
+    if (strcmp(op, "-le") == 0) return l <= r;
+    if (strcmp(op, "-gt") == 0) return l > r;
+    return l >= r;
+}
+
+static int test_or(test_t* t);
+
+/** @brief primaire : "(" expression ")", opérande opérateur opérande, opérateur unaire opérande, ou chaîne seule. */
+static int test_primary(test_t* t) {
+    if (t->pos >= t->argc) return test_error(t, "argument expected", NULL);
+
+    char** a = t->argv + t->pos;
+    int left = t->argc - t->pos;
+    if (left >= 3 && test_is_binary(a[1])) {
+        t->pos += 3;
+        return test_binary(t, a[0], a[1], a[2]);
+    }
+    if (strcmp(a[0], "(") == 0 && left >= 2) {
+        t->pos++;
+        int r = test_or(t);
+        if (t->pos >= t->argc || strcmp(t->argv[t->pos], ")") != 0) return test_error(t, "`)' expected", NULL);
+        t->pos++;
+        return r;
+    }
+    if (left >= 2 && test_is_unary(a[0])) {
+        t->pos += 2;
+        return test_unary(t, a[0][1], a[1]);
+    }
+    t->pos++;
+    return a[0][0] != '\0';
+}
+
+/** @brief négation : "!" négation | primaire. */
+static int test_not(test_t* t) {
+    if (t->pos < t->argc - 1 && strcmp(t->argv[t->pos], "!") == 0) {
+        t->pos++;
+        return !test_not(t);
+    }
+    return test_primary(t);
+}
+
+/** @brief conjonction : négation ("-a" négation)*. */
+static int test_and(test_t* t) {
+    int r = test_not(t);
+    while (t->pos < t->argc && strcmp(t->argv[t->pos], "-a") == 0) {
+        t->pos++;
+        r = test_not(t) && r;
+    }
+    return r;
+}
+
+/** @brief disjonction : conjonction ("-o" conjonction)*. */
+static int test_or(test_t* t) {
+    int r = test_and(t);
+    while (t->pos < t->argc && strcmp(t->argv[t->pos], "-o") == 0) {
+        t->pos++;
+        r = test_and(t) || r;
+    }
+    return r;
+}
+
+/** @brief Fonction d'exécution des commandes "test" et "[".
+ * @param cmd Pointeur vers la structure de commande à exécuter.
+ * @return int 0 si l'expression est vraie, 1 si elle est fausse, 2 en cas d'erreur de syntaxe.
+ * @details Évalue l'expression formée par les arguments : tests de fichiers (-e, -f, -d, -r, -w, -x, -s, -L...), de chaînes (-n, -z, =, !=),
+ *  comparaisons entières (-eq, -ne, -lt, -le, -gt, -ge), négation (!), parenthèses et opérateurs -a et -o.
+ *  Sous la forme "[", le dernier argument doit être "]".
+ */
+int builtin_test(processus_t* cmd) {
+    test_t t = { cmd, cmd->argv + 1, 0, 0, 0 };
+    while (t.argv[t.argc]) t.argc++;
+
+    if (strcmp(cmd->argv[0], "[") == 0) {
+        if (t.argc == 0 || strcmp(t.argv[t.argc - 1], "]") != 0) {
+            dprintf(cmd->stderr_fd, "[: missing `]'\n");
+            return 2;
+        }
+        t.argc--;
+    }
+    if (t.argc == 0) return 1;
+
+    int r = test_or(&t);
+    if (!t.err && t.pos < t.argc) test_error(&t, "too many arguments", NULL);
+    return t.err ? 2 : !r;
+}
+
+/** @brief Fonction d'exécution de la commande "set".
+ * @param cmd Pointeur vers la structure de commande à exécuter.
+ * @return int Code de retour de la commande : 0 en cas de succès, 2 pour une option invalide.
+ * @details Seule l'option de l'ordonnanceur parallèle est reconnue (voir scheduler.h) : "set -j N" exécute les listes indépendantes
+ *  au plus N à la fois, "set +j" revient à l'exécution dans l'ordre. Sans argument, affiche le réglage courant sur *cmd->stdout*.
+ *  Le réglage s'applique à partir de la ligne suivante ; la commande étant une barrière, les jobs en cours sont terminés avant elle.
+ */
+int builtin_set(processus_t* cmd) {
+    if (!cmd->argv[1]) {
+        if (sched_limit()) dprintf(cmd->stdout_fd, "set -j %u\n", sched_limit());
+        else dprintf(cmd->stdout_fd, "set +j\n");
+        return 0;
+    }
+
+    if (strcmp(cmd->argv[1], "+j") == 0 && !cmd->argv[2]) {
+        sched_set_limit(0);
+        return 0;
+    }
+    if (strncmp(cmd->argv[1], "-j", 2) == 0) {
+        const char* arg = cmd->argv[1][2] ? cmd->argv[1] + 2 : cmd->argv[2];
+        char* end = NULL;
+        long n = (arg && *arg >= '0' && *arg <= '9') ? strtol(arg, &end, 10) : -1;
+        int extra = cmd->argv[1][2] ? cmd->argv[2] != NULL : (cmd->argv[2] && cmd->argv[3]);
+        if (n >= 1 && n <= SCHED_MAX_JOBS && !*end && !extra) {
+            sched_set_limit((unsigned)n);
+            return 0;
+        }
+        dprintf(cmd->stderr_fd, "set: -j: expected a number of jobs between 1 and %d\n", SCHED_MAX_JOBS);
+        return 2;
+    }
+    dprintf(cmd->stderr_fd, "set: usage: set [-j jobs | +j]\n");
+    return 2;
+}
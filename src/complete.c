@@ -0,0 +1,325 @@
+/** @file complete.c
+ * @brief Implementation of tab completion
+ * @author Nom1
+ * @author Nom2
+ * @date 2025-26
+ * @details Implémentation de la complétion et de l'index des exécutables du PATH. Les répertoires sont lus avec *getdents64()*
+ *   par blocs de DIRENT_BUFFER_SIZE octets : le type de chaque entrée est donné par le noyau, et *fstatat()* n'est appelé que
+ *   lorsqu'il est inconnu ou qu'il s'agit d'un lien symbolique.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "complete.h"
+#include "builtins.h"
+#include "env.h"
+
+/// PATH utilisé lorsque la variable n'est pas définie (même valeur que pour la résolution des commandes)
+#define DEFAULT_PATH "/bin:/usr/bin"
+/// Taille du tampon de lecture des répertoires
+#define DIRENT_BUFFER_SIZE 32768
+/// Caractères terminant un mot
+#define WORD_DELIMITERS " \t|&;<>()"
+/// Caractères échappés dans un candidat inséré
+#define SPECIAL_CHARS " \t|&;<>()\\'\"$*?[]#~`!{}"
+
+/**
+ * @brief Structure représentant un répertoire du PATH dans l'index.
+ * @struct path_dir_t
+ */
+typedef struct {
+    char* path;             ///< Chemin du répertoire
+    int scanned;            ///< Le répertoire a été parcouru (ou trouvé absent)
+    dev_t dev;              ///< Périphérique au dernier parcours
+    ino_t ino;              ///< Inœud au dernier parcours
+    struct timespec mtime;  ///< Date de modification au dernier parcours
+    char* names;            ///< Noms des exécutables, chacun terminé par '\0'
+    size_t len;             ///< Octets utilisés dans *names*
+    size_t cap;             ///< Capacité de *names*
+} path_dir_t;
+
+static path_dir_t* dirs = NULL;  ///< Répertoires du PATH, dans l'ordre
+static size_t num_dirs = 0;      ///< Nombre de répertoires
+static int dirs_ready = 0;       ///< PATH découpé en répertoires
+static char** exec_index = NULL; ///< Noms des exécutables, triés et sans doublon (pointeurs dans les *names* des répertoires)
+static size_t exec_count = 0;    ///< Nombre de noms de l'index
+static int exec_dirty = 1;       ///< L'index doit être reconstruit
+
+/** @brief Ajout d'une chaîne de *len* octets (plus '\0') à un tampon de chaînes. */
+static int strings_append(char** data, size_t* used, size_t* cap, const char* s, size_t len) {
+    if (*used + len + 1 > *cap) {
+        size_t c = *cap ? *cap : 1024;
+        while (c < *used + len + 1) c *= 2;
+        char* d = realloc(*data, c);
+        if (!d) return -1;
+        *data = d;
+        *cap = c;
+    }
+    memcpy(*data + *used, s, len);
+    (*data)[*used + len] = '\0';
+    *used += len + 1;
+    return 0;
+}
+
+/** @brief Comparaison de deux chaînes pour *qsort()*. */
+static int compare_strings(const void* a, const void* b) {
+    return strcmp(*(char* const*)a, *(char* const*)b);
+}
+
+/** @brief Lecture d'un répertoire et appel de *fn* pour chaque entrée (hors "." et "..").
+ * @return int 0 en cas de succès, -1 si le répertoire ne peut pas être lu.
+ */
+static int scan_dir(const char* path, int (*fn)(int dirfd, const char* name, unsigned char type, void* arg), void* arg) {
+    int fd = open(path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) return -1;
+
+    static char buffer[DIRENT_BUFFER_SIZE];
+    ssize_t n;
+    while ((n = getdents64(fd, buffer, sizeof(buffer))) > 0) {
+        for (ssize_t off = 0; off < n;) {
+            const struct dirent64* d = (const struct dirent64*)(buffer + off);
+            off += d->d_reclen;
+            const char* name = d->d_name;
+            if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) continue;
+            if (fn(fd, name, d->d_type, arg) != 0) {
+                close(fd);
+                return -1;
+            }
+        }
+    }
+    close(fd);
+    return n < 0 ? -1 : 0;
+}
+
+/** @brief Ajout d'une entrée de répertoire du PATH à ses exécutables (fichiers réguliers exécutables). */
+static int add_executable(int dirfd, const char* name, unsigned char type, void* arg) {
+    path_dir_t* dir = arg;
+    if (type == DT_DIR) return 0;
+    if (type != DT_REG) {
+        struct stat st;
+        if (fstatat(dirfd, name, &st, 0) != 0 || !S_ISREG(st.st_mode)) return 0;
+    }
+    if (faccessat(dirfd, name, X_OK, 0) != 0) return 0;
+    return strings_append(&dir->names, &dir->len, &dir->cap, name, strlen(name));
+}
+
+/** @brief Découpage du PATH en répertoires (aucun n'est encore parcouru). */
+static int split_path(void) {
+    const char* path = env_get("PATH");
+    if (!path) path = DEFAULT_PATH;
+
+    size_t n = 1;
+    for (const char* p = path; *p; ++p) n += *p == ':';
+    dirs = calloc(n, sizeof(path_dir_t));
+    if (!dirs) return -1;
+
+    const char* dir = path;
+    for (num_dirs = 0; num_dirs < n; ++num_dirs) {
+        const char* end = strchrnul(dir, ':');
+        /* un élément vide désigne le répertoire courant */
+        dirs[num_dirs].path = end == dir ? strdup(".") : strndup(dir, end - dir);
+        if (!dirs[num_dirs].path) return -1;
+        dir = *end ? end + 1 : end;
+    }
+    dirs_ready = 1;
+    exec_dirty = 1;
+    return 0;
+}
+
+/** @brief Mise à jour de l'index : seuls les répertoires dont la date de modification a changé sont parcourus à nouveau. */
+static int exec_index_refresh(void) {
+    if (!dirs_ready && split_path() != 0) {
+        complete_invalidate();
+        return -1;
+    }
+
+    for (size_t i = 0; i < num_dirs; ++i) {
+        path_dir_t* d = &dirs[i];
+        struct stat st;
+        int exists = stat(d->path, &st) == 0 && S_ISDIR(st.st_mode);
+        if (d->scanned && !exists && d->dev == 0 && d->ino == 0) continue;
+        if (d->scanned && exists && st.st_dev == d->dev && st.st_ino == d->ino
+            && st.st_mtim.tv_sec == d->mtime.tv_sec && st.st_mtim.tv_nsec == d->mtime.tv_nsec)
+            continue;
+
+        d->len = 0;
+        d->scanned = 1;
+        d->dev = exists ? st.st_dev : 0;
+        d->ino = exists ? st.st_ino : 0;
+        if (exists) {
+            d->mtime = st.st_mtim;
+            if (scan_dir(d->path, add_executable, d) != 0) d->len = 0;
+        }
+        exec_dirty = 1;
+    }
+    if (!exec_dirty) return 0;
+
+    size_t total = 0;
+    for (size_t i = 0; i < num_dirs; ++i)
+        for (size_t off = 0; off < dirs[i].len; off += strlen(dirs[i].names + off) + 1) total++;
+    char** names = realloc(exec_index, (total ? total : 1) * sizeof(char*));
+    if (!names) return -1;
+    exec_index = names;
+
+    exec_count = 0;
+    for (size_t i = 0; i < num_dirs; ++i)
+        for (size_t off = 0; off < dirs[i].len; off += strlen(dirs[i].names + off) + 1) exec_index[exec_count++] = dirs[i].names + off;
+    qsort(exec_index, exec_count, sizeof(char*), compare_strings);
+    size_t unique = 0;
+    for (size_t i = 0; i < exec_count; ++i)
+        if (unique == 0 || strcmp(exec_index[unique - 1], exec_index[i]) != 0) exec_index[unique++] = exec_index[i];
+    exec_count = unique;
+    exec_dirty = 0;
+    return 0;
+}
+
+void complete_invalidate(void) {
+    for (size_t i = 0; i < num_dirs; ++i) {
+        free(dirs[i].path);
+        free(dirs[i].names);
+    }
+    free(dirs);
+    free(exec_index);
+    dirs = NULL;
+    num_dirs = 0;
+    exec_index = NULL;
+    exec_count = 0;
+    dirs_ready = 0;
+    exec_dirty = 1;
+}
+
+/** @brief Ajout d'un candidat : *prefix* suivi de *name* échappé, puis *suffix*. */
+static int add_candidate(completion_t* c, const char* prefix, size_t prefix_len, const char* name, const char* suffix) {
+    char buf[4096];
+    size_t n = 0;
+    if (prefix_len >= sizeof(buf)) return 0;
+    memcpy(buf, prefix, prefix_len);
+    n = prefix_len;
+    for (; *name && n + 3 < sizeof(buf); ++name) {
+        if (strchr(SPECIAL_CHARS, *name)) buf[n++] = '\\';
+        buf[n++] = *name;
+    }
+    for (; *suffix && n + 1 < sizeof(buf); ++suffix) buf[n++] = *suffix;
+    return strings_append(&c->data, &c->len, &c->cap, buf, n);
+}
+
+/** @brief Tri des candidats et suppression des doublons. */
+static int finish(completion_t* c) {
+    size_t n = 0;
+    for (size_t off = 0; off < c->len; off += strlen(c->data + off) + 1) n++;
+    c->items = malloc((n ? n : 1) * sizeof(char*));
+    if (!c->items) return -1;
+    c->count = 0;
+    for (size_t off = 0; off < c->len; off += strlen(c->data + off) + 1) c->items[c->count++] = c->data + off;
+    qsort(c->items, c->count, sizeof(char*), compare_strings);
+    size_t unique = 0;
+    for (size_t i = 0; i < c->count; ++i)
+        if (unique == 0 || strcmp(c->items[unique - 1], c->items[i]) != 0) c->items[unique++] = c->items[i];
+    c->count = unique;
+    return (int)unique;
+}
+
+/**
+ * @brief Structure représentant une complétion de noms de fichiers en cours.
+ * @struct file_match_t
+ */
+typedef struct {
+    completion_t* out;   ///< Candidats
+    const char* prefix;  ///< Répertoire saisi (tel quel)
+    size_t prefix_len;   ///< Longueur du répertoire saisi
+    const char* base;    ///< Début du nom cherché
+    size_t base_len;     ///< Longueur du début du nom
+} file_match_t;
+
+/** @brief Ajout d'une entrée de répertoire commençant par le nom cherché (fichiers cachés seulement si le nom commence par '.'). */
+static int add_file(int dirfd, const char* name, unsigned char type, void* arg) {
+    file_match_t* m = arg;
+    if (strncmp(name, m->base, m->base_len) != 0) return 0;
+    if (name[0] == '.' && m->base_len == 0) return 0;
+
+    int is_dir = type == DT_DIR;
+    if (type == DT_LNK || type == DT_UNKNOWN) {
+        struct stat st;
+        is_dir = fstatat(dirfd, name, &st, 0) == 0 && S_ISDIR(st.st_mode);
+    }
+    return add_candidate(m->out, m->prefix, m->prefix_len, name, is_dir ? "/" : "");
+}
+
+int complete_word(const char* line, size_t pos, size_t* start, completion_t* out) {
+    /* début du mot : après le dernier séparateur non échappé */
+    size_t s = pos;
+    while (s > 0 && !(strchr(WORD_DELIMITERS, line[s - 1]) && !(s >= 2 && line[s - 2] == '\\'))) s--;
+    *start = s;
+
+    /* mot sans échappements ni guillemets */
+    char word[4096];
+    size_t wlen = 0;
+    for (size_t i = s; i < pos && wlen + 1 < sizeof(word); ++i) {
+        if (line[i] == '"' || line[i] == '\'') continue;
+        if (line[i] == '\\' && i + 1 < pos) ++i;
+        word[wlen++] = line[i];
+    }
+    word[wlen] = '\0';
+
+    /* position de commande : début de ligne ou après un opérateur de contrôle */
+    size_t p = s;
+    while (p > 0 && (line[p - 1] == ' ' || line[p - 1] == '\t')) p--;
+    int command = (p == 0 || strchr("|&;(", line[p - 1])) && !strchr(word, '/');
+
+    if (command) {
+        size_t n;
+        const builtin_t* b = builtin_list(&n);
+        for (size_t i = 0; i < n; ++i)
+            if (strncmp(b[i].name, word, wlen) == 0 && add_candidate(out, "", 0, b[i].name, "") != 0) return -1;
+
+        if (exec_index_refresh() == 0) {
+            /* premier nom de l'index commençant par le mot (recherche dichotomique) */
+            size_t lo = 0, hi = exec_count;
+            while (lo < hi) {
+                size_t mid = (lo + hi) / 2;
+                if (strcmp(exec_index[mid], word) < 0) lo = mid + 1;
+                else hi = mid;
+            }
+            for (; lo < exec_count && strncmp(exec_index[lo], word, wlen) == 0; ++lo)
+                if (add_candidate(out, "", 0, exec_index[lo], "") != 0) return -1;
+        }
+        out->display = 0;
+        return finish(out);
+    }
+
+    /* noms de fichiers : le répertoire saisi est conservé tel quel dans les candidats */
+    file_match_t m = { out, line + s, 0, word, wlen };
+    const char* raw_slash = NULL;
+    for (size_t i = s; i < pos; ++i)
+        if (line[i] == '/') raw_slash = line + i;
+    if (raw_slash) m.prefix_len = raw_slash + 1 - m.prefix;
+
+    char dir[4096] = ".";
+    char* slash = strrchr(word, '/');
+    if (slash) {
+        m.base = slash + 1;
+        m.base_len = wlen - (m.base - word);
+        const char* home = env_get("HOME");
+        if (word[0] == '~' && word[1] == '/' && home)
+            snprintf(dir, sizeof(dir), "%s%.*s", home, (int)(slash - word), word + 1);
+        else
+            snprintf(dir, sizeof(dir), "%.*s", (int)(slash - word + 1), word);
+    }
+    out->display = m.prefix_len;
+    /* un répertoire illisible ne donne aucun candidat */
+    scan_dir(dir, add_file, &m);
+    return finish(out);
+}
+
+void completion_free(completion_t* c) {
+    free(c->data);
+    free(c->items);
+    memset(c, 0, sizeof(*c));
+}
@@ -0,0 +1,282 @@
+/** @file env.c
+ * @brief Implementation of the shell variables table
+ * @author Nom1
+ * @author Nom2
+ * @date 2025-26
+ * @details Implémentation de la table de hachage des variables (adressage ouvert, sondage linéaire) et du cache de l'environnement exporté.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "env.h"
+#include "pathcache.h"
+#include "complete.h"
+
+/// Capacité initiale de la table (puissance de 2)
+#define ENV_INITIAL 256
+
+/**
+ * @brief Entrée de la table de hachage.
+ * @struct env_entry_t
+ * @details La variable est stockée en une seule chaîne "NOM=valeur" (ou "NOM" sans valeur), directement utilisable dans l'environnement exporté.
+ */
+typedef struct {
+    char* pair;        ///< "NOM=valeur" (NULL si l'emplacement est libre)
+    size_t name_len;   ///< Longueur du nom
+    uint8_t exported;  ///< Variable exportée vers les commandes lancées
+    uint8_t has_value; ///< La variable a une valeur
+} env_entry_t;
+
+static env_entry_t* table = NULL; ///< Tableau des entrées
+static size_t capacity = 0;       ///< Nombre d'emplacements (puissance de 2)
+static size_t count = 0;          ///< Nombre d'entrées occupées
+
+static char** envp_cache = NULL;  ///< Environnement exporté mis en cache
+static size_t envp_capacity = 0;  ///< Capacité de *envp_cache*
+static size_t envp_count = 0;     ///< Nombre de variables dans *envp_cache*
+static int envp_dirty = 1;        ///< Le cache doit être reconstruit
+
+/** @brief Hachage FNV-1a des *len* premiers octets de *name*.
+ * @details Le nom d'une variable n'est pas terminé par '\0' : il est suivi de '=' dans une affectation comme dans la chaîne *pair* d'une entrée.
+ */
+static uint64_t hash_name(const char* name, size_t len) {
+    uint64_t h = 1469598103934665603ULL;
+    for (size_t i = 0; i < len; ++i) {
+        h ^= (unsigned char)name[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+/** @brief Recherche de l'emplacement de la variable *name* de longueur *len* (sondage linéaire).
+ * @return size_t Rang de l'entrée dont *pair* commence par ce nom sur exactement *name_len* == *len* octets ("PATH" ne désigne pas "PATHX=..."),
+ *    ou du premier emplacement libre, où la variable sera créée.
+ */
+static size_t find_slot(const char* name, size_t len) {
+    size_t mask = capacity - 1;
+    size_t i = hash_name(name, len) & mask;
+    while (table[i].pair && (table[i].name_len != len || memcmp(table[i].pair, name, len) != 0))
+        i = (i + 1) & mask;
+    return i;
+}
+
+/** @brief Doublement de la table des variables, appelé dès qu'elle est à moitié pleine (ENV_INITIAL emplacements au départ).
+ * @details Les entrées sont replacées d'après le nom en tête de leur *pair* ; les chaînes "NOM=valeur" ne sont pas recopiées,
+ *    si bien que les pointeurs de *envp_cache* restent valables.
+ */
+static int grow(void) {
+    size_t old_capacity = capacity;
+    env_entry_t* old = table;
+
+    size_t new_capacity = capacity ? capacity * 2 : ENV_INITIAL;
+    env_entry_t* t = calloc(new_capacity, sizeof(env_entry_t));
+    if (!t) return -1;
+
+    table = t;
+    capacity = new_capacity;
+    for (size_t i = 0; i < old_capacity; ++i) {
+        if (old[i].pair) table[find_slot(old[i].pair, old[i].name_len)] = old[i];
+    }
+    free(old);
+    return 0;
+}
+
+/** @brief Recherche d'une entrée occupée. */
+static env_entry_t* lookup(const char* name, size_t len) {
+    if (!capacity) return NULL;
+    env_entry_t* e = &table[find_slot(name, len)];
+    return e->pair ? e : NULL;
+}
+
+/** @brief Modification (ou création) de la variable *name* de longueur *len*. */
+static int set_variable(const char* name, size_t len, const char* value, int flags) {
+    if (!env_valid_name(name, len)) return -1;
+    if (count * 2 >= capacity && grow() != 0) return -1;
+
+    size_t value_len = value ? strlen(value) : 0;
+    char* pair = malloc(len + (value ? value_len + 2 : 1));
+    if (!pair) return -1;
+    memcpy(pair, name, len);
+    if (value) {
+        pair[len] = '=';
+        memcpy(pair + len + 1, value, value_len + 1);
+    } else {
+        pair[len] = '\0';
+    }
+
+    env_entry_t* e = &table[find_slot(name, len)];
+    if (e->pair) {
+        /* "export NOM" sur une variable existante : la valeur est conservée */
+        if (!value && e->has_value) {
+            free(pair);
+        } else {
+            free(e->pair);
+            e->pair = pair;
+            e->has_value = value != NULL;
+        }
+    } else {
+        e->pair = pair;
+        e->name_len = len;
+        e->exported = 0;
+        e->has_value = value != NULL;
+        count++;
+    }
+    if (flags & ENV_EXPORT) e->exported = 1;
+    if (e->exported) envp_dirty = 1;
+
+    /* les chemins mémorisés et l'index de complétion ne sont plus valables */
+    if (len == 4 && memcmp(name, "PATH", 4) == 0) {
+        path_cache_clear();
+        complete_invalidate();
+    }
+    return 0;
+}
+
+int env_valid_name(const char* name, size_t len) {
+    if (!name || len == 0) return 0;
+    for (size_t i = 0; i < len; ++i) {
+        char c = name[i];
+        int alpha = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+        if (!alpha && (i == 0 || c < '0' || c > '9')) return 0;
+    }
+    return 1;
+}
+
+int env_init(char** envp) {
+    if (!envp) return 0;
+    for (size_t i = 0; envp[i]; ++i) {
+        const char* eq = strchr(envp[i], '=');
+        if (!eq) continue;
+        /* les entrées invalides (noms non conformes) sont ignorées */
+        set_variable(envp[i], eq - envp[i], eq + 1, ENV_EXPORT);
+    }
+    return 0;
+}
+
+const char* env_get(const char* name) {
+    if (!name) return NULL;
+    env_entry_t* e = lookup(name, strlen(name));
+    return (e && e->has_value) ? e->pair + e->name_len + 1 : NULL;
+}
+
+int env_set(const char* name, const char* value, int flags) {
+    if (!name) return -1;
+    return set_variable(name, strlen(name), value, flags);
+}
+
+int env_put(const char* assignment, int flags) {
+    if (!assignment) return -1;
+    const char* eq = strchr(assignment, '=');
+    if (!eq) return -1;
+    return set_variable(assignment, eq - assignment, eq + 1, flags);
+}
+
+int env_unset(const char* name) {
+    if (!name) return -1;
+    size_t len = strlen(name);
+    if (!env_valid_name(name, len)) return -1;
+    if (!capacity) return 0;
+
+    size_t mask = capacity - 1;
+    size_t i = find_slot(name, len);
+    if (!table[i].pair) return 0;
+
+    if (table[i].exported) envp_dirty = 1;
+    free(table[i].pair);
+    table[i].pair = NULL;
+    count--;
+
+    /* pas de marque de suppression : les variables qui suivent dans la grappe sont replacées d'après leur nom,
+     * pour qu'aucune ne reste derrière l'emplacement libéré, où find_slot() arrête sa recherche */
+    for (size_t j = (i + 1) & mask; table[j].pair; j = (j + 1) & mask) {
+        env_entry_t e = table[j];
+        table[j].pair = NULL;
+        table[find_slot(e.pair, e.name_len)] = e;
+    }
+
+    if (len == 4 && memcmp(name, "PATH", 4) == 0) {
+        path_cache_clear();
+        complete_invalidate();
+    }
+    return 0;
+}
+
+char** env_environ(void) {
+    if (!envp_dirty && envp_cache) return envp_cache;
+
+    if (envp_capacity < count + 1) {
+        size_t cap = envp_capacity ? envp_capacity : 64;
+        while (cap < count + 1) cap *= 2;
+        char** t = realloc(envp_cache, cap * sizeof(char*));
+        if (!t) return NULL;
+        envp_cache = t;
+        envp_capacity = cap;
+    }
+
+    size_t n = 0;
+    for (size_t i = 0; i < capacity; ++i) {
+        if (table[i].pair && table[i].exported && table[i].has_value)
+            envp_cache[n++] = table[i].pair;
+    }
+    envp_cache[n] = NULL;
+    envp_count = n;
+    envp_dirty = 0;
+    return envp_cache;
+}
+
+char** env_merge(arena_t* arena, char* const* overrides) {
+    char** base = env_environ();
+    if (!base || !arena) return NULL;
+
+    size_t num_overrides = 0;
+    while (overrides && overrides[num_overrides]) num_overrides++;
+
+    char** envp = arena_alloc(arena, (envp_count + num_overrides + 1) * sizeof(char*));
+    if (!envp) return NULL;
+
+    /* variables exportées non remplacées, puis affectations de la commande */
+    size_t n = 0;
+    for (size_t i = 0; i < envp_count; ++i) {
+        size_t len = strchrnul(base[i], '=') - base[i];
+        int replaced = 0;
+        for (size_t j = 0; j < num_overrides && !replaced; ++j)
+            replaced = strncmp(overrides[j], base[i], len + 1) == 0;
+        if (!replaced) envp[n++] = base[i];
+    }
+    for (size_t j = 0; j < num_overrides; ++j) envp[n++] = overrides[j];
+    envp[n] = NULL;
+    return envp;
+}
+
+/** @brief Comparaison de deux chaînes "NOM=valeur" par nom. */
+static int compare_pairs(const void* a, const void* b) {
+    return strcmp(*(char* const*)a, *(char* const*)b);
+}
+
+int env_print(int fd) {
+    size_t n = 0;
+    for (size_t i = 0; i < capacity; ++i)
+        if (table[i].pair && table[i].exported) n++;
+    if (n == 0) return 0;
+
+    char** pairs = malloc(n * sizeof(char*));
+    if (!pairs) return -1;
+    n = 0;
+    for (size_t i = 0; i < capacity; ++i)
+        if (table[i].pair && table[i].exported) pairs[n++] = table[i].pair;
+    qsort(pairs, n, sizeof(char*), compare_pairs);
+
+    for (size_t i = 0; i < n; ++i) {
+        const char* eq = strchr(pairs[i], '=');
+        if (eq)
+            dprintf(fd, "export %.*s=\"%s\"\n", (int)(eq - pairs[i]), pairs[i], eq + 1);
+        else
+            dprintf(fd, "export %s\n", pairs[i]);
+    }
+    free(pairs);
+    return (int)n;
+}
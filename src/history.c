@@ -0,0 +1,349 @@
+/** @file history.c
+ * @brief Implementation of the persistent command history
+ * @author Nom1
+ * @author Nom2
+ * @date 2025-26
+ * @details Implémentation de l'historique projeté en mémoire et de son index de filtres de Bloom.
+ *   Le fichier d'index commence par un en-tête identifiant l'historique indexé (inode, octets couverts et empreinte des derniers octets couverts),
+ *   suivi des blocs dans l'ordre du fichier. Les blocs ne sont ajoutés que complets : les lignes qui suivent le dernier bloc
+ *   (moins d'un bloc) sont parcourues directement lors des recherches.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "history.h"
+
+/// Signature du fichier d'index
+#define INDEX_MAGIC "MSHIDX01"
+/// Nombre d'octets de l'historique pris en compte dans l'empreinte de l'en-tête
+#define CHECK_BYTES 64
+
+/**
+ * @brief Structure représentant l'en-tête du fichier d'index.
+ * @struct index_header_t
+ */
+typedef struct {
+    char magic[8];          ///< INDEX_MAGIC
+    uint32_t block_size;    ///< HISTORY_BLOCK_SIZE à la création
+    uint32_t filter_bytes;  ///< HISTORY_FILTER_BYTES à la création
+    uint64_t ino;           ///< Inode de l'historique indexé
+    uint64_t indexed;       ///< Octets de l'historique couverts par les blocs
+    uint64_t num_blocks;    ///< Nombre de blocs
+    uint64_t check;         ///< Empreinte des CHECK_BYTES octets précédant *indexed*
+} index_header_t;
+
+/**
+ * @brief Structure représentant un bloc de l'index.
+ * @struct index_block_t
+ */
+typedef struct {
+    uint64_t start;                        ///< Position du bloc dans l'historique (début d'une ligne)
+    uint64_t len;                          ///< Longueur du bloc (lignes entières, saut de ligne final compris)
+    uint8_t filter[HISTORY_FILTER_BYTES];  ///< Filtre de Bloom des trigrammes des lignes du bloc
+} index_block_t;
+
+static int hist_fd = -1;           ///< Fichier d'historique
+static const char* map = NULL;     ///< Projection de l'historique
+static size_t map_size = 0;        ///< Taille projetée
+
+static int idx_fd = -1;            ///< Fichier d'index (-1 : recherches sans index)
+static const char* idx_map = NULL; ///< Projection de l'index
+static size_t idx_map_size = 0;    ///< Taille projetée
+
+/** @brief Hachage FNV-1a. */
+static uint64_t fnv1a(const char* data, size_t len) {
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < len; ++i) {
+        h ^= (unsigned char)data[i];
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
+/** @brief Positions des deux bits d'un trigramme dans un filtre. */
+static void trigram_bits(const char* t, unsigned* b1, unsigned* b2) {
+    uint32_t v = (unsigned char)t[0] | (unsigned char)t[1] << 8 | (unsigned char)t[2] << 16;
+    uint32_t h = v * 0x9E3779B1u;
+    *b1 = h >> (32 - 11);
+    *b2 = (h >> 8) & (HISTORY_FILTER_BYTES * 8 - 1);
+}
+
+/** @brief Ajout des trigrammes de [*s*, *s* + *len*) à un filtre. */
+static void filter_add(uint8_t* filter, const char* s, size_t len) {
+    for (size_t i = 0; i + 3 <= len; ++i) {
+        unsigned b1, b2;
+        trigram_bits(s + i, &b1, &b2);
+        filter[b1 >> 3] |= 1 << (b1 & 7);
+        filter[b2 >> 3] |= 1 << (b2 & 7);
+    }
+}
+
+/** @brief Test de la présence possible de tous les trigrammes d'une requête dans un filtre. */
+static int filter_match(const uint8_t* filter, const char* q, size_t qlen) {
+    for (size_t i = 0; i + 3 <= qlen; ++i) {
+        unsigned b1, b2;
+        trigram_bits(q + i, &b1, &b2);
+        if (!(filter[b1 >> 3] & (1 << (b1 & 7))) || !(filter[b2 >> 3] & (1 << (b2 & 7)))) return 0;
+    }
+    return 1;
+}
+
+/** @brief Projection (ou nouvelle projection) d'un fichier en lecture.
+ * @return int 0 en cas de succès, -1 en cas d'erreur (la projection précédente est supprimée).
+ */
+static int remap(int fd, const char** addr, size_t* size, size_t new_size) {
+    if (*addr && new_size == *size) return 0;
+    if (*addr) munmap((void*)*addr, *size);
+    *addr = NULL;
+    *size = 0;
+    if (new_size == 0) return 0;
+    void* p = mmap(NULL, new_size, PROT_READ, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED) return -1;
+    *addr = p;
+    *size = new_size;
+    return 0;
+}
+
+/** @brief Mise à jour de la projection de l'historique sur la taille courante du fichier. */
+static size_t refresh(void) {
+    struct stat st;
+    if (hist_fd < 0 || fstat(hist_fd, &st) != 0) return map_size;
+    if ((size_t)st.st_size != map_size) remap(hist_fd, &map, &map_size, st.st_size);
+    return map_size;
+}
+
+/** @brief En-tête de l'index projeté (NULL si l'index est absent ou vide). */
+static const index_header_t* index_header(void) {
+    return (idx_map && idx_map_size >= sizeof(index_header_t)) ? (const index_header_t*)idx_map : NULL;
+}
+
+/** @brief Nombre de blocs de l'index utilisables (dans la projection courante). */
+static size_t index_blocks(void) {
+    const index_header_t* h = index_header();
+    if (!h) return 0;
+    size_t max = (idx_map_size - sizeof(index_header_t)) / sizeof(index_block_t);
+    return h->num_blocks < max ? h->num_blocks : max;
+}
+
+/** @brief Octets de l'historique couverts par les blocs utilisables. */
+static size_t index_covered(void) {
+    size_t n = index_blocks();
+    if (n == 0) return 0;
+    const index_block_t* b = (const index_block_t*)(idx_map + sizeof(index_header_t)) + (n - 1);
+    return b->start + b->len;
+}
+
+/** @brief Validité de l'en-tête pour l'historique courant (même fichier, contenu indexé inchangé). */
+static int index_valid(const index_header_t* h, ino_t ino) {
+    if (memcmp(h->magic, INDEX_MAGIC, 8) != 0 || h->block_size != HISTORY_BLOCK_SIZE || h->filter_bytes != HISTORY_FILTER_BYTES) return 0;
+    if (h->ino != (uint64_t)ino || h->indexed > map_size) return 0;
+    size_t from = h->indexed > CHECK_BYTES ? h->indexed - CHECK_BYTES : 0;
+    return fnv1a(map + from, h->indexed - from) == h->check;
+}
+
+/** @brief Ajout à l'index des blocs complets qui suivent les lignes déjà indexées.
+ * @details Le fichier d'index est verrouillé (*flock()*) pendant la mise à jour : un seul shell indexe une même portion.
+ *    Les blocs sont écrits avant l'en-tête : un shell qui lit l'index pendant la mise à jour voit l'ancien nombre de blocs.
+ */
+static void index_update(void) {
+    if (idx_fd < 0 || !map) return;
+    /* pas de mise à jour tant que moins d'un bloc a été ajouté */
+    size_t covered = index_covered();
+    if (index_header() && covered <= map_size && map_size - covered < HISTORY_BLOCK_SIZE) return;
+    if (flock(idx_fd, LOCK_EX) != 0) return;
+
+    /* l'index a pu être complété par un autre shell sur des lignes que la projection courante ne couvre pas encore */
+    refresh();
+    struct stat hst, ist;
+    if (fstat(hist_fd, &hst) != 0 || fstat(idx_fd, &ist) != 0) goto unlock;
+    remap(idx_fd, &idx_map, &idx_map_size, ist.st_size);
+
+    index_header_t h;
+    const index_header_t* cur = index_header();
+    if (cur && index_valid(cur, hst.st_ino)) {
+        h = *cur;
+    } else {
+        /* index absent, d'un autre historique ou historique réécrit : reconstruction complète.
+         * Le fichier n'est pas tronqué (un autre shell qui le projette recevrait SIGBUS) : l'en-tête est remis à zéro
+         * puis les blocs sont réécrits par-dessus les anciens */
+        memset(&h, 0, sizeof(h));
+        memcpy(h.magic, INDEX_MAGIC, 8);
+        h.block_size = HISTORY_BLOCK_SIZE;
+        h.filter_bytes = HISTORY_FILTER_BYTES;
+        h.ino = hst.st_ino;
+        if (pwrite(idx_fd, &h, sizeof(h), 0) != (ssize_t)sizeof(h)) goto unlock;
+    }
+
+    index_block_t block;
+    size_t start = h.indexed;
+    size_t added = 0;
+    while (start < map_size) {
+        /* lignes entières jusqu'à atteindre la taille d'un bloc */
+        size_t end = start;
+        memset(block.filter, 0, sizeof(block.filter));
+        while (end - start < HISTORY_BLOCK_SIZE) {
+            const char* nl = memchr(map + end, '\n', map_size - end);
+            if (!nl) break;
+            filter_add(block.filter, map + end, nl - (map + end));
+            end = nl - map + 1;
+        }
+        if (end - start < HISTORY_BLOCK_SIZE) break;
+        block.start = start;
+        block.len = end - start;
+        off_t off = sizeof(index_header_t) + (off_t)(h.num_blocks + added) * sizeof(index_block_t);
+        if (pwrite(idx_fd, &block, sizeof(block), off) != (ssize_t)sizeof(block)) break;
+        added++;
+        start = end;
+    }
+
+    h.num_blocks += added;
+    h.indexed = start;
+    size_t from = start > CHECK_BYTES ? start - CHECK_BYTES : 0;
+    h.check = fnv1a(map + from, start - from);
+    if (pwrite(idx_fd, &h, sizeof(h), 0) == (ssize_t)sizeof(h) && fstat(idx_fd, &ist) == 0)
+        remap(idx_fd, &idx_map, &idx_map_size, ist.st_size);
+
+unlock:
+    flock(idx_fd, LOCK_UN);
+}
+
+int history_open(const char* path) {
+    if (!path || !*path) return -1;
+    history_close();
+
+    hist_fd = open(path, O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0600);
+    if (hist_fd < 0) return -1;
+    refresh();
+
+    size_t len = strlen(path);
+    char* idx_path = malloc(len + 5);
+    if (idx_path) {
+        memcpy(idx_path, path, len);
+        memcpy(idx_path + len, ".idx", 5);
+        idx_fd = open(idx_path, O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+        free(idx_path);
+    }
+    if (idx_fd >= 0) {
+        struct stat st;
+        if (fstat(idx_fd, &st) == 0) remap(idx_fd, &idx_map, &idx_map_size, st.st_size);
+        /* un index d'un autre historique n'est pas utilisé : il sera reconstruit par la mise à jour */
+        if (index_header() && fstat(hist_fd, &st) == 0 && !index_valid(index_header(), st.st_ino))
+            remap(idx_fd, &idx_map, &idx_map_size, 0);
+        index_update();
+    }
+    return 0;
+}
+
+void history_close(void) {
+    remap(-1, &map, &map_size, 0);
+    remap(-1, &idx_map, &idx_map_size, 0);
+    if (hist_fd >= 0) close(hist_fd);
+    if (idx_fd >= 0) close(idx_fd);
+    hist_fd = idx_fd = -1;
+}
+
+int history_add(const char* line, size_t len) {
+    if (hist_fd < 0 || !line || len == 0) return hist_fd < 0 ? -1 : 0;
+
+    /* doublon de la dernière entrée */
+    size_t pos = refresh(), last_len;
+    const char* last = history_prev(&pos, &last_len);
+    if (last && last_len == len && memcmp(last, line, len) == 0) return 0;
+
+    /* une seule écriture en O_APPEND : la ligne n'est pas entremêlée avec celles d'autres shells */
+    char small[1024];
+    char* entry = (len + 1 <= sizeof(small)) ? small : malloc(len + 1);
+    if (!entry) return -1;
+    memcpy(entry, line, len);
+    entry[len] = '\n';
+    ssize_t n;
+    do n = write(hist_fd, entry, len + 1); while (n < 0 && errno == EINTR);
+    if (entry != small) free(entry);
+    return n == (ssize_t)(len + 1) ? 0 : -1;
+}
+
+size_t history_end(void) {
+    return refresh();
+}
+
+const char* history_prev(size_t* pos, size_t* len) {
+    size_t end = *pos < map_size ? *pos : map_size;
+    if (end == 0) return NULL;
+    /* saut de ligne terminant l'entrée précédente (absent pour une dernière ligne incomplète) */
+    if (map[end - 1] == '\n') end--;
+    const char* nl = end ? memrchr(map, '\n', end) : NULL;
+    size_t start = nl ? (size_t)(nl - map) + 1 : 0;
+    *pos = start;
+    *len = end - start;
+    return map + start;
+}
+
+const char* history_next(size_t* pos, size_t* len) {
+    if (*pos >= map_size) return NULL;
+    const char* nl = memchr(map + *pos, '\n', map_size - *pos);
+    if (!nl || (size_t)(nl - map) + 1 >= map_size) return NULL;
+    size_t start = nl - map + 1;
+    const char* end = memchr(map + start, '\n', map_size - start);
+    *pos = start;
+    *len = (end ? (size_t)(end - map) : map_size) - start;
+    return map + start;
+}
+
+/** @brief Recherche de la dernière occurrence de *query* dans [*lo*, *hi*) et de la ligne qui la contient.
+ * @return const char* Début de la ligne, NULL si aucune occurrence.
+ */
+static const char* scan_range(size_t lo, size_t hi, const char* query, size_t qlen, size_t* pos, size_t* len) {
+    const char* last = NULL;
+    size_t p = lo;
+    const char* m;
+    while (p < hi && (m = memmem(map + p, hi - p, query, qlen)) != NULL) {
+        last = m;
+        p = m - map + 1;
+    }
+    if (!last) return NULL;
+
+    const char* nl = memrchr(map, '\n', last - map);
+    size_t start = nl ? (size_t)(nl - map) + 1 : 0;
+    const char* end = memchr(last, '\n', map_size - (last - map));
+    *pos = start;
+    *len = (end ? (size_t)(end - map) : map_size) - start;
+    return map + start;
+}
+
+const char* history_search(const char* query, size_t qlen, size_t* pos, size_t* len) {
+    if (!query || qlen == 0 || memchr(query, '\n', qlen)) return NULL;
+    refresh();
+    index_update();
+    if (!map) return NULL;
+
+    size_t before = *pos < map_size ? *pos : map_size;
+    size_t covered = index_covered();
+    size_t num_blocks = index_blocks();
+    /* index en avance sur l'historique (tronqué par ailleurs, mise à jour impossible) : ignoré */
+    if (covered > map_size) covered = num_blocks = 0;
+    const char* r;
+
+    /* lignes qui suivent le dernier bloc, non indexées */
+    if (before > covered && (r = scan_range(covered, before, query, qlen, pos, len))) return r;
+
+    /* blocs de l'index, du plus récent au plus ancien, filtrés par les trigrammes de la requête */
+    const index_block_t* blocks = (const index_block_t*)(idx_map + sizeof(index_header_t));
+    for (size_t i = num_blocks; i-- > 0;) {
+        const index_block_t* b = &blocks[i];
+        /* un bloc en cours de réécriture par un autre shell peut désigner n'importe quoi */
+        if (b->start >= before || b->len > map_size - b->start) continue;
+        if (qlen >= 3 && !filter_match(b->filter, query, qlen)) continue;
+        size_t hi = b->start + b->len < before ? b->start + b->len : before;
+        if ((r = scan_range(b->start, hi, query, qlen, pos, len))) return r;
+    }
+    return NULL;
+}
@@ -0,0 +1,143 @@
+/** @file input.c
+ * @brief Implementation of command input sources
+ * @author Nom1
+ * @author Nom2
+ * @date 2025-26
+ * @details Implémentation de la lecture par blocs et du découpage en lignes.
+ */
+
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "input.h"
+
+/** @brief Initialisation commune des champs d'une source. */
+static void input_reset(input_t* in, int fd) {
+    in->fd = fd;
+    in->owns_fd = 0;
+    in->seekable = 0;
+    in->eof = 0;
+    in->buf = NULL;
+    in->start = 0;
+    in->end = 0;
+    in->cap = 0;
+    in->line_no = 0;
+}
+
+int input_open_fd(input_t* in, int fd) {
+    if (!in || fd < 0) return -1;
+
+    input_reset(in, fd);
+    struct stat st;
+    in->seekable = fstat(fd, &st) == 0 && S_ISREG(st.st_mode);
+    return 0;
+}
+
+int input_open_file(input_t* in, const char* path) {
+    if (!in || !path) return -1;
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return -1;
+    input_reset(in, fd);
+    in->owns_fd = 1;
+    return 0;
+}
+
+int input_open_string(input_t* in, const char* str) {
+    if (!in || !str) return -1;
+
+    input_reset(in, -1);
+    size_t len = strlen(str);
+    in->buf = malloc(len + 1);
+    if (!in->buf) return -1;
+    memcpy(in->buf, str, len + 1);
+    in->end = len;
+    in->cap = len + 1;
+    in->eof = 1;
+    return 0;
+}
+
+/** @brief Lecture d'un bloc à la suite des octets non consommés.
+ * @return int Nombre d'octets lus, 0 en fin de source, -1 en cas d'erreur.
+ * @details Les octets non consommés sont d'abord ramenés en début de tampon ; le tampon est doublé s'il reste moins d'un bloc de place
+ *    (une ligne plus longue que le tampon le fait donc grandir jusqu'à la contenir).
+ */
+static ssize_t fill(input_t* in) {
+    if (in->start > 0) {
+        memmove(in->buf, in->buf + in->start, in->end - in->start);
+        in->end -= in->start;
+        in->start = 0;
+    }
+    if (in->cap - in->end < INPUT_BLOCK_SIZE + 1) {
+        size_t cap = in->cap ? in->cap : INPUT_BLOCK_SIZE;
+        while (cap - in->end < INPUT_BLOCK_SIZE + 1) cap *= 2;
+        char* buf = realloc(in->buf, cap);
+        if (!buf) return -1;
+        in->buf = buf;
+        in->cap = cap;
+    }
+
+    ssize_t n;
+    do {
+        n = read(in->fd, in->buf + in->end, in->cap - in->end - 1);
+    } while (n < 0 && errno == EINTR);
+    if (n > 0) in->end += n;
+    return n;
+}
+
+char* input_read_line(input_t* in, size_t* len) {
+    if (!in) return NULL;
+
+    size_t scanned = in->start;
+    while (1) {
+        char* nl = (scanned < in->end) ? memchr(in->buf + scanned, '\n', in->end - scanned) : NULL;
+        if (nl) {
+            char* line = in->buf + in->start;
+            *nl = '\0';
+            if (len) *len = nl - line;
+            in->start = nl - in->buf + 1;
+            in->line_no++;
+            return line;
+        }
+        if (in->eof) break;
+
+        /* pas de ligne complète : lire le bloc suivant (le tampon peut être déplacé) */
+        size_t offset = in->end - in->start;
+        ssize_t n = fill(in);
+        if (n < 0) return NULL;
+        if (n == 0) in->eof = 1;
+        scanned = in->start + offset;
+    }
+
+    /* dernière ligne sans saut de ligne final */
+    if (in->start >= in->end) return NULL;
+    char* line = in->buf + in->start;
+    in->buf[in->end] = '\0';
+    if (len) *len = in->end - in->start;
+    in->start = in->end;
+    in->line_no++;
+    return line;
+}
+
+void input_sync(input_t* in) {
+    if (!in || !in->seekable || in->start == in->end) return;
+
+    if (lseek(in->fd, -(off_t)(in->end - in->start), SEEK_CUR) >= 0) {
+        in->start = 0;
+        in->end = 0;
+        in->eof = 0;
+    }
+}
+
+void input_close(input_t* in) {
+    if (!in) return;
+
+    if (in->owns_fd && in->fd >= 0) close(in->fd);
+    free(in->buf);
+    input_reset(in, -1);
+}
@@ -0,0 +1,369 @@
+/** @file jobs.c
+ * @brief Implementation of job control
+ * @author Nom1
+ * @author Nom2
+ * @date 2025-26
+ * @details Implémentation de la table des jobs et du contrôle des jobs.
+ *   Le gestionnaire de SIGCHLD ne fait que des appels *wait4(WNOHANG)* sur les PID de la table (simple appel système) :
+ *   les processus de premier plan, absents de la table, restent attendus explicitement par *wait_processus()*.
+ *   Toute modification de la table se fait SIGCHLD bloqué.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+
+#include "jobs.h"
+#include "trace.h"
+
+static job_t** jobs = NULL;         ///< Table des jobs, du plus ancien au plus récent
+static size_t num_jobs = 0;         ///< Nombre de jobs de la table
+static size_t jobs_capacity = 0;    ///< Capacité de la table
+
+static int enabled = 0;             ///< Contrôle des jobs actif
+static int terminal = -1;           ///< Terminal du shell
+static pid_t shell_pgid = 0;        ///< Groupe de processus du shell
+static struct termios shell_tmodes; ///< Attributs du terminal du shell
+
+/** @brief Mise à jour de l'état d'un étage à partir d'un statut et des ressources renvoyés par *wait4()* (*usage* peut être NULL).
+ * @details Appelée depuis le gestionnaire de SIGCHLD : n'utilise que des fonctions async-signal-safe.
+ */
+static void update_proc(job_t* job, size_t i, int wstatus, const struct rusage* usage) {
+    if (WIFSTOPPED(wstatus)) {
+        job->proc_states[i] = JOB_STOPPED;
+    } else if (WIFCONTINUED(wstatus)) {
+        job->proc_states[i] = JOB_RUNNING;
+    } else {
+        job->proc_states[i] = JOB_DONE;
+        job->procs[i].status = wstatus;
+        if (usage) job->procs[i].rusage = *usage;
+        clock_gettime(CLOCK_MONOTONIC, &job->procs[i].end_time);
+    }
+
+    job_state_t state = JOB_DONE;
+    for (size_t k = 0; k < job->num_procs; ++k) {
+        if (job->proc_states[k] == JOB_STOPPED) state = JOB_STOPPED;
+        else if (job->proc_states[k] == JOB_RUNNING && state != JOB_STOPPED) state = JOB_RUNNING;
+    }
+    if (state != job->state) {
+        job->state = state;
+        job->notified = (state == JOB_RUNNING);
+    }
+}
+
+/** @brief Récupération des étages d'un job ayant changé d'état.
+ * @param options Options supplémentaires de *wait4()* (WNOHANG depuis le gestionnaire de signal, 0 pour une attente bloquante).
+ */
+static void reap_job(job_t* job, int options) {
+    for (size_t i = 0; i < job->num_procs; ++i) {
+        if (job->proc_states[i] == JOB_DONE) continue;
+        if (options == 0 && job->proc_states[i] == JOB_STOPPED) continue;
+
+        int wstatus = 0;
+        struct rusage usage;
+        pid_t r = wait4(job->procs[i].pid, &wstatus, options | WUNTRACED | WCONTINUED, &usage);
+        if (r == job->procs[i].pid) {
+            update_proc(job, i, wstatus, &usage);
+            /* enregistrement sans verrou ni allocation : possible depuis le gestionnaire de SIGCHLD */
+            if (trace_enabled && job->proc_states[i] == JOB_DONE)
+                trace_span("child", job->command, trace_timespec(job->procs[i].start_time), trace_timespec(job->procs[i].end_time),
+                           r, "status", WIFEXITED(wstatus) ? WEXITSTATUS(wstatus) : 128 + WTERMSIG(wstatus), NULL);
+            if (options == 0 && job->state == JOB_STOPPED) return;
+        } else if (r < 0 && errno == ECHILD) {
+            /* processus déjà récupéré par ailleurs : considéré comme terminé */
+            update_proc(job, i, job->procs[i].status, NULL);
+        }
+    }
+}
+
+/** @brief Gestionnaire de SIGCHLD : récupère sans bloquer les processus des jobs. */
+static void sigchld_handler(int sig) {
+    (void) sig;
+    int saved_errno = errno;
+    for (size_t j = 0; j < num_jobs; ++j)
+        reap_job(jobs[j], WNOHANG);
+    errno = saved_errno;
+}
+
+int job_control_init(int interactive) {
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = sigchld_handler;
+    sigemptyset(&sa.sa_mask);
+    sa.sa_flags = SA_RESTART;
+    if (sigaction(SIGCHLD, &sa, NULL) != 0) {
+        perror("sigaction");
+        return -1;
+    }
+
+    if (!interactive || !isatty(STDIN_FILENO)) return 0;
+
+    /* attendre d'être au premier plan avant de prendre le terminal */
+    terminal = STDIN_FILENO;
+    while (tcgetpgrp(terminal) != (shell_pgid = getpgrp()))
+        kill(-shell_pgid, SIGTTIN);
+
+    signal(SIGQUIT, SIG_IGN);
+    signal(SIGTSTP, SIG_IGN);
+    signal(SIGTTIN, SIG_IGN);
+    signal(SIGTTOU, SIG_IGN);
+
+    /* le shell devient leader de son propre groupe (échoue sans conséquence s'il est leader de session) */
+    shell_pgid = getpid();
+    if (setpgid(shell_pgid, shell_pgid) < 0) shell_pgid = getpgrp();
+    tcsetpgrp(terminal, shell_pgid);
+    tcgetattr(terminal, &shell_tmodes);
+
+    enabled = 1;
+    return 0;
+}
+
+int job_control_enabled(void) {
+    return enabled;
+}
+
+void job_control_leave(void) {
+    enabled = 0;
+}
+
+int job_terminal(void) {
+    return enabled ? terminal : -1;
+}
+
+void job_block_sigchld(void) {
+    sigset_t set;
+    sigemptyset(&set);
+    sigaddset(&set, SIGCHLD);
+    sigprocmask(SIG_BLOCK, &set, NULL);
+}
+
+void job_unblock_sigchld(void) {
+    sigset_t set;
+    sigemptyset(&set);
+    sigaddset(&set, SIGCHLD);
+    sigprocmask(SIG_UNBLOCK, &set, NULL);
+}
+
+void job_give_terminal(pid_t pgid) {
+    if (enabled && pgid > 0) tcsetpgrp(terminal, pgid);
+}
+
+void job_take_terminal(void) {
+    if (!enabled) return;
+    tcsetpgrp(terminal, shell_pgid);
+    tcsetattr(terminal, TCSADRAIN, &shell_tmodes);
+}
+
+/** @brief Construction du texte d'un pipeline à partir des arguments de ses étages. */
+static char* pipeline_text(processus_t* first, size_t num_procs) {
+    size_t len = 1;
+    processus_t* p = first;
+    for (size_t i = 0; i < num_procs && p; ++i) {
+        for (int a = 0; p->argv[a]; ++a) len += strlen(p->argv[a]) + 1;
+        len += 3;
+        p = (p->cf && p->cf->pipe_next) ? p->cf->pipe_next->proc : NULL;
+    }
+
+    char* text = malloc(len);
+    if (!text) return NULL;
+    char* out = text;
+    p = first;
+    for (size_t i = 0; i < num_procs && p; ++i) {
+        if (i > 0) out = stpcpy(out, " | ");
+        for (int a = 0; p->argv[a]; ++a) {
+            if (a > 0) *out++ = ' ';
+            out = stpcpy(out, p->argv[a]);
+        }
+        p = (p->cf && p->cf->pipe_next) ? p->cf->pipe_next->proc : NULL;
+    }
+    *out = '\0';
+    return text;
+}
+
+job_t* job_add(processus_t* first, size_t num_procs, pid_t pgid, job_state_t state) {
+    if (!first || num_procs == 0) return NULL;
+
+    if (num_jobs == jobs_capacity) {
+        size_t capacity = jobs_capacity ? jobs_capacity * 2 : 8;
+        job_t** t = realloc(jobs, capacity * sizeof(job_t*));
+        if (!t) return NULL;
+        jobs = t;
+        jobs_capacity = capacity;
+    }
+
+    job_t* job = calloc(1, sizeof(job_t));
+    if (!job) return NULL;
+    job->procs = calloc(num_procs, sizeof(processus_t));
+    job->proc_states = calloc(num_procs, sizeof(job_state_t));
+    job->command = pipeline_text(first, num_procs);
+    if (!job->procs || !job->proc_states || !job->command) {
+        free(job->procs);
+        free(job->proc_states);
+        free(job->command);
+        free(job);
+        return NULL;
+    }
+
+    job->id = (num_jobs > 0) ? jobs[num_jobs - 1]->id + 1 : 1;
+    job->pgid = pgid;
+    job->num_procs = num_procs;
+    job->state = state;
+    job->notified = 1;
+
+    processus_t* p = first;
+    for (size_t i = 0; i < num_procs && p; ++i) {
+        init_processus(&job->procs[i]);
+        job->procs[i].pid = p->pid;
+        job->procs[i].pgid = p->pgid;
+        job->procs[i].status = p->status;
+        job->procs[i].start_time = p->start_time;
+        job->procs[i].end_time = p->end_time;
+        job->procs[i].rusage = p->rusage;
+        /* étage non lancé ou déjà récupéré (end_time n'est renseigné qu'à la terminaison) : terminé */
+        if (p->pid <= 0 || p->end_time.tv_sec != 0 || p->end_time.tv_nsec != 0)
+            job->proc_states[i] = JOB_DONE;
+        else if (WIFSTOPPED(p->status))
+            job->proc_states[i] = JOB_STOPPED;
+        else
+            job->proc_states[i] = state;
+        p = (p->cf && p->cf->pipe_next) ? p->cf->pipe_next->proc : NULL;
+    }
+
+    jobs[num_jobs++] = job;
+    return job;
+}
+
+job_t* job_find(const char* spec) {
+    if (num_jobs == 0) return NULL;
+    if (!spec || strcmp(spec, "%") == 0 || strcmp(spec, "%+") == 0 || strcmp(spec, "%%") == 0)
+        return jobs[num_jobs - 1];
+    if (strcmp(spec, "%-") == 0)
+        return (num_jobs > 1) ? jobs[num_jobs - 2] : NULL;
+
+    if (spec[0] == '%') spec++;
+    char* end;
+    long id = strtol(spec, &end, 10);
+    if (*spec == '\0' || *end != '\0') return NULL;
+    for (size_t j = 0; j < num_jobs; ++j) {
+        if (jobs[j]->id == id) return jobs[j];
+    }
+    return NULL;
+}
+
+job_t* job_find_pid(pid_t pid) {
+    for (size_t j = 0; j < num_jobs; ++j) {
+        for (size_t i = 0; i < jobs[j]->num_procs; ++i) {
+            if (jobs[j]->procs[i].pid == pid) return jobs[j];
+        }
+    }
+    return NULL;
+}
+
+int job_wait(job_t* job) {
+    if (!job) return -1;
+
+    job_block_sigchld();
+    while (job->state == JOB_RUNNING) reap_job(job, 0);
+    job_unblock_sigchld();
+
+    processus_t* last = &job->procs[job->num_procs - 1];
+    if (job->state == JOB_STOPPED) return 128 + (WIFSTOPPED(last->status) ? WSTOPSIG(last->status) : SIGTSTP);
+    if (WIFEXITED(last->status)) return WEXITSTATUS(last->status);
+    if (WIFSIGNALED(last->status)) return 128 + WTERMSIG(last->status);
+    return 0;
+}
+
+/** @brief Retrait d'un job de la table (SIGCHLD doit être bloqué). */
+static void detach_job(job_t* job) {
+    for (size_t j = 0; j < num_jobs; ++j) {
+        if (jobs[j] != job) continue;
+        memmove(&jobs[j], &jobs[j + 1], (num_jobs - j - 1) * sizeof(job_t*));
+        num_jobs--;
+        return;
+    }
+}
+
+/** @brief Libération de la mémoire d'un job. */
+static void free_job(job_t* job) {
+    free(job->procs);
+    free(job->proc_states);
+    free(job->command);
+    free(job);
+}
+
+void job_remove(job_t* job) {
+    if (!job) return;
+
+    job_block_sigchld();
+    detach_job(job);
+    job_unblock_sigchld();
+    free_job(job);
+}
+
+/** @brief Texte décrivant l'état d'un job, à la manière de bash. */
+static const char* state_text(const job_t* job, char* buffer, size_t size) {
+    const processus_t* last = &job->procs[job->num_procs - 1];
+    if (job->state == JOB_RUNNING) return "Running";
+    if (job->state == JOB_STOPPED) return "Stopped";
+    if (WIFSIGNALED(last->status)) {
+        snprintf(buffer, size, "%s", strsignal(WTERMSIG(last->status)));
+        return buffer;
+    }
+    if (WIFEXITED(last->status) && WEXITSTATUS(last->status) != 0) {
+        snprintf(buffer, size, "Exit %d", WEXITSTATUS(last->status));
+        return buffer;
+    }
+    return "Done";
+}
+
+void job_print(const job_t* job, int fd, int with_pids) {
+    if (!job || fd < 0) return;
+
+    char buffer[64];
+    char mark = ' ';
+    if (num_jobs > 0 && jobs[num_jobs - 1] == job) mark = '+';
+    else if (num_jobs > 1 && jobs[num_jobs - 2] == job) mark = '-';
+
+    if (with_pids) {
+        dprintf(fd, "[%d]%c %d %-22s %s\n", job->id, mark, (int)job->procs[0].pid,
+                state_text(job, buffer, sizeof(buffer)), job->command);
+    } else {
+        dprintf(fd, "[%d]%c  %-22s %s\n", job->id, mark, state_text(job, buffer, sizeof(buffer)), job->command);
+    }
+}
+
+job_t* job_at(size_t index) {
+    return (index < num_jobs) ? jobs[index] : NULL;
+}
+
+size_t job_count(void) {
+    return num_jobs;
+}
+
+void job_notify(int fd) {
+    job_block_sigchld();
+    size_t j = 0;
+    while (j < num_jobs) {
+        job_t* job = jobs[j];
+        if (job->state != JOB_RUNNING && !job->notified) {
+            job_print(job, fd, 0);
+            job->notified = 1;
+        }
+        if (job->state == JOB_DONE) {
+            detach_job(job);
+            free_job(job);
+            continue;
+        }
+        j++;
+    }
+    job_unblock_sigchld();
+}
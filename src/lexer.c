@@ -0,0 +1,696 @@
+/** @file lexer.c
+ * @brief Implementation of the command line lexer
+ * @author Nom1
+ * @author Nom2
+ * @date 2025-26
+ * @details Implémentation de l'analyseur lexical en une seule passe. Les corps des here-documents sont lus dès leur redirection,
+ *   par une recherche en avant de la fin de la ligne : ils ne sont parcourus qu'une fois, puis sautés quand l'analyse atteint cette fin de ligne.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "lexer.h"
+#include "env.h"
+#include "subst.h"
+
+/// Marqueurs de la forme symbolique d'un mot (les octets de même valeur présents dans la ligne sont précédés de WORD_ESCAPE)
+#define WORD_VAR        '\001' ///< $NOM hors guillemets : suivi du nom et de WORD_END, valeur découpée en champs
+#define WORD_VAR_QUOTED '\002' ///< $NOM entre guillemets : suivi du nom et de WORD_END, valeur non découpée
+#define WORD_END        '\003' ///< Fin du nom d'une variable
+#define WORD_ESCAPE     '\004' ///< L'octet suivant est littéral
+#define WORD_QUOTES     '\005' ///< Guillemets : le champ existe même s'il reste vide
+#define WORD_SUBST      '\006' ///< $(...) hors guillemets : suivi de la ligne intérieure et de WORD_END, sortie découpée en champs
+#define WORD_SUBST_QUOTED '\007' ///< $(...) entre guillemets : suivi de la ligne intérieure et de WORD_END, sortie non découpée
+#define WORD_PROCESS    '\010' ///< <(...) ou >(...) : suivi de '<' ou '>', de la ligne intérieure et de WORD_END
+
+/** @brief Mot en cours de construction dans l'arène. */
+typedef struct {
+    arena_t* arena;   ///< Arène propriétaire du tampon
+    char* buf;        ///< Tampon (forme symbolique, ou champs séparés par '\0' lors de l'expansion)
+    size_t len;       ///< Nombre d'octets utilisés
+    size_t cap;       ///< Capacité du tampon
+    size_t fields;    ///< Nombre de champs terminés
+    int started;      ///< Le champ courant existe (même vide, s'il contient des guillemets)
+    int symbolic;     ///< Le mot contient des marqueurs
+} word_t;
+
+/** @brief Ajout d'un octet au mot ; le tampon est doublé (sur place tant qu'il est la dernière allocation de l'arène). */
+static int word_putc(word_t* w, char c) {
+    if (w->len == w->cap) {
+        size_t cap = w->cap ? w->cap * 2 : 64;
+        char* buf = arena_realloc(w->arena, w->buf, w->cap, cap);
+        if (!buf) return -1;
+        w->buf = buf;
+        w->cap = cap;
+    }
+    w->buf[w->len++] = c;
+    return 0;
+}
+
+/** @brief Ajout d'un marqueur à la forme symbolique. */
+static int word_put_marker(word_t* w, char marker) {
+    w->symbolic = 1;
+    return word_putc(w, marker);
+}
+
+/** @brief Ajout d'un octet littéral à la forme symbolique (protégé s'il a la valeur d'un marqueur). */
+static int word_put_literal(word_t* w, char c) {
+    if (c >= WORD_VAR && c <= WORD_PROCESS && word_put_marker(w, WORD_ESCAPE) != 0) return -1;
+    return word_putc(w, c);
+}
+
+/** @brief Terminaison du champ courant s'il existe. */
+static int word_end_field(word_t* w) {
+    if (!w->started) return 0;
+    if (word_putc(w, '\0') != 0) return -1;
+    w->fields++;
+    w->started = 0;
+    return 0;
+}
+
+static int is_blank(char c) {
+    return c == ' ' || c == '\t' || c == '\n';
+}
+
+/** @brief Caractères qui terminent un mot non protégé. */
+static int is_meta(char c) {
+    return is_blank(c) || c == ';' || c == '&' || c == '|' || c == '<' || c == '>';
+}
+
+static int is_name_start(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+}
+
+static int is_name_char(char c) {
+    return is_name_start(c) || (c >= '0' && c <= '9');
+}
+
+/** @brief Ajout de la valeur d'une variable au mot.
+ * @details Hors guillemets (*split*), la valeur est découpée en champs sur les blancs.
+ */
+static int word_put_value(word_t* w, const char* val, int split) {
+    for (; *val; ++val) {
+        if (split && is_blank(*val)) {
+            if (word_end_field(w) != 0) return -1;
+            continue;
+        }
+        if (word_putc(w, *val) != 0) return -1;
+        w->started = 1;
+    }
+    return 0;
+}
+
+/** @brief Recherche de la parenthèse fermant une substitution de commande dont le contenu commence en *from*.
+ * @return size_t Position de la ')' correspondante, *len* si elle est absente.
+ * @details Les parenthèses sont comptées hors guillemets ; les guillemets, les échappements et les substitutions imbriquées entre guillemets sont sautés.
+ */
+static size_t find_subst_end(const char* s, size_t len, size_t from) {
+    size_t open = 1;
+    for (size_t i = from; i < len; ++i) {
+        if (s[i] == '\\') {
+            i++;
+        } else if (s[i] == '\'') {
+            const char* end = memchr(s + i + 1, '\'', len - i - 1);
+            if (!end) return len;
+            i = end - s;
+        } else if (s[i] == '"') {
+            for (i++; i < len && s[i] != '"'; ++i) {
+                if (s[i] == '\\') i++;
+                else if (s[i] == '$' && i + 1 < len && s[i + 1] == '(') i = find_subst_end(s, len, i + 2);
+            }
+            if (i >= len) return len;
+        } else if (s[i] == '(') {
+            open++;
+        } else if (s[i] == ')' && --open == 0) {
+            return i;
+        }
+    }
+    return len;
+}
+
+/** @brief Lecture de la variable ou de la substitution de commande qui suit le '$' situé en *lex->pos*, ajoutée au mot sous forme symbolique.
+ * @return int 0 en cas de succès, -1 en cas d'erreur (accolade ou parenthèse non fermée, nom invalide).
+ * @details Si le '$' n'est suivi ni d'un nom, ni de '{', ni de '(', il est conservé tel quel.
+ *    La ligne intérieure d'une substitution est gardée telle quelle : elle sera analysée à son exécution.
+ */
+static int lex_variable(lexer_t* lex, word_t* w, int quoted) {
+    const char* s = lex->line;
+    size_t i = lex->pos + 1;
+    size_t start, end;
+
+    if (i < lex->len && s[i] == '(') {
+        end = find_subst_end(s, lex->len, i + 1);
+        if (end >= lex->len) return -1;
+        if (word_put_marker(w, quoted ? WORD_SUBST_QUOTED : WORD_SUBST) != 0) return -1;
+        for (size_t k = i + 1; k < end; ++k)
+            if (word_put_literal(w, s[k]) != 0) return -1;
+        lex->pos = end + 1;
+        return word_putc(w, WORD_END);
+    }
+
+    if (i < lex->len && s[i] == '{') {
+        start = i + 1;
+        end = start;
+        while (end < lex->len && s[end] != '}') end++;
+        if (end >= lex->len || !env_valid_name(s + start, end - start)) return -1;
+        lex->pos = end + 1;
+    } else if (i < lex->len && is_name_start(s[i])) {
+        start = i;
+        end = i;
+        while (end < lex->len && is_name_char(s[end])) end++;
+        lex->pos = end;
+    } else {
+        lex->pos = i;
+        return word_putc(w, '$');
+    }
+
+    if (word_put_marker(w, quoted ? WORD_VAR_QUOTED : WORD_VAR) != 0) return -1;
+    for (size_t k = start; k < end; ++k)
+        if (word_putc(w, s[k]) != 0) return -1;
+    return word_putc(w, WORD_END);
+}
+
+/** @brief Lecture de la substitution de processus "<(...)" ou ">(...)" située en *lex->pos*, ajoutée au mot sous forme symbolique.
+ * @return int 0 en cas de succès, -1 en cas d'erreur (parenthèse non fermée).
+ */
+static int lex_process(lexer_t* lex, word_t* w) {
+    const char* s = lex->line;
+    size_t end = find_subst_end(s, lex->len, lex->pos + 2);
+    if (end >= lex->len) return -1;
+    if (word_put_marker(w, WORD_PROCESS) != 0 || word_putc(w, s[lex->pos]) != 0) return -1;
+    for (size_t k = lex->pos + 2; k < end; ++k)
+        if (word_put_literal(w, s[k]) != 0) return -1;
+    lex->pos = end + 1;
+    return word_putc(w, WORD_END);
+}
+
+int lexer_init(lexer_t* lex, const char* line, size_t len, arena_t* arena) {
+    if (!lex || !line || !arena) return -1;
+
+    lex->line = line;
+    lex->len = len;
+    lex->pos = 0;
+    lex->arena = arena;
+    lex->line_end = 0;
+    lex->body = 0;
+    lex->has_queued = 0;
+    lex->unterminated = 0;
+    return 0;
+}
+
+/** @brief Lecture d'un opérateur ou d'une redirection commençant en *lex->pos*.
+ * @return int 1 si un token a été lu, 0 si la position ne commence pas un opérateur, -1 en cas d'erreur de syntaxe.
+ */
+static int lex_operator(lexer_t* lex, token_t* tok) {
+    const char* s = lex->line;
+    size_t i = lex->pos;
+    int fd = -1;
+
+    /* descripteur explicite collé devant la redirection : 2>, 2>>, 2>&1 */
+    size_t j = i;
+    while (j < lex->len && s[j] >= '0' && s[j] <= '9') j++;
+    if (j > i && j < lex->len && (s[j] == '<' || s[j] == '>')) {
+        fd = 0;
+        for (size_t k = i; k < j; ++k) {
+            fd = fd * 10 + (s[k] - '0');
+            if (fd > 1000000) return -1;
+        }
+        i = j;
+    }
+
+    char c = s[i];
+    char n = (i + 1 < lex->len) ? s[i + 1] : '\0';
+    /* "<(" et ">(" commencent une substitution de processus, qui fait partie d'un mot (y compris "2>(...)") */
+    if ((c == '<' || c == '>') && n == '(') return 0;
+
+    tok->fd = -1;
+    tok->target_fd = -1;
+    tok->flags = 0;
+    tok->len = 0;
+
+    if (c == '<' || c == '>') {
+        tok->type = TOKEN_REDIRECTION;
+        size_t width = 1;
+        if (c == '<' && n == '<' && i + 2 < lex->len && s[i + 2] == '<') { tok->op = REDIR_HERESTRING; width = 3; }
+        else if (c == '<' && n == '<') { tok->op = REDIR_HEREDOC; width = 2; }
+        else if (c == '>' && n == '>') { tok->op = REDIR_APPEND; width = 2; }
+        else if (n == '&') {
+            tok->op = (c == '<') ? REDIR_DUP_IN : REDIR_DUP_OUT;
+            size_t k = i + 2;
+            int target = 0;
+            if (k >= lex->len || s[k] < '0' || s[k] > '9') return -1;
+            while (k < lex->len && s[k] >= '0' && s[k] <= '9') {
+                target = target * 10 + (s[k] - '0');
+                if (target > 1000000) return -1;
+                k++;
+            }
+            tok->target_fd = target;
+            width = k - i;
+        }
+        else tok->op = (c == '<') ? REDIR_IN : REDIR_OUT;
+
+        tok->fd = (fd >= 0) ? fd : (c == '<') ? 0 : 1;
+        tok->text = (tok->op == REDIR_APPEND) ? ">>" : (tok->op == REDIR_HEREDOC) ? "<<" : (tok->op == REDIR_HERESTRING) ? "<<<"
+                  : (c == '<') ? "<" : ">";
+        lex->pos = i + width;
+        return 1;
+    }
+
+    if (fd >= 0) return 0;
+
+    tok->type = TOKEN_OPERATOR;
+    if (c == ';') { tok->op = OP_SEMICOLON; tok->text = ";"; lex->pos = i + 1; return 1; }
+    if (c == '&' && n == '&') { tok->op = OP_AND; tok->text = "&&"; lex->pos = i + 2; return 1; }
+    if (c == '&') { tok->op = OP_AMPERSAND; tok->text = "&"; lex->pos = i + 1; return 1; }
+    if (c == '|' && n == '|') { tok->op = OP_OR; tok->text = "||"; lex->pos = i + 2; return 1; }
+    if (c == '|') { tok->op = OP_PIPE; tok->text = "|"; lex->pos = i + 1; return 1; }
+    return 0;
+}
+
+/** @brief Lecture du mot commençant en *lex->pos*. */
+static int lex_word(lexer_t* lex, token_t* tok) {
+    const char* s = lex->line;
+
+    /* NOM= en tête de mot : affectation, dont la valeur n'est pas découpée en champs */
+    size_t i = lex->pos;
+    int assignment = 0;
+    if (is_name_start(s[i])) {
+        size_t k = i + 1;
+        while (k < lex->len && is_name_char(s[k])) k++;
+        assignment = (k < lex->len && s[k] == '=');
+    }
+
+    word_t w = { lex->arena, NULL, 0, 0, 0, 0, 0 };
+    int quoted = 0;
+    int in_double = 0;
+
+    while (lex->pos < lex->len) {
+        char c = s[lex->pos];
+        if (c == '\0') break;
+
+        if (in_double) {
+            if (c == '"') { in_double = 0; lex->pos++; continue; }
+            if (c == '$') { if (lex_variable(lex, &w, 1) != 0) return -1; continue; }
+            if (c == '\\' && lex->pos + 1 < lex->len) {
+                char e = s[lex->pos + 1];
+                if (e == '\n') { lex->pos += 2; continue; }
+                if (e == '$' || e == '"' || e == '\\' || e == '`') { c = e; lex->pos++; }
+            }
+            if (word_put_literal(&w, c) != 0) return -1;
+            lex->pos++;
+            continue;
+        }
+
+        if ((c == '<' || c == '>') && lex->pos + 1 < lex->len && s[lex->pos + 1] == '(') {
+            if (lex_process(lex, &w) != 0) return -1;
+            continue;
+        }
+        if (is_meta(c)) break;
+
+        if (c == '\'') {
+            const char* end = memchr(s + lex->pos + 1, '\'', lex->len - lex->pos - 1);
+            if (!end) return -1;
+            if (word_put_marker(&w, WORD_QUOTES) != 0) return -1;
+            for (const char* p = s + lex->pos + 1; p < end; ++p)
+                if (word_put_literal(&w, *p) != 0) return -1;
+            quoted = 1;
+            lex->pos = end - s + 1;
+            continue;
+        }
+        if (c == '"') {
+            if (word_put_marker(&w, WORD_QUOTES) != 0) return -1;
+            in_double = 1;
+            quoted = 1;
+            lex->pos++;
+            continue;
+        }
+        if (c == '\\') {
+            if (lex->pos + 1 >= lex->len) { lex->pos++; continue; }
+            if (s[lex->pos + 1] == '\n') { lex->pos += 2; continue; }
+            if (word_put_marker(&w, WORD_ESCAPE) != 0 || word_putc(&w, s[lex->pos + 1]) != 0) return -1;
+            quoted = 1;
+            lex->pos += 2;
+            continue;
+        }
+        if (c == '$') {
+            if (lex_variable(lex, &w, 0) != 0) return -1;
+            continue;
+        }
+
+        if (word_put_literal(&w, c) != 0) return -1;
+        lex->pos++;
+    }
+
+    /* guillemet non fermé */
+    if (in_double) return -1;
+    if (word_putc(&w, '\0') != 0) return -1;
+    /* rendre à l'arène la fin inutilisée du tampon */
+    w.buf = arena_realloc(w.arena, w.buf, w.cap, w.len);
+
+    tok->type = assignment ? TOKEN_ASSIGNMENT : TOKEN_WORD;
+    tok->op = 0;
+    tok->fd = -1;
+    tok->target_fd = -1;
+    tok->flags = (quoted ? TOKEN_QUOTED : 0) | (w.symbolic ? TOKEN_SYMBOLIC : 0);
+    tok->text = w.buf;
+    tok->len = w.len - 1;
+    return 1;
+}
+
+/** @brief Recherche de la fin de la ligne commençant avant *from* (saut de ligne hors guillemets et non protégé, ou fin du texte). */
+static size_t find_line_end(const lexer_t* lex, size_t from) {
+    const char* s = lex->line;
+    for (size_t i = from; i < lex->len; ++i) {
+        if (s[i] == '\\') {
+            i++;
+        } else if (s[i] == '\'') {
+            const char* end = memchr(s + i + 1, '\'', lex->len - i - 1);
+            if (!end) return lex->len;
+            i = end - s;
+        } else if (s[i] == '"') {
+            for (i++; i < lex->len && s[i] != '"'; ++i)
+                if (s[i] == '\\') i++;
+        } else if (s[i] == '\n') {
+            return i;
+        }
+    }
+    return lex->len;
+}
+
+/** @brief Forme littérale du délimiteur d'un here-document : guillemets et échappements retirés, variables et substitutions laissées telles quelles. */
+static char* heredoc_delimiter(lexer_t* lex, const token_t* word, size_t* len) {
+    char* d = arena_alloc(lex->arena, 2 * word->len + 2);
+    if (!d) return NULL;
+    size_t n = 0;
+    int in_subst = 0;
+    for (size_t i = 0; i < word->len; ++i) {
+        char c = word->text[i];
+        if (c == WORD_QUOTES) continue;
+        if (c == WORD_END) {
+            if (in_subst) d[n++] = ')';
+            in_subst = 0;
+            continue;
+        }
+        if (c == WORD_SUBST || c == WORD_SUBST_QUOTED || (c == WORD_PROCESS && i + 1 < word->len)) {
+            d[n++] = (c == WORD_PROCESS) ? word->text[++i] : '$';
+            c = '(';
+            in_subst = 1;
+        } else if (c == WORD_VAR || c == WORD_VAR_QUOTED) c = '$';
+        else if (c == WORD_ESCAPE && i + 1 < word->len) c = word->text[++i];
+        d[n++] = c;
+    }
+    d[n] = '\0';
+    *len = n;
+    return d;
+}
+
+/** @brief Lecture du délimiteur qui suit "<<" et du corps du here-document, placé en attente pour l'appel suivant.
+ * @return int 1 en cas de succès, -1 en cas d'erreur (délimiteur absent, variable invalide dans le corps).
+ */
+static int lex_heredoc(lexer_t* lex) {
+    const char* s = lex->line;
+    int strip = 0;
+    if (lex->pos < lex->len && s[lex->pos] == '-') {
+        strip = 1;
+        lex->pos++;
+    }
+    while (lex->pos < lex->len && (s[lex->pos] == ' ' || s[lex->pos] == '\t')) lex->pos++;
+    if (lex->pos >= lex->len || is_meta(s[lex->pos])) return -1;
+
+    token_t word;
+    if (lex_word(lex, &word) != 1) return -1;
+    size_t dlen;
+    char* delim = heredoc_delimiter(lex, &word, &dlen);
+    if (!delim) return -1;
+    int literal = word.flags & TOKEN_QUOTED;
+    lex->heredoc.delim = delim;
+    lex->heredoc.len = dlen;
+    lex->heredoc.strip = strip;
+
+    /* le premier corps commence après la ligne courante, les suivants après le délimiteur du précédent */
+    if (!lex->body) {
+        lex->line_end = find_line_end(lex, lex->pos);
+        lex->body = lex->line_end < lex->len ? lex->line_end + 1 : lex->len;
+    }
+
+    /* le champ existe même si le corps est vide */
+    word_t w = { lex->arena, NULL, 0, 0, 0, 0, 1 };
+    if (word_putc(&w, WORD_QUOTES) != 0) return -1;
+
+    size_t p = lex->body;
+    int found = 0;
+    while (p < lex->len) {
+        const char* nl = memchr(s + p, '\n', lex->len - p);
+        size_t e = nl ? (size_t)(nl - s) : lex->len;
+        size_t b = p;
+        if (strip) while (b < e && s[b] == '\t') b++;
+        p = nl ? e + 1 : e;
+        if (e - b == dlen && memcmp(s + b, delim, dlen) == 0) {
+            found = 1;
+            break;
+        }
+
+        for (size_t i = b; i < e; ++i) {
+            char c = s[i];
+            if (!literal && c == '$') {
+                size_t save = lex->pos, len = lex->len;
+                lex->pos = i;
+                lex->len = e;
+                int r = lex_variable(lex, &w, 1);
+                i = lex->pos - 1;
+                lex->pos = save;
+                lex->len = len;
+                if (r != 0) return -1;
+                continue;
+            }
+            if (!literal && c == '\\' && i + 1 < e && (s[i + 1] == '$' || s[i + 1] == '`' || s[i + 1] == '\\')) c = s[++i];
+            if (word_put_literal(&w, c) != 0) return -1;
+        }
+        if (word_putc(&w, '\n') != 0) return -1;
+    }
+    if (!found) lex->unterminated++;
+    lex->body = p;
+
+    if (word_putc(&w, '\0') != 0) return -1;
+    w.buf = arena_realloc(w.arena, w.buf, w.cap, w.len);
+
+    token_t* body = &lex->queued;
+    body->type = TOKEN_WORD;
+    body->op = 0;
+    body->fd = -1;
+    body->target_fd = -1;
+    body->flags = TOKEN_QUOTED | TOKEN_SYMBOLIC;
+    body->text = w.buf;
+    body->len = w.len - 1;
+    lex->has_queued = 1;
+    return 1;
+}
+
+/** @brief Token d'un saut de ligne (fin de la ligne courante). */
+static int lex_newline(token_t* tok) {
+    tok->type = TOKEN_OPERATOR;
+    tok->op = OP_NEWLINE;
+    tok->fd = -1;
+    tok->target_fd = -1;
+    tok->flags = 0;
+    tok->text = "\\n";
+    tok->len = 0;
+    return 1;
+}
+
+int lexer_next(lexer_t* lex, token_t* tok) {
+    if (!lex || !tok) return -1;
+
+    if (lex->has_queued) {
+        *tok = lex->queued;
+        lex->has_queued = 0;
+        return 1;
+    }
+
+    const char* s = lex->line;
+
+    /* blancs, continuations de ligne et commentaire ; à la fin d'une ligne, les corps de ses here-documents sont sautés */
+    while (lex->pos < lex->len) {
+        if (lex->body && lex->pos >= lex->line_end) {
+            lex->pos = lex->body;
+            lex->body = 0;
+            return lex_newline(tok);
+        } else if (s[lex->pos] == '\n') {
+            lex->pos++;
+            return lex_newline(tok);
+        } else if (is_blank(s[lex->pos])) {
+            lex->pos++;
+        } else if (s[lex->pos] == '\\' && lex->pos + 1 < lex->len && s[lex->pos + 1] == '\n') {
+            lex->pos += 2;
+        } else if (s[lex->pos] == '#') {
+            const char* nl = memchr(s + lex->pos, '\n', lex->len - lex->pos);
+            lex->pos = nl ? (size_t)(nl - s) : lex->len;
+        } else {
+            break;
+        }
+    }
+    if (lex->pos >= lex->len || s[lex->pos] == '\0') return 0;
+
+    int r = lex_operator(lex, tok);
+    if (r > 0 && tok->type == TOKEN_REDIRECTION && tok->op == REDIR_HEREDOC) return lex_heredoc(lex);
+    if (r != 0) return r;
+    return lex_word(lex, tok);
+}
+
+int lexer_heredocs(arena_t* arena, const char* line, size_t len, heredoc_t** docs, size_t* num) {
+    lexer_t lex;
+    if (!docs || !num || lexer_init(&lex, line, len, arena) != 0) return -1;
+    *docs = NULL;
+    *num = 0;
+
+    size_t cap = 0;
+    token_t tok;
+    int r;
+    while ((r = lexer_next(&lex, &tok)) > 0) {
+        /* seuls les here-documents dont le délimiteur n'a pas été trouvé attendent la suite de leur corps */
+        if (tok.type != TOKEN_REDIRECTION || tok.op != REDIR_HEREDOC || lex.unterminated == *num) continue;
+        if (*num == cap) {
+            size_t c = cap ? cap * 2 : 4;
+            heredoc_t* d = arena_realloc(arena, *docs, cap * sizeof(heredoc_t), c * sizeof(heredoc_t));
+            if (!d) return -1;
+            *docs = d;
+            cap = c;
+        }
+        (*docs)[(*num)++] = lex.heredoc;
+    }
+    return r < 0 ? -1 : 0;
+}
+
+/**
+ * @brief Sortie d'une substitution de commande en cours d'ajout à un mot.
+ * @struct output_t
+ */
+typedef struct {
+    word_t* w;        ///< Mot en cours d'expansion
+    int split;        ///< Sortie découpée en champs (substitution hors guillemets)
+    size_t newlines;  ///< Sauts de ligne en attente (supprimés s'ils terminent la sortie)
+} output_t;
+
+/** @brief Ajout au mot d'un bloc de la sortie d'une substitution (fonction de type subst_sink_t).
+ * @details Les sauts de ligne ne sont traités qu'à la lecture d'un octet qui les suit : ceux qui terminent la sortie sont ainsi supprimés.
+ *    Hors guillemets, la sortie est découpée en champs sur les blancs. Les octets nuls sont ignorés.
+ */
+static int word_put_output(void* arg, const char* data, size_t len) {
+    output_t* out = arg;
+    word_t* w = out->w;
+    for (size_t i = 0; i < len; ++i) {
+        char c = data[i];
+        if (c == '\0') continue;
+        if (c == '\n') {
+            out->newlines++;
+            continue;
+        }
+        if (out->newlines > 0) {
+            if (out->split && word_end_field(w) != 0) return -1;
+            for (; !out->split && out->newlines > 0; --out->newlines)
+                if (word_putc(w, '\n') != 0) return -1;
+            out->newlines = 0;
+        }
+        if (out->split && is_blank(c)) {
+            if (word_end_field(w) != 0) return -1;
+            continue;
+        }
+        if (word_putc(w, c) != 0) return -1;
+        w->started = 1;
+    }
+    return 0;
+}
+
+/** @brief Ligne intérieure d'une substitution, de *text[from]* jusqu'au WORD_END non protégé, échappements retirés.
+ * @param end Pointeur dans lequel est renvoyée la position du WORD_END.
+ * @return char* Ligne allouée avec *malloc()*, terminée par '\0', NULL en cas de mémoire insuffisante.
+ */
+static char* subst_line(const char* text, size_t len, size_t from, size_t* end) {
+    char* line = malloc(len - from + 1);
+    if (!line) return NULL;
+    size_t n = 0, i = from;
+    for (; i < len && text[i] != WORD_END; ++i) {
+        if (text[i] == WORD_ESCAPE && i + 1 < len) i++;
+        line[n++] = text[i];
+    }
+    line[n] = '\0';
+    *end = i;
+    return line;
+}
+
+/** @brief Exécution de la substitution de commande dont la ligne intérieure commence en *text[from]* ; sa sortie est ajoutée au mot.
+ * @param end Pointeur dans lequel est renvoyée la position du WORD_END qui termine la ligne intérieure.
+ * @return int 0 en cas de succès (quel que soit le code de retour de la ligne intérieure), -1 en cas d'erreur.
+ */
+static int expand_subst(word_t* w, const char* text, size_t len, size_t from, int split, size_t* end) {
+    char* line = subst_line(text, len, from, end);
+    if (!line) return -1;
+
+    output_t out = { w, split, 0 };
+    int r = subst_run(line, word_put_output, &out);
+    free(line);
+    return r < 0 ? -1 : 0;
+}
+
+/** @brief Démarrage de la substitution de processus dont le sens est en *text[from]* ; le chemin de son tube est ajouté au mot.
+ * @param end Pointeur dans lequel est renvoyée la position du WORD_END qui termine la ligne intérieure.
+ * @return int 0 en cas de succès, -1 en cas d'erreur.
+ */
+static int expand_process(word_t* w, const char* text, size_t len, size_t from, size_t* end) {
+    if (from >= len) return -1;
+    char* line = subst_line(text, len, from + 1, end);
+    if (!line) return -1;
+
+    char path[32];
+    int r = subst_process(line, text[from] == '>', path, sizeof(path));
+    free(line);
+    if (r != 0) return -1;
+    w->started = 1;
+    return word_put_value(w, path, 0);
+}
+
+int lexer_expand(arena_t* arena, const char* text, size_t len, int split, char** fields, size_t* num_fields) {
+    if (!arena || !text || !fields || !num_fields) return -1;
+
+    word_t w = { arena, NULL, 0, 0, 0, 0, 0 };
+    for (size_t i = 0; i < len; ++i) {
+        char c = text[i];
+        if (c == WORD_QUOTES) {
+            w.started = 1;
+            continue;
+        }
+        if (c == WORD_VAR || c == WORD_VAR_QUOTED) {
+            const char* name = text + i + 1;
+            const char* end = memchr(name, WORD_END, len - i - 1);
+            if (!end) return -1;
+            char buf[end - name + 1];
+            memcpy(buf, name, end - name);
+            buf[end - name] = '\0';
+
+            const char* val = env_get(buf);
+            if (c == WORD_VAR_QUOTED) w.started = 1;
+            if (val && word_put_value(&w, val, split && c == WORD_VAR) != 0) return -1;
+            i = end - text;
+            continue;
+        }
+        if (c == WORD_SUBST || c == WORD_SUBST_QUOTED) {
+            if (c == WORD_SUBST_QUOTED) w.started = 1;
+            if (expand_subst(&w, text, len, i + 1, split && c == WORD_SUBST, &i) != 0) return -1;
+            continue;
+        }
+        if (c == WORD_PROCESS) {
+            if (expand_process(&w, text, len, i + 1, &i) != 0) return -1;
+            continue;
+        }
+        if (c == WORD_ESCAPE && i + 1 < len) c = text[++i];
+        if (word_putc(&w, c) != 0) return -1;
+        w.started = 1;
+    }
+    if (word_end_field(&w) != 0) return -1;
+    if (w.buf) w.buf = arena_realloc(w.arena, w.buf, w.cap, w.len);
+
+    *fields = w.buf ? w.buf : "";
+    *num_fields = w.fields;
+    return 0;
+}
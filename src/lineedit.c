@@ -0,0 +1,544 @@
+/** @file lineedit.c
+ * @brief Implementation of the interactive line editor
+ * @author Nom1
+ * @author Nom2
+ * @date 2025-26
+ * @details Implémentation de l'éditeur de ligne en mode brut. Les touches sont lues par blocs (un collage n'entraîne pas un appel
+ *   système par caractère) et chaque affichage est envoyé en une seule écriture. Le texte est traité en UTF-8 :
+ *   le curseur se déplace d'un caractère et non d'un octet (chaque caractère compte pour une colonne).
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <termios.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+
+#include "lineedit.h"
+#include "history.h"
+#include "complete.h"
+
+/// Touche obtenue avec Ctrl
+#define KEY_CTRL(c) ((c) & 0x1f)
+/// Taille maximale de la requête de recherche incrémentale
+#define QUERY_SIZE 256
+/// Nombre de candidats de complétion au-delà duquel une confirmation est demandée avant de les afficher
+#define COMPLETION_ASK 100
+
+/// Touches spéciales (séquences d'échappement), hors de l'intervalle des octets
+enum {
+    KEY_NONE = 0,
+    KEY_BACKSPACE = 127,
+    KEY_LEFT = 256,
+    KEY_RIGHT,
+    KEY_UP,
+    KEY_DOWN,
+    KEY_HOME,
+    KEY_END,
+    KEY_DELETE,
+    KEY_EOF
+};
+
+/**
+ * @brief Structure représentant un tampon de texte édité.
+ * @struct line_t
+ */
+typedef struct {
+    char* buf;    ///< Texte, terminé par '\0'
+    size_t len;   ///< Longueur du texte
+    size_t cap;   ///< Capacité du tampon
+    size_t pos;   ///< Position du curseur (octets)
+} line_t;
+
+static line_t line;                 ///< Ligne en cours d'édition
+static line_t saved;                ///< Ligne mise de côté pendant la navigation ou la recherche dans l'historique
+static char screen_buf[4096];       ///< Affichage en cours de construction (écrit en une fois)
+static size_t screen_len = 0;       ///< Longueur de l'affichage
+static char input_buf[256];         ///< Octets lus et non encore traités
+static size_t input_start = 0;      ///< Début des octets non traités
+static size_t input_end = 0;        ///< Fin des octets lus
+static struct termios cooked;       ///< Réglages du terminal hors saisie
+static int raw = 0;                 ///< Terminal en mode brut
+
+int lineedit_available(void) {
+    const char* term = getenv("TERM");
+    return isatty(STDIN_FILENO) && isatty(STDOUT_FILENO) && !(term && strcmp(term, "dumb") == 0);
+}
+
+/** @brief Retour du terminal à ses réglages normaux. */
+static void disable_raw(void) {
+    if (!raw) return;
+    tcsetattr(STDIN_FILENO, TCSAFLUSH, &cooked);
+    raw = 0;
+}
+
+/** @brief Passage du terminal en mode brut : lecture octet par octet, sans écho ni signaux clavier.
+ * @details Le traitement de la sortie (OPOST) est conservé : "\n" reste un retour à la ligne complet.
+ */
+static int enable_raw(void) {
+    static int registered = 0;
+    if (tcgetattr(STDIN_FILENO, &cooked) != 0) return -1;
+    if (!registered) {
+        atexit(disable_raw);
+        registered = 1;
+    }
+
+    struct termios t = cooked;
+    t.c_iflag &= ~(BRKINT | ICRNL | INPCK | ISTRIP | IXON);
+    t.c_cflag |= CS8;
+    t.c_lflag &= ~(ECHO | ICANON | IEXTEN | ISIG);
+    t.c_cc[VMIN] = 1;
+    t.c_cc[VTIME] = 0;
+    if (tcsetattr(STDIN_FILENO, TCSAFLUSH, &t) != 0) return -1;
+    raw = 1;
+    return 0;
+}
+
+/** @brief Largeur du terminal en colonnes (80 si elle est inconnue). */
+static size_t term_width(void) {
+    struct winsize ws;
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &ws) == 0 && ws.ws_col > 0) return ws.ws_col;
+    return 80;
+}
+
+/** @brief Lecture d'un octet (depuis le tampon, rempli par blocs).
+ * @return int Octet lu, -1 en fin de fichier ou en cas d'erreur.
+ */
+static int read_byte(void) {
+    if (input_start == input_end) {
+        ssize_t n;
+        /* un SIGCHLD de job en arrière-plan interrompt la lecture : elle est reprise */
+        do n = read(STDIN_FILENO, input_buf, sizeof(input_buf)); while (n < 0 && errno == EINTR);
+        if (n <= 0) return -1;
+        input_start = 0;
+        input_end = n;
+    }
+    return (unsigned char)input_buf[input_start++];
+}
+
+/** @brief Lecture d'une touche, séquences d'échappement des touches spéciales comprises.
+ * @return int Octet, touche KEY_*, ou KEY_EOF.
+ */
+static int read_key(void) {
+    int c = read_byte();
+    if (c < 0) return KEY_EOF;
+    if (c != 27) return c;
+
+    int c1 = read_byte();
+    if (c1 != '[' && c1 != 'O') return c1 < 0 ? KEY_EOF : KEY_NONE;
+    int c2 = read_byte();
+    if (c2 < 0) return KEY_EOF;
+    if (c1 == '[' && c2 >= '0' && c2 <= '9') {
+        /* séquence "ESC [ n ~" (paramètres éventuels ignorés) */
+        int n = c2 - '0', c3;
+        while ((c3 = read_byte()) >= 0 && c3 != '~' && !(c3 >= 'A' && c3 <= 'Z'))
+            if (c3 >= '0' && c3 <= '9') n = n * 10 + c3 - '0';
+        if (c3 < 0) return KEY_EOF;
+        if (c3 != '~') return KEY_NONE;
+        switch (n) {
+        case 1: case 7: return KEY_HOME;
+        case 4: case 8: return KEY_END;
+        case 3: return KEY_DELETE;
+        default: return KEY_NONE;
+        }
+    }
+    switch (c2) {
+    case 'A': return KEY_UP;
+    case 'B': return KEY_DOWN;
+    case 'C': return KEY_RIGHT;
+    case 'D': return KEY_LEFT;
+    case 'H': return KEY_HOME;
+    case 'F': return KEY_END;
+    default: return KEY_NONE;
+    }
+}
+
+/** @brief Octet de continuation UTF-8 (ne commence pas un caractère). */
+static int is_continuation(char c) {
+    return ((unsigned char)c & 0xC0) == 0x80;
+}
+
+/** @brief Position du caractère précédant *pos*. */
+static size_t prev_char(const char* s, size_t pos) {
+    while (pos > 0 && is_continuation(s[--pos])) {}
+    return pos;
+}
+
+/** @brief Position du caractère suivant *pos*. */
+static size_t next_char(const char* s, size_t len, size_t pos) {
+    while (pos < len && is_continuation(s[++pos])) {}
+    return pos;
+}
+
+/** @brief Nombre de colonnes occupées par [*s*, *s* + *len*). */
+static size_t columns(const char* s, size_t len) {
+    size_t n = 0;
+    for (size_t i = 0; i < len; ++i) n += !is_continuation(s[i]);
+    return n;
+}
+
+/** @brief Agrandissement d'un tampon de texte pour contenir *len* octets (plus '\0'). */
+static int line_reserve(line_t* l, size_t len) {
+    if (len + 1 <= l->cap) return 0;
+    size_t cap = l->cap ? l->cap : 256;
+    while (cap < len + 1) cap *= 2;
+    char* buf = realloc(l->buf, cap);
+    if (!buf) return -1;
+    l->buf = buf;
+    l->cap = cap;
+    return 0;
+}
+
+/** @brief Remplacement du texte d'un tampon (curseur en fin de texte). */
+static int line_set(line_t* l, const char* s, size_t len) {
+    if (line_reserve(l, len) != 0) return -1;
+    memmove(l->buf, s, len);
+    l->buf[len] = '\0';
+    l->len = l->pos = len;
+    return 0;
+}
+
+/** @brief Insertion de *n* octets au curseur. */
+static int line_insert(line_t* l, const char* s, size_t n) {
+    if (line_reserve(l, l->len + n) != 0) return -1;
+    memmove(l->buf + l->pos + n, l->buf + l->pos, l->len - l->pos + 1);
+    memcpy(l->buf + l->pos, s, n);
+    l->len += n;
+    l->pos += n;
+    return 0;
+}
+
+/** @brief Suppression de [*from*, *to*) ; le curseur est placé en *from*. */
+static void line_erase(line_t* l, size_t from, size_t to) {
+    if (from >= to) return;
+    memmove(l->buf + from, l->buf + to, l->len - to + 1);
+    l->len -= to - from;
+    l->pos = from;
+}
+
+/** @brief Ajout d'octets à l'affichage en cours (écrit d'abord si le tampon est plein). */
+static void screen_append(const char* s, size_t n) {
+    while (n > 0) {
+        if (screen_len == sizeof(screen_buf)) {
+            if (write(STDOUT_FILENO, screen_buf, screen_len) < 0) {}
+            screen_len = 0;
+        }
+        size_t k = sizeof(screen_buf) - screen_len;
+        if (k > n) k = n;
+        memcpy(screen_buf + screen_len, s, k);
+        screen_len += k;
+        s += k;
+        n -= k;
+    }
+}
+
+/** @brief Écriture de l'affichage en cours. */
+static void screen_flush(void) {
+    if (screen_len > 0 && write(STDOUT_FILENO, screen_buf, screen_len) < 0) {}
+    screen_len = 0;
+}
+
+/** @brief Affichage de la ligne : prompt, partie visible du texte (défilement horizontal), puis curseur.
+ * @details La fenêtre visible est calculée en O(largeur du terminal) : le texte est parcouru depuis le curseur
+ *    vers la gauche puis vers la droite, sans mesurer toute la ligne.
+ */
+static void refresh(const char* prompt, const char* text, size_t len, size_t pos) {
+    size_t width = term_width();
+    size_t plen = columns(prompt, strlen(prompt));
+    size_t avail = width > plen + 1 ? width - plen - 1 : 1;
+
+    size_t start = pos, before = 0;
+    while (start > 0 && before < avail) {
+        start = prev_char(text, start);
+        before++;
+    }
+    size_t end = pos, shown = before;
+    while (end < len && shown < avail) {
+        end = next_char(text, len, end);
+        shown++;
+    }
+
+    screen_append("\r", 1);
+    screen_append(prompt, strlen(prompt));
+    screen_append(text + start, end - start);
+    screen_append("\x1b[K\r", 4);
+    if (plen + before > 0) {
+        char move[32];
+        int n = snprintf(move, sizeof(move), "\x1b[%zuC", plen + before);
+        screen_append(move, n);
+    }
+    screen_flush();
+}
+
+/** @brief Recherche de *query* dans l'historique avant la position *from* ; la ligne prend l'entrée trouvée.
+ * @param match Pointeur vers le début de l'entrée courante, mis à jour en cas de succès.
+ * @return int 1 si une entrée a été trouvée, 0 sinon.
+ */
+static int search_from(const char* query, size_t qlen, size_t from, size_t* match) {
+    size_t pos = from, n;
+    const char* e = history_search(query, qlen, &pos, &n);
+    if (!e) return 0;
+    line_set(&line, e, n);
+    const char* at = memmem(line.buf, line.len, query, qlen);
+    line.pos = at ? (size_t)(at - line.buf) : line.len;
+    *match = pos;
+    return 1;
+}
+
+/** @brief Recherche incrémentale en arrière (Ctrl-R).
+ * @return int Touche qui a terminé la recherche, à traiter par l'éditeur (KEY_NONE après Ctrl-G).
+ * @details Chaque caractère tapé complète la requête et relance la recherche à partir de l'entrée courante, Ctrl-R passe à une entrée plus ancienne,
+ *    Retour arrière raccourcit la requête et relance la recherche depuis la fin. Ctrl-G (ou Ctrl-C) rétablit la ligne d'origine ;
+ *    toute autre touche conserve l'entrée trouvée et est ensuite traitée normalement (Entrée l'exécute).
+ */
+static int reverse_search(void) {
+    char query[QUERY_SIZE];
+    size_t qlen = 0;
+    int failed = 0;
+    size_t match = history_end() + 1;
+    line_set(&saved, line.buf ? line.buf : "", line.len);
+    saved.pos = line.pos;
+
+    while (1) {
+        char prompt[QUERY_SIZE + 64];
+        snprintf(prompt, sizeof(prompt), "(%sreverse-i-search)`%.*s': ", failed ? "failed " : "", (int)qlen, query);
+        refresh(prompt, line.buf ? line.buf : "", line.len, line.pos);
+
+        int c = read_key();
+        if (c == KEY_CTRL('r')) {
+            if (qlen > 0) failed = !search_from(query, qlen, match, &match);
+        } else if (c == KEY_BACKSPACE || c == KEY_CTRL('h')) {
+            if (qlen > 0) qlen = prev_char(query, qlen);
+            match = history_end() + 1;
+            failed = qlen > 0 && !search_from(query, qlen, match, &match);
+            if (qlen == 0) line_set(&line, saved.buf, saved.len);
+        } else if (c == KEY_CTRL('g') || c == KEY_CTRL('c')) {
+            line_set(&line, saved.buf, saved.len);
+            line.pos = saved.pos;
+            return c == KEY_CTRL('c') ? c : KEY_NONE;
+        } else if (c >= 32 && c < 256 && c != KEY_BACKSPACE) {
+            if (qlen + 1 < sizeof(query)) {
+                query[qlen++] = (char)c;
+                /* l'entrée courante peut encore convenir à la requête complétée */
+                failed = !search_from(query, qlen, match + 1, &match);
+            }
+        } else {
+            return c;
+        }
+    }
+}
+
+/** @brief Affichage des candidats d'une complétion en colonnes, sous la ligne en cours.
+ * @details Au-delà de COMPLETION_ASK candidats, l'affichage doit d'abord être confirmé.
+ */
+static void list_candidates(const completion_t* c) {
+    if (c->count > COMPLETION_ASK) {
+        char question[96];
+        int n = snprintf(question, sizeof(question), "\nAfficher les %zu possibilités ? (o/n)", c->count);
+        screen_append(question, n);
+        screen_flush();
+        int answer = read_key();
+        if (answer != 'o' && answer != 'O' && answer != 'y' && answer != 'Y') {
+            screen_append("\n", 1);
+            return;
+        }
+    }
+
+    size_t width = 0;
+    for (size_t i = 0; i < c->count; ++i) {
+        size_t w = columns(c->items[i] + c->display, strlen(c->items[i] + c->display));
+        if (w > width) width = w;
+    }
+    width += 2;
+    size_t per_row = term_width() / width;
+    if (per_row == 0) per_row = 1;
+    size_t rows = (c->count + per_row - 1) / per_row;
+
+    /* rangement par colonnes, comme ls */
+    screen_append("\n", 1);
+    for (size_t r = 0; r < rows; ++r) {
+        for (size_t i = r; i < c->count; i += rows) {
+            const char* item = c->items[i] + c->display;
+            size_t len = strlen(item);
+            screen_append(item, len);
+            if (i + rows < c->count)
+                for (size_t pad = columns(item, len); pad < width; ++pad) screen_append(" ", 1);
+        }
+        screen_append("\n", 1);
+    }
+}
+
+/** @brief Complétion du mot situé avant le curseur (Tab).
+ * @param again La touche précédente était déjà Tab.
+ * @details Un candidat unique remplace le mot (suivi d'une espace, sauf pour un répertoire) ; sinon le mot est complété par le plus long
+ *    préfixe commun des candidats et, s'il n'y a rien à compléter, un second Tab affiche la liste.
+ */
+static void complete(int again) {
+    completion_t c = {0};
+    size_t start;
+    int n = complete_word(line.buf, line.pos, &start, &c);
+    if (n <= 0) {
+        screen_append("\a", 1);
+        completion_free(&c);
+        return;
+    }
+
+    size_t common = strlen(c.items[0]);
+    for (size_t i = 1; i < c.count; ++i) {
+        size_t k = 0;
+        while (k < common && c.items[i][k] == c.items[0][k]) k++;
+        common = k;
+    }
+    /* pas de caractère UTF-8 coupé */
+    while (common > 0 && is_continuation(c.items[0][common])) common--;
+
+    if (n == 1 || common > line.pos - start) {
+        line_erase(&line, start, line.pos);
+        line_insert(&line, c.items[0], common);
+        if (n == 1 && c.items[0][common - 1] != '/') line_insert(&line, " ", 1);
+    } else if (again) {
+        list_candidates(&c);
+    } else {
+        screen_append("\a", 1);
+    }
+    completion_free(&c);
+}
+
+char* lineedit_read(const char* prompt, size_t* len) {
+    if (!prompt) prompt = "";
+    fflush(stdout);
+    if (line_set(&line, "", 0) != 0 || enable_raw() != 0) return NULL;
+
+    /* navigation dans l'historique : position de l'entrée affichée, la ligne saisie est mise de côté */
+    int browsing = 0;
+    size_t hist_pos = 0;
+    int done = 0, eof = 0, last = KEY_NONE;
+
+    refresh(prompt, line.buf, line.len, line.pos);
+    while (!done) {
+        int c = read_key();
+        if (c == KEY_CTRL('r')) {
+            c = reverse_search();
+            browsing = 0;
+        }
+
+        switch (c) {
+        case KEY_NONE:
+            break;
+        case '\r':
+        case '\n':
+            done = 1;
+            break;
+        case KEY_EOF:
+            eof = done = 1;
+            break;
+        case KEY_CTRL('c'):
+            screen_append("^C", 2);
+            line_set(&line, "", 0);
+            done = 1;
+            break;
+        case KEY_CTRL('d'):
+            if (line.len == 0) {
+                eof = done = 1;
+                break;
+            }
+            /* fall through */
+        case KEY_DELETE:
+            line_erase(&line, line.pos, next_char(line.buf, line.len, line.pos));
+            break;
+        case KEY_BACKSPACE:
+        case KEY_CTRL('h'):
+            line_erase(&line, prev_char(line.buf, line.pos), line.pos);
+            break;
+        case KEY_LEFT:
+        case KEY_CTRL('b'):
+            line.pos = prev_char(line.buf, line.pos);
+            break;
+        case KEY_RIGHT:
+        case KEY_CTRL('f'):
+            line.pos = next_char(line.buf, line.len, line.pos);
+            break;
+        case KEY_HOME:
+        case KEY_CTRL('a'):
+            line.pos = 0;
+            break;
+        case KEY_END:
+        case KEY_CTRL('e'):
+            line.pos = line.len;
+            break;
+        case KEY_CTRL('k'):
+            line_erase(&line, line.pos, line.len);
+            break;
+        case KEY_CTRL('u'):
+            line_erase(&line, 0, line.pos);
+            break;
+        case KEY_CTRL('w'): {
+            size_t p = line.pos;
+            while (p > 0 && line.buf[p - 1] == ' ') p--;
+            while (p > 0 && line.buf[p - 1] != ' ') p--;
+            line_erase(&line, p, line.pos);
+            break;
+        }
+        case '\t':
+            complete(last == '\t');
+            break;
+        case KEY_CTRL('l'):
+            screen_append("\x1b[H\x1b[2J", 7);
+            break;
+        case KEY_UP:
+        case KEY_CTRL('p'): {
+            if (!browsing) {
+                line_set(&saved, line.buf, line.len);
+                hist_pos = history_end();
+            }
+            size_t p = hist_pos, n;
+            const char* e = history_prev(&p, &n);
+            if (e) {
+                browsing = 1;
+                hist_pos = p;
+                line_set(&line, e, n);
+            }
+            break;
+        }
+        case KEY_DOWN:
+        case KEY_CTRL('n'): {
+            if (!browsing) break;
+            size_t p = hist_pos, n;
+            const char* e = history_next(&p, &n);
+            if (e) {
+                hist_pos = p;
+                line_set(&line, e, n);
+            } else {
+                /* après l'entrée la plus récente : retour à la ligne saisie */
+                browsing = 0;
+                line_set(&line, saved.buf, saved.len);
+            }
+            break;
+        }
+        default:
+            /* caractères imprimables et octets UTF-8 ; les autres caractères de contrôle sont ignorés */
+            if (c >= 32 && c < 256) {
+                char ch = (char)c;
+                line_insert(&line, &ch, 1);
+            }
+            break;
+        }
+
+        last = c;
+        /* touches déjà reçues (collage) : un seul affichage après la dernière */
+        if (!done && input_start == input_end) refresh(prompt, line.buf, line.len, line.pos);
+    }
+
+    /* curseur en fin de ligne avant de passer à la ligne suivante */
+    if (!eof) refresh(prompt, line.buf, line.len, line.len);
+    screen_append("\n", 1);
+    screen_flush();
+    disable_raw();
+
+    if (eof) return NULL;
+    if (len) *len = line.len;
+    return line.buf;
+}
@@ -7,6 +7,7 @@
  *   incluant l'affichage du prompt, la lecture de la ligne de commande, le parsing et l'exécution.
  */
 
+#define _GNU_SOURCE
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -14,86 +15,425 @@
 
 #include <termios.h>    // ← AJOUTE
 #include <unistd.h>     // ← AJOUTE
+#include <fcntl.h>
 
 #include "parser.h"
 #include "processus.h"
 #include "builtins.h"
+#include "jobs.h"
+#include "env.h"
+#include "input.h"
+#include "trace.h"
+#include "history.h"
+#include "lineedit.h"
+#include "lexer.h"
+#include "zygote.h"
+#include "scheduler.h"
 
-/** @brief Affiche le prompt du shell.
- * @details Affiche le prompt "$ " et force l'affichage immédiat avec fflush.
- *   Cette fonction peut être modifiée pour afficher des informations supplémentaires (CWD, utilisateur, etc.).
+/** @brief Construit le prompt du shell.
+ * @param buf Tampon recevant le prompt.
+ * @param size Taille du tampon.
+ * @details Signale d'abord les jobs terminés ou suspendus depuis le dernier prompt, puis écrit le répertoire courant suivi de "$ ".
+ *   Cette fonction peut être modifiée pour afficher des informations supplémentaires (utilisateur, etc.).
  */
-void prompt() {
+static void build_prompt(char* buf, size_t size) {
+    job_notify(STDERR_FILENO);
+
     char cwd[512];
-    getcwd(cwd, sizeof(cwd));
-    printf("%s$ ", cwd);
-    fflush(stdout);
+    if (!getcwd(cwd, sizeof(cwd))) cwd[0] = '\0';
+    snprintf(buf, size, "%s$ ", cwd);
+}
+
+/** @brief Ouvre l'historique des commandes de l'éditeur de ligne.
+ * @details Le fichier est celui désigné par MINISHELL_HISTFILE, à défaut $HOME/.minishell_history. Sans fichier utilisable, l'éditeur fonctionne sans historique.
+ */
+static void open_history(void) {
+    const char* path = env_get(HISTORY_ENV);
+    char buf[4096];
+    if (!path || !*path) {
+        const char* home = env_get("HOME");
+        if (!home || !*home) return;
+        snprintf(buf, sizeof(buf), "%s/%s", home, HISTORY_DEFAULT_NAME);
+        path = buf;
+    }
+    history_open(path);
+}
+
+
+/** @brief Lit une ligne, avec l'éditeur de ligne ou depuis la source des commandes.
+ * @param in Source des commandes (sans éditeur).
+ * @param editing L'éditeur de ligne est utilisé.
+ * @param prompt Prompt à afficher (NULL pour aucun).
+ * @param len Pointeur dans lequel est renvoyée la longueur de la ligne.
+ * @return char* Ligne lue (valide jusqu'à la lecture suivante), NULL en fin de saisie.
+ */
+static char* read_line(input_t* in, int editing, const char* prompt, size_t* len) {
+    if (editing) return lineedit_read(prompt, len);
+    if (prompt) {
+        fputs(prompt, stdout);
+        fflush(stdout);
+    }
+    return input_read_line(in, len);
+}
+
+/** @brief Indique si une ligne se termine par une continuation : un '\\' non protégé, hors apostrophes et hors commentaire.
+ * @param s Ligne lue (sans son saut de ligne).
+ * @param len Longueur de la ligne.
+ * @return int 1 si la ligne se poursuit sur la suivante, 0 sinon.
+ */
+static int ends_with_continuation(const char* s, size_t len) {
+    char quote = 0;
+    for (size_t i = 0; i < len; ++i) {
+        char c = s[i];
+        if (quote == '\'') {
+            if (c == '\'') quote = 0;
+        } else if (c == '\\') {
+            if (i + 1 == len) return 1;
+            i++;
+        } else if (quote) {
+            if (c == '"') quote = 0;
+        } else if (c == '\'' || c == '"') {
+            quote = c;
+        } else if (c == '#' && (i == 0 || strchr(" \t;&|()<>", s[i - 1]))) {
+            return 0;
+        }
+    }
+    return 0;
+}
+
+/** @brief Joint à une ligne terminée par une continuation ("\\" en fin de ligne) les lignes suivantes.
+ * @param in Source des commandes (sans éditeur).
+ * @param editing L'éditeur de ligne est utilisé.
+ * @param interactive Le prompt secondaire "> " est affiché avant chaque ligne.
+ * @param line Ligne lue.
+ * @param len Pointeur vers la longueur de la ligne, remplacée par celle du texte renvoyé.
+ * @return char* *line* si elle ne se poursuit pas, sinon les lignes mises bout à bout, sans leurs '\\' finaux ni leurs sauts de ligne
+ *    (comme pour sh, "echo a\\" suivi de "b" donne "echo ab"), NULL en cas d'erreur.
+ * @details La jonction est faite avant l'analyse : le lexeur ne reçoit qu'une ligne à la fois et ne peut pas lire la suivante.
+ *    Si la saisie se termine après une continuation, le '\\' final est ignoré.
+ */
+static char* read_continued_line(input_t* in, int editing, int interactive, char* line, size_t* len) {
+    static char* text = NULL;
+    static size_t cap = 0;
+
+    if (!ends_with_continuation(line, *len)) return line;
+
+    size_t used = 0;
+    while (1) {
+        int more = ends_with_continuation(line, *len);
+        size_t n = more ? *len - 1 : *len;
+        if (used + n + 1 > cap) {
+            size_t c = cap ? cap : 4096;
+            while (c < used + n + 1) c *= 2;
+            char* t = realloc(text, c);
+            if (!t) {
+                perror("realloc");
+                return NULL;
+            }
+            text = t;
+            cap = c;
+        }
+        memcpy(text + used, line, n);
+        used += n;
+        text[used] = '\0';
+        if (!more) break;
+
+        line = read_line(in, editing, interactive ? "> " : NULL, len);
+        if (!line) break;
+        if (editing && *len > 0) history_add(line, *len);
+    }
+    *len = used;
+    return text;
+}
+
+/** @brief Lit le corps des here-documents introduits par une ligne.
+ * @param cmdl Ligne de commande dont l'arène reçoit les délimiteurs.
+ * @param in Source des commandes (sans éditeur).
+ * @param editing L'éditeur de ligne est utilisé.
+ * @param interactive Le prompt secondaire "> " est affiché avant chaque ligne.
+ * @param line Ligne lue.
+ * @param len Pointeur vers la longueur de la ligne, remplacée par celle du texte renvoyé.
+ * @return char* *line* si elle n'a pas de here-document, sinon le texte complet : la ligne suivie des lignes des corps jusqu'à leurs délimiteurs (séparées par '\n').
+ * @details Une erreur de syntaxe est laissée à l'analyse de la ligne. Si la saisie se termine avant un délimiteur, un avertissement est affiché
+ *    et le corps s'étend jusqu'à la fin de la saisie.
+ */
+static char* read_heredocs(command_line_t* cmdl, input_t* in, int editing, int interactive, char* line, size_t* len) {
+    static char* text = NULL;
+    static size_t cap = 0;
+
+    heredoc_t* docs;
+    size_t num;
+    if (!memmem(line, *len, "<<", 2) || lexer_heredocs(&cmdl->arena, line, *len, &docs, &num) != 0 || num == 0) return line;
+
+    size_t used = 0, i = 0;
+    while (1) {
+        // Ajout de la ligne lue (la première, puis celles des corps)
+        if (used + *len + 2 > cap) {
+            size_t c = cap ? cap : 4096;
+            while (c < used + *len + 2) c *= 2;
+            char* t = realloc(text, c);
+            if (!t) {
+                perror("realloc");
+                return line;
+            }
+            text = t;
+            cap = c;
+        }
+        if (used > 0) text[used++] = '\n';
+        memcpy(text + used, line, *len);
+        used += *len;
+        text[used] = '\0';
+        if (i == num) break;
+
+        // Lignes du corps du here-document i, jusqu'à son délimiteur
+        line = read_line(in, editing, interactive ? "> " : NULL, len);
+        if (!line) {
+            fprintf(stderr, "avertissement : here-document délimité par la fin de fichier (« %s » attendu)\n", docs[i].delim);
+            break;
+        }
+        const char* l = line;
+        size_t n = *len;
+        if (docs[i].strip)
+            while (n > 0 && *l == '\t') { l++; n--; }
+        if (n == docs[i].len && memcmp(l, docs[i].delim, n) == 0) i++;
+    }
+    *len = used;
+    return text;
+}
+
+/** @brief Lit la ligne suivante d'une commande incomplète (boucle non fermée) et l'ajoute au texte déjà lu.
+ * @param cmdl Ligne de commande dont l'arène reçoit les délimiteurs des here-documents.
+ * @param in Source des commandes (sans éditeur).
+ * @param editing L'éditeur de ligne est utilisé.
+ * @param interactive Le prompt secondaire "> " est affiché.
+ * @param line Texte déjà lu.
+ * @param len Pointeur vers la longueur du texte, remplacée par celle du texte renvoyé.
+ * @return char* Texte complet (lignes séparées par '\n', corps des nouveaux here-documents compris), NULL en fin de saisie ou en cas d'erreur.
+ */
+static char* read_continuation(command_line_t* cmdl, input_t* in, int editing, int interactive, char* line, size_t* len) {
+    static char* text = NULL;
+    static size_t cap = 0;
+
+    size_t used = *len;
+    // Le texte déjà lu est mis à l'abri : la lecture suivante réutilise le tampon de la ligne
+    if (line != text) {
+        if (used + 1 > cap) {
+            size_t c = cap ? cap : 4096;
+            while (c < used + 1) c *= 2;
+            char* t = realloc(text, c);
+            if (!t) {
+                perror("realloc");
+                return NULL;
+            }
+            text = t;
+            cap = c;
+        }
+        memcpy(text, line, used);
+    }
+
+    size_t n;
+    char* next = read_line(in, editing, interactive ? "> " : NULL, &n);
+    if (!next) return NULL;
+    if (editing && n > 0) history_add(next, n);
+    if (!(next = read_continued_line(in, editing, interactive, next, &n))) return NULL;
+    if (used + n + 2 > cap) {
+        size_t c = cap ? cap : 4096;
+        while (c < used + n + 2) c *= 2;
+        char* t = realloc(text, c);
+        if (!t) {
+            perror("realloc");
+            return NULL;
+        }
+        text = t;
+        cap = c;
+    }
+    text[used++] = '\n';
+    memcpy(text + used, next, n);
+    used += n;
+    text[used] = '\0';
+    *len = used;
+    return read_heredocs(cmdl, in, editing, interactive, text, len);
+}
+
+/** @brief Active l'ordonnanceur parallèle avec le nombre de jobs donné en argument de -j.
+ * @param arg Nombre de jobs exécutés en même temps (de 1 à SCHED_MAX_JOBS).
+ * @return int 0 en cas de succès, -1 si l'argument n'est pas un nombre valide.
+ */
+static int parse_jobs(const char* arg) {
+    char* end;
+    long n = strtol(arg, &end, 10);
+    if (*arg < '0' || *arg > '9' || *end || n < 1 || n > SCHED_MAX_JOBS) return -1;
+    return sched_set_limit((unsigned)n);
+}
+
+/** @brief Affiche la syntaxe d'appel du shell sur stderr.
+ * @param name Nom du programme.
+ */
+static void usage(const char* name) {
+    fprintf(stderr, "usage: %s [-i] [-z] [-j jobs] [-c commandes | script]\n", name);
 }
 
 
 /** @brief Fonction principale du shell.
- * @param argc Nombre d'arguments (non utilisé).
- * @param argv Tableau des arguments (non utilisé).
- * @return int Code de retour du programme. Ce code pourrait être le code de retour du dernier processus exécuté (optionnel).
+ * @param argc Nombre d'arguments.
+ * @param argv Tableau des arguments : [-i] [-z] [-j jobs] [-c commandes | script].
+ * @return int Code de retour du programme : celui de la dernière ligne de commandes exécutée (2 en cas d'erreur de syntaxe).
  * @details Cette fonction gère la boucle principale du shell:
- * - Affiche le prompt
+ * - Affiche le prompt (en mode interactif uniquement)
  * - Lit la ligne de commande
  * - Parse la ligne de commande
  * - Exécute les commandes
+ * Les lignes sont lues depuis la chaîne passée avec -c, depuis le fichier *script*, ou à défaut depuis l'entrée standard.
+ * Le shell est interactif (prompt, réglages du terminal, contrôle des jobs) si les commandes sont lues sur l'entrée standard et que c'est un terminal, ou avec -i.
+ * Avec -z, les commandes externes au premier plan sont lancées par un serveur de lancement créé au démarrage (voir zygote.h), sauf avec le contrôle des jobs.
+ * Avec -j N, les listes indépendantes sont exécutées en parallèle par l'ordonnanceur, au plus N à la fois (voir scheduler.h) ;
+ * en mode interactif, elles sont toutes attendues avant le prompt suivant.
  * En cas d'erreur lors de l'exécution, un message est affiché sur stderr et la boucle continue.
  * Le shell se termine proprement en cas d'EOF (Ctrl+D) ou d'erreur fatale.
  */
 int main(int argc, char* argv[]) {
-    (void) argc; // Pour éviter les warnings inutilisés
-    (void) argv; // Pour éviter les warnings inutilisés
+    // Les descripteurs 0, 1 et 2 doivent exister : sinon un tube ou un fichier ouvert par le shell (O_CLOEXEC) prendrait leur numéro et serait fermé à l'execve() de la commande
+    for (int fd = STDIN_FILENO; fd <= STDERR_FILENO; ++fd)
+        if (fcntl(fd, F_GETFD) < 0 && open("/dev/null", O_RDWR) < 0) return 2;
+
+    // Analyse des options
+    const char* command_string = NULL;
+    const char* script = NULL;
+    int force_interactive = 0;
+    int use_zygote = 0;
+    int i = 1;
+    for (; i < argc && argv[i][0] == '-'; ++i) {
+        if (strcmp(argv[i], "--") == 0) { ++i; break; }
+        if (strcmp(argv[i], "-i") == 0) { force_interactive = 1; continue; }
+        if (strcmp(argv[i], "-z") == 0) { use_zygote = 1; continue; }
+        if (strncmp(argv[i], "-j", 2) == 0) {
+            const char* jobs = argv[i][2] ? argv[i] + 2 : (i + 1 < argc ? argv[++i] : "");
+            if (parse_jobs(jobs) == 0) continue;
+        }
+        if (strcmp(argv[i], "-c") == 0 && i + 1 < argc) { command_string = argv[++i]; continue; }
+        usage(argv[0]);
+        return 2;
+    }
+    if (!command_string && i < argc) script = argv[i];
+
+    // Serveur de lancement créé avant toute autre allocation ou ouverture : l'auxiliaire reste minuscule et n'hérite d'aucun descripteur
+    if (use_zygote && zygote_start() != 0) perror("zygote");
+
+    // Traçage de l'exécution au format Chrome trace si MINISHELL_TRACE désigne un fichier
+    trace_init(getenv(TRACE_ENV));
+
+    // Source des lignes de commandes
+    input_t in;
+    if (command_string) {
+        if (input_open_string(&in, command_string) != 0) return 2;
+    } else if (script) {
+        if (input_open_file(&in, script) != 0) {
+            perror(script);
+            return 127;
+        }
+    } else {
+        input_open_fd(&in, STDIN_FILENO);
+    }
+    int interactive = force_interactive || (!command_string && !script && isatty(STDIN_FILENO));
+
     // Initialisation des structures nécessaires
-    command_line_t cmdl;
+    // Structure de ligne de commande (l'arène qu'elle contient doit être initialisée à zéro)
+    command_line_t cmdl = {0};
+    // Code de retour de la dernière ligne exécutée
+    int status = 0;
 
-    // Boucle principale du shell
-    signal(SIGINT, SIG_IGN);//ignorer sigint dans le shell , Le shell ignore Ctrl+C
-    
-     // NOUVEAU : Désactiver l'affichage de ^C
-    struct termios term;
-    tcgetattr(STDIN_FILENO, &term);      // Récupérer les attributs actuels
-    term.c_lflag &= ~ECHOCTL;            // Désactiver l'écho des caractères de contrôle
-    tcsetattr(STDIN_FILENO, TCSANOW, &term);  // Appliquer
+    if (interactive) {
+        signal(SIGINT, SIG_IGN);//ignorer sigint dans le shell , Le shell ignore Ctrl+C
+
+        // Désactiver l'affichage de ^C
+        struct termios term;
+        if (tcgetattr(STDIN_FILENO, &term) == 0) {
+            term.c_lflag &= ~ECHOCTL;            // Désactiver l'écho des caractères de contrôle
+            tcsetattr(STDIN_FILENO, TCSANOW, &term);  // Appliquer
+        }
+    }
 
+    // Variables du shell, importées de l'environnement reçu
+    extern char** environ;
+    env_init(environ);
+
+    // Table des jobs et, en mode interactif sur un terminal, contrôle des jobs (groupes de processus, passage du terminal)
+    job_control_init(interactive);
+    // Les fils du serveur de lancement ne peuvent pas rejoindre le groupe d'un job : inutile avec le contrôle des jobs
+    if (job_control_enabled()) zygote_stop();
+
+    // Éditeur de ligne et historique persistant, si le shell interactif lit un terminal
+    int editing = interactive && !command_string && !script && lineedit_available();
+    if (editing) open_history();
+
+    // Les commandes intégrées écrivent depuis le shell : une sortie fermée doit donner EPIPE et non tuer le shell (SIGPIPE est rétabli dans les fils)
+    signal(SIGPIPE, SIG_IGN);
+
+    // Boucle principale du shell
     while (1) {
         // Initialisation de la structure de ligne de commande
         // On s'assure ici que tous les champs sont remis à zéro ou à leur valeur par défaut
         init_command_line(&cmdl);
-        prompt();
-
-        // Lecture de la ligne de commande
-        if (fgets(cmdl.command_line, sizeof(cmdl.command_line), stdin) == NULL) {
+        // Lecture de la ligne de commande (sans limite de longueur, saut de ligne final retiré)
+        char buf[520];
+        if (interactive) build_prompt(buf, sizeof(buf));
+        else job_notify(-1);
+        size_t len;
+        char* line = read_line(&in, editing, interactive ? buf : NULL, &len);
+        if (editing && line && len > 0) history_add(line, len);
+        if (line == NULL) {
             // EOF ou erreur de lecture (provoqué par exemple par Ctrl+D)
-            processus_t exit_cmd;
-            init_processus(&exit_cmd);
-            exit_cmd.argv[0] = "exit";
-            builtin_exit(&exit_cmd);
-        }
-        // Suppression du saut de ligne final conservé par fgets
-        if (strlen(cmdl.command_line) > 0 && cmdl.command_line[strlen(cmdl.command_line) - 1] == '\n') {
-            cmdl.command_line[strlen(cmdl.command_line) - 1] = '\0';
+            break;
         }
 
         // La ligne de commande est vide, on passe à la suivante
-        if (strlen(cmdl.command_line) == 0) {
+        if (len == 0) {
             continue;
         }
 
-        // Parsing de la ligne de commande
-        if (parse_command_line(&cmdl, cmdl.command_line) != 0) {
+        // Ligne terminée par "\\" : elle se poursuit sur la suivante
+        if (!(line = read_continued_line(&in, editing, interactive, line, &len))) break;
+
+        // Corps des here-documents, lus sur les lignes suivantes
+        line = read_heredocs(&cmdl, &in, editing, interactive, line, &len);
+
+        // Parsing de la ligne de commande ; une boucle non fermée se poursuit sur les lignes suivantes
+        int r;
+        while ((r = parse_command_line(&cmdl, line)) > 0) {
+            init_command_line(&cmdl);
+            if (!(line = read_continuation(&cmdl, &in, editing, interactive, line, &len))) break;
+        }
+        // Une erreur de syntaxe suit, dans l'ordre du script, les listes confiées à l'ordonnanceur : son code de retour l'emporte
+        if (r != 0) sched_drain(NULL);
+        if (r > 0) {
+            fprintf(stderr, "Erreur de syntaxe : boucle non terminée en fin de fichier\n");
+            status = 2;
+            break;
+        }
+        if (r != 0) {
             fprintf(stderr, "Erreur lors de l'analyse de la ligne de commandes.\n");
+            status = 2;
             continue;
         }
-        
+
+        // Les commandes lancées lisent la suite de l'entrée standard, et non le bloc déjà lu par le shell
+        input_sync(&in);
+
         // Traitement de la ligne de commande
-        if (launch_command_line(&cmdl) != 0) {
+        if (schedule_command_line(&cmdl) != 0) {
             fprintf(stderr, "Erreur à l'exécution de la ligne de commandes.\n");
             continue;
         }
+        status = cmdl.status;
+        // Ordonnanceur en mode interactif : la sortie de la ligne est complète avant le prompt suivant
+        if (interactive) sched_drain(&status);
     }
 
-    return 0;
+    // Jobs de l'ordonnanceur encore en cours : le code de retour est celui de la dernière liste du script
+    sched_drain(&status);
+    if (editing) history_close();
+    zygote_stop();
+    input_close(&in);
+    arena_destroy(&cmdl.arena);
+    return status;
 }
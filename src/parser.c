@@ -19,6 +19,9 @@
 
 #include "parser.h"
 #include "processus.h"
+#include "plan.h"
+#include "env.h"
+#include "trace.h"
 
 /** @brief Fonction de suppression des espaces inutiles au début et à la fin d'une chaîne de caractères.
  * @param str Chaîne de caractères à traiter.
@@ -185,7 +188,7 @@ int substenv(char* str, size_t max) {
             var[vi] = '\0';
             i--;
 
-            char* val = getenv(var);
+            const char* val = env_get(var);
             if (!val) val = "";
 
             if (strlen(buffer) + strlen(val) >= max) return -1;
@@ -237,247 +240,29 @@ int strcut(char* str, char sep, char** tokens, size_t max) {
 /** @brief Fonction d'analyse d'une ligne de commande.
  * @param cmdl Pointeur vers la structure de ligne de commande à remplir.
  * @param line Chaîne de caractères contenant la ligne de commande à analyser.
- * @return int 0 en cas de succès, -1 en cas d'erreur (ligne trop longue, trop de commandes, etc.).
- * @details Cette fonction analyse la ligne de commande *line* et remplit la structure *cmdl* avec les informations extraites.
- *    La ligne de commande est copiée dans *cmdl->command_line* dans la limite de MAX_CMD_LINE caractères.
- *    La ligne est ensuite nettoyée (trim, clean, separate_s, replace, substenv), puis découpée en tokens.
- *    Les tokens sont ensuite utilisés pour remplir les structures processus_t et control_flow_t dans *cmdl*.
- *    Si la ligne dépasse la taille maximale ou si le nombre de commandes dépasse MAX_CMDS, la fonction retourne -1.
- *    Si une erreur est détectée, les descripteurs de fichiers ouverts sont fermés via close_fds(cmdl) avant de retourner -1.
+ * @return int 0 en cas de succès, 1 si la ligne est incomplète (boucle non fermée : la suite est attendue, aucun message), -1 en cas d'erreur (erreur de syntaxe, mémoire insuffisante, etc.).
+ * @details Cette fonction analyse la ligne de commande *line* et prépare la structure *cmdl* à son exécution.
+ *    La ligne de commande est copiée dans *cmdl->command_line*, allouée dans l'arène de *cmdl* (tout comme les mots, les processus et leurs arguments).
+ *    L'analyse se fait en deux temps (*plan_build()*) : la ligne est d'abord transformée en plan, suite de tokens typés produits en une seule passe
+ *    par l'analyseur lexical et dont les variables restent symboliques ; ce plan est mis en cache, si bien qu'une ligne déjà rencontrée n'est pas réanalysée.
+ *    Le plan est copié dans l'arène ; chacun de ses pipelines est instancié juste avant son lancement (*plan_instantiate()*) : les variables sont remplacées
+ *    par leur valeur courante ("X=5; echo $X" affiche 5), les mots deviennent des arguments et les redirections sont enregistrées sur leur processus.
+ *    Les affectations qui précèdent le nom d'une commande sont rangées dans son *envp*. Un '!' en tête de pipeline inverse son code de retour.
+ *    Aucun fichier ni tube n'est ouvert par l'analyse : ils le sont au lancement de chaque commande (une commande non exécutée ne tronque pas son fichier).
+ *    Avec le traçage, la durée de l'analyse est enregistrée (catégorie "parse", nommée d'après le début de la ligne).
 */
 int parse_command_line(command_line_t* cmdl, const char* line) {
-    // !!! Attention code modifié par rapport à la première version
-    // Seules ces deux lignes sont modifiées (commentées)
-    // Copie de la ligne de commande dans la structure
-    // strncpy(cmdl->command_line, line, MAX_CMD_LINE - 1);
-    // cmdl->command_line[MAX_CMD_LINE - 1] = '\0';
-    // !!!
-
-    // Suppression des espaces inutiles au début et à la fin
-    if (trim(cmdl->command_line) != 0) {
-        return -1;
-    }
-    // Suppression des doublons d'espaces
-    if (clean(cmdl->command_line) != 0) {
-        return -1;
-    }
-    // Ajout d'espaces autour des caractères ;
-    if (separate_s(cmdl->command_line, ";", MAX_CMD_LINE) != 0) {
-        return -1;
-    }
-    // Traitement des variables d'environnement
-    if (substenv(cmdl->command_line, MAX_CMD_LINE) != 0) {
-        return -1;
-    }
-    // Découpage de la ligne en tokens
-    int num_tokens = strcut(cmdl->command_line, ' ', cmdl->tokens , MAX_CMD_LINE / 2 + 1);
-    if (num_tokens < 0) {
-        return -1;
-    }
-
-
-    // Index des tokens
-    int token_index = 0;
-    // Index des arguments dans le processus courant
-    int argv_index = 0;
-    // Premier processus de la ligne de commande
-    processus_t* current_proc = add_processus(cmdl, UNCONDITIONAL);
-
-    while (cmdl->tokens[token_index] != NULL) {
-        // TODO : vérifier que le nombre de processus ne dépasse pas MAX_CMDS
-        //        Que le nombre d'arguments ne dépasse pas MAX_ARGS 
-        //        ...
-        char* token = cmdl->tokens[token_index];
-        if (strcmp(token, ";") == 0) {
-            // Fin d'une commande.
-            // Si le ';' est le dernier token, on peut arrêter le parsing
-            if (cmdl->tokens[token_index + 1] == NULL) {
-                break;
-            }
-            // Sinon, on passe au processus suivant
-            current_proc = add_processus(cmdl, UNCONDITIONAL);
-            // On réinitialise l'index des arguments
-            argv_index = 0;
-            // On passe au token suivant
-            token_index++;
-            continue;
-        }
-        if (strcmp(token, "<") == 0) {
-            // Redirection de l'entrée standard
-            // Le token suivant doit être le fichier
-            token_index++;
-            if (cmdl->tokens[token_index] == NULL) {
-                fprintf(stderr, "Erreur de syntaxe: fichier attendu après '<'\n");
-                close_fds(cmdl);
-                return -1;
-            }
-            // Ouvrir le fichier en lecture
-            int fd = open(cmdl->tokens[token_index], O_RDONLY);
-            if (fd < 0) {
-                perror("open");
-                close_fds(cmdl);
-                return -1;
-            }
-            current_proc->stdin_fd = fd;
-            // Ajouter le descripteur à la liste des descripteurs ouverts
-            if (add_fd(cmdl, fd) != 0) {
-                close(fd);
-                close_fds(cmdl);
-                return -1;
-            }
-            // On passe au token suivant
-            token_index++;
-            continue;
-        }
-        // Traitement des autres opérateurs du shell (>, >>, 2>, |, &&, ||, ...)
-        //if (strcmp(token, ">") == 0) {
-            // Ouvrir le fichier en écriture (O_WRONLY | O_CREAT | O_TRUNC)
-            // Ajouter le descripteur à la liste des descripteurs ouverts
-            // Affecter le descripteur au stdout_fd du processus courant
-        //}
-        if (strcmp(token, ">") == 0) {
-            token_index++;
-            int fd = open(cmdl->tokens[token_index], O_WRONLY | O_CREAT |       O_TRUNC, 0644);
-            if (fd < 0) { perror("open"); close_fds(cmdl); return -1; }
-
-            current_proc->stdout_fd = fd;
-            add_fd(cmdl, fd);
-            token_index++;
-            continue;
-}
-
-        
-
-        //if (strcmp(token, ">>") == 0) {
-            // Ouvrir le fichier en écriture (O_WRONLY | O_CREAT | O_APPEND)
-            // Ajouter le descripteur à la liste des descripteurs ouverts
-            // Affecter le descripteur au stdout_fd du processus courant
-        //}
-        if (strcmp(token, ">>") == 0) {
-            token_index++;
-            int fd = open(cmdl->tokens[token_index], O_WRONLY | O_CREAT | O_APPEND, 0644);
-            if (fd < 0) { perror("open"); close_fds(cmdl); return -1; }
-
-             current_proc->stdout_fd = fd;
-             add_fd(cmdl, fd);
-             token_index++;
-             continue;
-             }
-
-
-        //if (strcmp(token, "2>") == 0) {
-            // Reprendre le même traitement que pour ">", mais pour stderr_fd
-        //}
-        if (strcmp(token, "2>") == 0) {
-              token_index++;
-              int fd = open(cmdl->tokens[token_index], O_WRONLY | O_CREAT | O_TRUNC, 0644);
-               if (fd < 0) { perror("open"); close_fds(cmdl); return -1; }
-
-               current_proc->stderr_fd = fd;
-               add_fd(cmdl, fd);
-               token_index++;
-               continue;
-           }
-           
-           
-           
-
-
-        //if (strcmp(token, "2>>") == 0) {
-            // Reprendre le même traitement que pour ">>", mais pour stderr_fd
-        //}
-        
-        if (strcmp(token, "2>>") == 0) {
-        token_index++;
-        int fd = open(cmdl->tokens[token_index], O_WRONLY | O_CREAT | O_APPEND, 0644);
-        if (fd < 0) { perror("open"); close_fds(cmdl); return -1; }
-
-         current_proc->stderr_fd = fd;     
-          add_fd(cmdl, fd);
-          token_index++;
-          continue;
-    
-}
-
-
-        //if (strcmp(token, "|") == 0) {
-            // Pour la gestion du pipe, vous pourrez utiliser next_processus(cmdl) pour initialiser les descripteurs
-            // des IOs standards de la structure processus_t courante et de la suivante.
-            // next_processus(cmdl) retourne un pointeur vers le processus qui sera renvoyé par add_processus(cmdl, mode)
-            // lors du prochain appel.
-        //}
-        
-        if (strcmp(token, "|") == 0) {
-            int fds[2];
-            if (pipe(fds) < 0) { perror("pipe"); close_fds(cmdl); return -1; }
-
-           current_proc->stdout_fd = fds[1];
-           add_fd(cmdl, fds[1]);
-
-           processus_t* next = add_processus(cmdl, UNCONDITIONAL);
-           next->stdin_fd = fds[0];
-           add_fd(cmdl, fds[0]);
-
-           current_proc = next;
-           argv_index = 0;
-           token_index++;
-           continue;
-}
+    if (!cmdl || !line) return -1;
 
+    int64_t start = trace_enabled ? trace_clock() : 0;
 
+    // Copie de la ligne de commande dans l'arène
+    size_t len = strlen(line);
+    cmdl->command_line = arena_strndup(&cmdl->arena, line, len);
+    if (!cmdl->command_line) return -1;
 
-        //if (strcmp(token, "&&") == 0) {
-            // Même traitement que pour ";", mais avec le mode ON_SUCCESS
-        //}
-        if (strcmp(token, "&&") == 0) {
-           current_proc = add_processus(cmdl, ON_SUCCESS);
-           argv_index = 0;
-           token_index++;
-           continue;
-}
-
-
-        //if (strcmp(token, "||") == 0) {
-            // Même traitement que pour ";", mais avec le mode ON_FAILURE
-        //}
-        if (strcmp(token, "||") == 0) {
-            current_proc = add_processus(cmdl, ON_FAILURE);
-            argv_index = 0;
-            token_index++;
-            continue;
-}
-
-
-        //if (strcmp(token, "&") == 0) {
-           // Mettre le flag is_background du processus courant à 1
-        //}
-        if (strcmp(token, "&") == 0) {
-           current_proc->is_background = 1;
-           token_index++;
-           continue;
-}
-
-
-        if (strcmp(token, "!") == 0) {
-            // Mettre le flag invert du processus courant à 1
-        }
-
-        // Le token n'est pas un opérateur, c'est une commande ou un argument
-        if (argv_index >= MAX_ARGS - 1) {
-            fprintf(stderr, "Erreur: trop d'arguments pour une commande (max %d)\n", MAX_ARGS - 1);
-            close_fds(cmdl);
-            return -1;
-        }
-        // argv_index == 0 => C'est la commande
-        if (argv_index == 0) {
-            current_proc->path = token;
-        }
-        current_proc->argv[argv_index++] = token;
-        // On passe au token suivant
-        token_index++;
-    }
-    // On a traité tous les tokens.
-    // À ce moment, la structure cmdl contient toutes les informations nécessaires
-    // pour exécuter la ligne de commande avec le controle de flux associé.
-    return 0;
+    // Plan de la ligne (lu dans le cache si la ligne a déjà été analysée)
+    int r = plan_build(cmdl, cmdl->command_line, len);
+    if (trace_enabled) trace_span("parse", cmdl->command_line, start, trace_clock(), 0, "bytes", (long)len, NULL);
+    return r;
 }
@@ -0,0 +1,274 @@
+/** @file pathcache.c
+ * @brief Implementation of the command path cache
+ * @author Nom1
+ * @author Nom2
+ * @date 2025-26
+ * @details Implémentation de la table de hachage (adressage ouvert, sondage linéaire) associant les noms de commandes à leur chemin.
+ *   Une entrée négative porte la génération des répertoires du PATH au moment de la recherche : la génération avance dès que l'un d'eux
+ *   change (date de modification, ou autre répertoire désigné), et l'entrée négative d'une génération passée est recherchée à nouveau.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/stat.h>
+
+#include "pathcache.h"
+#include "env.h"
+
+/// Capacité initiale de la table (puissance de 2)
+#define PATH_CACHE_INITIAL 64
+/// PATH utilisé lorsque la variable n'est pas définie (même valeur par défaut qu'*execvp()*)
+#define DEFAULT_PATH "/bin:/usr/bin"
+
+/**
+ * @brief Entrée de la table de hachage.
+ * @struct path_entry_t
+ */
+typedef struct {
+    char* name;     ///< Nom de la commande (NULL si l'emplacement est libre)
+    char* path;     ///< Chemin absolu, ou NULL si la commande est introuvable (entrée négative)
+    unsigned hits;  ///< Nombre de résolutions servies par cette entrée
+    unsigned long generation; ///< Génération des répertoires du PATH lors de la recherche (entrée négative)
+} path_entry_t;
+
+/**
+ * @brief Répertoire du PATH, tel qu'il était lors de la dernière vérification.
+ * @struct path_dir_t
+ */
+typedef struct {
+    char* path;             ///< Chemin du répertoire ("." pour un élément vide)
+    dev_t dev;              ///< Périphérique (0 si le répertoire n'existe pas)
+    ino_t ino;              ///< Inœud (0 si le répertoire n'existe pas)
+    struct timespec mtime;  ///< Date de modification
+} path_dir_t;
+
+static path_entry_t* table = NULL; ///< Tableau des entrées
+static size_t capacity = 0;        ///< Nombre d'emplacements (puissance de 2)
+static size_t count = 0;           ///< Nombre d'entrées occupées
+static path_dir_t* dirs = NULL;    ///< Répertoires du PATH, dans l'ordre (NULL : PATH pas encore découpé)
+static size_t num_dirs = 0;        ///< Nombre de répertoires
+static unsigned long generation = 0; ///< Génération des répertoires du PATH (avance à chaque changement de l'un d'eux)
+static char* uncached = NULL;      ///< Dernier chemin résolu par un élément relatif du PATH (jamais mis en cache)
+
+/** @brief Hachage FNV-1a d'un nom de commande (clé de la table, chaîne terminée par '\0'). */
+static uint64_t hash_name(const char* name) {
+    uint64_t h = 1469598103934665603ULL;
+    for (; *name; ++name) {
+        h ^= (unsigned char)*name;
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+/** @brief Recherche de l'emplacement de la commande *name* (sondage linéaire, comparaison du nom entier).
+ * @return size_t Rang de l'entrée de *name*, positive (*path*) ou négative (*path* NULL), ou du premier emplacement libre, où la résolution sera mémorisée.
+ */
+static size_t find_slot(const char* name) {
+    size_t mask = capacity - 1;
+    size_t i = hash_name(name) & mask;
+    while (table[i].name && strcmp(table[i].name, name) != 0)
+        i = (i + 1) & mask;
+    return i;
+}
+
+/** @brief Doublement de la table des chemins, appelé dès qu'elle est à moitié pleine (PATH_CACHE_INITIAL emplacements au départ).
+ * @details Les entrées gardent leur nom, leur chemin, leur compteur *hits* et leur génération : seul leur rang change.
+ */
+static int grow(void) {
+    size_t old_capacity = capacity;
+    path_entry_t* old = table;
+
+    size_t new_capacity = capacity ? capacity * 2 : PATH_CACHE_INITIAL;
+    path_entry_t* t = calloc(new_capacity, sizeof(path_entry_t));
+    if (!t) return -1;
+
+    table = t;
+    capacity = new_capacity;
+    for (size_t i = 0; i < old_capacity; ++i) {
+        if (old[i].name) table[find_slot(old[i].name)] = old[i];
+    }
+    free(old);
+    return 0;
+}
+
+/** @brief Libération des répertoires du PATH mémorisés. */
+static void dirs_free(void) {
+    for (size_t i = 0; i < num_dirs; ++i) free(dirs[i].path);
+    free(dirs);
+    dirs = NULL;
+    num_dirs = 0;
+}
+
+/** @brief Vérification des répertoires du PATH : la génération avance si l'un d'eux a changé depuis la vérification précédente.
+ * @details Le PATH est découpé au premier appel suivant sa modification. Un élément relatif est vérifié dans le répertoire courant :
+ *    un changement de répertoire du shell fait donc aussi avancer la génération.
+ */
+static void dirs_refresh(void) {
+    if (!dirs) {
+        const char* path = env_get("PATH");
+        if (!path) path = DEFAULT_PATH;
+
+        size_t n = 1;
+        for (const char* p = path; *p; ++p) n += *p == ':';
+        dirs = calloc(n, sizeof(path_dir_t));
+        if (!dirs) return;
+
+        const char* dir = path;
+        for (num_dirs = 0; num_dirs < n; ++num_dirs) {
+            const char* end = strchrnul(dir, ':');
+            /* un élément vide désigne le répertoire courant */
+            dirs[num_dirs].path = end == dir ? strdup(".") : strndup(dir, end - dir);
+            if (!dirs[num_dirs].path) {
+                dirs_free();
+                return;
+            }
+            dir = *end ? end + 1 : end;
+        }
+        generation++;
+    }
+
+    for (size_t i = 0; i < num_dirs; ++i) {
+        path_dir_t* d = &dirs[i];
+        struct stat st;
+        if (stat(d->path, &st) != 0 || !S_ISDIR(st.st_mode)) memset(&st, 0, sizeof(st));
+        if (st.st_dev == d->dev && st.st_ino == d->ino
+            && st.st_mtim.tv_sec == d->mtime.tv_sec && st.st_mtim.tv_nsec == d->mtime.tv_nsec)
+            continue;
+        d->dev = st.st_dev;
+        d->ino = st.st_ino;
+        d->mtime = st.st_mtim;
+        generation++;
+    }
+}
+
+/** @brief Recherche de *name* dans les répertoires du PATH.
+ * @param relative Pointeur dans lequel est renvoyé 1 si le chemin trouvé vient d'un élément relatif du PATH (il dépend du répertoire courant).
+ * @return char* Chemin alloué dynamiquement, ou NULL si la commande est introuvable.
+ */
+static char* search_path(const char* name, int* relative) {
+    const char* dirs = env_get("PATH");
+    if (!dirs) dirs = DEFAULT_PATH;
+
+    size_t name_len = strlen(name);
+    const char* dir = dirs;
+    while (1) {
+        const char* end = strchrnul(dir, ':');
+        size_t dir_len = end - dir;
+
+        /* un élément vide désigne le répertoire courant */
+        char* candidate = malloc(dir_len + name_len + 3);
+        if (!candidate) return NULL;
+        if (dir_len == 0) {
+            memcpy(candidate, "./", 2);
+            dir_len = 2;
+        } else {
+            memcpy(candidate, dir, dir_len);
+        }
+        candidate[dir_len] = '/';
+        memcpy(candidate + dir_len + 1, name, name_len + 1);
+
+        struct stat st;
+        if (stat(candidate, &st) == 0 && S_ISREG(st.st_mode) && access(candidate, X_OK) == 0) {
+            *relative = candidate[0] != '/';
+            return candidate;
+        }
+        free(candidate);
+
+        if (*end == '\0') break;
+        dir = end + 1;
+    }
+    return NULL;
+}
+
+const char* path_resolve(const char* name) {
+    if (!name || !*name) return NULL;
+    if (strchr(name, '/')) return name;
+
+    free(uncached);
+    uncached = NULL;
+    if (count * 2 >= capacity && grow() != 0) return NULL;
+
+    size_t i = find_slot(name);
+    if (table[i].name && !table[i].path) {
+        /* entrée négative : valable tant qu'aucun répertoire du PATH n'a changé */
+        dirs_refresh();
+        if (table[i].generation != generation) {
+            path_cache_forget(name);
+            i = find_slot(name);
+        }
+    }
+    if (!table[i].name) {
+        dirs_refresh();
+        int relative = 0;
+        char* path = search_path(name, &relative);
+        if (relative) {
+            /* "./name" change de sens avec le répertoire courant : le chemin n'est pas mémorisé */
+            uncached = path;
+            return uncached;
+        }
+        char* key = strdup(name);
+        if (!key) {
+            free(path);
+            return NULL;
+        }
+        table[i].name = key;
+        table[i].path = path;
+        table[i].hits = 0;
+        table[i].generation = generation;
+        count++;
+    }
+    table[i].hits++;
+    return table[i].path;
+}
+
+void path_cache_forget(const char* name) {
+    if (!name || !capacity) return;
+
+    size_t mask = capacity - 1;
+    size_t i = find_slot(name);
+    if (!table[i].name) return;
+
+    free(table[i].name);
+    free(table[i].path);
+    table[i].name = NULL;
+    count--;
+
+    /* les commandes qui suivent dans la grappe sont réinsérées une à une : find_slot(), qui s'arrête au premier emplacement vide, les retrouve encore */
+    for (size_t j = (i + 1) & mask; table[j].name; j = (j + 1) & mask) {
+        path_entry_t e = table[j];
+        table[j].name = NULL;
+        table[find_slot(e.name)] = e;
+    }
+}
+
+void path_cache_clear(void) {
+    for (size_t i = 0; i < capacity; ++i) {
+        if (table[i].name) {
+            free(table[i].name);
+            free(table[i].path);
+            table[i].name = NULL;
+        }
+    }
+    count = 0;
+    dirs_free();
+    free(uncached);
+    uncached = NULL;
+}
+
+int path_cache_print(int fd) {
+    int n = 0;
+    for (size_t i = 0; i < capacity; ++i) {
+        if (!table[i].name) continue;
+        if (n++ == 0) dprintf(fd, "hits\tcommand\n");
+        if (table[i].path)
+            dprintf(fd, "%4u\t%s\n", table[i].hits, table[i].path);
+        else
+            dprintf(fd, "%4u\t%s (not found)\n", table[i].hits, table[i].name);
+    }
+    return n;
+}
@@ -0,0 +1,841 @@
+/** @file plan.c
+ * @brief Implementation of parsed command line plans and their cache
+ * @author Nom1
+ * @author Nom2
+ * @date 2025-26
+ * @details Implémentation de la construction des plans, de la compilation de leur programme, de leur cache
+ *   (table à correspondance directe indexée par le hachage de la ligne) et de l'instanciation de leurs pipelines dans une structure command_line_t.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "plan.h"
+#include "builtins.h"
+#include "env.h"
+#include "lexer.h"
+#include "subst.h"
+
+/**
+ * @brief Emplacement du cache.
+ * @struct plan_slot_t
+ */
+typedef struct {
+    uint64_t hash;  ///< Hachage de la ligne
+    plan_t* plan;   ///< Plan mémorisé (NULL si l'emplacement est libre)
+} plan_slot_t;
+
+static plan_slot_t cache[PLAN_CACHE_SIZE]; ///< Emplacements du cache
+static size_t cache_count = 0;             ///< Nombre de plans en cache
+static size_t cache_bytes = 0;             ///< Taille cumulée des plans en cache
+static unsigned long cache_hits = 0;       ///< Lignes servies par le cache
+static unsigned long cache_misses = 0;     ///< Lignes analysées
+static unsigned long cache_evictions = 0;  ///< Plans remplacés par celui d'une autre ligne
+
+/// Capacité du tableau de travail conservée d'une ligne à l'autre (au-delà, il est libéré après usage)
+#define PLAN_SCRATCH_KEEP 256
+
+static plan_token_t* scratch = NULL;       ///< Tokens de la ligne en cours d'analyse
+static size_t scratch_cap = 0;             ///< Capacité de *scratch*
+
+/** @brief Fonction de hachage d'une ligne.
+ * @details Variante de FNV-1a qui consomme 8 octets par multiplication (les lignes peuvent être longues et sont hachées à chaque lecture).
+ */
+static uint64_t hash_line(const char* line, size_t len) {
+    uint64_t h = 1469598103934665603ULL ^ len;
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8) {
+        uint64_t w;
+        memcpy(&w, line + i, 8);
+        h = (h ^ w) * 1099511628211ULL;
+        h ^= h >> 32;
+    }
+    for (; i < len; ++i) {
+        h ^= (unsigned char)line[i];
+        h *= 1099511628211ULL;
+    }
+    return h ^ (h >> 29);
+}
+
+/** @brief Programme d'un plan. */
+static const instruction_t* plan_code(const plan_t* plan) {
+    return (const instruction_t*)&plan->tokens[plan->num_tokens];
+}
+
+/** @brief Ligne source d'un plan. */
+static const char* plan_line(const plan_t* plan) {
+    return (const char*)&plan_code(plan)[plan->code_len];
+}
+
+/** @brief Fonction d'affichage d'une erreur de syntaxe.
+ * @param near Texte du token en cause (NULL en fin de ligne).
+ * @return int -1
+ */
+static int syntax_error(const char* near) {
+    fprintf(stderr, "Erreur de syntaxe près de '%s'\n", near ? near : "fin de ligne");
+    return -1;
+}
+
+/** @brief Parties d'une boucle, dans l'ordre de leur analyse.
+ * @enum loop_phase_t
+ */
+typedef enum {
+    PHASE_NAME,          ///< for : nom de la variable attendu
+    PHASE_IN,            ///< for : "in", ";" ou saut de ligne attendu
+    PHASE_WORDS,         ///< for : mots de la liste, jusqu'à ";" ou un saut de ligne
+    PHASE_DO,            ///< for : "do" attendu
+    PHASE_CONDITION,     ///< while, until : condition, encore vide
+    PHASE_CONDITION_CMD, ///< while, until : condition commencée, "do" accepté en position de commande
+    PHASE_BODY,          ///< Corps, encore vide
+    PHASE_BODY_CMD       ///< Corps commencé, "done" accepté en position de commande
+} loop_phase_t;
+
+/**
+ * @brief Boucle ouverte pendant l'analyse d'une ligne.
+ * @struct open_loop_t
+ */
+typedef struct {
+    uint8_t keyword; ///< KW_FOR, KW_WHILE ou KW_UNTIL
+    uint8_t phase;   ///< Partie en cours d'analyse (loop_phase_t)
+} open_loop_t;
+
+/** @brief Mot réservé reconnu en position de commande.
+ * @return int KW_FOR, KW_WHILE, KW_UNTIL, KW_DO ou KW_DONE, -1 si le mot n'est pas réservé ou s'il est protégé.
+ */
+static int command_keyword(const token_t* tok) {
+    static const char* const names[] = { "for", "while", "until", "do", "done" };
+    if (tok->type != TOKEN_WORD || (tok->flags & (TOKEN_QUOTED | TOKEN_SYMBOLIC))) return -1;
+    for (int k = KW_FOR; k <= KW_DONE; ++k)
+        if (tok->len == strlen(names[k]) && memcmp(tok->text, names[k], tok->len) == 0) return k;
+    return -1;
+}
+
+/** @brief Passage de la condition ou du corps de la boucle *top* à l'état "commencé" au début d'une commande. */
+static void begin_command(open_loop_t* top) {
+    if (top && top->phase == PHASE_CONDITION) top->phase = PHASE_CONDITION_CMD;
+    else if (top && top->phase == PHASE_BODY) top->phase = PHASE_BODY_CMD;
+}
+
+/** @brief Fonction d'analyse d'une ligne en tokens, avec vérification de la syntaxe.
+ * @param arena Arène dans laquelle les mots sont construits.
+ * @param line Ligne à analyser.
+ * @param len Longueur de la ligne.
+ * @param words_size Pointeur dans lequel est renvoyée la taille cumulée des mots (avec leur '\0').
+ * @return ssize_t Nombre de tokens placés dans *scratch*, -1 en cas d'erreur (message affiché), -2 si une boucle n'est pas fermée en fin de ligne.
+ * @details Dans *scratch*, le champ *text* des tokens est l'adresse du mot dans l'arène (et non une position relative).
+ *    Les mots réservés ne sont reconnus qu'en position de commande ("echo for" affiche for) et s'ils ne sont pas protégés ; ils deviennent des tokens TOKEN_KEYWORD.
+ *    Un saut de ligne qui termine une commande devient un ";", les autres sont retirés ("a &&" puis "b" sur la ligne suivante forment une liste).
+ *    Une boucle ne peut être ni un étage de pipeline ni en arrière-plan.
+ */
+static ssize_t lex_line(arena_t* arena, const char* line, size_t len, size_t* words_size) {
+    lexer_t lex;
+    if (lexer_init(&lex, line, len, arena) != 0) return -1;
+
+    size_t n = 0;
+    *words_size = 0;
+    // Une commande a commencé depuis le dernier opérateur
+    int in_command = 0;
+    // Opérateur qui attend une commande ("|", "&&", "||"), NULL sinon
+    const char* pending_op = NULL;
+    // La redirection précédente attend son fichier
+    const char* pending_redir = NULL;
+    // Boucles ouvertes, de la plus extérieure à la plus intérieure
+    open_loop_t* loops = NULL;
+    size_t depth = 0, loops_cap = 0;
+    // Le "done" d'une boucle vient d'être lu : seuls des redirections ou un opérateur peuvent suivre
+    int closed = 0;
+
+    token_t tok;
+    int r;
+    while ((r = lexer_next(&lex, &tok)) > 0) {
+        open_loop_t* top = depth ? &loops[depth - 1] : NULL;
+        int newline = (tok.type == TOKEN_OPERATOR && tok.op == OP_NEWLINE);
+        if (pending_redir && tok.type != TOKEN_WORD && tok.type != TOKEN_ASSIGNMENT) return syntax_error(newline ? NULL : tok.text);
+
+        // Un saut de ligne termine la commande ou la liste de mots d'un for en cours ; ailleurs, c'est un blanc
+        if (newline) {
+            if (!in_command && !(top && (top->phase == PHASE_IN || top->phase == PHASE_WORDS))) continue;
+            tok.op = OP_SEMICOLON;
+            tok.text = ";";
+        }
+
+        if (top && top->phase <= PHASE_WORDS) {
+            /* en-tête d'un for : nom de la variable, "in", mots jusqu'au séparateur */
+            if (top->phase == PHASE_NAME) {
+                if (tok.type != TOKEN_WORD || (tok.flags & (TOKEN_QUOTED | TOKEN_SYMBOLIC)) || !env_valid_name(tok.text, tok.len))
+                    return syntax_error(tok.text);
+                top->phase = PHASE_IN;
+            } else if (tok.type == TOKEN_OPERATOR && tok.op == OP_SEMICOLON) {
+                top->phase = PHASE_DO;
+            } else if (top->phase == PHASE_IN && tok.type == TOKEN_WORD && !(tok.flags & (TOKEN_QUOTED | TOKEN_SYMBOLIC))
+                       && tok.len == 2 && memcmp(tok.text, "in", 2) == 0) {
+                tok.type = TOKEN_KEYWORD;
+                tok.op = KW_IN;
+                top->phase = PHASE_WORDS;
+            } else if (top->phase == PHASE_WORDS && (tok.type == TOKEN_WORD || tok.type == TOKEN_ASSIGNMENT)) {
+                // "for x in a=b" : un mot ordinaire, découpé en champs
+                tok.type = TOKEN_WORD;
+            } else {
+                return syntax_error(tok.text);
+            }
+        } else if (tok.type == TOKEN_OPERATOR) {
+            // Un opérateur doit suivre une commande
+            if (!in_command) return syntax_error(tok.text);
+            if (closed && (tok.op == OP_PIPE || tok.op == OP_AMPERSAND)) {
+                fprintf(stderr, "%s: boucle dans un pipeline ou en arrière-plan non prise en charge\n", tok.text);
+                return -1;
+            }
+            pending_op = (tok.op == OP_SEMICOLON || tok.op == OP_AMPERSAND) ? NULL : tok.text;
+            in_command = 0;
+            closed = 0;
+        } else {
+            int keyword = in_command ? -1 : command_keyword(&tok);
+            if (closed && !pending_redir && tok.type != TOKEN_REDIRECTION) return syntax_error(tok.text);
+            if (top && top->phase == PHASE_DO && keyword != KW_DO) return syntax_error(tok.text);
+
+            if (keyword == KW_FOR || keyword == KW_WHILE || keyword == KW_UNTIL) {
+                if (pending_op && strcmp(pending_op, "|") == 0) {
+                    fprintf(stderr, "%s: boucle dans un pipeline non prise en charge\n", tok.text);
+                    return -1;
+                }
+                begin_command(top);
+                if (depth == loops_cap) {
+                    size_t cap = loops_cap ? loops_cap * 2 : 8;
+                    open_loop_t* l = arena_realloc(arena, loops, loops_cap * sizeof(open_loop_t), cap * sizeof(open_loop_t));
+                    if (!l) { perror("arena_realloc"); return -1; }
+                    loops = l;
+                    loops_cap = cap;
+                }
+                loops[depth++] = (open_loop_t){ (uint8_t)keyword, keyword == KW_FOR ? PHASE_NAME : PHASE_CONDITION };
+                pending_op = NULL;
+            } else if (keyword == KW_DO) {
+                if (!top || pending_op || (top->phase != PHASE_DO && top->phase != PHASE_CONDITION_CMD)) return syntax_error(tok.text);
+                top->phase = PHASE_BODY;
+            } else if (keyword == KW_DONE) {
+                if (!top || pending_op || top->phase != PHASE_BODY_CMD) return syntax_error(tok.text);
+                depth--;
+                in_command = 1;
+                closed = 1;
+            } else {
+                if (!in_command) begin_command(top);
+                if (tok.type == TOKEN_REDIRECTION) {
+                    if (tok.op != REDIR_DUP_IN && tok.op != REDIR_DUP_OUT) pending_redir = tok.text;
+                } else {
+                    pending_redir = NULL;
+                }
+                in_command = 1;
+                pending_op = NULL;
+            }
+            if (keyword >= 0) {
+                tok.type = TOKEN_KEYWORD;
+                tok.op = keyword;
+            }
+        }
+
+        if (n == scratch_cap) {
+            size_t cap = scratch_cap ? scratch_cap * 2 : PLAN_SCRATCH_KEEP;
+            plan_token_t* t = realloc(scratch, cap * sizeof(plan_token_t));
+            if (!t) { perror("realloc"); return -1; }
+            scratch = t;
+            scratch_cap = cap;
+        }
+        plan_token_t* t = &scratch[n++];
+        t->type = tok.type;
+        t->op = tok.op;
+        t->flags = tok.flags;
+        t->fd = tok.fd;
+        t->target_fd = tok.target_fd;
+        t->len = tok.len;
+        t->text = (uintptr_t)tok.text;
+        if (tok.type == TOKEN_WORD || tok.type == TOKEN_ASSIGNMENT) *words_size += tok.len + 1;
+    }
+
+    if (r < 0) {
+        fprintf(stderr, "Erreur de syntaxe: guillemet non fermé ou expression invalide\n");
+        return -1;
+    }
+    // "|", "&&" ou "||" en fin de ligne, redirection sans fichier
+    if (pending_op || pending_redir) return syntax_error(NULL);
+    // Boucle non fermée : la suite est attendue
+    if (depth) return -2;
+    return (ssize_t)n;
+}
+
+/// Fin d'une chaîne de sauts à résoudre
+#define CHAIN_END UINT32_MAX
+
+/** @brief Fonction de résolution d'une chaîne de sauts.
+ * @param code Programme en cours de compilation.
+ * @param chain Premier saut de la chaîne (les sauts sont chaînés par leur champ *arg*), CHAIN_END si elle est vide.
+ * @param target Instruction cible.
+ */
+static void resolve(instruction_t* code, uint32_t chain, uint32_t target) {
+    while (chain != CHAIN_END) {
+        uint32_t next = code[chain].arg;
+        code[chain].arg = target;
+        chain = next;
+    }
+}
+
+/** @brief Fonction d'émission du saut conditionnel qui précède un élément (pipeline ou boucle) d'une liste "&&"/"||".
+ * @param code Programme en cours de compilation.
+ * @param n Pointeur vers le nombre d'instructions émises.
+ * @param connector Opérateur qui précède l'élément (OP_SEMICOLON en début de liste : aucun saut).
+ * @param on_failure Chaîne des sauts pris en cas d'échec ("&&").
+ * @param on_success Chaîne des sauts pris en cas de succès ("||").
+ * @details Les sauts de condition opposée, en attente, arrivent sur l'élément.
+ */
+static void emit_connector(instruction_t* code, uint32_t* n, int connector, uint32_t* on_failure, uint32_t* on_success) {
+    if (connector == OP_AND) {
+        code[*n] = (instruction_t){ BC_JUMP_FAILURE, 0, *on_failure };
+        *on_failure = (*n)++;
+        resolve(code, *on_success, *n);
+        *on_success = CHAIN_END;
+    } else if (connector == OP_OR) {
+        code[*n] = (instruction_t){ BC_JUMP_SUCCESS, 0, *on_success };
+        *on_success = (*n)++;
+        resolve(code, *on_failure, *n);
+        *on_failure = CHAIN_END;
+    }
+}
+
+/** @brief Fonction de choix de l'instruction de lancement d'un pipeline.
+ * @param in Instruction BC_PIPELINE du pipeline, remplacée si le pipeline peut être exécuté plus directement.
+ * @param first Premier mot du pipeline (NULL s'il n'en a pas).
+ * @param base Adresse à laquelle le champ *text* des tokens est relatif.
+ * @param simple Le pipeline a un seul étage et s'exécute au premier plan.
+ * @param assignments Le pipeline commence par des affectations.
+ * @details Le premier mot d'une commande n'est son nom que s'il est littéral et n'est pas un mot-clé ("!", "time") :
+ *    la commande intégrée correspondante est alors connue dès la compilation.
+ */
+static void select_launch(instruction_t* in, const plan_token_t* first, uintptr_t base, int simple, int assignments) {
+    if (!simple) return;
+    if (!first) {
+        if (assignments) in->op = BC_ASSIGN;
+        return;
+    }
+    const char* word = (const char*)(base + first->text);
+    if (first->flags & TOKEN_SYMBOLIC) return;
+    if (!(first->flags & TOKEN_QUOTED) && (strcmp(word, "!") == 0 || strcmp(word, "time") == 0)) return;
+
+    const builtin_t* b = builtin_find(word);
+    if (!b) return;
+    size_t count;
+    in->op = BC_BUILTIN;
+    in->builtin = (uint8_t)(b - builtin_list(&count));
+}
+
+/**
+ * @brief Boucle en cours de compilation.
+ * @struct loop_ctx_t
+ */
+typedef struct {
+    uint8_t keyword;      ///< KW_FOR, KW_WHILE ou KW_UNTIL
+    uint32_t enter;       ///< Instruction BC_LOOP, dont l'opérande reçoit le premier token des redirections de la boucle
+    uint32_t top;         ///< Instruction BC_ITERATE : cible du saut de fin de corps et de continue
+    uint32_t exits;       ///< Sauts vers la sortie de la boucle, en attente de leur cible
+    uint32_t on_failure;  ///< Sauts "&&" en attente de la liste englobante
+    uint32_t on_success;  ///< Sauts "||" en attente de la liste englobante
+} loop_ctx_t;
+
+/** @brief Fonction de compilation de break et continue.
+ * @param code Programme en cours de compilation.
+ * @param run Instruction de lancement du pipeline, remplacée par un saut s'il s'agit de "break [n]" ou "continue [n]".
+ * @param first Premier mot du pipeline, *second* son second mot (NULL s'ils n'existent pas).
+ * @param words Nombre de mots du pipeline.
+ * @param base Adresse à laquelle le champ *text* des tokens est relatif.
+ * @param loops Boucles en cours de compilation, *depth* leur nombre (au moins 1).
+ * @return int 1 si l'instruction a été remplacée, 0 sinon.
+ * @details Un nombre de niveaux supérieur à la profondeur vise la boucle la plus extérieure. Une forme invalide ("break 0", "break x")
+ *    reste un appel à la commande intégrée, qui signale l'erreur.
+ */
+static int loop_control(instruction_t* code, uint32_t run, const plan_token_t* first, const plan_token_t* second, int words,
+                        uintptr_t base, loop_ctx_t* loops, size_t depth) {
+    if (!first || words > 2 || (first->flags & (TOKEN_QUOTED | TOKEN_SYMBOLIC))) return 0;
+    const char* word = (const char*)(base + first->text);
+    int is_break = (strcmp(word, "break") == 0);
+    if (!is_break && strcmp(word, "continue") != 0) return 0;
+
+    size_t levels = 1;
+    if (second) {
+        const char* arg = (const char*)(base + second->text);
+        char* end;
+        if ((second->flags & TOKEN_SYMBOLIC) || arg[0] < '0' || arg[0] > '9') return 0;
+        unsigned long v = strtoul(arg, &end, 10);
+        if (*end || v == 0) return 0;
+        levels = v;
+    }
+    if (levels > depth) levels = depth;
+    if (levels > UINT8_MAX + 1) levels = UINT8_MAX + 1;
+
+    loop_ctx_t* target = &loops[depth - levels];
+    if (is_break) {
+        code[run] = (instruction_t){ BC_BREAK, (uint8_t)(levels - 1), target->exits };
+        target->exits = run;
+    } else {
+        code[run] = (instruction_t){ BC_CONTINUE, (uint8_t)(levels - 1), target->top };
+    }
+    return 1;
+}
+
+/** @brief Fonction de compilation du programme d'une ligne.
+ * @param arena Arène dans laquelle le programme est alloué.
+ * @param tokens Tokens de la ligne (syntaxe déjà vérifiée).
+ * @param num_tokens Nombre de tokens.
+ * @param base Adresse à laquelle le champ *text* des tokens est relatif (adresse du plan, ou 0 pour les tokens de *scratch*).
+ * @param len Pointeur dans lequel est renvoyé le nombre d'instructions.
+ * @return instruction_t* Programme, terminé par BC_HALT, NULL en cas de mémoire insuffisante.
+ * @details Chaque pipeline est lancé par une instruction qui désigne son premier token. Un pipeline précédé de "&&" est précédé d'un saut
+ *    BC_JUMP_FAILURE, un pipeline précédé de "||" d'un saut BC_JUMP_SUCCESS : le statut ne changeant pas pendant les sauts, chacun vise directement
+ *    le lancement du prochain pipeline de la liste dont la condition est remplie, ou la fin de la liste (BC_LIST_END, pour ";", "&" et la fin de ligne).
+ *    Les sauts dont la cible n'est pas encore connue sont chaînés par leur champ *arg*, puis résolus ensemble.
+ *    Une boucle occupe la place d'un pipeline dans sa liste :
+ *    BC_LOOP [BC_FOR] BC_ITERATE condition [BC_JUMP_FAILURE ou BC_JUMP_SUCCESS vers la sortie] corps BC_JUMP (vers BC_ITERATE) BC_LOOP_EXIT.
+ *    Sa condition et son corps sont des suites de listes compilées de la même façon ; les sauts en attente de la liste englobante sont mis de côté.
+ */
+static instruction_t* compile(arena_t* arena, const plan_token_t* tokens, size_t num_tokens, uintptr_t base, size_t* len) {
+    /* au plus deux instructions par token (lancement, saut de "&&"/"||", fin de liste de ";"/"&", instructions des boucles), plus la dernière fin de liste et BC_HALT */
+    instruction_t* code = arena_alloc(arena, (2 * num_tokens + 2) * sizeof(instruction_t));
+    if (!code) return NULL;
+
+    uint32_t n = 0;
+    // Sauts pris en cas d'échec ("&&") et de succès ("||"), en attente de leur cible
+    uint32_t on_failure = CHAIN_END, on_success = CHAIN_END;
+    // Opérateur qui précède le pipeline suivant (OP_SEMICOLON en début de liste)
+    int connector = OP_SEMICOLON;
+    // Lancement du pipeline courant (CHAIN_END entre deux pipelines), et ce que l'on sait de lui
+    uint32_t run = CHAIN_END;
+    const plan_token_t* first = NULL;
+    const plan_token_t* second = NULL;
+    int stages = 0, assignments = 0, words = 0;
+    // Une liste "&&"/"||" est commencée et n'a pas encore sa fin
+    int in_list = 0;
+    // Boucles en cours, de la plus extérieure à la plus intérieure
+    loop_ctx_t* loops = NULL;
+    size_t depth = 0, loops_cap = 0;
+    // Instruction BC_LOOP de la boucle qui vient de se terminer (ses redirections suivent "done"), CHAIN_END sinon
+    uint32_t closed = CHAIN_END;
+
+    for (size_t i = 0; i <= num_tokens; ++i) {
+        const plan_token_t* tok = (i < num_tokens) ? &tokens[i] : NULL;
+
+        if (tok && tok->type == TOKEN_KEYWORD) {
+            if (tok->op == KW_DO) {
+                /* fin de la condition : sortie de la boucle selon son statut */
+                loop_ctx_t* l = &loops[depth - 1];
+                if (l->keyword != KW_FOR) {
+                    code[n] = (instruction_t){ l->keyword == KW_WHILE ? BC_JUMP_FAILURE : BC_JUMP_SUCCESS, 0, l->exits };
+                    l->exits = n++;
+                }
+                continue;
+            }
+            if (tok->op == KW_DONE) {
+                loop_ctx_t* l = &loops[--depth];
+                code[n++] = (instruction_t){ BC_JUMP, 0, l->top };
+                resolve(code, l->exits, n);
+                code[n++] = (instruction_t){ BC_LOOP_EXIT, 0, 0 };
+                on_failure = l->on_failure;
+                on_success = l->on_success;
+                in_list = 1;
+                closed = l->enter;
+                continue;
+            }
+
+            /* for, while, until : la boucle prend la place d'un pipeline dans la liste englobante */
+            emit_connector(code, &n, connector, &on_failure, &on_success);
+            if (depth == loops_cap) {
+                size_t cap = loops_cap ? loops_cap * 2 : 8;
+                loop_ctx_t* l = arena_realloc(arena, loops, loops_cap * sizeof(loop_ctx_t), cap * sizeof(loop_ctx_t));
+                if (!l) return NULL;
+                loops = l;
+                loops_cap = cap;
+            }
+            loop_ctx_t* l = &loops[depth++];
+            *l = (loop_ctx_t){ tok->op, n, 0, CHAIN_END, on_failure, on_success };
+            on_failure = on_success = CHAIN_END;
+            connector = OP_SEMICOLON;
+            in_list = 0;
+
+            code[n++] = (instruction_t){ BC_LOOP, tok->op, LOOP_NO_REDIRECT };
+            if (tok->op == KW_FOR) {
+                /* nom, "in" et mots sont lus à l'exécution ; le corps commence au "do" */
+                code[n++] = (instruction_t){ BC_FOR, 0, (uint32_t)(i + 1) };
+                while (tokens[i + 1].type != TOKEN_KEYWORD || tokens[i + 1].op != KW_DO) ++i;
+            }
+            l->top = n;
+            l->exits = n;
+            code[n++] = (instruction_t){ BC_ITERATE, 0, CHAIN_END };
+            continue;
+        }
+
+        if (tok && tok->type != TOKEN_OPERATOR) {
+            if (closed != CHAIN_END) {
+                /* redirections de la boucle qui vient de se terminer, appliquées à toute la boucle */
+                if (code[closed].arg == LOOP_NO_REDIRECT) code[closed].arg = (uint32_t)i;
+                if (tok->op != REDIR_DUP_IN && tok->op != REDIR_DUP_OUT) ++i;
+                continue;
+            }
+            if (run == CHAIN_END) {
+                /* début d'un pipeline : saut conditionnel, puis lancement */
+                emit_connector(code, &n, connector, &on_failure, &on_success);
+                run = n;
+                code[n++] = (instruction_t){ BC_PIPELINE, 0, (uint32_t)i };
+                in_list = 1;
+                first = second = NULL;
+                stages = 1;
+                assignments = words = 0;
+            }
+            if (tok->type == TOKEN_REDIRECTION) {
+                // Le token suivant est le fichier (ou le corps d'un here-document)
+                if (tok->op != REDIR_DUP_IN && tok->op != REDIR_DUP_OUT) ++i;
+            } else if (tok->type == TOKEN_ASSIGNMENT && !first) {
+                assignments = 1;
+            } else {
+                if (!first) first = tok;
+                else if (!second) second = tok;
+                words++;
+            }
+            continue;
+        }
+
+        closed = CHAIN_END;
+        if (tok && tok->op == OP_PIPE) {
+            stages++;
+            continue;
+        }
+
+        /* fin d'un pipeline : "&&", "||", ";", "&" ou fin de ligne */
+        int background = tok && tok->op == OP_AMPERSAND;
+        if (run != CHAIN_END) {
+            int simple = (stages == 1 && !background);
+            if (!(simple && depth && !assignments && loop_control(code, run, first, second, words, base, loops, depth)))
+                select_launch(&code[run], first, base, simple, assignments);
+        }
+        run = CHAIN_END;
+        if (tok && (tok->op == OP_AND || tok->op == OP_OR)) {
+            connector = tok->op;
+            continue;
+        }
+        /* fin de liste : ";", "&" ou fin de ligne (une ligne terminée par ";" ou "&" n'en ajoute pas une seconde) */
+        if (in_list) {
+            resolve(code, on_failure, n);
+            resolve(code, on_success, n);
+            on_failure = on_success = CHAIN_END;
+            code[n++] = (instruction_t){ BC_LIST_END, 0, 0 };
+            in_list = 0;
+        }
+        connector = OP_SEMICOLON;
+    }
+
+    code[n++] = (instruction_t){ BC_HALT, 0, 0 };
+    *len = n;
+    return code;
+}
+
+/** @brief Fonction de construction d'un plan dans le bloc *plan* (de *size* octets) à partir des tokens de *scratch* et du programme *code*.
+ * @details Le bloc contient l'en-tête, les tokens, le programme, la ligne source puis les mots ; les adresses des mots sont remplacées par leur position dans le bloc.
+ */
+static void pack(plan_t* plan, const char* line, size_t len, size_t num_tokens, const instruction_t* code, size_t code_len, size_t size) {
+    plan->size = size;
+    plan->line_len = len;
+    plan->num_tokens = num_tokens;
+    plan->code_len = code_len;
+    plan->hits = 0;
+
+    memcpy((instruction_t*)plan_code(plan), code, code_len * sizeof(instruction_t));
+    char* text = (char*)plan_line(plan);
+    memcpy(text, line, len);
+    text[len] = '\0';
+    text += len + 1;
+
+    for (size_t i = 0; i < num_tokens; ++i) {
+        plan_token_t* t = &plan->tokens[i];
+        *t = scratch[i];
+        if (t->type != TOKEN_WORD && t->type != TOKEN_ASSIGNMENT) {
+            t->text = 0;
+            continue;
+        }
+        memcpy(text, (const char*)scratch[i].text, t->len + 1);
+        t->text = text - (char*)plan;
+        text += t->len + 1;
+    }
+}
+
+/// Texte des redirections, indexé par redirection_t
+static const char* const redirection_text[] = { "<", ">", ">>", "<&", ">&", "<<", "<<<" };
+
+/** @brief Fonction d'enregistrement d'une redirection du processus courant.
+ * @param proc Processus concerné.
+ * @param tok Token de redirection.
+ * @param target Nom du fichier, ou contenu d'un here-document ou d'une here-string (NULL pour une duplication [n]>&m).
+ * @return int 0 en cas de succès, -1 en cas d'erreur (message affiché).
+ * @details Aucun fichier n'est ouvert ici : la redirection est appliquée au lancement du processus (voir *add_redirection()*).
+ */
+static int record_redirection(processus_t* proc, const plan_token_t* tok, char* target) {
+    if (tok->fd < STDIN_FILENO || tok->fd > STDERR_FILENO) {
+        fprintf(stderr, "%d: redirection non prise en charge (seuls 0, 1 et 2 peuvent être redirigés)\n", tok->fd);
+        return -1;
+    }
+    int dup = (tok->op == REDIR_DUP_IN || tok->op == REDIR_DUP_OUT);
+    if (dup && (tok->target_fd < STDIN_FILENO || tok->target_fd > STDERR_FILENO)) {
+        fprintf(stderr, "%d: mauvais descripteur de fichier\n", tok->target_fd);
+        return -1;
+    }
+    if (add_redirection(proc, tok->op, tok->fd, dup ? tok->target_fd : -1, dup ? NULL : target) != 0) {
+        perror("add_redirection");
+        return -1;
+    }
+    return 0;
+}
+
+/** @brief Fonction d'instanciation d'un token d'un pipeline sur son processus courant.
+ * @param cmdl Pointeur vers la structure de ligne de commande.
+ * @param proc Processus courant.
+ * @param tokens Tokens du plan, *i* le rang du token (avancé sur le fichier d'une redirection).
+ * @param base Adresse du plan.
+ * @param first_stage Le processus est le premier étage du pipeline.
+ * @param list_head Le pipeline commence une liste "&&"/"||".
+ * @return int 0 en cas de succès, -1 en cas d'erreur (message affiché).
+ */
+static int instantiate_token(command_line_t* cmdl, processus_t* proc, const plan_token_t* tokens, size_t* i, uintptr_t base,
+                             int first_stage, int list_head) {
+    const plan_token_t* tok = &tokens[*i];
+    char* word = (char*)(base + tok->text);
+
+    if (tok->type == TOKEN_REDIRECTION) {
+        char* target = NULL;
+        if (tok->op != REDIR_DUP_IN && tok->op != REDIR_DUP_OUT) {
+            // Le token suivant est le fichier, ou le contenu (non découpé en champs) d'un here-document ou d'une here-string
+            const plan_token_t* file = &tokens[++*i];
+            int here = (tok->op == REDIR_HEREDOC || tok->op == REDIR_HERESTRING);
+            size_t n;
+            if (lexer_expand(&cmdl->arena, (const char*)(base + file->text), file->len, !here, &target, &n) != 0) return -1;
+            if (here && n == 0) target = "";
+            else if (n != 1) {
+                fprintf(stderr, "%s: redirection ambiguë\n", redirection_text[tok->op]);
+                return -1;
+            }
+        }
+        return record_redirection(proc, tok, target);
+    }
+
+    // Un "time" non protégé en tête de liste "&&"/"||" en mesure la durée et les ressources
+    if (list_head && first_stage && proc->argc == 0 && !proc->envp && !proc->invert && !proc->timed
+        && !(tok->flags & (TOKEN_QUOTED | TOKEN_SYMBOLIC)) && tok->len == 4 && memcmp(word, "time", 4) == 0) {
+        proc->timed = 1;
+        return 0;
+    }
+
+    // Un '!' non protégé en tête de pipeline inverse son code de retour
+    if (first_stage && proc->argc == 0 && !proc->invert && !(tok->flags & TOKEN_QUOTED) && tok->len == 1 && word[0] == '!') {
+        proc->invert = 1;
+        return 0;
+    }
+
+    // Les variables sont remplacées maintenant : le plan reste valable quand leurs valeurs changent
+    char* field = word;
+    size_t num_fields = 1;
+    if ((tok->flags & TOKEN_SYMBOLIC) && lexer_expand(&cmdl->arena, word, tok->len, tok->type != TOKEN_ASSIGNMENT, &field, &num_fields) != 0) {
+        perror("lexer_expand");
+        return -1;
+    }
+
+    // Affectation avant le nom de la commande : propre à la commande ("FOO=1 cmd"), ou au shell si la commande en est réduite là
+    if (tok->type == TOKEN_ASSIGNMENT && proc->argc == 0) {
+        if (add_assignment(proc, field) != 0) {
+            perror("add_assignment");
+            return -1;
+        }
+        return 0;
+    }
+
+    // Mot : chaque champ devient un argument
+    for (size_t f = 0; f < num_fields; ++f) {
+        // Premier argument => C'est la commande
+        if (proc->argc == 0) {
+            proc->path = field;
+        }
+        if (add_argument(proc, field) != 0) {
+            perror("add_argument");
+            return -1;
+        }
+        field += strlen(field) + 1;
+    }
+    return 0;
+}
+
+int plan_instantiate(command_line_t* cmdl, size_t token, control_flow_t** head) {
+    if (!cmdl || !cmdl->plan || !head || token >= cmdl->plan->num_tokens) return -1;
+
+    const plan_t* plan = cmdl->plan;
+    const plan_token_t* tokens = plan->tokens;
+    uintptr_t base = (uintptr_t)plan;
+    // Début de liste : début de ligne, après ";", "&" ou un mot réservé
+    const plan_token_t* prev = token ? &tokens[token - 1] : NULL;
+    int list_head = !prev || prev->type == TOKEN_KEYWORD
+                 || (prev->type == TOKEN_OPERATOR && (prev->op == OP_SEMICOLON || prev->op == OP_AMPERSAND));
+    // Processus courant (NULL après un "|", tant que l'étage suivant n'a pas commencé)
+    processus_t* current_proc = NULL;
+    // Mode d'ajout du prochain processus
+    control_flow_mode_t mode = UNCONDITIONAL;
+    int r = 0;
+
+    *head = NULL;
+    for (size_t i = token; i < plan->num_tokens && tokens[i].type != TOKEN_KEYWORD; ++i) {
+        const plan_token_t* tok = &tokens[i];
+        if (tok->type == TOKEN_OPERATOR) {
+            if (tok->op == OP_PIPE) {
+                // le tube est créé au lancement du pipeline
+                mode = PIPE;
+                current_proc = NULL;
+                continue;
+            }
+            if (tok->op == OP_AMPERSAND) current_proc->is_background = 1;
+            break;
+        }
+
+        // Début d'un nouvel étage
+        if (!current_proc) {
+            current_proc = add_processus(cmdl, mode);
+            if (!current_proc) {
+                perror("add_processus");
+                r = -1;
+                break;
+            }
+            if (!*head) *head = current_proc->cf;
+        }
+        // Les substitutions de processus des mots suivants sont transmises à cet étage
+        subst_attach(current_proc);
+        if (instantiate_token(cmdl, current_proc, tokens, &i, base, mode != PIPE, list_head) != 0) {
+            r = -1;
+            break;
+        }
+    }
+
+    subst_attach(NULL);
+    return r;
+}
+
+int plan_for_words(command_line_t* cmdl, size_t token, const char** name, char*** words, size_t* num_words) {
+    if (!cmdl || !cmdl->plan || !name || !words || !num_words || token >= cmdl->plan->num_tokens) return -1;
+
+    const plan_t* plan = cmdl->plan;
+    const plan_token_t* tokens = plan->tokens;
+    uintptr_t base = (uintptr_t)plan;
+    *name = (const char*)(base + tokens[token].text);
+    *words = NULL;
+    *num_words = 0;
+
+    size_t i = token + 1;
+    if (i >= plan->num_tokens || tokens[i].type != TOKEN_KEYWORD || tokens[i].op != KW_IN) return 0;
+
+    size_t capacity = 0;
+    for (++i; i < plan->num_tokens && tokens[i].type == TOKEN_WORD; ++i) {
+        char* field = (char*)(base + tokens[i].text);
+        size_t num_fields = 1;
+        if ((tokens[i].flags & TOKEN_SYMBOLIC) && lexer_expand(&cmdl->arena, field, tokens[i].len, 1, &field, &num_fields) != 0) {
+            perror("lexer_expand");
+            return -1;
+        }
+        for (size_t f = 0; f < num_fields; ++f) {
+            if (*num_words == capacity) {
+                size_t c = capacity ? capacity * 2 : 16;
+                char** w = arena_realloc(&cmdl->arena, *words, capacity * sizeof(char*), c * sizeof(char*));
+                if (!w) {
+                    perror("arena_realloc");
+                    return -1;
+                }
+                *words = w;
+                capacity = c;
+            }
+            (*words)[(*num_words)++] = field;
+            field += strlen(field) + 1;
+        }
+    }
+    return 0;
+}
+
+int plan_build(command_line_t* cmdl, const char* line, size_t len) {
+    if (!cmdl || !line) return -1;
+
+    uint64_t h = hash_line(line, len);
+    plan_slot_t* slot = &cache[h & (PLAN_CACHE_SIZE - 1)];
+    plan_t* plan = slot->plan;
+    plan_t* copy = NULL;
+    if (plan && slot->hash == h && plan->line_len == len && memcmp(plan_line(plan), line, len) == 0) {
+        plan->hits++;
+        cache_hits++;
+        // Le plan est copié : une commande de la ligne peut vider le cache pendant son exécution ("plancache -r")
+        copy = arena_alloc(&cmdl->arena, plan->size);
+        if (!copy) {
+            perror("arena_alloc");
+            return -1;
+        }
+        memcpy(copy, plan, plan->size);
+    } else {
+        cache_misses++;
+        size_t words_size;
+        ssize_t n = lex_line(&cmdl->arena, line, len, &words_size);
+        instruction_t* code = NULL;
+        size_t code_len = 0;
+        size_t size = 0;
+        if (n >= 0 && !(code = compile(&cmdl->arena, scratch, n, 0, &code_len))) perror("compile");
+        if (code) {
+            size = sizeof(plan_t) + n * sizeof(plan_token_t) + code_len * sizeof(instruction_t) + len + 1 + words_size;
+            copy = arena_alloc(&cmdl->arena, size);
+            if (!copy) perror("arena_alloc");
+            else pack(copy, line, len, n, code, code_len, size);
+        }
+        if (scratch_cap > PLAN_SCRATCH_KEEP) {
+            free(scratch);
+            scratch = NULL;
+            scratch_cap = 0;
+        }
+        if (!code || !copy) return (n == -2) ? 1 : -1;
+
+        // Le plan ne contient aucun pointeur : il est aussi conservé hors de l'arène, dans un bloc unique
+        if (size <= PLAN_MAX_SIZE && (plan = malloc(size)) != NULL) {
+            memcpy(plan, copy, size);
+            if (slot->plan) {
+                cache_evictions++;
+                cache_bytes -= slot->plan->size;
+                cache_count--;
+                free(slot->plan);
+            }
+            slot->hash = h;
+            slot->plan = plan;
+            cache_bytes += size;
+            cache_count++;
+        }
+    }
+
+    cmdl->plan = copy;
+    cmdl->code = plan_code(copy);
+    cmdl->code_len = copy->code_len;
+    return 0;
+}
+
+void plan_cache_clear(void) {
+    for (size_t i = 0; i < PLAN_CACHE_SIZE; ++i) {
+        free(cache[i].plan);
+        cache[i].plan = NULL;
+    }
+    cache_count = 0;
+    cache_bytes = 0;
+    cache_hits = 0;
+    cache_misses = 0;
+    cache_evictions = 0;
+}
+
+int plan_cache_print(int fd) {
+    dprintf(fd, "plancache: %zu entries (%zu bytes), %lu hits, %lu misses, %lu evictions\n",
+            cache_count, cache_bytes, cache_hits, cache_misses, cache_evictions);
+    for (size_t i = 0; i < PLAN_CACHE_SIZE; ++i) {
+        const plan_t* plan = cache[i].plan;
+        if (plan) dprintf(fd, "%8u\t%.*s\n", plan->hits, (int)(plan->line_len > 60 ? 60 : plan->line_len), plan_line(plan));
+    }
+    return (int)cache_count;
+}
@@ -15,6 +15,15 @@
 
 #include "processus.h"
 #include "builtins.h"
+#include "pathcache.h"
+#include "jobs.h"
+#include "env.h"
+#include "lexer.h"
+#include "plan.h"
+#include "trace.h"
+#include "subst.h"
+#include "zygote.h"
+#include "scheduler.h"
 
 
 
@@ -24,6 +33,10 @@
 #include <time.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <spawn.h>
+#include <limits.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
 
 
 /**
@@ -32,45 +45,59 @@
  * @return int 0 en cas de succès, -1 en cas d'erreur.
  * @details Cette fonction initialise les champs de la structure avec les valeurs suivantes:
  * - *pid*: 0
- * - *argv*: {NULL}
- * - *envp*: {NULL}
+ * - *pgid*: 0
+ * - *argv*: {NULL} (tableau vide partagé, *argc* et *argv_capacity* à 0)
+ * - *envp*: NULL
  * - *path*: NULL
  * - *stdin_fd*: 0
  * - *stdout_fd*: 1
  * - *stderr_fd*: 2
+ * - *redirs*: NULL (*num_redirs* et *redirs_capacity* à 0)
  * - *status*: 0
  * - *is_background*: 0
+ * - *invert*: 0
+ * - *timed*: 0
+ * - *zygote*: 0
  * - *start_time*: {0}
  * - *end_time*: {0}
+ * - *rusage*: {0}
  * - *cf*: NULL
  */
- 
-#define MAX_FDS 32
-#define MAX_TOKENS 128
-
 int init_processus(processus_t* proc) {
+    /* vecteur vide partagé : jamais modifié, add_argument() alloue un vrai tableau au premier argument */
+    static char* empty_argv[] = {NULL};
+
     if (!proc) return -1;
 
     proc->pid = 0;
+    proc->pgid = 0;
 
-    for (int i = 0; i < MAX_ARGS; i++)
-        proc->argv[i] = NULL;
-
-    for (int i = 0; i < MAX_ENV; i++) {
-        proc->envp[i] = NULL;
-     } 
+    proc->argv = empty_argv;
+    proc->argc = 0;
+    proc->argv_capacity = 0;
+    proc->envp = NULL;
 
     proc->path = NULL;
 
     proc->stdin_fd = 0;
     proc->stdout_fd = 1;
     proc->stderr_fd = 2;
+    proc->redirs = NULL;
+    proc->num_redirs = 0;
+    proc->redirs_capacity = 0;
+    proc->inherited = NULL;
+    proc->num_inherited = 0;
+    proc->inherited_capacity = 0;
 
     proc->status = 0;
     proc->is_background = 0;
+    proc->invert = 0;
+    proc->timed = 0;
+    proc->zygote = 0;
 
     memset(&proc->start_time, 0, sizeof(struct timespec));
     memset(&proc->end_time, 0, sizeof(struct timespec));
+    memset(&proc->rusage, 0, sizeof(struct rusage));
 
     proc->cf = NULL;
 
@@ -78,33 +105,439 @@ int init_processus(processus_t* proc) {
 
 }
 
-/** @brief Fonction de lancement d'un processus à partir d'une structure de processus.
+/** @brief Fonction d'ajout d'un argument à un processus.
+ * @param proc Pointeur vers la structure de processus (rattachée à une ligne de commande via *cf*).
+ * @param arg Argument à ajouter (non copié : il doit vivre aussi longtemps que la ligne).
+ * @return int 0 en cas de succès, -1 en cas d'erreur (processus non rattaché, mémoire insuffisante).
+ * @details Le tableau *argv* est alloué dans l'arène de la ligne et sa capacité est doublée lorsqu'il est plein :
+ *    les arguments d'une commande sont généralement les dernières allocations de l'arène, le tableau est alors agrandi sur place.
+ */
+int add_argument(processus_t* proc, char* arg) {
+    if (!proc || !arg || !proc->cf || !proc->cf->cmdl) return -1;
+
+    if (proc->argc + 1 >= proc->argv_capacity) {
+        arena_t* arena = &proc->cf->cmdl->arena;
+        size_t capacity = proc->argv_capacity ? proc->argv_capacity * 2 : 8;
+        char** argv = arena_realloc(arena, proc->argv_capacity ? proc->argv : NULL,
+                                    proc->argv_capacity * sizeof(char*), capacity * sizeof(char*));
+        if (!argv) return -1;
+        proc->argv = argv;
+        proc->argv_capacity = capacity;
+    }
+
+    proc->argv[proc->argc++] = arg;
+    proc->argv[proc->argc] = NULL;
+    return 0;
+}
+
+/** @brief Fonction d'ajout d'une affectation propre à un processus ("FOO=1 cmd").
+ * @param proc Pointeur vers la structure de processus (rattachée à une ligne de commande via *cf*).
+ * @param assignment Affectation "NOM=valeur" (non copiée : elle doit vivre aussi longtemps que la ligne).
+ * @return int 0 en cas de succès, -1 en cas d'erreur (processus non rattaché, mémoire insuffisante).
+ * @details Le tableau *envp* est alloué dans l'arène de la ligne. Il ne contient que les affectations de la commande :
+ *    l'environnement complet est construit au lancement à partir des variables exportées du shell.
+ */
+int add_assignment(processus_t* proc, char* assignment) {
+    if (!proc || !assignment || !proc->cf || !proc->cf->cmdl) return -1;
+
+    /* peu d'affectations par commande : le tableau est agrandi d'une case à chaque ajout */
+    size_t n = 0;
+    while (proc->envp && proc->envp[n]) n++;
+    char** envp = arena_realloc(&proc->cf->cmdl->arena, proc->envp, (n + 1) * sizeof(char*), (n + 2) * sizeof(char*));
+    if (!envp) return -1;
+
+    envp[n] = assignment;
+    envp[n + 1] = NULL;
+    proc->envp = envp;
+    return 0;
+}
+
+/** @brief Fonction d'ajout d'une redirection à un processus.
+ * @param proc Pointeur vers la structure de processus (rattachée à une ligne de commande via *cf*).
+ * @param type Type de redirection (redirection_t).
+ * @param fd Descripteur redirigé (0, 1 ou 2).
+ * @param target_fd Descripteur dupliqué pour REDIR_DUP_IN et REDIR_DUP_OUT (0, 1 ou 2).
+ * @param path Fichier cible, ou contenu pour REDIR_HEREDOC et REDIR_HERESTRING (non copié : il doit vivre aussi longtemps que la ligne).
+ * @return int 0 en cas de succès, -1 en cas d'erreur (processus non rattaché, mémoire insuffisante).
+ * @details La redirection n'est qu'enregistrée : le fichier est ouvert au lancement du processus, si celui-ci a lieu.
+ *    Le tableau *redirs* est alloué dans l'arène de la ligne et sa capacité est doublée lorsqu'il est plein.
+ */
+int add_redirection(processus_t* proc, int type, int fd, int target_fd, char* path) {
+    if (!proc || !proc->cf || !proc->cf->cmdl) return -1;
+
+    if (proc->num_redirs == proc->redirs_capacity) {
+        size_t capacity = proc->redirs_capacity ? proc->redirs_capacity * 2 : 4;
+        redirect_t* redirs = arena_realloc(&proc->cf->cmdl->arena, proc->redirs,
+                                           proc->redirs_capacity * sizeof(redirect_t), capacity * sizeof(redirect_t));
+        if (!redirs) return -1;
+        proc->redirs = redirs;
+        proc->redirs_capacity = capacity;
+    }
+
+    redirect_t* r = &proc->redirs[proc->num_redirs++];
+    r->type = (uint8_t)type;
+    r->fd = fd;
+    r->target_fd = target_fd;
+    r->path = path;
+    r->opened = -1;
+    return 0;
+}
+
+/** @brief Fonction d'ajout d'un descripteur transmis tel quel à un processus.
+ * @param proc Pointeur vers la structure de processus (rattachée à une ligne de commande via *cf*).
+ * @param fd Descripteur ouvert par le shell (O_CLOEXEC), déjà listé dans *opened_descriptors*.
+ * @return int 0 en cas de succès, -1 en cas d'erreur (processus non rattaché, mémoire insuffisante).
+ * @details Le descripteur reste ouvert sous le même numéro dans la commande (accès par /dev/fd/N) ;
+ *    le shell le ferme dès le lancement effectué, comme les fichiers de redirection.
+ */
+int add_inherited_fd(processus_t* proc, int fd) {
+    if (!proc || !proc->cf || !proc->cf->cmdl || fd < 0) return -1;
+
+    if (proc->num_inherited == proc->inherited_capacity) {
+        size_t capacity = proc->inherited_capacity ? proc->inherited_capacity * 2 : 4;
+        int* fds = arena_realloc(&proc->cf->cmdl->arena, proc->inherited,
+                                 proc->inherited_capacity * sizeof(int), capacity * sizeof(int));
+        if (!fds) return -1;
+        proc->inherited = fds;
+        proc->inherited_capacity = capacity;
+    }
+
+    proc->inherited[proc->num_inherited++] = fd;
+    return 0;
+}
+
+/** @brief Fonction de fermeture, dans le shell, des fichiers ouverts pour les redirections d'un processus et des descripteurs qui lui sont transmis.
+ * @param proc Pointeur vers la structure de processus.
+ * @details Appelée dès que le processus est lancé (le fils possède ses propres copies) ou que la commande intégrée est terminée.
+ */
+static void close_redirections(processus_t* proc) {
+    for (size_t i = 0; i < proc->num_redirs; ++i) {
+        if (proc->redirs[i].opened < 0) continue;
+        if (!proc->cf || release_fd(proc->cf->cmdl, proc->redirs[i].opened) != 0) close(proc->redirs[i].opened);
+        proc->redirs[i].opened = -1;
+    }
+    /* extrémités de tubes des substitutions de processus : seule la commande les garde (le producteur d'un "<(...)" reçoit EPIPE quand elle se termine) */
+    for (size_t i = 0; i < proc->num_inherited; ++i)
+        if (proc->cf) release_fd(proc->cf->cmdl, proc->inherited[i]);
+    proc->num_inherited = 0;
+}
+
+/** @brief Fermeture d'un fichier de redirection remplacé par une redirection suivante ("cmd > a > b" ne garde que b ouvert).
+ * @param proc Pointeur vers la structure de processus.
+ * @param count Nombre de redirections déjà appliquées.
+ * @param fd Descripteur remplacé.
+ * @param slot Descripteur standard qui le référençait (les deux autres peuvent encore l'utiliser, après un 2>&1 par exemple).
+ */
+static void drop_replaced(processus_t* proc, size_t count, int fd, const int* slot) {
+    if ((slot != &proc->stdin_fd && proc->stdin_fd == fd) || (slot != &proc->stdout_fd && proc->stdout_fd == fd)
+        || (slot != &proc->stderr_fd && proc->stderr_fd == fd)) return;
+    for (size_t i = 0; i < count; ++i) {
+        if (proc->redirs[i].opened != fd) continue;
+        if (!proc->cf || release_fd(proc->cf->cmdl, fd) != 0) close(fd);
+        proc->redirs[i].opened = -1;
+        return;
+    }
+}
+
+/** @brief Écriture complète d'un bloc, reprise après une écriture partielle ou une interruption. */
+static int write_full(int fd, const char* data, size_t len) {
+    while (len > 0) {
+        ssize_t n = write(fd, data, len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        data += n;
+        len -= n;
+    }
+    return 0;
+}
+
+/** @brief Ouverture en lecture du contenu d'un here-document ou d'une here-string, sans fichier temporaire ni processus auxiliaire.
+ * @param content Contenu (variables déjà remplacées).
+ * @param newline 1 pour ajouter un saut de ligne final (here-string).
+ * @return int Descripteur (O_CLOEXEC) positionné au début du contenu, -1 en cas d'erreur.
+ * @details Un contenu d'au plus PIPE_BUF octets est écrit en une fois dans un tube neuf, ce qui ne peut pas bloquer ; au-delà, il est écrit
+ *    dans un fichier anonyme en mémoire (*memfd_create()*) relu depuis le début, que la commande peut lire à son rythme.
+ */
+static int open_heredoc(const char* content, int newline) {
+    size_t len = strlen(content);
+    if (len + newline <= PIPE_BUF) {
+        int p[2];
+        if (pipe2(p, O_CLOEXEC) != 0) return -1;
+        struct iovec iov[2] = { { (void*)content, len }, { "\n", (size_t)newline } };
+        ssize_t n = writev(p[1], iov, 2);
+        close(p[1]);
+        if (n != (ssize_t)(len + newline)) {
+            close(p[0]);
+            return -1;
+        }
+        return p[0];
+    }
+
+    int fd = memfd_create("heredoc", MFD_CLOEXEC);
+    if (fd < 0) return -1;
+    if (write_full(fd, content, len) != 0 || write_full(fd, "\n", newline) != 0 || lseek(fd, 0, SEEK_SET) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/** @brief Fonction d'application des redirections d'un processus, au moment de son lancement.
+ * @param proc Pointeur vers la structure de processus (descripteurs des tubes déjà positionnés).
+ * @return int 0 en cas de succès, -1 si un fichier ne peut pas être ouvert (message affiché, fichiers déjà ouverts refermés).
+ * @details Les redirections sont appliquées dans leur ordre d'apparition sur *stdin_fd*, *stdout_fd* et *stderr_fd* :
+ *    "cmd 2>&1 | suite" envoie donc l'erreur dans le tube, "cmd 2>&1 > f" la laisse sur la sortie précédente.
+ *    Les fichiers sont ouverts avec O_CLOEXEC (aucun autre étage n'en hérite) et ajoutés à *opened_descriptors*.
+ *    Le contenu d'un here-document ou d'une here-string est placé dans un tube ou un fichier anonyme (*open_heredoc()*).
+ *    Avec le traçage, chaque ouverture est enregistrée (catégorie "redirect").
+ */
+static int open_redirections(processus_t* proc) {
+    for (size_t i = 0; i < proc->num_redirs; ++i) {
+        redirect_t* r = &proc->redirs[i];
+        int* slot = (r->fd == STDIN_FILENO) ? &proc->stdin_fd
+                  : (r->fd == STDOUT_FILENO) ? &proc->stdout_fd : &proc->stderr_fd;
+
+        if (r->type == REDIR_DUP_IN || r->type == REDIR_DUP_OUT) {
+            int fd = (r->target_fd == STDIN_FILENO) ? proc->stdin_fd
+                   : (r->target_fd == STDOUT_FILENO) ? proc->stdout_fd : proc->stderr_fd;
+            if (fd != *slot) drop_replaced(proc, i, *slot, slot);
+            *slot = fd;
+            continue;
+        }
+
+        int here = (r->type == REDIR_HEREDOC || r->type == REDIR_HERESTRING);
+        int flags = (r->type == REDIR_IN) ? O_RDONLY
+                  : (r->type == REDIR_APPEND) ? O_WRONLY | O_CREAT | O_APPEND
+                  : O_WRONLY | O_CREAT | O_TRUNC;
+        int64_t start = trace_enabled ? trace_clock() : 0;
+        int fd = here ? open_heredoc(r->path, r->type == REDIR_HERESTRING) : open(r->path, flags | O_CLOEXEC, 0644);
+        if (trace_enabled) trace_span("redirect", here ? (r->type == REDIR_HEREDOC ? "<<" : "<<<") : r->path, start, trace_clock(), 0, "fd", r->fd, NULL);
+        if (fd < 0 || (proc->cf && proc->cf->cmdl && add_fd(proc->cf->cmdl, fd) != 0)) {
+            if (fd < 0) perror(here ? "here-document" : r->path);
+            else close(fd);
+            close_redirections(proc);
+            return -1;
+        }
+        r->opened = fd;
+        drop_replaced(proc, i, *slot, slot);
+        *slot = fd;
+    }
+    return 0;
+}
+
+/** @brief Fermeture, dans un fils créé par *fork()*, des descripteurs de *first* à *last* inclus.
+ * @details Un seul appel *close_range()* quel que soit le nombre de descripteurs ; à défaut (glibc ou noyau trop anciens),
+ *    les descripteurs sont fermés un par un jusqu'à la limite *sysconf(_SC_OPEN_MAX)*.
+ */
+static void close_range_fallback(int first, unsigned last) {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 34))
+    if (close_range((unsigned)first, last, 0) == 0) return;
+#endif
+    long max = sysconf(_SC_OPEN_MAX);
+    if (max <= 0) max = 1024;
+    for (long fd = first; fd < max && (unsigned long)fd <= last; ++fd) close((int)fd);
+}
+
+/** @brief Fermeture, dans un fils créé par *fork()*, de tous les descripteurs à partir de *first*.
+ * @param proc Processus exécuté par le fils.
+ * @param first Premier descripteur à fermer.
+ * @details Le fichier de trace, s'il est ouvert, est conservé : le fils y écrit ses propres événements avant de se terminer.
+ *    Les descripteurs transmis à la commande (*inherited*) sont conservés aussi ; les intervalles qui les séparent sont fermés d'un seul appel chacun.
+ */
+static void close_descriptors_from(const processus_t* proc, int first) {
+    int keep[proc->num_inherited + 1];
+    size_t n = 0;
+    keep[n++] = trace_descriptor();
+    for (size_t i = 0; i < proc->num_inherited; ++i) {
+        /* tri par insertion : quelques descripteurs au plus */
+        size_t k = n++;
+        for (; k > 0 && keep[k - 1] > proc->inherited[i]; --k) keep[k] = keep[k - 1];
+        keep[k] = proc->inherited[i];
+    }
+
+    for (size_t i = 0; i < n; ++i) {
+        if (keep[i] < first) continue;
+        if (keep[i] > first) close_range_fallback(first, (unsigned)keep[i] - 1);
+        first = keep[i] + 1;
+    }
+    close_range_fallback(first, ~0U);
+}
+
+/** @brief Fonction de calcul des signaux à remettre à leur comportement par défaut dans un fils.
+ * @param proc Pointeur vers la structure de processus lancée.
+ * @param set Ensemble de signaux à remplir.
+ * @details Le shell ignore SIGINT (et, avec le contrôle des jobs, SIGQUIT, SIGTSTP, SIGTTIN, SIGTTOU) : ces dispositions seraient héritées à travers *execve()*.
+ *    Sans contrôle des jobs, un processus en arrière-plan garde SIGINT ignoré pour ne pas être tué par un Ctrl-C destiné au premier plan.
+ */
+static void child_default_signals(const processus_t* proc, sigset_t* set) {
+    sigemptyset(set);
+    if (!proc->is_background || job_control_enabled()) sigaddset(set, SIGINT);
+    sigaddset(set, SIGQUIT);
+    sigaddset(set, SIGTSTP);
+    sigaddset(set, SIGTTIN);
+    sigaddset(set, SIGTTOU);
+    sigaddset(set, SIGCHLD);
+    sigaddset(set, SIGPIPE);
+}
+
+/** @brief Lancement de l'exécutable *exe* par le serveur de lancement s'il peut servir la commande, par *posix_spawn()* sinon.
+ * @param pid Pointeur dans lequel est renvoyé le PID du fils (0 si *execve()* a échoué dans le serveur).
+ * @return int 0 en cas de succès, un numéro d'erreur sinon (comme *posix_spawn()*).
+ * @details Le serveur ne lance que les commandes au premier plan sans contrôle des jobs : ses fils ne peuvent ni rejoindre le groupe
+ *    d'un job ni être récupérés par le gestionnaire de SIGCHLD de la table des jobs. S'il est indisponible, le lancement se fait directement.
+ */
+static int spawn_exe(processus_t* proc, const char* exe, const posix_spawn_file_actions_t* actions, const posix_spawnattr_t* attr,
+                     const sigset_t* sigdef, char** envp, pid_t* pid) {
+    proc->zygote = 0;
+    if (zygote_enabled() && !job_control_enabled() && !proc->is_background && proc->num_inherited <= ZYGOTE_MAX_INHERITED) {
+        zygote_request_t req = {
+            exe, proc->argv, envp,
+            { proc->stdin_fd >= 0 ? proc->stdin_fd : STDIN_FILENO, proc->stdout_fd >= 0 ? proc->stdout_fd : STDOUT_FILENO,
+              proc->stderr_fd >= 0 ? proc->stderr_fd : STDERR_FILENO },
+            proc->inherited, proc->num_inherited, sigdef
+        };
+        int err = 0;
+        pid_t p = zygote_spawn(&req, &err);
+        if (p >= 0) {
+            *pid = p;
+            proc->zygote = (p > 0);
+            return err;
+        }
+    }
+    return posix_spawn(pid, exe, actions, attr, proc->argv, envp);
+}
+
+/** @brief Fonction de lancement d'une commande externe via *posix_spawn()*.
  * @param proc Pointeur vers la structure de processus à lancer.
- * @return int 0 en cas de succès, un code d'erreur sinon.
- * @details Cette fonction utilise *fork()* et *execve()* pour lancer le processus décrit par la structure.
- *    Elle gère également les redirections des IOs standards (via *dup2()*).
- *    En cas de succès, le champ *pid* de la structure est mis à jour avec le PID du processus fils.
- *    Le flag *is_background* détermine si on attend la fin du processus ou non.
- *    La valeur de *status* est mise à jour à l'issue de l'exécution avec le code de retour du processus fils lorsque le flag *is_background* est désactivé.
- *    Les temps de démarrage et d'arrêt sont enregistrés dans *start_time* et *end_time* respectivement. *end_time* est mis à jour uniquement si *is_background* est désactivé.
- *    Les descripteurs de fichiers ouverts sont gérés dans *cf->cmdl->opened_descriptors* : le processus "fils" ferme tous les descripteurs listés dans ce tableau avant d'exécuter la commande.
+ * @return int 0 en cas de succès (y compris commande introuvable), -1 en cas d'erreur de préparation.
+ * @details La glibc implémente *posix_spawn()* avec *clone(CLONE_VM|CLONE_VFORK)* : contrairement à *fork()*, le coût du lancement ne dépend
+ *    ni de la taille du tas du shell ni du nombre de pages à recopier en copie sur écriture.
+ *    Les redirections des IOs standards deviennent des actions *dup2* (la copie perd O_CLOEXEC) ; les autres descripteurs du shell,
+ *    tous ouverts avec O_CLOEXEC, sont fermés par *execve()* sans action *close*. Les signaux ignorés par le shell y sont remis à leur comportement par défaut et le masque est vidé.
+ *    Avec le contrôle des jobs, le fils rejoint le groupe *proc->pgid* (un nouveau groupe si 0) et prend le terminal s'il est au premier plan.
+ *    Le chemin de l'exécutable est résolu par *path_resolve()* : le fils n'a pas à parcourir le PATH.
+ *    Avec l'option -z, une commande au premier plan sans contrôle des jobs est lancée par le serveur de lancement (*spawn_exe()*).
+ *    L'environnement est celui des variables exportées (*env_environ()*), complété par les affectations de *proc->envp*.
+ *    Si la commande ne peut pas être exécutée, le message d'erreur est écrit par le parent sur la sortie d'erreur de la commande (*stderr_fd*, redirections comprises)
+ *    et *status* vaut le code 127 (126 si elle n'est pas exécutable).
  */
- 
-int launch_processus(processus_t* proc) {
+static int spawn_processus(processus_t* proc) {
+    posix_spawn_file_actions_t actions;
+    posix_spawnattr_t attr;
+    sigset_t sigdef, sigmask;
+    short flags = POSIX_SPAWN_SETSIGDEF | POSIX_SPAWN_SETSIGMASK;
+
+    if (posix_spawn_file_actions_init(&actions) != 0) return -1;
+    if (posix_spawnattr_init(&attr) != 0) {
+        posix_spawn_file_actions_destroy(&actions);
+        return -1;
+    }
+
+    int err = 0;
+    if (job_control_enabled()) {
+        flags |= POSIX_SPAWN_SETPGROUP;
+        err = posix_spawnattr_setpgroup(&attr, proc->pgid);
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 35))
+        /* le fils prend lui-même le terminal, avant toute redirection de son entrée standard */
+        if (!proc->is_background)
+            err = err ? err : posix_spawn_file_actions_addtcsetpgrp_np(&actions, job_terminal());
+#endif
+    }
+
+    /* Appliquer redirections (si différents des standards) */
+    if (proc->stdin_fd >= 0 && proc->stdin_fd != STDIN_FILENO)
+        err = err ? err : posix_spawn_file_actions_adddup2(&actions, proc->stdin_fd, STDIN_FILENO);
+    if (proc->stdout_fd >= 0 && proc->stdout_fd != STDOUT_FILENO)
+        err = err ? err : posix_spawn_file_actions_adddup2(&actions, proc->stdout_fd, STDOUT_FILENO);
+    if (proc->stderr_fd >= 0 && proc->stderr_fd != STDERR_FILENO)
+        err = err ? err : posix_spawn_file_actions_adddup2(&actions, proc->stderr_fd, STDERR_FILENO);
+
+    /* Aucune action close : tous les descripteurs ouverts par le shell sont en O_CLOEXEC et disparaissent à l'execve() ;
+     * un dup2 sur lui-même retire O_CLOEXEC aux descripteurs transmis tels quels (substitutions de processus) */
+    for (size_t i = 0; i < proc->num_inherited; ++i)
+        err = err ? err : posix_spawn_file_actions_adddup2(&actions, proc->inherited[i], proc->inherited[i]);
+
+    /* Signaux ignorés par le shell remis par défaut ; SIGCHLD peut être bloqué pendant le lancement d'un job */
+    child_default_signals(proc, &sigdef);
+    sigemptyset(&sigmask);
+    err = err ? err : posix_spawnattr_setsigdefault(&attr, &sigdef);
+    err = err ? err : posix_spawnattr_setsigmask(&attr, &sigmask);
+    err = err ? err : posix_spawnattr_setflags(&attr, flags);
+
+    /* Environnement exporté du shell (en cache), complété par les affectations propres à la commande */
+    char** envp = (proc->envp && proc->cf && proc->cf->cmdl) ? env_merge(&proc->cf->cmdl->arena, proc->envp) : env_environ();
+    if (!envp) err = err ? err : ENOMEM;
+
+    pid_t pid = 0;
+    int64_t start = trace_enabled ? trace_clock() : 0;
+    if (!err) {
+        /* Résolution dans le PATH faite une fois par le shell (cache) : le fils appelle directement execve() */
+        const char* exe = path_resolve(proc->path);
+        if (exe) {
+            err = spawn_exe(proc, exe, &actions, &attr, &sigdef, envp, &pid);
+            if (err == ENOENT && exe != proc->path) {
+                /* l'exécutable mémorisé a disparu : nouvelle résolution */
+                path_cache_forget(proc->path);
+                exe = path_resolve(proc->path);
+                err = exe ? spawn_exe(proc, exe, &actions, &attr, &sigdef, envp, &pid) : ENOENT;
+            }
+        }
+        if (!exe) {
+            dprintf(proc->stderr_fd >= 0 ? proc->stderr_fd : STDERR_FILENO, "%s: command not found\n", proc->path);
+            proc->status = W_EXITCODE(127, 0);
+            pid = 0;
+        } else if (err) {
+            /* Si exec échoue : le message suit la sortie d'erreur de la commande (redirection, pipe) */
+            dprintf(proc->stderr_fd >= 0 ? proc->stderr_fd : STDERR_FILENO, "%s: %s\n", proc->path, strerror(err));
+            proc->status = W_EXITCODE((err == ENOENT) ? 127 : 126, 0);
+            pid = 0;
+            err = 0;
+        }
+    } else {
+        fprintf(stderr, "posix_spawn: %s\n", strerror(err));
+        err = -1;
+    }
+
+    posix_spawnattr_destroy(&attr);
+    posix_spawn_file_actions_destroy(&actions);
+    if (trace_enabled) trace_span("spawn", proc->path, start, trace_clock(), 0, "pid", pid, NULL);
+
+    proc->pid = pid;
+    return err;
+}
+
+/** @brief Fonction de démarrage d'un processus sans attente de sa terminaison.
+ * @param proc Pointeur vers la structure de processus à démarrer.
+ * @return int 0 en cas de succès, -1 en cas d'erreur (échec de *fork()*).
+ * @details Cette fonction effectue le lancement décrit pour *launch_processus()* mais rend la main immédiatement au parent.
+ *    Contrairement à *launch_processus()*, une commande intégrée est toujours exécutée dans le processus fils : cette fonction est utilisée
+ *    pour les étages d'un pipeline, qui doivent tous s'exécuter en parallèle.
+ *    Avec le contrôle des jobs, le processus est placé dans le groupe *pgid* (0 : nouveau groupe dont il est le leader).
+ *    Les redirections sont appliquées ici : si un fichier ne peut pas être ouvert, le processus n'est pas lancé et *status* vaut le code 1.
+ *    Les fichiers ouverts restent ouverts dans le parent jusqu'à l'appel de *release_stage_fds()*.
+ *    Un processus sans commande (*path* NULL) n'est pas lancé : son *pid* reste à 0 et son *status* à 0 (ses redirections sont tout de même ouvertes, "> f" crée f).
+ */
+int start_processus(processus_t* proc) {
     if (!proc) return -1;
 
-    /* Si c'est un builtin et qu'on est en foreground : exécution dans le parent */
-    if (is_builtin(proc) && !proc->is_background) {
-        int r = exec_builtin(proc);
-        proc->status = (r == 0) ? 0 : 1;
-        return (r == 0) ? 0 : -1;
+    proc->pid = 0;
+    proc->status = 0;
+    proc->zygote = 0;
+    if (open_redirections(proc) != 0) {
+        proc->status = W_EXITCODE(1, 0);
+        return 0;
     }
+    if (!proc->path) return 0;
 
-    /* Enregistrer le temps de démarrage si le champ existe */
-    #if defined(CLOCK_REALTIME)
-    clock_gettime(CLOCK_REALTIME, &proc->start_time);
-    #endif
+    /* Enregistrer le temps de démarrage (horloge monotone : insensible aux changements de l'heure système) */
+    clock_gettime(CLOCK_MONOTONIC, &proc->start_time);
 
+    /* Les commandes externes passent par posix_spawn() : le fork() n'est gardé que pour les builtins */
+    if (!is_builtin(proc)) return spawn_processus(proc);
+
+    int64_t start = trace_enabled ? trace_clock() : 0;
     pid_t pid = fork();
     if (pid < 0) {
         perror("fork");
@@ -113,7 +546,19 @@ int launch_processus(processus_t* proc) {
 
     if (pid == 0) {
         /* ---------- enfant ---------- */
-        signal(SIGINT, SIG_DFL);  // ajoute pour restaurer le comportement par defaut de sigint
+        trace_fork_child();
+        zygote_leave();
+        sched_leave();
+        sigset_t sigdef;
+        child_default_signals(proc, &sigdef);
+        for (int sig = 1; sig < NSIG; ++sig) {
+            if (sigismember(&sigdef, sig) == 1) signal(sig, SIG_DFL);
+        }
+        if (job_control_enabled()) {
+            setpgid(0, proc->pgid);
+            if (!proc->is_background) job_give_terminal(getpgrp());
+        }
+        job_unblock_sigchld();
 
         /* Appliquer redirections (si différents des standards) */
         if (proc->stdin_fd >= 0 && proc->stdin_fd != STDIN_FILENO) {
@@ -135,72 +580,323 @@ int launch_processus(processus_t* proc) {
             }
         }
 
-        /* Fermer les descripteurs listés dans cmdl->opened_descriptors s'ils existent */
-        if (proc->cf && proc->cf->cmdl) {
-            for (int i = 0; i < MAX_FDS; ++i) {
-                int fd = proc->cf->cmdl->opened_descriptors[i];
-                if (fd >= 0) {
-                    /* ne pas fermer les std fds préalablement dupliqués (ils valent 0/1/2) */
-                    if (fd != STDIN_FILENO && fd != STDOUT_FILENO && fd != STDERR_FILENO)
-                        close(fd);
-                }
+        /* Pas d'execve() pour fermer les descripteurs O_CLOEXEC : tout ce qui dépasse 2 est fermé d'un seul appel
+         * (le fils ne doit pas garder l'extrémité de lecture de son propre tube, sans quoi il ne recevrait jamais EPIPE) */
+        close_descriptors_from(proc, STDERR_FILENO + 1);
+
+        /* Builtin (arrière-plan ou étage de pipeline) -> exécution dans l'enfant (ne changera pas le parent) */
+        proc->stdin_fd = STDIN_FILENO;
+        proc->stdout_fd = STDOUT_FILENO;
+        proc->stderr_fd = STDERR_FILENO;
+        int64_t run = trace_enabled ? trace_clock() : 0;
+        int r = exec_builtin(proc) & 0xff;
+        if (trace_enabled) {
+            trace_span("builtin", proc->path, run, trace_clock(), 0, "status", r, NULL);
+            trace_flush();
+        }
+        _exit(r);
+    }
+
+    /* ---------- parent ---------- */
+    if (trace_enabled) trace_span("fork", proc->path, start, trace_clock(), 0, "pid", pid, NULL);
+    proc->pid = pid;
+    /* même appel que dans le fils, pour ne pas dépendre de l'ordonnancement */
+    if (job_control_enabled()) setpgid(pid, proc->pgid ? proc->pgid : pid);
+    return 0;
+}
+
+/** @brief Fonction d'attente de la terminaison d'un processus démarré par *start_processus()*.
+ * @param proc Pointeur vers la structure de processus à attendre.
+ * @return int 0 si le processus s'est terminé avec succès, son code de retour (ou 128 + numéro de signal) sinon, -1 en cas d'erreur.
+ * @details Les champs *status*, *end_time* et *rusage* sont mis à jour (attente par *wait4()*, ou *zygote_wait()* pour un fils du serveur de lancement) ;
+ *    *end_time* n'est renseigné que si le processus est terminé.
+ *    Avec le contrôle des jobs, la fonction retourne aussi lorsque le processus est suspendu (WIFSTOPPED(*status*) est alors vrai).
+ *    Si *pid* vaut 0 (processus non lancé), la fonction retourne immédiatement.
+ *    Avec le traçage, l'attente (catégorie "wait") et la vie du fils, du lancement à sa terminaison (catégorie "child", sur la ligne de son PID), sont enregistrées.
+ */
+int wait_processus(processus_t* proc) {
+    if (!proc) return -1;
+    /* processus non lancé (commande vide ou introuvable) : le statut est déjà positionné */
+    if (proc->pid <= 0) return WIFEXITED(proc->status) ? WEXITSTATUS(proc->status) : 0;
+
+    int wstatus = 0;
+    int options = job_control_enabled() ? WUNTRACED : 0;
+    int64_t start = trace_enabled ? trace_clock() : 0;
+    if (proc->zygote) {
+        /* fils du serveur de lancement : statut et ressources transmis par la socket */
+        if (zygote_wait(proc->pid, &wstatus, &proc->rusage) < 0) {
+            perror("zygote_wait");
+            return -1;
+        }
+    } else {
+        while (wait4(proc->pid, &wstatus, options, &proc->rusage) < 0) {
+            if (errno != EINTR) {
+                perror("wait4");
+                return -1;
             }
         }
+    }
 
-        /* Si builtin et background -> exécution dans l'enfant (ne changera pas le parent) */
-        if (is_builtin(proc)) {
-            int r = exec_builtin(proc);
-            _exit((r == 0) ? 0 : 1);
+    /* enregistrer status */
+    proc->status = wstatus;
+    if (trace_enabled) trace_span("wait", proc->path, start, trace_clock(), 0, "pid", proc->pid, NULL);
+    if (WIFSTOPPED(wstatus)) return 128 + WSTOPSIG(wstatus);
+
+    /* enregistrer end_time */
+    clock_gettime(CLOCK_MONOTONIC, &proc->end_time);
+    if (trace_enabled)
+        trace_span("child", proc->path, trace_timespec(proc->start_time), trace_timespec(proc->end_time), proc->pid, "status",
+                   WIFEXITED(wstatus) ? WEXITSTATUS(wstatus) : 128 + WTERMSIG(wstatus), NULL);
+
+    /* retourner 0 si exit code 0 sinon code d'erreur non nul */
+    if (WIFEXITED(wstatus)) {
+        return WEXITSTATUS(wstatus);
+    } else if (WIFSIGNALED(wstatus)) {
+        return 128 + WTERMSIG(wstatus);
+    }
+    return -1;
+}
+
+/** @brief Fonction d'exécution d'une commande intégrée dans le processus du shell.
+ * @param proc Pointeur vers la structure de processus à exécuter.
+ * @param b Commande intégrée, déjà résolue à la compilation de la ligne (NULL : recherchée d'après *proc->path*).
+ * @return int Code de retour de la commande (1 si une redirection échoue).
+ * @details Les redirections sont ouvertes juste avant la commande et refermées juste après.
+ *    Avec le traçage, l'exécution est enregistrée (catégorie "builtin").
+ */
+static int run_builtin_in_shell(processus_t* proc, const builtin_t* b) {
+    clock_gettime(CLOCK_MONOTONIC, &proc->start_time);
+    int r = (open_redirections(proc) == 0) ? (b ? b->fn(proc) : exec_builtin(proc)) & 0xff : 1;
+    close_redirections(proc);
+    clock_gettime(CLOCK_MONOTONIC, &proc->end_time);
+    if (trace_enabled)
+        trace_span("builtin", proc->path, trace_timespec(proc->start_time), trace_timespec(proc->end_time), 0, "status", r, NULL);
+    /* statut au format de waitpid() pour que WIFEXITED/WEXITSTATUS s'appliquent aussi aux builtins */
+    proc->status = W_EXITCODE(r, 0);
+    return r;
+}
+
+/** @brief Fonction d'exécution d'une commande réduite à des affectations ("X=1"), qui modifient les variables du shell.
+ * @param proc Pointeur vers la structure de processus (sans commande, *envp* non NULL).
+ * @details Les redirections sont tout de même effectuées ("X=1 > f" crée f). *status* vaut 1 si une affectation ou une redirection échoue.
+ */
+static void run_assignments(processus_t* proc) {
+    int err = 0;
+    clock_gettime(CLOCK_MONOTONIC, &proc->start_time);
+    for (size_t i = 0; proc->envp[i]; ++i)
+        if (env_put(proc->envp[i], 0) != 0) err = 1;
+    if (open_redirections(proc) != 0) err = 1;
+    close_redirections(proc);
+    proc->status = W_EXITCODE(err, 0);
+    proc->end_time = proc->start_time;
+}
+
+/** @brief Fonction d'attente d'un job de premier plan.
+ * @param first Premier étage du pipeline.
+ * @param num_procs Nombre d'étages lancés.
+ * @param pgid Groupe de processus du pipeline.
+ * @return int 0 en cas de succès, -1 en cas d'erreur.
+ * @details Le terminal est donné au groupe du pipeline pendant l'attente puis repris par le shell.
+ *    Si un étage est suspendu (Ctrl-Z), le pipeline est ajouté à la table des jobs et l'attente s'arrête.
+ */
+static int wait_foreground(processus_t* first, size_t num_procs, pid_t pgid) {
+    int err = 0;
+    job_give_terminal(pgid);
+
+    processus_t* p = first;
+    for (size_t i = 0; i < num_procs && p; ++i) {
+        if (wait_processus(p) < 0) err = -1;
+        if (p->pid > 0 && WIFSTOPPED(p->status)) {
+            job_block_sigchld();
+            job_t* job = job_add(first, num_procs, pgid, JOB_STOPPED);
+            job_unblock_sigchld();
+            fputc('\n', stderr);
+            job_print(job, STDERR_FILENO, 0);
+            break;
         }
+        p = (p->cf && p->cf->pipe_next) ? p->cf->pipe_next->proc : NULL;
+    }
 
-        /* Exécuter le binaire : utiliser execve si envp connu sinon execvp */
-        //Exécuter la commande
-        
-        // Préparer l'environnement
-    extern char **environ;  // Environnement global
-    char **env = (proc->envp[0] != NULL) ? proc->envp : environ;
-    
-    // Utiliser execvp qui cherche automatiquement dans le PATH
-execvp(proc->path, proc->argv);
+    job_take_terminal();
+    return err;
+}
 
-        /* Si exec échoue */
-        fprintf(stderr, "%s: %s\n", proc->path ? proc->path : "unknown", strerror(errno));
-        _exit(127);
-    } else {
-        /* ---------- parent ---------- */
-        proc->pid = pid;
+/** @brief Fonction de lancement d'un processus à partir d'une structure de processus.
+ * @param proc Pointeur vers la structure de processus à lancer.
+ * @return int 0 en cas de succès, un code d'erreur sinon.
+ * @details Cette fonction utilise *posix_spawn()* pour lancer le processus décrit par la structure (*fork()* n'est conservé que pour les builtins exécutés hors du shell).
+ *    Elle gère également les redirections des IOs standards (actions *dup2* de *posix_spawn*).
+ *    En cas de succès, le champ *pid* de la structure est mis à jour avec le PID du processus fils.
+ *    Le flag *is_background* détermine si on attend la fin du processus ou non : un processus en arrière-plan est enregistré dans la table des jobs.
+ *    La valeur de *status* est mise à jour à l'issue de l'exécution avec le code de retour du processus fils lorsque le flag *is_background* est désactivé.
+ *    Les temps de démarrage et d'arrêt sont enregistrés dans *start_time* et *end_time* respectivement. *end_time* est mis à jour uniquement si *is_background* est désactivé.
+ *    Les descripteurs ouverts par le shell (tubes, fichiers de redirection) le sont avec O_CLOEXEC : seuls ceux qui sont dupliqués sur 0, 1 et 2 restent ouverts dans la commande.
+ *    Ils sont listés dans *cf->cmdl->opened_descriptors* pour être refermés par le shell.
+ *    Si la commande est introuvable, un message est affiché et *status* vaut le code de retour 127.
+ */
+ 
+int launch_processus(processus_t* proc) {
+    if (!proc) return -1;
 
-        if (proc->is_background) {
-            /* processus en arrière-plan : ne pas attendre */
-            printf("[bg] pid %d\n", (int)pid);
-            proc->status = 0;
-            return 0;
-        } else {
-            int wstatus = 0;
-            if (waitpid(pid, &wstatus, 0) < 0) {
-                perror("waitpid");
-                return -1;
-            }
+    /* Si c'est un builtin et qu'on est en foreground : exécution dans le parent */
+    if (is_builtin(proc) && !proc->is_background) {
+        return run_builtin_in_shell(proc, NULL);
+    }
+
+    proc->pgid = 0;
+    job_block_sigchld();
+    int err = start_processus(proc);
+    close_redirections(proc);
+    if (err != 0) {
+        job_unblock_sigchld();
+        return -1;
+    }
+    pid_t pgid = job_control_enabled() ? proc->pid : 0;
+
+    if (proc->is_background) {
+        /* processus en arrière-plan : enregistré dans la table des jobs, sans attente */
+        job_t* job = (proc->pid > 0) ? job_add(proc, 1, pgid, JOB_RUNNING) : NULL;
+        job_unblock_sigchld();
+        if (job && job_control_enabled()) printf("[%d] %d\n", job->id, (int)proc->pid);
+        proc->status = 0;
+        return 0;
+    }
+    job_unblock_sigchld();
 
-            /* enregistrer status */
-            proc->status = wstatus;
+    if (wait_foreground(proc, 1, pgid) < 0) return -1;
+    return WIFEXITED(proc->status) ? WEXITSTATUS(proc->status) : 128 + (WIFSIGNALED(proc->status) ? WTERMSIG(proc->status) : SIGTSTP);
+}
 
-            /* enregistrer end_time si champ présent */
-            #if defined(CLOCK_REALTIME)
-            clock_gettime(CLOCK_REALTIME, &proc->end_time);
-            #endif
+/** @brief Fonction de création du tube reliant un étage au suivant.
+ * @param cmdl Pointeur vers la structure de ligne de commande.
+ * @param stage Étage qui écrit dans le tube.
+ * @return int 0 en cas de succès, -1 en cas d'erreur (message affiché).
+ * @details Le tube est créé avec O_CLOEXEC : seul l'étage qui en reçoit une extrémité par *dup2()* la garde après *execve()*.
+ *    Les deux extrémités sont ajoutées à *opened_descriptors* pour être fermées par le shell dès que possible.
+ *    Les redirections de chaque étage sont appliquées après ce branchement et peuvent le remplacer ("a > f | b").
+ */
+static int connect_stage(command_line_t* cmdl, control_flow_t* stage) {
+    int fds[2];
+    if (pipe2(fds, O_CLOEXEC) < 0) {
+        perror("pipe2");
+        return -1;
+    }
+    if (add_fd(cmdl, fds[0]) != 0 || add_fd(cmdl, fds[1]) != 0) {
+        if (release_fd(cmdl, fds[0]) != 0) close(fds[0]);
+        if (release_fd(cmdl, fds[1]) != 0) close(fds[1]);
+        return -1;
+    }
+    stage->proc->stdout_fd = fds[1];
+    stage->pipe_next->proc->stdin_fd = fds[0];
+    return 0;
+}
 
-            /* retourner 0 si exit code 0 sinon code d'erreur non nul */
-            if (WIFEXITED(wstatus)) {
-                int exitcode = WEXITSTATUS(wstatus);
-                return (exitcode == 0) ? 0 : exitcode;
-            } else if (WIFSIGNALED(wstatus)) {
-                return 128 + WTERMSIG(wstatus);
-            } else {
-                return -1;
+/** @brief Fonction de fermeture, dans le parent, des descripteurs d'un étage qui vient d'être lancé.
+ * @param proc Pointeur vers la structure de processus lancée.
+ * @param pipe_in Extrémité de lecture du tube alimentant l'étage (-1 si aucune).
+ * @param pipe_out Extrémité d'écriture du tube vers l'étage suivant (-1 si aucune).
+ * @details Les extrémités de tubes et fichiers de redirection de l'étage n'appartiennent qu'à lui : le parent doit les fermer
+ *    au plus tôt, sans quoi l'étage lecteur ne verrait jamais la fin de fichier sur son tube.
+ *    Les tubes sont désignés explicitement car une redirection de l'étage a pu remplacer le descripteur correspondant.
+ */
+static void release_stage_fds(processus_t* proc, int pipe_in, int pipe_out) {
+    close_redirections(proc);
+    if (!proc->cf || !proc->cf->cmdl) return;
+    release_fd(proc->cf->cmdl, pipe_in);
+    release_fd(proc->cf->cmdl, pipe_out);
+}
+
+/** @brief Fonction de lancement d'un pipeline complet.
+ * @param cf Pointeur vers la structure de contrôle de flux du premier étage du pipeline.
+ * @param last Pointeur dans lequel est renvoyé le dernier étage du pipeline (peut être NULL).
+ * @return int 0 en cas de succès, -1 en cas d'erreur fatale (échec de *fork()*, de *waitpid()*...).
+ * @details Les étages sont reliés par le champ *pipe_next*. Une commande intégrée seule au premier plan est exécutée dans le shell,
+ *    et une commande réduite à des affectations ("X=1") y modifie les variables.
+ *    Sinon, tous les étages sont démarrés via *start_processus()* avant la moindre attente : le tube vers l'étage suivant est créé juste avant
+ *    le lancement de chaque étage, dont les redirections sont alors ouvertes ; le parent ferme ses extrémités des tubes
+ *    et les fichiers de redirection de chaque étage dès que celui-ci est lancé, puis attend l'ensemble des étages.
+ *    Un dernier étage au premier plan qui est une commande intégrée sans effet sur le shell (BUILTIN_NOFORK) est exécuté par le shell lui-même,
+ *    après le démarrage des autres étages : sa sortie n'alimente aucun étage, il ne peut donc pas bloquer le pipeline.
+ *    Avec le contrôle des jobs, les étages forment un groupe de processus dont le leader est le premier étage, et ce groupe reçoit le terminal.
+ *    Le statut du pipeline est celui du dernier étage. Si le dernier étage est en arrière-plan, le pipeline est enregistré dans la table des jobs sans attente.
+ */
+int launch_pipeline(control_flow_t* cf, control_flow_t** last) {
+    if (!cf || !cf->proc) return -1;
+
+    control_flow_t* end = cf;
+    size_t num_procs = 1;
+    while (end->pipe_next) {
+        end = end->pipe_next;
+        num_procs++;
+    }
+    if (last) *last = end;
+
+    /* affectations sans commande ("X=1") au premier plan : variables du shell */
+    if (num_procs == 1 && !cf->proc->path && cf->proc->envp && !cf->proc->is_background) {
+        run_assignments(cf->proc);
+        return 0;
+    }
+
+    /* builtin seul au premier plan : exécution dans le shell */
+    if (num_procs == 1 && is_builtin(cf->proc) && !cf->proc->is_background) {
+        run_builtin_in_shell(cf->proc, NULL);
+        return 0;
+    }
+
+    /* démarrer tous les étages avant toute attente, SIGCHLD bloqué jusqu'à l'enregistrement éventuel du job */
+    uint8_t background = end->proc->is_background;
+    pid_t pgid = 0;
+    size_t started = 0;
+    int err = 0;
+    /* extrémité de lecture du tube alimentant l'étage courant */
+    int pipe_in = -1;
+    job_block_sigchld();
+    for (control_flow_t* stage = cf; stage; stage = stage->pipe_next) {
+        stage->proc->is_background = background;
+        stage->proc->pgid = pgid;
+        /* les tubes sont créés au lancement, étage par étage : seuls deux sont ouverts à la fois dans le shell */
+        int pipe_out = -1, next_in = -1;
+        if (stage->pipe_next) {
+            if (connect_stage(cf->cmdl, stage) != 0) {
+                err = -1;
+                break;
             }
+            pipe_out = stage->proc->stdout_fd;
+            next_in = stage->pipe_next->proc->stdin_fd;
+        }
+        /* dernier étage sans effet sur le shell ("... | true") : exécuté par le shell une fois les autres démarrés */
+        if (stage == end && !background && stage->proc->path) {
+            const builtin_t* b = builtin_find(stage->proc->path);
+            if (b && (b->flags & BUILTIN_NOFORK)) break;
         }
+        if (start_processus(stage->proc) != 0) {
+            err = -1;
+            break;
+        }
+        started++;
+        if (job_control_enabled() && pgid == 0 && stage->proc->pid > 0) pgid = stage->proc->pid;
+        release_stage_fds(stage->proc, pipe_in, pipe_out);
+        pipe_in = next_in;
+    }
+
+    if (!err && background) {
+        /* pipeline en arrière-plan : enregistré dans la table des jobs, sans attente */
+        job_t* job = job_add(cf->proc, num_procs, pgid, JOB_RUNNING);
+        job_unblock_sigchld();
+        if (job && job_control_enabled()) printf("[%d] %d\n", job->id, (int)end->proc->pid);
+        end->proc->status = 0;
+        return 0;
+    }
+    job_unblock_sigchld();
+
+    if (!err && started < num_procs) {
+        run_builtin_in_shell(end->proc, NULL);
+        release_stage_fds(end->proc, pipe_in, -1);
     }
+
+    /* attendre tous les étages lancés ; le statut du pipeline est celui du dernier */
+    if (wait_foreground(cf->proc, started, pgid) < 0) err = -1;
+    return err;
 }
 
 
@@ -211,9 +907,7 @@ execvp(proc->path, proc->argv);
  * @return int 0 en cas de succès, -1 en cas d'erreur.
  * @details Cette fonction initialise les champs de la structure avec les valeurs suivantes:
  * - *proc*: NULL
- * - *unconditionnal_next*: NULL
- * - *on_success_next*: NULL
- * - *on_failure_next*: NULL
+ * - *pipe_next*: NULL
  * - *cmdl*: NULL
  */
  
@@ -223,95 +917,95 @@ int init_control_flow(control_flow_t* cf) {
      if (!cf) return -1;
 
     cf->proc = NULL;
-    cf->unconditionnal_next = NULL;
-    cf->on_success_next = NULL;
-    cf->on_failure_next = NULL;
+    cf->pipe_next = NULL;
     cf->cmdl = NULL;
 
     return 0;
     
 }
 
+/** @brief Fonction d'allocation d'un noeud de contrôle de flux et de son processus dans l'arène de la ligne.
+ * @param cmdl Pointeur vers la structure de ligne de commande.
+ * @return control_flow_t* Noeud initialisé, dont *proc* pointe vers un processus initialisé, NULL en cas d'erreur.
+ */
+static control_flow_t* new_flow(command_line_t* cmdl) {
+    control_flow_t* cf = arena_alloc(&cmdl->arena, sizeof(control_flow_t));
+    processus_t* proc = arena_alloc(&cmdl->arena, sizeof(processus_t));
+    if (!cf || !proc) return NULL;
+
+    init_control_flow(cf);
+    init_processus(proc);
+    cf->proc = proc;
+    cf->cmdl = cmdl;
+    proc->cf = cf;
+    return cf;
+}
+
 /** @brief Fonction d'ajout d'un processus à la structure de contrôle de flux.
  * @param cmdl Pointeur vers la structure de ligne de commande dans laquelle le processus doit être ajouté.
- * @param mode Mode d'ajout (UNCONDITIONAL, ON_SUCCESS, ON_FAILURE).
- * @return processus_t* Pointeur vers le processus ajouté, ou NULL en cas d'erreur (tableau plein par exemple).
- * @details Cette fonction ajoute le processus *proc* à la structure de contrôle de flux *cf* selon le mode spécifié:
- * Le dernier élément du tableau *commands* est retourné après avoir été initialisé dans le dernier élément du tableau *flow*.
- * Cette structure control_flow_t est mise à jour pour que le champ *proc* pointe vers le processus ajouté et la liste est mise à jour de la manière suivante :
- * - Si *mode* est UNCONDITIONAL, *proc* est ajouté à la liste des processus à exécuter inconditionnellement après le processus courant.
- * - Si *mode* est ON_SUCCESS, *proc* est ajouté à la liste des processus à exécuter uniquement si le processus courant s'est terminé avec succès (code de retour 0).
- * - Si *mode* est ON_FAILURE, *proc* est ajouté à la liste des processus à exécuter uniquement si le processus courant s'est terminé avec un échec (code de retour non nul).
+ * @param mode Mode d'ajout (UNCONDITIONAL, ON_SUCCESS, ON_FAILURE, PIPE).
+ * @return processus_t* Pointeur vers le processus ajouté, ou NULL en cas d'erreur (mémoire insuffisante).
+ * @details Cette fonction ajoute un processus à la liste des noeuds de contrôle de flux de *cmdl* selon le mode spécifié.
+ * Le noeud et son processus sont alloués dans l'arène de la ligne (ou repris de *pending_flow* s'ils ont été préparés par *next_processus()*).
+ * - Si *mode* est PIPE, *proc* devient l'étage suivant du pipeline du processus courant (champ *pipe_next*).
+ * - Sinon (UNCONDITIONAL, ON_SUCCESS, ON_FAILURE), *proc* commence un nouveau pipeline.
+ *
+ * La condition d'exécution du pipeline n'est pas enregistrée ici : elle est compilée dans le programme de la ligne (*code*).
  */
 
 processus_t* add_processus(command_line_t* cmdl, control_flow_mode_t mode) {
     if (!cmdl) return NULL;
 
-    if (cmdl->num_commands >= MAX_CMDS) return NULL;
-
-    int idx = cmdl->num_commands;
+    /* reprendre le noeud préparé par next_processus(), ou en allouer un nouveau */
+    control_flow_t* cf = cmdl->pending_flow ? cmdl->pending_flow : new_flow(cmdl);
+    if (!cf) return NULL;
+    cmdl->pending_flow = NULL;
     cmdl->num_commands += 1;
 
-    /* initialiser le processus à l'indice idx */
-    processus_t* proc = &cmdl->commands[idx];
-    init_processus(proc);
-
-    /* initialiser le flow correspondant */
-    control_flow_t* cf = &cmdl->flow[idx];
-    init_control_flow(cf);
-    cf->proc = proc;
-    cf->cmdl = cmdl;
-
-    /* relier le flow précédent vers ce nouveau selon le mode */
-    if (idx > 0) {
-        control_flow_t* prev = &cmdl->flow[idx - 1];
-        if (mode == UNCONDITIONAL) prev->unconditionnal_next = cf;
-        else if (mode == ON_SUCCESS) prev->on_success_next = cf;
-        else if (mode == ON_FAILURE) prev->on_failure_next = cf;
-    }
+    control_flow_t* last = cmdl->last_flow;
+    if (!cmdl->flow) cmdl->flow = cf;
+    cmdl->last_flow = cf;
 
-    proc->cf = cf;
-    return proc;
+    if (last && mode == PIPE) last->pipe_next = cf;
+    return cf->proc;
 }
 
-
-
-
 /** @brief Fonction de récupération du prochain processus à exécuter selon le contrôle de flux.
  * @param cmdl Pointeur vers la structure de ligne de commande.
- * @return processus_t* Pointeur vers le prochain processus à exécuter, ou NULL si le nombre maximum est atteint.
- * @details Cette fonction retourne un pointeur vers la structure processus_t dans le tableau *commands* situé à l'indice *num_commands + 1*.
- *  Si le nombre maximum de commandes est atteint (MAX_CMDS), la fonction retourne NULL.
+ * @return processus_t* Pointeur vers le prochain processus, ou NULL en cas d'erreur (mémoire insuffisante).
+ * @details Cette fonction prépare dans l'arène (champ *pending_flow*) le processus qui sera renvoyé par le prochain appel à *add_processus()*,
+ *  et retourne toujours le même tant que cet appel n'a pas eu lieu.
  *  Cela permet notamment d'initialiser les descripteurs des IOs standards qui dépendent du processus en court de traitement (dans le cas des pipes par exemple).
  */
 processus_t* next_processus(command_line_t* cmdl) {
     if (!cmdl) return NULL;
 
-    if (cmdl->num_commands >= MAX_CMDS) return NULL;
-
-    return &cmdl->commands[cmdl->num_commands];
+    if (!cmdl->pending_flow) cmdl->pending_flow = new_flow(cmdl);
+    return cmdl->pending_flow ? cmdl->pending_flow->proc : NULL;
 }
 
-
 /** @brief Fonction d'ajout d'un descripteur de fichier à la structure de contrôle de flux.
  * @param cmdl Pointeur vers la structure de ligne de commande.
  * @param fd Descripteur de fichier à ajouter.
- * @return int 0 en cas de succès, -1 en cas d'erreur (tableau plein ou fd invalide).
+ * @return int 0 en cas de succès, -1 en cas d'erreur (mémoire insuffisante ou fd invalide).
  * @details Cette fonction ajoute le descripteur de fichier *fd* au tableau *opened_descriptors* de la structure *cf*.
- *    Si le tableau est plein ou si *fd* est invalide (négatif), la fonction retourne -1
+ *    Le tableau est agrandi dans l'arène de la ligne lorsqu'il est plein ; si *fd* est invalide (négatif), la fonction retourne -1
  */
  
 int add_fd(command_line_t* cmdl, int fd) {
     if (!cmdl || fd < 0) return -1;
 
-    for (int i = 0; i < MAX_FDS; i++) {
-        if (cmdl->opened_descriptors[i] == -1) {
-            cmdl->opened_descriptors[i] = fd;
-            return 0;
-        }
+    if (cmdl->num_descriptors == cmdl->descriptors_capacity) {
+        size_t capacity = cmdl->descriptors_capacity ? cmdl->descriptors_capacity * 2 : 16;
+        int* fds = arena_realloc(&cmdl->arena, cmdl->opened_descriptors,
+                                 cmdl->descriptors_capacity * sizeof(int), capacity * sizeof(int));
+        if (!fds) return -1;
+        cmdl->opened_descriptors = fds;
+        cmdl->descriptors_capacity = capacity;
     }
 
-    return -1;
+    cmdl->opened_descriptors[cmdl->num_descriptors++] = fd;
+    return 0;
 }
 
 
@@ -325,7 +1019,7 @@ int add_fd(command_line_t* cmdl, int fd) {
 int close_fds(command_line_t* cmdl) {
     if (!cmdl) return -1;
 
-    for (int i = 0; i < MAX_FDS; ++i) {
+    for (size_t i = 0; i < cmdl->num_descriptors; ++i) {
         int fd = cmdl->opened_descriptors[i];
         if (fd >= 0) {
             close(fd);
@@ -336,95 +1030,570 @@ int close_fds(command_line_t* cmdl) {
     return 0;
 }
 
+/** @brief Fonction de fermeture d'un descripteur de fichier listé dans la structure de ligne de commande.
+ * @param cmdl Pointeur vers la structure de ligne de commande.
+ * @param fd Descripteur de fichier à fermer.
+ * @return int 0 si le descripteur a été fermé, -1 s'il n'est pas présent dans *opened_descriptors*.
+ * @details Le descripteur n'est fermé que s'il est présent dans le tableau *opened_descriptors*, son entrée étant remise à -1 :
+ *    un même descripteur ne peut donc pas être fermé deux fois, et les descripteurs standards ne sont jamais fermés.
+ */
+
+int release_fd(command_line_t* cmdl, int fd) {
+    if (!cmdl || fd < 0) return -1;
+
+    /* parcours depuis la fin : les descripteurs libérés sont presque toujours les derniers ouverts (étage courant) */
+    for (size_t i = cmdl->num_descriptors; i-- > 0; ) {
+        if (cmdl->opened_descriptors[i] == fd) {
+            close(fd);
+            cmdl->opened_descriptors[i] = -1;
+            return 0;
+        }
+    }
+
+    return -1;
+}
+
 /** @brief Fonction d'initialisation d'une structure de ligne de commande.
- * @param cmdl Pointeur vers la structure de ligne de commande à initialiser.
+ * @param cmdl Pointeur vers la structure de ligne de commande à initialiser (initialisée à zéro avant le premier appel).
  * @return int 0 en cas de succès, -1 en cas d'erreur.
- * @details Cette fonction initialise les champs de la structure avec les valeurs suivantes:
- * - *command_line*: "\0"
- * - *tokens*: {NULL}
- * - *commands*: tableau de processus initialisés via *init_processus()*
- * - *flow*: tableau de contrôle de flux initialisé via *init_control_flow()*
+ * @details Cette fonction libère toutes les données de la ligne précédente par *arena_reset()* (coût proportionnel à la mémoire utilisée)
+ *    et initialise les champs de la structure avec les valeurs suivantes:
+ * - *command_line*: NULL
+ * - *flow*, *last_flow*, *pending_flow*: NULL
  * - *num_commands*: 0
- * - *opened_descriptors*: {-1}
+ * - *plan*, *code*: NULL (*code_len* à 0)
+ * - *status*: 0
+ * - *opened_descriptors*: NULL (*num_descriptors* et *descriptors_capacity* à 0)
  */
  
  int init_command_line(command_line_t* cmdl) {
     if (!cmdl) return -1;
 
-    /* clear command line string */
-    cmdl->command_line[0] = '\0';
+    /* ligne précédente analysée mais non lancée : ses tubes et ses substitutions de processus ne sont pas encore libérés */
+    close_fds(cmdl);
+    subst_wait(cmdl);
+    arena_reset(&cmdl->arena);
 
-    /* tokens */
-    for (int i = 0; i < MAX_TOKENS; ++i) cmdl->tokens[i] = NULL;
+    cmdl->command_line = NULL;
 
-    /* commands and flow */
+    cmdl->flow = NULL;
+    cmdl->last_flow = NULL;
+    cmdl->pending_flow = NULL;
     cmdl->num_commands = 0;
-    for (int i = 0; i < MAX_CMDS; ++i) {
-        init_processus(&cmdl->commands[i]);
-        init_control_flow(&cmdl->flow[i]);
-        cmdl->flow[i].cmdl = cmdl;
-    }
+    cmdl->plan = NULL;
+    cmdl->code = NULL;
+    cmdl->code_len = 0;
+    cmdl->status = 0;
 
     /* opened descriptors */
-    for (int i = 0; i < MAX_FDS; ++i) cmdl->opened_descriptors[i] = -1;
+    cmdl->opened_descriptors = NULL;
+    cmdl->num_descriptors = 0;
+    cmdl->descriptors_capacity = 0;
 
     return 0;
 }
 
+/**
+ * @brief Structure représentant la mesure en cours d'une liste "&&"/"||" préfixée par le mot-clé time.
+ * @struct timing_t
+ */
+typedef struct {
+    struct timespec start;   ///< Début de la liste (CLOCK_MONOTONIC)
+    struct rusage self;      ///< Ressources consommées par le shell au début de la liste
+    processus_t** procs;     ///< Étages exécutés (tableau alloué dans l'arène de la ligne)
+    size_t num_procs;        ///< Nombre d'étages exécutés
+    size_t capacity;         ///< Capacité du tableau *procs*
+    size_t depth;            ///< Profondeur d'imbrication des boucles au début de la liste
+} timing_t;
+
+/** @brief Durée en secondes d'une valeur *timeval*. */
+static double tv_seconds(struct timeval tv) {
+    return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+/** @brief Durée en secondes entre deux instants. */
+static double ts_elapsed(struct timespec from, struct timespec to) {
+    return (to.tv_sec - from.tv_sec) + (to.tv_nsec - from.tv_nsec) / 1e9;
+}
+
+/** @brief Fonction d'enregistrement des étages d'un pipeline dans une mesure en cours.
+ * @return int 0 en cas de succès, -1 en cas d'erreur (mémoire insuffisante).
+ * @details Les étages en arrière-plan ne sont pas terminés : ils ne sont pas comptés.
+ */
+static int timing_add(command_line_t* cmdl, timing_t* timing, control_flow_t* cf) {
+    for (control_flow_t* stage = cf; stage; stage = stage->pipe_next) {
+        if (stage->proc->is_background) continue;
+        if (timing->num_procs == timing->capacity) {
+            size_t capacity = timing->capacity ? timing->capacity * 2 : 8;
+            processus_t** procs = arena_realloc(&cmdl->arena, timing->procs,
+                                                timing->capacity * sizeof(processus_t*), capacity * sizeof(processus_t*));
+            if (!procs) return -1;
+            timing->procs = procs;
+            timing->capacity = capacity;
+        }
+        timing->procs[timing->num_procs++] = stage->proc;
+    }
+    return 0;
+}
+
+/** @brief Fonction d'affichage du bilan d'une mesure sur la sortie d'erreur.
+ * @details Les temps CPU et les compteurs sont la somme des ressources renvoyées par *wait4()* pour chaque étage
+ *    et de celles consommées par le shell lui-même (builtins, affectations) depuis le début de la liste.
+ *    La mémoire maximale est celle du plus gros étage. Un étage par ligne est ajouté lorsque la liste en compte plusieurs.
+ */
+static void timing_report(const timing_t* timing) {
+    struct timespec end;
+    struct rusage self;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    getrusage(RUSAGE_SELF, &self);
+
+    double user = tv_seconds(self.ru_utime) - tv_seconds(timing->self.ru_utime);
+    double sys = tv_seconds(self.ru_stime) - tv_seconds(timing->self.ru_stime);
+    long maxrss = 0;
+    long nvcsw = self.ru_nvcsw - timing->self.ru_nvcsw;
+    long nivcsw = self.ru_nivcsw - timing->self.ru_nivcsw;
+    long inblock = self.ru_inblock - timing->self.ru_inblock;
+    long oublock = self.ru_oublock - timing->self.ru_oublock;
+    int children = 0;
+
+    for (size_t i = 0; i < timing->num_procs; ++i) {
+        const processus_t* p = timing->procs[i];
+        if (p->pid <= 0) continue;
+        children = 1;
+        user += tv_seconds(p->rusage.ru_utime);
+        sys += tv_seconds(p->rusage.ru_stime);
+        if (p->rusage.ru_maxrss > maxrss) maxrss = p->rusage.ru_maxrss;
+        nvcsw += p->rusage.ru_nvcsw;
+        nivcsw += p->rusage.ru_nivcsw;
+        inblock += p->rusage.ru_inblock;
+        oublock += p->rusage.ru_oublock;
+    }
+    /* sans processus fils, tout s'est déroulé dans le shell */
+    if (!children) maxrss = self.ru_maxrss;
+
+    double real = ts_elapsed(timing->start, end);
+    fprintf(stderr, "\nreal\t%dm%.3fs\n", (int)(real / 60), real - 60 * (int)(real / 60));
+    fprintf(stderr, "user\t%dm%.3fs\n", (int)(user / 60), user - 60 * (int)(user / 60));
+    fprintf(stderr, "sys\t%dm%.3fs\n", (int)(sys / 60), sys - 60 * (int)(sys / 60));
+    fprintf(stderr, "maxrss\t%ld kB\n", maxrss);
+    fprintf(stderr, "csw\t%ld voluntary, %ld involuntary\n", nvcsw, nivcsw);
+    fprintf(stderr, "io\t%ld in, %ld out (blocks)\n", inblock, oublock);
+
+    if (timing->num_procs < 2) return;
+    for (size_t i = 0; i < timing->num_procs; ++i) {
+        const processus_t* p = timing->procs[i];
+        const char* name = (p->argc > 0) ? p->argv[0] : (p->envp ? p->envp[0] : "");
+        if (p->pid > 0)
+            fprintf(stderr, "  %-7d %8.3fs real %8.3fs user %8.3fs sys %8ld kB  %s\n", (int)p->pid,
+                    ts_elapsed(p->start_time, p->end_time), tv_seconds(p->rusage.ru_utime), tv_seconds(p->rusage.ru_stime),
+                    p->rusage.ru_maxrss, name);
+        else
+            fprintf(stderr, "  %-7s %8.3fs real %9s %9s %11s  %s\n", "shell",
+                    ts_elapsed(p->start_time, p->end_time), "-", "-", "-", name);
+    }
+}
+
+/** @brief Fonction de recherche de l'arc suivi après un pipeline, pour le traçage.
+ * @param code Programme de la ligne.
+ * @param pc Instruction qui suit le lancement du pipeline.
+ * @param success Succès du pipeline.
+ * @return const char* "success" ou "failure" si un autre pipeline de la même liste "&&"/"||" est lancé ensuite, "unconditional" sinon.
+ */
+static const char* next_edge(const instruction_t* code, size_t pc, int success) {
+    for (;;) {
+        switch (code[pc].op) {
+        case BC_JUMP:         pc = code[pc].arg; break;
+        case BC_JUMP_SUCCESS: pc = success ? code[pc].arg : pc + 1; break;
+        case BC_JUMP_FAILURE: pc = success ? pc + 1 : code[pc].arg; break;
+        case BC_PIPELINE:
+        case BC_BUILTIN:
+        case BC_ASSIGN:
+        case BC_LOOP:
+        case BC_BREAK:
+        case BC_CONTINUE:     return success ? "success" : "failure";
+        default:              return "unconditional";
+        }
+    }
+}
 
+/**
+ * @brief Structure représentant une boucle en cours d'exécution.
+ * @struct loop_t
+ * @details Allouée dans l'arène de la ligne avant la marque de la boucle : chaque itération rend en une fois la mémoire de ses pipelines (*arena_rewind()*).
+ */
+typedef struct loop {
+    struct loop* outer;           ///< Boucle englobante (NULL au premier niveau)
+    arena_mark_t mark;            ///< Position de l'arène au début d'une itération
+    control_flow_t* flow;         ///< Champs de la ligne au début d'une itération, rétablis par *loop_rewind()*
+    control_flow_t* last_flow;
+    unsigned int num_commands;
+    int* opened_descriptors;
+    size_t descriptors_capacity;
+    int saved[3];                 ///< Copies des descripteurs standards remplacés par les redirections de la boucle (-1 : inchangé)
+    uint8_t keyword;              ///< KW_FOR, KW_WHILE ou KW_UNTIL
+    const char* name;             ///< Variable d'une boucle for (NULL pour while et until)
+    char** words;                 ///< Mots de la liste d'une boucle for (alloués avant la marque)
+    size_t num_words;             ///< Nombre de mots de la liste
+    size_t next;                  ///< Rang du prochain mot
+    int status;                   ///< Code de retour de la boucle : celui de la dernière commande du corps (0 si le corps n'est jamais exécuté)
+    uint8_t failed;               ///< Les redirections ou les mots de la boucle ont échoué : elle s'arrête avant son corps
+    uint8_t started;              ///< Le corps a été atteint au moins une fois
+    int64_t start;                ///< Début de la boucle (traçage)
+} loop_t;
+
+/** @brief Fonction de marquage du début des itérations d'une boucle : les données allouées ensuite sont rendues à chaque itération. */
+static void loop_mark(command_line_t* cmdl, loop_t* loop) {
+    loop->mark = arena_mark(&cmdl->arena);
+    loop->flow = cmdl->flow;
+    loop->last_flow = cmdl->last_flow;
+    loop->num_commands = cmdl->num_commands;
+    loop->opened_descriptors = cmdl->opened_descriptors;
+    loop->descriptors_capacity = cmdl->descriptors_capacity;
+}
+
+/** @brief Fonction de retour de la ligne à l'état marqué par *loop_mark()* (descripteurs de l'itération déjà fermés). */
+static void loop_rewind(command_line_t* cmdl, loop_t* loop) {
+    arena_rewind(&cmdl->arena, loop->mark);
+    cmdl->flow = loop->flow;
+    cmdl->last_flow = loop->last_flow;
+    cmdl->pending_flow = NULL;
+    cmdl->num_commands = loop->num_commands;
+    cmdl->opened_descriptors = loop->opened_descriptors;
+    cmdl->num_descriptors = 0;
+    cmdl->descriptors_capacity = loop->descriptors_capacity;
+}
 
+/** @brief Fonction d'application des redirections d'une boucle ("done > f"), ouvertes une seule fois pour toutes ses itérations.
+ * @param cmdl Pointeur vers la structure de ligne de commande.
+ * @param loop Boucle concernée.
+ * @param token Premier token des redirections, qui suivent "done".
+ * @return int 0 en cas de succès, -1 en cas d'erreur (message affiché).
+ * @details Les descripteurs standards du shell remplacés sont d'abord copiés au-delà de 10 (O_CLOEXEC), puis les fichiers ouverts y sont dupliqués :
+ *    toutes les commandes de la boucle, intégrées ou non, en héritent. Une duplication vers un descripteur standard remplacé
+ *    ("done 2>&1 > f") vise sa copie, c'est-à-dire sa valeur avant la boucle. *loop_restore()* rétablit les descripteurs.
+ */
+static int loop_redirect(command_line_t* cmdl, loop_t* loop, size_t token) {
+    control_flow_t* cf;
+    if (plan_instantiate(cmdl, token, &cf) != 0 || !cf) return -1;
+    processus_t* proc = cf->proc;
+    if (open_redirections(proc) != 0) return -1;
+
+    const int target[3] = { proc->stdin_fd, proc->stdout_fd, proc->stderr_fd };
+    int err = 0;
+    /* les données en attente dans le tampon de stdout appartiennent à la sortie d'avant la boucle */
+    fflush(stdout);
+    for (int fd = STDIN_FILENO; fd <= STDERR_FILENO && !err; ++fd)
+        if (target[fd] != fd && (loop->saved[fd] = fcntl(fd, F_DUPFD_CLOEXEC, 10)) < 0) err = 1;
+    for (int fd = STDIN_FILENO; fd <= STDERR_FILENO && !err; ++fd) {
+        if (target[fd] == fd) continue;
+        int from = (target[fd] <= STDERR_FILENO && loop->saved[target[fd]] >= 0) ? loop->saved[target[fd]] : target[fd];
+        if (dup2(from, fd) < 0) err = 1;
+    }
+    if (err) perror("dup2");
+    close_redirections(proc);
+    return err ? -1 : 0;
+}
 
-/** @brief Fonction de lancement d'une ligne de commande.
+/** @brief Fonction de rétablissement des descripteurs standards remplacés par les redirections d'une boucle. */
+static void loop_restore(loop_t* loop) {
+    fflush(stdout);
+    for (int fd = STDIN_FILENO; fd <= STDERR_FILENO; ++fd) {
+        if (loop->saved[fd] < 0) continue;
+        dup2(loop->saved[fd], fd);
+        close(loop->saved[fd]);
+        loop->saved[fd] = -1;
+    }
+}
+
+/** @brief Fonction de fin d'un pipeline : fermeture de ses descripteurs, puis attente de ses substitutions de processus.
+ * @details Le tableau *opened_descriptors* est vidé : il ne grandit pas avec le nombre de pipelines de la ligne.
+ */
+static void end_pipeline(command_line_t* cmdl) {
+    close_fds(cmdl);
+    cmdl->num_descriptors = 0;
+    subst_wait(cmdl);
+}
+
+/** @brief Modes d'exécution du programme d'une ligne. */
+typedef enum {
+    RUN_SEQUENTIAL, ///< Toutes les instructions, dans l'ordre, par le shell
+    RUN_SCHEDULE,   ///< Listes de premier niveau confiées à l'ordonnanceur (scheduler.h), barrières exécutées par le shell
+    RUN_JOB         ///< Une liste, dans un job de l'ordonnanceur : un pipeline en arrière-plan y est attendu
+} run_mode_t;
+
+/** @brief Fonction de recherche de la fin d'une liste de premier niveau, pour l'ordonnanceur.
+ * @param code Programme de la ligne.
+ * @param pc Première instruction de la liste.
+ * @return size_t Rang de l'instruction qui suit la fin de la liste (BC_LIST_END), 0 si la liste doit être exécutée par le shell (barrière).
+ * @details Une liste est une barrière si elle peut modifier l'état du shell : commande intégrée autre que BUILTIN_NOFORK, affectations, boucle.
+ *    Les sauts d'une liste ne sortent pas de la liste : il suffit de la parcourir jusqu'à sa fin.
+ */
+static size_t schedulable_list(const instruction_t* code, size_t pc, const builtin_t* builtins, size_t num_builtins) {
+    for (;; ++pc) {
+        switch (code[pc].op) {
+        case BC_PIPELINE:
+        case BC_JUMP:
+        case BC_JUMP_SUCCESS:
+        case BC_JUMP_FAILURE:
+            continue;
+        case BC_BUILTIN:
+            if (code[pc].builtin < num_builtins && (builtins[code[pc].builtin].flags & BUILTIN_NOFORK)) continue;
+            return 0;
+        case BC_LIST_END:
+            return pc + 1;
+        default:
+            return 0;
+        }
+    }
+}
+
+/** @brief Fonction d'exécution du programme d'une ligne, de l'instruction *pc* à l'instruction *stop* exclue (ou jusqu'à BC_HALT).
  * @param cmdl Pointeur vers la structure de ligne de commande à lancer.
+ * @param pc Première instruction exécutée.
+ * @param stop Instruction à laquelle l'exécution s'arrête.
+ * @param mode Mode d'exécution.
  * @return int 0 en cas de succès, un code d'erreur sinon.
- * @details Cette fonction lance les processus selon le flux défini dans la structure *cmdl*. Les lancements sont effectués via *launch_processus()* en
- *    respectant les conditions de contrôle de flux (inconditionnel, en cas de succès, en cas d'échec).
- *    Le tableau *opened_descriptors* est utilisé pour fermer les descripteurs ouverts au moment de l'initialisation des structures processus_t.
+ * @details Cette fonction exécute le programme de la ligne (*code*, compilé à partir de son plan) dans une boucle d'interprétation :
+ *    - BC_PIPELINE instancie le pipeline (*plan_instantiate()*, variables remplacées par leur valeur courante) puis le lance via *launch_pipeline()* ;
+ *    - BC_BUILTIN exécute dans le shell la commande intégrée résolue à la compilation, BC_ASSIGN effectue des affectations seules ;
+ *    - BC_JUMP_SUCCESS et BC_JUMP_FAILURE sautent les pipelines d'une liste "&&"/"||" selon le statut du dernier étage,
+ *      inversé si le premier étage porte le flag *invert* ;
+ *    - BC_LOOP, BC_FOR, BC_ITERATE et BC_LOOP_EXIT exécutent une boucle, BC_BREAK et BC_CONTINUE en sortent.
+ *
+ *    Après chaque pipeline, ses descripteurs sont fermés et ses substitutions de processus attendues. Chaque itération d'une boucle
+ *    rend la mémoire de la précédente : une boucle s'exécute en mémoire constante, quel que soit son nombre d'itérations.
  *    La fonction retourne 0 si tous les processus à lancer en fonction du contrôle de flux ont pu être lancés sans erreur.
+ *    Le code de retour du dernier pipeline exécuté est rangé dans *cmdl->status* ; une erreur d'instanciation (redirection ambiguë...) vaut 1.
+ *    Une liste "&&"/"||" dont le premier étage porte le flag *timed* est mesurée : à sa fin (instruction BC_LIST_END),
+ *    le temps réel (CLOCK_MONOTONIC), les temps CPU, la mémoire maximale, les changements de contexte et les entrées-sorties bloc
+ *    sont affichés sur la sortie d'erreur.
+ *    En mode RUN_SCHEDULE, chaque liste de premier niveau est confiée à un job de l'ordonnanceur (*sched_fork()*), qui l'exécute en mode RUN_JOB,
+ *    et le shell passe aussitôt à la suivante ; avant une barrière, tous les jobs sont attendus et *cmdl->status* prend le code de retour du dernier.
+ *    Avec le traçage, chaque pipeline est enregistré (catégorie "pipeline") avec son code de retour et l'arc suivi ensuite
+ *    ("success", "failure" ou "unconditional"), chaque boucle l'est aussi (catégorie "loop") ; le tampon de trace est écrit à la fin de la ligne s'il est à moitié plein.
  */
-int launch_command_line(command_line_t* cmdl) {
-    if (!cmdl) return -1;
-    if (cmdl->num_commands == 0) return 0;
+static int run_program(command_line_t* cmdl, size_t pc, size_t stop, run_mode_t mode) {
+    const instruction_t* code = cmdl->code;
+    size_t num_builtins;
+    const builtin_t* builtins = builtin_list(&num_builtins);
+    int ret = 0;
+    /* statut du dernier pipeline, évalué par les sauts conditionnels */
+    int success = 1;
+    /* mesure "time" en cours (liste commençant par un premier étage marqué timed) */
+    timing_t timing = {0};
+    int timed = 0;
+    /* boucles en cours, de la plus intérieure à la plus extérieure */
+    loop_t* loops = NULL;
+    size_t depth = 0;
+
+    while (pc != stop && code[pc].op != BC_HALT) {
+        if (mode == RUN_SCHEDULE && !loops && sched_limit() && (pc == 0 || code[pc - 1].op == BC_LIST_END)) {
+            size_t end = schedulable_list(code, pc, builtins, num_builtins);
+            if (!end) {
+                /* barrière : la liste voit l'état du shell et le statut laissés par tous les jobs qui la précèdent */
+                int status;
+                if (sched_drain(&status)) cmdl->status = status;
+            } else {
+                pid_t pid = sched_fork();
+                if (pid == 0) {
+                    run_program(cmdl, pc, end, RUN_JOB);
+                    fflush(stdout);
+                    if (trace_enabled) trace_flush();
+                    _exit(cmdl->status & 0xff);
+                }
+                if (pid > 0) {
+                    pc = end;
+                    continue;
+                }
+                /* job impossible (message affiché) : la liste est exécutée par le shell */
+            }
+        }
+        const instruction_t* in = &code[pc++];
+        switch (in->op) {
+        case BC_JUMP:
+            pc = in->arg;
+            continue;
+        case BC_JUMP_SUCCESS:
+            if (success) pc = in->arg;
+            continue;
+        case BC_JUMP_FAILURE:
+            if (!success) pc = in->arg;
+            continue;
+        case BC_LIST_END:
+            if (timed && timing.depth == depth) {
+                timing_report(&timing);
+                timed = 0;
+            }
+            continue;
+        case BC_LOOP: {
+            loop_t* loop = arena_alloc(&cmdl->arena, sizeof(loop_t));
+            if (!loop) {
+                perror("arena_alloc");
+                ret = -1;
+                break;
+            }
+            memset(loop, 0, sizeof(loop_t));
+            loop->keyword = in->builtin;
+            loop->saved[0] = loop->saved[1] = loop->saved[2] = -1;
+            loop->start = trace_enabled ? trace_clock() : 0;
+            loop->outer = loops;
+            loops = loop;
+            depth++;
+            if (in->arg != LOOP_NO_REDIRECT && loop_redirect(cmdl, loop, in->arg) != 0) {
+                loop->failed = 1;
+                loop->status = 1;
+            }
+            end_pipeline(cmdl);
+            loop_mark(cmdl, loop);
+            continue;
+        }
+        case BC_FOR:
+            /* les mots sont développés une fois, avant la première itération */
+            if (!loops->failed && plan_for_words(cmdl, in->arg, &loops->name, &loops->words, &loops->num_words) != 0) {
+                loops->failed = 1;
+                loops->status = 1;
+            }
+            end_pipeline(cmdl);
+            loop_mark(cmdl, loops);
+            continue;
+        case BC_ITERATE:
+            if (timed && timing.depth >= depth) {
+                timing_report(&timing);
+                timed = 0;
+            }
+            if (loops->started) loops->status = cmdl->status;
+            loops->started = 1;
+            loop_rewind(cmdl, loops);
+            if (loops->failed || (loops->keyword == KW_FOR && loops->next == loops->num_words)) {
+                pc = in->arg;
+                continue;
+            }
+            if (loops->keyword == KW_FOR && env_set(loops->name, loops->words[loops->next++], 0) != 0) {
+                perror(loops->name);
+                loops->failed = 1;
+                loops->status = 1;
+                pc = in->arg;
+            }
+            continue;
+        case BC_BREAK:
+        case BC_CONTINUE:
+            /* sortie des boucles intérieures, sans attendre la fin de leur itération */
+            for (unsigned k = 0; k < in->builtin; ++k) {
+                loop_restore(loops);
+                loops = loops->outer;
+                depth--;
+            }
+            if (in->op == BC_BREAK) loops->status = 0;
+            else cmdl->status = 0;
+            success = 1;
+            pc = in->arg;
+            continue;
+        case BC_LOOP_EXIT:
+            if (timed && timing.depth >= depth) {
+                timing_report(&timing);
+                timed = 0;
+            }
+            loop_restore(loops);
+            cmdl->status = loops->status;
+            success = (loops->status == 0);
+            if (trace_enabled)
+                trace_span("loop", loops->keyword == KW_FOR ? "for" : loops->keyword == KW_WHILE ? "while" : "until", loops->start, trace_clock(), 0, "status", cmdl->status, next_edge(code, pc, success));
+            loops = loops->outer;
+            depth--;
+            continue;
+        default:
+            break;
+        }
+        if (ret < 0) break;
 
-    /* start from the first flow */
-    control_flow_t* cf = &cmdl->flow[0];
+        /* instanciation du pipeline désigné par l'instruction, avec les valeurs courantes des variables */
+        control_flow_t* cf = NULL;
+        if (in->op == BC_BUILTIN && in->builtin >= num_builtins) {
+            ret = -1;
+            break;
+        }
+        if (plan_instantiate(cmdl, in->arg, &cf) != 0 || !cf) {
+            success = 0;
+            cmdl->status = 1;
+            end_pipeline(cmdl);
+            continue;
+        }
+        control_flow_t* last = cf;
+
+        /* dans un job de l'ordonnanceur, un pipeline en arrière-plan est attendu : sa sortie fait partie de celle du job, son statut reste 0 */
+        int detached = 0;
+        if (mode == RUN_JOB) {
+            for (control_flow_t* stage = cf; stage; stage = stage->pipe_next) {
+                detached |= stage->proc->is_background;
+                stage->proc->is_background = 0;
+            }
+        }
 
-    while (cf && cf->proc) {
-        processus_t* p = cf->proc;
+        if (!timed && cf->proc->timed) {
+            memset(&timing, 0, sizeof(timing));
+            getrusage(RUSAGE_SELF, &timing.self);
+            clock_gettime(CLOCK_MONOTONIC, &timing.start);
+            timing.depth = depth;
+            timed = 1;
+        }
 
-        int ret = launch_processus(p);
-        /* si erreur non nulle (et non-code de succès 0) on peut décider d'interrompre */
-        if (ret < 0) {
+        int64_t start = trace_enabled ? trace_clock() : 0;
+        if (in->op == BC_BUILTIN) {
+            run_builtin_in_shell(cf->proc, &builtins[in->builtin]);
+        } else if (in->op == BC_ASSIGN) {
+            run_assignments(cf->proc);
+        } else if (launch_pipeline(cf, &last) < 0) {
             /* arrêter si erreur fatale */
-            return ret;
+            ret = -1;
+            break;
         }
+        /* les étages d'une boucle intérieure sont rendus à chaque itération : ils ne sont pas comptés */
+        if (timed && timing.depth == depth && timing_add(cmdl, &timing, cf) != 0) perror("time");
+        end_pipeline(cmdl);
 
-        /* décider du prochain noeud selon status */
-        int success = 0;
+        /* statut du dernier étage */
+        processus_t* p = last->proc;
         if (WIFEXITED(p->status)) {
             success = (WEXITSTATUS(p->status) == 0);
+            cmdl->status = WEXITSTATUS(p->status);
         } else {
             success = 0;
+            cmdl->status = 128 + (WIFSIGNALED(p->status) ? WTERMSIG(p->status) : WSTOPSIG(p->status));
+        }
+        if (detached) {
+            success = 1;
+            cmdl->status = 0;
+        }
+        /* "! pipeline" : le code de retour du pipeline est inversé */
+        if (cf->proc->invert) {
+            success = !success;
+            cmdl->status = !success;
         }
 
-        if (success && cf->on_success_next) cf = cf->on_success_next;
-        else if (!success && cf->on_failure_next) cf = cf->on_failure_next;
-        else cf = cf->unconditionnal_next;
+        if (trace_enabled)
+            trace_span("pipeline", cf->proc->path, start, trace_clock(), 0, "status", cmdl->status, next_edge(code, pc, success));
     }
 
-    /* fermer les fds ouverts pour cette ligne de commande */
+    /* erreur fatale dans une boucle : descripteurs standards du shell rétablis */
+    for (; loops; loops = loops->outer) loop_restore(loops);
+    /* fermer les fds encore ouverts (erreur fatale), puis attendre les substitutions de processus restantes */
     close_fds(cmdl);
+    subst_wait(cmdl);
+    trace_sync();
 
 
-    return 0;
+    return ret;
     
 }
 
-void free_processus(processus_t* p) {
-    for (int i = 0; i < MAX_ARGS; i++) {
-        if (p->argv[i])
-            free(p->argv[i]);
-    }
+int launch_command_line(command_line_t* cmdl) {
+    if (!cmdl) return -1;
+    if (!cmdl->code) return 0;
+    return run_program(cmdl, 0, cmdl->code_len, RUN_SEQUENTIAL);
 }
 
-
+int schedule_command_line(command_line_t* cmdl) {
+    if (!cmdl) return -1;
+    if (!cmdl->code) return 0;
+    return run_program(cmdl, 0, cmdl->code_len, sched_limit() ? RUN_SCHEDULE : RUN_SEQUENTIAL);
+}
@@ -0,0 +1,237 @@
+/** @file scheduler.c
+ * @brief Implementation of the parallel list scheduler
+ * @author Nom1
+ * @author Nom2
+ * @date 2025-26
+ * @details Implémentation de l'ordonnanceur parallèle. Les jobs sont rangés dans un tableau circulaire, dans l'ordre du programme :
+ *   seul le plus ancien peut voir sa sortie recopiée. Chaque job garde l'extrémité d'écriture d'un tube (O_CLOEXEC, absente des commandes qu'il lance)
+ *   jusqu'à sa fin : le shell attend la fin de plusieurs jobs à la fois par *poll()* sur les extrémités de lecture, puis les récupère par *waitpid()*.
+ *   Au plus *limit* jobs sont en cours, et au plus SCHED_WINDOW * *limit* jobs terminés ou en cours attendent que leur sortie soit recopiée
+ *   (un job long en tête retient ainsi un nombre borné de fichiers de capture).
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+#include "scheduler.h"
+#include "jobs.h"
+#include "trace.h"
+#include "zygote.h"
+
+/// Nombre de jobs dont la sortie peut attendre celle d'un job plus ancien, par job exécuté en même temps
+#define SCHED_WINDOW 2
+/// Capacité du tableau des jobs
+#define SCHED_CAPACITY (SCHED_WINDOW * SCHED_MAX_JOBS)
+/// Taille des blocs recopiés depuis les fichiers de capture
+#define SCHED_CHUNK (64 * 1024)
+
+/**
+ * @brief Job de l'ordonnanceur : sous-shell exécutant une liste.
+ * @struct sched_job_t
+ */
+typedef struct {
+    pid_t pid;      ///< PID du sous-shell
+    int out;        ///< Fichier de capture de la sortie standard
+    int err;        ///< Fichier de capture de la sortie d'erreur (-1 : même fichier que la sortie standard)
+    int done;       ///< Extrémité de lecture du tube de fin (-1 : job terminé et récupéré)
+    int status;     ///< Code de retour du job (128 + numéro du signal s'il a été tué)
+    int64_t start;  ///< Création du job (traçage)
+    int64_t end;    ///< Fin du job (traçage)
+} sched_job_t;
+
+static unsigned limit = 0;                      ///< Nombre de jobs exécutés en même temps (0 : ordonnanceur désactivé)
+static sched_job_t jobs[SCHED_CAPACITY];        ///< Jobs dont la sortie n'a pas encore été recopiée, dans l'ordre du programme
+static size_t head = 0;                         ///< Rang du plus ancien job de *jobs*
+static size_t count = 0;                        ///< Nombre de jobs de *jobs*
+static unsigned running = 0;                    ///< Nombre de jobs en cours
+static int last_status = 0;                     ///< Code de retour du dernier job dont la sortie a été recopiée
+
+int sched_set_limit(unsigned n) {
+    if (n > SCHED_MAX_JOBS) return -1;
+    limit = n;
+    return 0;
+}
+
+unsigned sched_limit(void) {
+    return limit;
+}
+
+/** @brief Recopie d'un fichier de capture, depuis son début, vers le descripteur *to*.
+ * @details Si *to* est fermé ou en erreur (EPIPE...), le reste de la sortie du job est perdu, comme pour une commande exécutée directement.
+ */
+static void copy_capture(int from, int to) {
+    char buf[SCHED_CHUNK];
+    off_t offset = 0;
+    for (;;) {
+        ssize_t n = pread(from, buf, sizeof(buf), offset);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return;
+        offset += n;
+        for (ssize_t w = 0; w < n;) {
+            ssize_t r = write(to, buf + w, n - w);
+            if (r < 0) {
+                if (errno == EINTR) continue;
+                return;
+            }
+            w += r;
+        }
+    }
+}
+
+/** @brief Récupération des jobs terminés.
+ * @param timeout Délai d'attente de *poll()* en millisecondes (-1 : jusqu'à la fin d'au moins un job, 0 : sans attente).
+ */
+static void reap(int timeout) {
+    struct pollfd fds[SCHED_MAX_JOBS];
+    size_t slot[SCHED_MAX_JOBS];
+    nfds_t n = 0;
+    for (size_t i = 0; i < count && n < SCHED_MAX_JOBS; ++i) {
+        size_t k = (head + i) % SCHED_CAPACITY;
+        if (jobs[k].done < 0) continue;
+        fds[n] = (struct pollfd){ jobs[k].done, POLLIN, 0 };
+        slot[n++] = k;
+    }
+    if (n == 0) return;
+    while (poll(fds, n, timeout) < 0) {
+        if (errno != EINTR) return;
+    }
+
+    for (nfds_t i = 0; i < n; ++i) {
+        if (!fds[i].revents) continue;
+        sched_job_t* job = &jobs[slot[i]];
+        int wstatus = 0;
+        while (waitpid(job->pid, &wstatus, 0) < 0) {
+            if (errno != EINTR) break;
+        }
+        job->status = WIFEXITED(wstatus) ? WEXITSTATUS(wstatus) : 128 + WTERMSIG(wstatus);
+        job->end = trace_enabled ? trace_clock() : 0;
+        close(job->done);
+        job->done = -1;
+        running--;
+    }
+}
+
+/** @brief Recopie, dans l'ordre du programme, de la sortie des jobs terminés qui ne suivent aucun job en cours. */
+static void emit(void) {
+    while (count > 0 && jobs[head].done < 0) {
+        sched_job_t* job = &jobs[head];
+        /* les données en attente dans les tampons du shell précèdent la sortie du job */
+        fflush(stdout);
+        copy_capture(job->out, STDOUT_FILENO);
+        close(job->out);
+        if (job->err >= 0) {
+            copy_capture(job->err, STDERR_FILENO);
+            close(job->err);
+        }
+        last_status = job->status;
+        if (trace_enabled) trace_span("sched", "job", job->start, job->end, job->pid, "status", job->status, NULL);
+        head = (head + 1) % SCHED_CAPACITY;
+        count--;
+    }
+}
+
+pid_t sched_fork(void) {
+    if (limit == 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    /* place libre : la sortie des jobs terminés entre-temps est recopiée au fur et à mesure */
+    while (running >= limit || count >= SCHED_WINDOW * limit) {
+        reap(-1);
+        emit();
+    }
+    reap(0);
+    emit();
+
+    /* sorties standard et d'erreur sur le même fichier (terminal, "2>&1") : une seule capture garde leur entrelacement */
+    struct stat out, err;
+    int shared = fstat(STDOUT_FILENO, &out) == 0 && fstat(STDERR_FILENO, &err) == 0 && out.st_dev == err.st_dev && out.st_ino == err.st_ino;
+
+    sched_job_t* job = &jobs[(head + count) % SCHED_CAPACITY];
+    int fds[2] = { -1, -1 };
+    job->out = memfd_create("minishell-job-out", MFD_CLOEXEC);
+    job->err = shared ? -1 : memfd_create("minishell-job-err", MFD_CLOEXEC);
+    if (job->out < 0 || (!shared && job->err < 0) || pipe2(fds, O_CLOEXEC) < 0) {
+        perror("scheduler");
+        if (job->out >= 0) close(job->out);
+        if (job->err >= 0) close(job->err);
+        return -1;
+    }
+
+    /* le fils ne doit pas réécrire les données en attente dans le tampon de stdout du shell */
+    fflush(stdout);
+    int64_t start = trace_enabled ? trace_clock() : 0;
+    pid_t pid = fork();
+    if (pid < 0) {
+        perror("fork");
+        close(job->out);
+        if (job->err >= 0) close(job->err);
+        close(fds[0]);
+        close(fds[1]);
+        return -1;
+    }
+
+    if (pid == 0) {
+        /* ---------- job ---------- */
+        trace_fork_child();
+        zygote_leave();
+        job_control_leave();
+        signal(SIGINT, SIG_DFL);
+        signal(SIGPIPE, SIG_DFL);
+        int null = open("/dev/null", O_RDONLY | O_CLOEXEC);
+        if (null < 0 || dup2(null, STDIN_FILENO) < 0 || dup2(job->out, STDOUT_FILENO) < 0 ||
+            dup2(job->err >= 0 ? job->err : job->out, STDERR_FILENO) < 0) {
+            perror("dup2");
+            _exit(127);
+        }
+        close(null);
+        close(job->out);
+        if (job->err >= 0) close(job->err);
+        close(fds[0]);
+        /* fds[1] reste ouvert jusqu'à la fin du job : sa fermeture signale la fin au shell */
+        sched_leave();
+        return 0;
+    }
+
+    /* ---------- shell ---------- */
+    close(fds[1]);
+    job->pid = pid;
+    job->done = fds[0];
+    job->status = 0;
+    job->start = start;
+    job->end = start;
+    count++;
+    running++;
+    return pid;
+}
+
+int sched_drain(int* status) {
+    if (count == 0) return 0;
+    while (count > 0) {
+        if (running > 0) reap(-1);
+        emit();
+    }
+    if (status) *status = last_status;
+    return 1;
+}
+
+void sched_leave(void) {
+    for (size_t i = 0; i < count; ++i) {
+        sched_job_t* job = &jobs[(head + i) % SCHED_CAPACITY];
+        close(job->out);
+        if (job->err >= 0) close(job->err);
+        if (job->done >= 0) close(job->done);
+    }
+    head = count = 0;
+    running = 0;
+    limit = 0;
+}
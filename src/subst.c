@@ -0,0 +1,292 @@
+/** @file subst.c
+ * @brief Implementation of command and process substitution
+ * @author Nom1
+ * @author Nom2
+ * @date 2025-26
+ * @details Implémentation des substitutions de commandes et de processus. Chaque niveau d'imbrication possède sa structure de ligne de commande,
+ *   dont l'arène est conservée d'une substitution à l'autre : une substitution répétée n'alloue rien.
+ *   Les sous-shells des substitutions de processus sont rangés dans une table propre au module (ils n'appartiennent à aucun job).
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+#include "subst.h"
+#include "builtins.h"
+#include "jobs.h"
+#include "parser.h"
+#include "plan.h"
+#include "processus.h"
+#include "trace.h"
+#include "zygote.h"
+#include "scheduler.h"
+
+/**
+ * @brief Sous-shell d'une substitution de processus, en attente de récupération.
+ * @struct process_subst_t
+ */
+typedef struct {
+    pid_t pid;              ///< PID du sous-shell
+    command_line_t* cmdl;   ///< Ligne qui l'a démarré (NULL : commande en arrière-plan, récupéré sans attente)
+    processus_t* owner;     ///< Commande qui reçoit son tube
+} process_subst_t;
+
+static command_line_t levels[SUBST_MAX_DEPTH]; ///< Ligne de commande de chaque niveau d'imbrication
+static size_t depth = 0;                        ///< Niveau de la prochaine substitution
+static processus_t* owner = NULL;               ///< Commande dont les mots sont en cours d'expansion
+static process_subst_t* pending = NULL;         ///< Sous-shells des substitutions de processus non récupérés
+static size_t num_pending = 0;                  ///< Nombre d'entrées de *pending*
+static size_t pending_capacity = 0;             ///< Capacité de *pending*
+
+/** @brief Lecture d'un descripteur jusqu'à la fin de fichier, bloc par bloc.
+ * @param offset Position de lecture (*pread()*), ou -1 pour une lecture séquentielle (tube).
+ * @return int 0 en cas de succès, -1 en cas d'erreur de lecture ou d'abandon par *sink*.
+ */
+static int drain(int fd, off_t offset, subst_sink_t sink, void* arg) {
+    char buf[SUBST_CHUNK];
+    for (;;) {
+        ssize_t n = (offset < 0) ? read(fd, buf, sizeof(buf)) : pread(fd, buf, sizeof(buf), offset);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        if (n == 0) return 0;
+        if (offset >= 0) offset += n;
+        if (sink(arg, buf, n) != 0) return -1;
+    }
+}
+
+/** @brief Fonction indiquant si une ligne peut être exécutée dans le shell.
+ * @return int 1 si la ligne est une commande intégrée sans effet sur le shell (BUILTIN_NOFORK), seule et au premier plan.
+ */
+static int runs_in_shell(const command_line_t* sub) {
+    const instruction_t* code = sub->code;
+    if (sub->code_len != 3 || code[0].op != BC_BUILTIN || code[1].op != BC_LIST_END) return 0;
+    size_t count;
+    const builtin_t* builtins = builtin_list(&count);
+    return code[0].builtin < count && (builtins[code[0].builtin].flags & BUILTIN_NOFORK);
+}
+
+/** @brief Exécution dans le shell d'une commande intégrée, sa sortie étant écrite dans un fichier anonyme en mémoire puis relue.
+ * @return int Code de retour de la commande, -1 en cas d'erreur, -2 si *memfd_create()* n'est pas disponible.
+ * @details La commande n'est instanciée qu'à son lancement : la sortie standard du shell est remplacée par le fichier le temps de la commande
+ *    (une redirection de la commande, "echo a > f", s'applique ensuite comme d'habitude).
+ */
+static int capture_in_shell(command_line_t* sub, subst_sink_t sink, void* arg) {
+    int fd = memfd_create("minishell-subst", MFD_CLOEXEC);
+    if (fd < 0) return -2;
+    fflush(stdout);
+    int out = fcntl(STDOUT_FILENO, F_DUPFD_CLOEXEC, 10);
+    if (out < 0 || dup2(fd, STDOUT_FILENO) < 0) {
+        int saved = errno;
+        if (out >= 0) close(out);
+        close(fd);
+        errno = saved;
+        return -1;
+    }
+
+    int r = launch_command_line(sub);
+    fflush(stdout);
+    dup2(out, STDOUT_FILENO);
+    close(out);
+    if (r == 0 && drain(fd, 0, sink, arg) != 0) r = -1;
+    int saved = errno;
+    close(fd);
+    errno = saved;
+    return r < 0 ? -1 : sub->status;
+}
+
+/** @brief Création d'un sous-shell qui exécute la ligne *sub*, l'extrémité de tube *fd* remplaçant son descripteur standard *target*.
+ * @param other Extrémité du tube gardée par le shell, fermée dans le sous-shell.
+ * @return pid_t PID du sous-shell, -1 en cas d'erreur.
+ */
+static pid_t fork_subshell(command_line_t* sub, int fd, int target, int other) {
+    /* le fils ne doit pas réécrire les données en attente dans le tampon de stdout du shell */
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid != 0) return pid;
+
+    /* ---------- sous-shell ---------- */
+    trace_fork_child();
+    zygote_leave();
+    sched_leave();
+    job_control_leave();
+    signal(SIGINT, SIG_DFL);
+    signal(SIGPIPE, SIG_DFL);
+    close(other);
+    if (fd != target) {
+        if (dup2(fd, target) < 0) {
+            perror("dup2");
+            _exit(127);
+        }
+        close(fd);
+    }
+    launch_command_line(sub);
+    fflush(stdout);
+    if (trace_enabled) trace_flush();
+    _exit(sub->status & 0xff);
+}
+
+/** @brief Exécution d'une ligne par un sous-shell, dont la sortie standard est lue sur un tube pendant son exécution.
+ * @return int Code de retour du sous-shell (128 + numéro du signal s'il a été tué), -1 en cas d'erreur.
+ */
+static int capture_in_subshell(command_line_t* sub, subst_sink_t sink, void* arg) {
+    int fds[2];
+    if (pipe2(fds, O_CLOEXEC) < 0) return -1;
+
+    pid_t pid = fork_subshell(sub, fds[1], STDOUT_FILENO, fds[0]);
+    int saved = errno;
+    close(fds[1]);
+    if (pid < 0) {
+        close(fds[0]);
+        errno = saved;
+        return -1;
+    }
+
+    int err = drain(fds[0], -1, sink, arg);
+    saved = errno;
+    /* lecture abandonnée : le sous-shell reçoit EPIPE (ou SIGPIPE) au lieu de rester bloqué */
+    close(fds[0]);
+
+    int wstatus = 0;
+    while (waitpid(pid, &wstatus, 0) < 0) {
+        if (errno != EINTR) return -1;
+    }
+    if (err) {
+        errno = saved;
+        return -1;
+    }
+    return WIFEXITED(wstatus) ? WEXITSTATUS(wstatus) : 128 + WTERMSIG(wstatus);
+}
+
+int subst_run(const char* line, subst_sink_t sink, void* arg) {
+    if (!line || !sink) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (depth == SUBST_MAX_DEPTH) {
+        fprintf(stderr, "$(...): imbrication trop profonde (%d niveaux)\n", SUBST_MAX_DEPTH);
+        return 2;
+    }
+
+    int64_t start = trace_enabled ? trace_clock() : 0;
+    command_line_t* sub = &levels[depth];
+    init_command_line(sub);
+
+    /* les substitutions de la ligne intérieure sont effectuées à l'instanciation de ses pipelines, au niveau suivant */
+    processus_t* proc = owner;
+    depth++;
+    int r = parse_command_line(sub, line);
+    if (r > 0) fprintf(stderr, "Erreur de syntaxe près de 'fin de ligne'\n");
+    if (r != 0) r = 2;
+    else if (sub->code[0].op == BC_HALT) r = 0;
+    else {
+        r = runs_in_shell(sub) ? capture_in_shell(sub, sink, arg) : -2;
+        if (r == -2) r = capture_in_subshell(sub, sink, arg);
+    }
+    depth--;
+    owner = proc;
+
+    /* les gros blocs de la ligne intérieure sont rendus tout de suite, le premier est gardé pour la substitution suivante */
+    int saved = errno;
+    init_command_line(sub);
+    errno = saved;
+    if (trace_enabled) trace_span("subst", line, start, trace_clock(), 0, "status", r, NULL);
+    return r;
+}
+
+void subst_attach(processus_t* proc) {
+    owner = proc;
+}
+
+/** @brief Enregistrement du sous-shell d'une substitution de processus.
+ * @return int 0 en cas de succès, -1 en cas de mémoire insuffisante.
+ */
+static int add_pending(pid_t pid, command_line_t* cmdl, processus_t* proc) {
+    if (num_pending == pending_capacity) {
+        size_t capacity = pending_capacity ? pending_capacity * 2 : 8;
+        process_subst_t* p = realloc(pending, capacity * sizeof(process_subst_t));
+        if (!p) return -1;
+        pending = p;
+        pending_capacity = capacity;
+    }
+    pending[num_pending++] = (process_subst_t){ pid, cmdl, proc };
+    return 0;
+}
+
+int subst_process(const char* line, int output, char* path, size_t size) {
+    processus_t* proc = owner;
+    if (!line || !proc || !proc->cf || !proc->cf->cmdl) {
+        fprintf(stderr, "%c(...): substitution de processus impossible ici\n", output ? '>' : '<');
+        return -1;
+    }
+    if (depth == SUBST_MAX_DEPTH) {
+        fprintf(stderr, "%c(...): imbrication trop profonde (%d niveaux)\n", output ? '>' : '<', SUBST_MAX_DEPTH);
+        return -1;
+    }
+    command_line_t* cmdl = proc->cf->cmdl;
+
+    int fds[2];
+    if (pipe2(fds, O_CLOEXEC) < 0) {
+        perror("pipe2");
+        return -1;
+    }
+    /* extrémité de la commande : lecture pour "<(...)", écriture pour ">(...)" */
+    int mine = output ? fds[1] : fds[0];
+    int theirs = output ? fds[0] : fds[1];
+    if (add_fd(cmdl, mine) != 0 || add_inherited_fd(proc, mine) != 0) {
+        if (release_fd(cmdl, mine) != 0) close(mine);
+        close(theirs);
+        perror("add_fd");
+        return -1;
+    }
+
+    int64_t start = trace_enabled ? trace_clock() : 0;
+    command_line_t* sub = &levels[depth];
+    init_command_line(sub);
+    depth++;
+    int r = parse_command_line(sub, line);
+    pid_t pid = 0;
+    if (r > 0) fprintf(stderr, "Erreur de syntaxe près de 'fin de ligne'\n");
+    if (r == 0 && sub->code[0].op != BC_HALT) pid = fork_subshell(sub, theirs, output ? STDIN_FILENO : STDOUT_FILENO, mine);
+    depth--;
+    owner = proc;
+    if (pid < 0) perror("fork");
+    close(theirs);
+    if (pid > 0 && add_pending(pid, cmdl, proc) != 0) {
+        /* sans entrée dans la table, le sous-shell est attendu tout de suite : la commande ne recevra qu'un tube vide */
+        kill(pid, SIGTERM);
+        while (waitpid(pid, NULL, 0) < 0 && errno == EINTR) {}
+        pid = -1;
+    }
+    init_command_line(sub);
+    if (trace_enabled) trace_span("subst", line, start, trace_clock(), 0, "pid", pid, NULL);
+    if (pid < 0) return -1;
+
+    snprintf(path, size, "/dev/fd/%d", mine);
+    return 0;
+}
+
+void subst_wait(command_line_t* cmdl) {
+    size_t n = 0;
+    for (size_t i = 0; i < num_pending; ++i) {
+        process_subst_t* p = &pending[i];
+        if (p->cmdl == cmdl && p->owner->is_background) p->cmdl = NULL;
+        if (p->cmdl == cmdl) {
+            while (waitpid(p->pid, NULL, 0) < 0 && errno == EINTR) {}
+            continue;
+        }
+        /* sous-shell d'une commande en arrière-plan : récupéré s'il est terminé ; ECHILD dans un sous-shell, qui hérite de la table */
+        if (!p->cmdl && waitpid(p->pid, NULL, WNOHANG) != 0) continue;
+        pending[n++] = *p;
+    }
+    num_pending = n;
+}
@@ -0,0 +1,190 @@
+/** @file trace.c
+ * @brief Implementation of execution tracing
+ * @author Nom1
+ * @author Nom2
+ * @date 2025-26
+ * @details Implémentation du tampon d'événements et de son écriture au format Chrome trace.
+ *   Chaque événement est un intervalle complet ("ph": "X") dont les temps sont en microsecondes de l'horloge monotone :
+ *   les événements de plusieurs processus écrits dans le même fichier sont directement comparables.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "trace.h"
+
+/**
+ * @brief Structure représentant un événement du tampon.
+ * @struct trace_event_t
+ */
+typedef struct {
+    const char* cat;             ///< Catégorie (chaîne statique)
+    const char* key;             ///< Nom de l'argument numérique (NULL si aucun)
+    const char* edge;            ///< Arc suivi (NULL si aucun)
+    int64_t start;               ///< Début en nanosecondes
+    int64_t end;                 ///< Fin en nanosecondes
+    long value;                  ///< Valeur de l'argument numérique
+    pid_t tid;                   ///< Processus auquel l'intervalle est rattaché
+    char name[TRACE_NAME_SIZE];  ///< Nom (copié)
+} trace_event_t;
+
+int trace_enabled = 0;
+
+static int trace_fd = -1;                          ///< Fichier de trace
+static pid_t trace_pid = 0;                        ///< PID du processus propriétaire du tampon
+static trace_event_t events[TRACE_BUFFER_EVENTS];  ///< Tampon des événements (non touché si le traçage est désactivé)
+static size_t num_events = 0;                      ///< Emplacements réservés (incrément atomique)
+static size_t num_dropped = 0;                     ///< Événements perdus, tampon plein
+
+/** @brief Écriture complète d'un bloc (les écritures en O_APPEND de plusieurs processus ne s'entremêlent pas). */
+static void write_all(const char* data, size_t len) {
+    while (len > 0) {
+        ssize_t n = write(trace_fd, data, len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+        data += n;
+        len -= n;
+    }
+}
+
+/** @brief Copie d'une chaîne dans une chaîne JSON (guillemets, barres obliques inverses et caractères de contrôle échappés).
+ * @return size_t Nombre d'octets écrits dans *out* (au plus *size*).
+ */
+static size_t json_escape(char* out, size_t size, const char* s) {
+    size_t n = 0;
+    for (; *s && n + 6 < size; ++s) {
+        unsigned char c = *s;
+        if (c == '"' || c == '\\') {
+            out[n++] = '\\';
+            out[n++] = c;
+        } else if (c < 0x20) {
+            n += snprintf(out + n, size - n, "\\u%04x", c);
+        } else {
+            out[n++] = c;
+        }
+    }
+    return n;
+}
+
+int trace_init(const char* path) {
+    if (!path || !*path) return 0;
+
+    trace_fd = open(path, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (trace_fd < 0) {
+        perror(path);
+        return -1;
+    }
+    struct stat st;
+    if (fstat(trace_fd, &st) == 0 && st.st_size == 0) write_all("[\n", 2);
+
+    trace_pid = getpid();
+    char line[128];
+    int n = snprintf(line, sizeof(line), "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":\"minishell\"}},\n",
+                     (int)trace_pid, (int)trace_pid);
+    write_all(line, n);
+
+    trace_enabled = 1;
+    atexit(trace_flush);
+    return 0;
+}
+
+int64_t trace_timespec(struct timespec ts) {
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+int64_t trace_clock(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return trace_timespec(ts);
+}
+
+void trace_span(const char* cat, const char* name, int64_t start, int64_t end, pid_t tid, const char* key, long value, const char* edge) {
+    if (!trace_enabled) return;
+
+    /* réservation sans verrou : un gestionnaire de signal qui interrompt l'écriture obtient l'emplacement suivant */
+    size_t i = __atomic_fetch_add(&num_events, 1, __ATOMIC_RELAXED);
+    if (i >= TRACE_BUFFER_EVENTS) {
+        __atomic_fetch_add(&num_dropped, 1, __ATOMIC_RELAXED);
+        return;
+    }
+
+    trace_event_t* e = &events[i];
+    e->cat = cat;
+    e->key = key;
+    e->edge = edge;
+    e->start = start;
+    e->end = end;
+    e->value = value;
+    e->tid = tid ? tid : trace_pid;
+    if (!name) name = cat;
+    size_t len = strnlen(name, TRACE_NAME_SIZE - 1);
+    memcpy(e->name, name, len);
+    e->name[len] = '\0';
+}
+
+void trace_sync(void) {
+    if (trace_enabled && __atomic_load_n(&num_events, __ATOMIC_RELAXED) >= TRACE_BUFFER_EVENTS / 2) trace_flush();
+}
+
+void trace_flush(void) {
+    if (!trace_enabled || trace_fd < 0) return;
+
+    /* aucun gestionnaire ne peut réserver d'emplacement pendant la lecture du tampon */
+    sigset_t all, saved;
+    sigfillset(&all);
+    sigprocmask(SIG_BLOCK, &all, &saved);
+
+    size_t count = num_events < TRACE_BUFFER_EVENTS ? num_events : TRACE_BUFFER_EVENTS;
+    char buffer[16384];
+    size_t len = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const trace_event_t* e = &events[i];
+        char name[6 * TRACE_NAME_SIZE];
+        name[json_escape(name, sizeof(name), e->name)] = '\0';
+
+        len += snprintf(buffer + len, sizeof(buffer) - len,
+                        "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%lld.%03d,\"dur\":%lld.%03d,\"pid\":%d,\"tid\":%d,\"args\":{",
+                        name, e->cat, (long long)(e->start / 1000), (int)(e->start % 1000),
+                        (long long)((e->end - e->start) / 1000), (int)((e->end - e->start) % 1000), (int)trace_pid, (int)e->tid);
+        if (e->key) len += snprintf(buffer + len, sizeof(buffer) - len, "\"%s\":%ld%s", e->key, e->value, e->edge ? "," : "");
+        if (e->edge) len += snprintf(buffer + len, sizeof(buffer) - len, "\"edge\":\"%s\"", e->edge);
+        len += snprintf(buffer + len, sizeof(buffer) - len, "}},\n");
+
+        /* place pour un événement complet (nom échappé compris) avant le suivant */
+        if (sizeof(buffer) - len < 1024) {
+            write_all(buffer, len);
+            len = 0;
+        }
+    }
+    if (num_dropped > 0) {
+        int64_t now = trace_clock();
+        len += snprintf(buffer + len, sizeof(buffer) - len,
+                        "{\"name\":\"trace_dropped\",\"ph\":\"i\",\"s\":\"p\",\"ts\":%lld,\"pid\":%d,\"tid\":%d,\"args\":{\"events\":%zu}},\n",
+                        (long long)(now / 1000), (int)trace_pid, (int)trace_pid, num_dropped);
+    }
+    write_all(buffer, len);
+    num_events = 0;
+    num_dropped = 0;
+
+    sigprocmask(SIG_SETMASK, &saved, NULL);
+}
+
+int trace_descriptor(void) {
+    return trace_fd;
+}
+
+void trace_fork_child(void) {
+    if (!trace_enabled) return;
+    num_events = 0;
+    num_dropped = 0;
+    trace_pid = getpid();
+}
@@ -0,0 +1,502 @@
+/** @file zygote.c
+ * @brief Implementation of the pre-forked spawn server
+ * @author Nom1
+ * @author Nom2
+ * @date 2025-26
+ * @details Implémentation du serveur de lancement. Le shell et l'auxiliaire échangent sur une socket Unix en mode flux :
+ *   - demande : un en-tête de taille fixe, auquel sont attachés les descripteurs (*SCM_RIGHTS*), suivi des chaînes exécutable, arguments
+ *     et environnement, chacune terminée par '\0' ;
+ *   - réponses : des messages de taille fixe, START (PID ou erreur d'*execve()*) pour chaque demande, EXIT (statut et ressources) à chaque terminaison.
+ *   L'auxiliaire attend à la fois la socket et SIGCHLD (*signalfd()*) : un EXIT n'est jamais envoyé avant le START du même fils.
+ *   L'erreur d'*execve()* remonte par un tube O_CLOEXEC, que l'auxiliaire lit avant de répondre : la fin de fichier signifie que la commande s'exécute.
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+
+#include "zygote.h"
+
+/// Nombre de descripteurs d'une demande : 0, 1, 2, répertoire courant puis descripteurs hérités
+#define ZYGOTE_MAX_FDS (4 + ZYGOTE_MAX_INHERITED)
+
+/**
+ * @brief En-tête d'une demande de lancement.
+ * @struct request_header_t
+ */
+typedef struct {
+    uint32_t argc;                              ///< Nombre d'arguments
+    uint32_t envc;                              ///< Nombre de variables d'environnement
+    uint32_t size;                              ///< Taille des chaînes qui suivent l'en-tête
+    uint32_t num_inherited;                     ///< Nombre de descripteurs hérités
+    uint64_t sigdefault;                        ///< Signaux remis par défaut (bit n - 1 pour le signal n)
+    int32_t inherited[ZYGOTE_MAX_INHERITED];    ///< Numéros sous lesquels les descripteurs hérités sont placés dans le fils
+} request_header_t;
+
+/** @brief Types des réponses de l'auxiliaire. */
+enum { REPLY_START, REPLY_EXIT };
+
+/**
+ * @brief Réponse de l'auxiliaire.
+ * @struct reply_t
+ */
+typedef struct {
+    int32_t type;           ///< REPLY_START ou REPLY_EXIT
+    int32_t pid;            ///< PID du fils (0 pour un START dont l'*execve()* a échoué)
+    int32_t value;          ///< START : erreur d'*execve()* (0 : succès) ; EXIT : statut au format de *waitpid()*
+    struct rusage usage;    ///< EXIT : ressources consommées par le fils
+} reply_t;
+
+static int sock = -1;               ///< Extrémité de la socket gardée par le shell (-1 : serveur inactif)
+static pid_t helper = 0;            ///< PID de l'auxiliaire
+static reply_t* stash = NULL;       ///< Terminaisons reçues avant d'être attendues
+static size_t num_stash = 0;        ///< Nombre d'entrées de *stash*
+static size_t stash_capacity = 0;   ///< Capacité de *stash*
+static char* buffer = NULL;         ///< Chaînes de la demande (construite par le shell, reçue par l'auxiliaire)
+static size_t buffer_capacity = 0;  ///< Capacité de *buffer*
+
+/** @brief Agrandissement de *buffer* à au moins *size* octets.
+ * @return int 0 en cas de succès, -1 en cas de mémoire insuffisante.
+ */
+static int reserve(size_t size) {
+    if (size <= buffer_capacity) return 0;
+    size_t capacity = buffer_capacity ? buffer_capacity : 4096;
+    while (capacity < size) capacity *= 2;
+    char* p = realloc(buffer, capacity);
+    if (!p) return -1;
+    buffer = p;
+    buffer_capacity = capacity;
+    return 0;
+}
+
+/** @brief Envoi complet de *len* octets sur la socket (sans SIGPIPE si l'autre extrémité est fermée).
+ * @return int 0 en cas de succès, -1 en cas d'erreur.
+ */
+static int send_all(int fd, const void* data, size_t len) {
+    const char* p = data;
+    while (len > 0) {
+        ssize_t n = send(fd, p, len, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        p += n;
+        len -= n;
+    }
+    return 0;
+}
+
+/** @brief Réception complète de *len* octets.
+ * @return int 0 en cas de succès, -1 en cas d'erreur ou de fin de fichier (*errno* vaut alors EPIPE).
+ */
+static int recv_all(int fd, void* data, size_t len) {
+    char* p = data;
+    while (len > 0) {
+        ssize_t n = recv(fd, p, len, 0);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        if (n == 0) {
+            errno = EPIPE;
+            return -1;
+        }
+        p += n;
+        len -= n;
+    }
+    return 0;
+}
+
+/* ================================ auxiliaire ================================ */
+
+/** @brief Exécution de la commande dans le fils de l'auxiliaire (ne retourne pas).
+ * @param fds Descripteurs reçus : 0, 1, 2, répertoire courant puis descripteurs hérités.
+ * @param report Extrémité d'écriture du tube de compte rendu (erreur d'*execve()*).
+ * @details Les descripteurs reçus sont d'abord déplacés au-dessus de tous les numéros visés, pour qu'aucun *dup2()* n'écrase
+ *    un descripteur pas encore placé. Ils sont tous O_CLOEXEC : seules les copies faites par *dup2()* restent ouvertes dans la commande.
+ */
+static void child_exec(const request_header_t* h, int* fds, size_t num_fds, int report, const char* exe, char** argv, char** envp) {
+    int base = STDERR_FILENO + 1;
+    for (uint32_t i = 0; i < h->num_inherited; ++i)
+        if (h->inherited[i] >= base) base = h->inherited[i] + 1;
+
+    int err = 0;
+    if ((report = fcntl(report, F_DUPFD_CLOEXEC, base)) < 0) _exit(127);
+    for (size_t i = 0; i < num_fds && !err; ++i)
+        if ((fds[i] = fcntl(fds[i], F_DUPFD_CLOEXEC, base)) < 0) err = errno;
+    for (int i = 0; i < 3 && !err; ++i)
+        if (dup2(fds[i], i) < 0) err = errno;
+    if (!err && fchdir(fds[3]) < 0) err = errno;
+    for (uint32_t i = 0; i < h->num_inherited && !err; ++i)
+        if (dup2(fds[4 + i], h->inherited[i]) < 0) err = errno;
+
+    if (!err) {
+        sigset_t empty;
+        for (int sig = 1; sig <= 64 && sig < NSIG; ++sig)
+            if (h->sigdefault & (UINT64_C(1) << (sig - 1))) signal(sig, SIG_DFL);
+        sigemptyset(&empty);
+        sigprocmask(SIG_SETMASK, &empty, NULL);
+        execve(exe, argv, envp);
+        err = errno;
+    }
+    while (write(report, &err, sizeof(err)) < 0 && errno == EINTR) {}
+    _exit(127);
+}
+
+/** @brief Réception d'une demande par l'auxiliaire.
+ * @param fds Tableau recevant les descripteurs attachés (ZYGOTE_MAX_FDS entrées).
+ * @param num_fds Pointeur dans lequel est renvoyé le nombre de descripteurs reçus.
+ * @return int 0 en cas de succès, -1 en fin de fichier ou en cas d'erreur (descripteurs reçus refermés).
+ */
+static int recv_request(int fd, request_header_t* h, int* fds, size_t* num_fds) {
+    union {
+        char buf[CMSG_SPACE(ZYGOTE_MAX_FDS * sizeof(int))];
+        struct cmsghdr align;
+    } control;
+    struct iovec iov = { h, sizeof(*h) };
+    struct msghdr msg = { .msg_iov = &iov, .msg_iovlen = 1, .msg_control = control.buf, .msg_controllen = sizeof(control.buf) };
+
+    ssize_t n;
+    while ((n = recvmsg(fd, &msg, MSG_CMSG_CLOEXEC)) < 0 && errno == EINTR) {}
+    if (n <= 0) return -1;
+
+    *num_fds = 0;
+    for (struct cmsghdr* c = CMSG_FIRSTHDR(&msg); c; c = CMSG_NXTHDR(&msg, c)) {
+        if (c->cmsg_level != SOL_SOCKET || c->cmsg_type != SCM_RIGHTS) continue;
+        size_t count = (c->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+        for (size_t i = 0; i < count; ++i) {
+            int received;
+            memcpy(&received, CMSG_DATA(c) + i * sizeof(int), sizeof(int));
+            if (*num_fds < ZYGOTE_MAX_FDS) fds[(*num_fds)++] = received;
+            else close(received);
+        }
+    }
+
+    int err = (size_t)n < sizeof(*h) ? recv_all(fd, (char*)h + n, sizeof(*h) - n) : 0;
+    if (!err && (h->num_inherited > ZYGOTE_MAX_INHERITED || *num_fds != 4 + h->num_inherited)) err = -1;
+    if (err) {
+        for (size_t i = 0; i < *num_fds; ++i) close(fds[i]);
+        return -1;
+    }
+    return 0;
+}
+
+/** @brief Découpage des chaînes d'une demande en tableau de pointeurs terminé par NULL.
+ * @param p Pointeur sur la première chaîne, avancé après la dernière.
+ * @param end Fin des chaînes reçues.
+ * @return char** Tableau alloué, NULL en cas d'erreur (chaînes tronquées, mémoire insuffisante).
+ */
+static char** split_strings(char** p, const char* end, uint32_t count) {
+    char** v = malloc((count + 1) * sizeof(char*));
+    if (!v) return NULL;
+    for (uint32_t i = 0; i < count; ++i) {
+        char* z = (*p < end) ? memchr(*p, '\0', end - *p) : NULL;
+        if (!z) {
+            free(v);
+            return NULL;
+        }
+        v[i] = *p;
+        *p = z + 1;
+    }
+    v[count] = NULL;
+    return v;
+}
+
+/** @brief Traitement d'une demande : création du fils, puis réponse START.
+ * @return int 0 en cas de succès, -1 si la socket est fermée ou si la demande est invalide (l'auxiliaire se termine).
+ */
+static int serve(int fd) {
+    request_header_t h;
+    int fds[ZYGOTE_MAX_FDS];
+    size_t num_fds;
+    if (recv_request(fd, &h, fds, &num_fds) != 0) return -1;
+
+    char** argv = NULL;
+    char** envp = NULL;
+    reply_t reply;
+    memset(&reply, 0, sizeof(reply));
+    reply.type = REPLY_START;
+    int ok = reserve((size_t)h.size + 1) == 0 && recv_all(fd, buffer, h.size) == 0;
+    if (ok) {
+        char* end = buffer + h.size;
+        char* p = buffer;
+        char* exe = p;
+        ok = memchr(p, '\0', h.size) != NULL;
+        if (ok) p += strlen(p) + 1;
+        ok = ok && (argv = split_strings(&p, end, h.argc)) != NULL && (envp = split_strings(&p, end, h.envc)) != NULL;
+
+        int report[2];
+        if (!ok) reply.value = EINVAL;
+        else if (pipe2(report, O_CLOEXEC) < 0) reply.value = errno;
+        else {
+            pid_t pid = fork();
+            if (pid == 0) child_exec(&h, fds, num_fds, report[1], exe, argv, envp);
+            close(report[1]);
+            if (pid < 0) reply.value = errno;
+            else {
+                int err = 0;
+                ssize_t n;
+                while ((n = read(report[0], &err, sizeof(err))) < 0 && errno == EINTR) {}
+                if (n == (ssize_t)sizeof(err)) {
+                    /* execve() a échoué : le fils est attendu tout de suite, seul le START est envoyé */
+                    while (waitpid(pid, NULL, 0) < 0 && errno == EINTR) {}
+                    reply.value = err;
+                } else {
+                    reply.pid = pid;
+                }
+            }
+            close(report[0]);
+        }
+    }
+    for (size_t i = 0; i < num_fds; ++i) close(fds[i]);
+    free(argv);
+    free(envp);
+    if (!ok && reply.value == 0) return -1;
+    return send_all(fd, &reply, sizeof(reply));
+}
+
+/** @brief Envoi d'un EXIT pour chaque fils terminé.
+ * @return int 0 en cas de succès, -1 si la socket est fermée.
+ */
+static int reap(int fd) {
+    reply_t reply;
+    memset(&reply, 0, sizeof(reply));
+    reply.type = REPLY_EXIT;
+    int wstatus;
+    pid_t pid;
+    while ((pid = wait4(-1, &wstatus, WNOHANG, &reply.usage)) > 0) {
+        reply.pid = pid;
+        reply.value = wstatus;
+        if (send_all(fd, &reply, sizeof(reply)) != 0) return -1;
+    }
+    return 0;
+}
+
+/** @brief Boucle de l'auxiliaire (ne retourne pas).
+ * @details Les descripteurs standards hérités du shell sont remplacés par /dev/null : l'auxiliaire ne garde pas ouvert un tube
+ *    dont le shell est l'écrivain. SIGCHLD est bloqué et lu par *signalfd()*, en même temps que la socket.
+ */
+static void helper_main(int fd) {
+    signal(SIGINT, SIG_IGN);
+    signal(SIGPIPE, SIG_IGN);
+    int null = open("/dev/null", O_RDWR);
+    if (null >= 0) {
+        for (int i = STDIN_FILENO; i <= STDERR_FILENO; ++i)
+            if (null != i) dup2(null, i);
+        if (null > STDERR_FILENO) close(null);
+    }
+
+    sigset_t chld;
+    sigemptyset(&chld);
+    sigaddset(&chld, SIGCHLD);
+    sigprocmask(SIG_BLOCK, &chld, NULL);
+    int sfd = signalfd(-1, &chld, SFD_CLOEXEC | SFD_NONBLOCK);
+    if (sfd < 0) _exit(1);
+
+    struct pollfd pfd[2] = { { fd, POLLIN, 0 }, { sfd, POLLIN, 0 } };
+    for (;;) {
+        if (poll(pfd, 2, -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (pfd[1].revents & POLLIN) {
+            struct signalfd_siginfo info;
+            while (read(sfd, &info, sizeof(info)) > 0) {}
+            if (reap(fd) != 0) break;
+        }
+        if (pfd[0].revents & (POLLIN | POLLHUP | POLLERR)) {
+            if (serve(fd) != 0) break;
+        }
+    }
+    _exit(0);
+}
+
+/* ================================== shell =================================== */
+
+int zygote_start(void) {
+    if (sock >= 0) return 0;
+    int sv[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sv) < 0) return -1;
+
+    pid_t pid = fork();
+    if (pid < 0) {
+        int saved = errno;
+        close(sv[0]);
+        close(sv[1]);
+        errno = saved;
+        return -1;
+    }
+    if (pid == 0) {
+        close(sv[0]);
+        helper_main(sv[1]);
+    }
+    close(sv[1]);
+    sock = sv[0];
+    helper = pid;
+    return 0;
+}
+
+void zygote_stop(void) {
+    if (sock >= 0) close(sock);
+    sock = -1;
+    /* l'auxiliaire se termine dès qu'il lit la fin de fichier */
+    if (helper > 0) while (waitpid(helper, NULL, 0) < 0 && errno == EINTR) {}
+    helper = 0;
+    free(stash);
+    stash = NULL;
+    num_stash = stash_capacity = 0;
+}
+
+void zygote_leave(void) {
+    if (sock >= 0) close(sock);
+    sock = -1;
+    helper = 0;
+    num_stash = 0;
+}
+
+int zygote_enabled(void) {
+    return sock >= 0;
+}
+
+/** @brief Mémorisation d'une terminaison reçue avant d'être attendue.
+ * @return int 0 en cas de succès, -1 en cas de mémoire insuffisante.
+ */
+static int stash_add(const reply_t* reply) {
+    if (num_stash == stash_capacity) {
+        size_t capacity = stash_capacity ? stash_capacity * 2 : 8;
+        reply_t* p = realloc(stash, capacity * sizeof(reply_t));
+        if (!p) return -1;
+        stash = p;
+        stash_capacity = capacity;
+    }
+    stash[num_stash++] = *reply;
+    return 0;
+}
+
+/** @brief Copie des chaînes *v* (terminées par NULL) dans *buffer* à partir de *used*.
+ * @return int 0 en cas de succès, -1 en cas de mémoire insuffisante ou de demande trop grande.
+ */
+static int pack_strings(char* const* v, uint32_t* count, size_t* used) {
+    *count = 0;
+    for (; v && v[*count]; ++*count) {
+        size_t len = strlen(v[*count]) + 1;
+        if (*used + len > UINT32_MAX || reserve(*used + len) != 0) return -1;
+        memcpy(buffer + *used, v[*count], len);
+        *used += len;
+    }
+    return 0;
+}
+
+/** @brief Envoi de l'en-tête d'une demande, les descripteurs *fds* attachés à son premier octet.
+ * @return int 0 en cas de succès, -1 en cas d'erreur.
+ */
+static int send_header(const request_header_t* h, const int* fds, size_t num_fds) {
+    union {
+        char buf[CMSG_SPACE(ZYGOTE_MAX_FDS * sizeof(int))];
+        struct cmsghdr align;
+    } control;
+    memset(&control, 0, sizeof(control));
+    struct iovec iov = { (void*)h, sizeof(*h) };
+    struct msghdr msg = { .msg_iov = &iov, .msg_iovlen = 1, .msg_control = control.buf, .msg_controllen = CMSG_SPACE(num_fds * sizeof(int)) };
+    struct cmsghdr* c = CMSG_FIRSTHDR(&msg);
+    c->cmsg_level = SOL_SOCKET;
+    c->cmsg_type = SCM_RIGHTS;
+    c->cmsg_len = CMSG_LEN(num_fds * sizeof(int));
+    memcpy(CMSG_DATA(c), fds, num_fds * sizeof(int));
+
+    ssize_t n;
+    while ((n = sendmsg(sock, &msg, MSG_NOSIGNAL)) < 0 && errno == EINTR) {}
+    if (n < 0) return -1;
+    return send_all(sock, (const char*)h + n, sizeof(*h) - n);
+}
+
+/** @brief Lecture des réponses jusqu'au START de la dernière demande, les EXIT reçus entre-temps étant mémorisés.
+ * @return int 0 en cas de succès, -1 en cas d'erreur.
+ */
+static int recv_start(reply_t* reply) {
+    for (;;) {
+        if (recv_all(sock, reply, sizeof(*reply)) != 0) return -1;
+        if (reply->type == REPLY_START) return 0;
+        if (stash_add(reply) != 0) return -1;
+    }
+}
+
+pid_t zygote_spawn(const zygote_request_t* req, int* err) {
+    if (sock < 0 || !req || req->num_inherited > ZYGOTE_MAX_INHERITED) {
+        errno = (sock < 0) ? ENOTCONN : EINVAL;
+        return -1;
+    }
+
+    request_header_t h;
+    memset(&h, 0, sizeof(h));
+    size_t used = strlen(req->exe) + 1;
+    if (reserve(used) != 0) return -1;
+    memcpy(buffer, req->exe, used);
+    if (pack_strings(req->argv, &h.argc, &used) != 0 || pack_strings(req->envp, &h.envc, &used) != 0) {
+        errno = E2BIG;
+        return -1;
+    }
+    h.size = used;
+    h.num_inherited = req->num_inherited;
+    for (int sig = 1; sig <= 64 && sig < NSIG; ++sig)
+        if (req->sigdefault && sigismember(req->sigdefault, sig) == 1) h.sigdefault |= UINT64_C(1) << (sig - 1);
+
+    int fds[ZYGOTE_MAX_FDS];
+    memcpy(fds, req->fds, sizeof(req->fds));
+    /* répertoire courant du shell, que le fils rejoint par fchdir() */
+    if ((fds[3] = open(".", O_PATH | O_DIRECTORY | O_CLOEXEC)) < 0) return -1;
+    for (size_t i = 0; i < req->num_inherited; ++i) {
+        h.inherited[i] = req->inherited[i];
+        fds[4 + i] = req->inherited[i];
+    }
+
+    int r = send_header(&h, fds, 4 + req->num_inherited);
+    close(fds[3]);
+    reply_t reply;
+    if (r != 0 || send_all(sock, buffer, used) != 0 || recv_start(&reply) != 0) {
+        /* auxiliaire disparu (ou flux désynchronisé) : serveur désactivé */
+        int saved = errno;
+        zygote_stop();
+        errno = saved;
+        return -1;
+    }
+    *err = reply.value;
+    return reply.pid;
+}
+
+int zygote_wait(pid_t pid, int* wstatus, struct rusage* usage) {
+    reply_t reply;
+    size_t i = 0;
+    while (i < num_stash && stash[i].pid != pid) ++i;
+    if (i < num_stash) {
+        reply = stash[i];
+        stash[i] = stash[--num_stash];
+    } else {
+        if (sock < 0) {
+            errno = ECHILD;
+            return -1;
+        }
+        for (;;) {
+            if (recv_all(sock, &reply, sizeof(reply)) != 0) {
+                int saved = errno;
+                zygote_stop();
+                errno = saved;
+                return -1;
+            }
+            if (reply.type == REPLY_EXIT && reply.pid == pid) break;
+            if (reply.type == REPLY_EXIT && stash_add(&reply) != 0) return -1;
+        }
+    }
+    *wstatus = reply.value;
+    if (usage) *usage = reply.usage;
+    return 0;
+}
@@ -0,0 +1,85 @@
+#!/bin/sh
+# @file regress.sh
+# @brief Regression tests of the shell
+# @author Nom1
+# @author Nom2
+# @date 2025-26
+# @details Exécute chaque cas (lignes de commandes passées sur l'entrée standard du shell) et compare la sortie obtenue
+#   (sorties standard et d'erreur mêlées) à la sortie attendue. Affiche les cas en échec ; le code de retour est le nombre d'échecs.
+#
+#   Utilisation : regress.sh [minishell]   (par défaut : ./minishell)
+
+SHELL_BIN=${1:-./minishell}
+TMP=$(mktemp -d) || exit 1
+trap 'rm -rf "$TMP"' EXIT
+FAILED=0
+TOTAL=0
+
+# check <nom> <commandes> <sortie attendue>
+check() {
+    TOTAL=$((TOTAL + 1))
+    # le prompt (« répertoire$ »), affiché même lorsque le shell lit un tube, est retiré
+    got=$(cd "$TMP" && printf '%s\n' "$2" | "$SHELL_BIN" 2>&1 | sed "s|^\($TMP\\$ \)*||")
+    if [ "$got" != "$3" ]; then
+        FAILED=$((FAILED + 1))
+        printf 'ÉCHEC %s\n  attendu : %s\n  obtenu  : %s\n' "$1" "$3" "$got"
+    fi
+}
+
+# "&&" et "||" ne portent que sur leur propre liste, jamais au-delà d'un ";"
+check "liste-point-virgule" 'true ; false && echo WRONG
+echo ok' "ok"
+check "liste-point-virgule-ou" 'false ; true || echo WRONG
+echo ok' "ok"
+check "listes-chainees" 'false && echo WRONG || echo b ; true && echo c ; false || echo d' "b
+c
+d"
+
+# une commande introuvable est recherchée à nouveau une fois installée dans un répertoire du PATH
+check "cache-negatif" "mkdir neg
+export PATH=$TMP/neg:/bin:/usr/bin
+mytool
+printf '#!/bin/sh\\necho installed\\n' > neg/mytool
+chmod +x neg/mytool
+mytool" "mytool: command not found
+installed"
+# un chemin trouvé par un élément relatif du PATH n'est pas mémorisé
+check "path-relatif" "mkdir rel rel/a rel/b rel/c
+printf '#!/bin/sh\\necho A\\n' > rel/a/t
+printf '#!/bin/sh\\necho B\\n' > rel/b/t
+chmod +x rel/a/t rel/b/t
+echo 'non exécutable' > rel/c/t
+export PATH=.:$TMP/rel/b:/bin:/usr/bin
+cd rel/a
+t
+cd ../c
+t" "A
+B"
+
+# une ligne terminée par "\" non protégé se poursuit sur la suivante
+check "continuation" 'echo a\
+b
+echo one \
+  two
+echo "q\
+r" '"'s\\'"'
+echo x # c \
+echo z\\' 'ab
+one two
+qr s\
+x
+z\'
+
+# le message d'une commande qui ne peut pas être exécutée suit ses redirections
+check "erreur-exec-redirigee" "echo 'non exécutable' > noexec
+./noexec 2> err.txt
+cat err.txt
+./noexec 2>&1 | tr a-z A-Z" "./noexec: Permission denied
+./NOEXEC: PERMISSION DENIED"
+check "introuvable-redirigee" "nosuchcmd 2> err.txt
+cat err.txt
+nosuchcmd 2>&1 | tr a-z A-Z" "nosuchcmd: command not found
+NOSUCHCMD: COMMAND NOT FOUND"
+
+echo "$((TOTAL - FAILED))/$TOTAL cas réussis"
+exit $FAILED